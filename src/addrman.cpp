@@ -6,19 +6,23 @@
 #include <addrman.h>
 #include <addrman_impl.h>
 
+#include <crypto/common.h>
 #include <hash.h>
 #include <logging.h>
 #include <logging/timer.h>
 #include <netaddress.h>
 #include <protocol.h>
 #include <random.h>
+#include <rcu.h>
 #include <serialize.h>
 #include <streams.h>
 #include <tinyformat.h>
 #include <uint256.h>
+#include <span.h>
 #include <util/check.h>
 #include <util/time.h>
 
+#include <algorithm>
 #include <cmath>
 #include <optional>
 
@@ -129,6 +133,35 @@ double AddrInfo::GetChance(NodeSeconds now) const {
     return fChance;
 }
 
+void AddrSelectEntry::Update(const AddrInfo &info) {
+    m_time = TicksSinceEpoch<std::chrono::seconds>(info.nTime);
+    m_services = info.nServices;
+    m_last_try = TicksSinceEpoch<std::chrono::seconds>(info.m_last_try);
+    m_last_success = TicksSinceEpoch<std::chrono::seconds>(info.m_last_success);
+    m_attempts = info.nAttempts;
+}
+
+AddrInfo AddrSelectEntry::Load() const {
+    AddrInfo info{CAddress{m_service, ServiceFlags(m_services.load())},
+                  CNetAddr{}};
+    info.nTime = NodeSeconds{std::chrono::seconds{m_time}};
+    info.m_last_try = NodeSeconds{std::chrono::seconds{m_last_try}};
+    info.m_last_success = NodeSeconds{std::chrono::seconds{m_last_success}};
+    info.nAttempts = m_attempts;
+    return info;
+}
+
+/**
+ * Publish an object for the lock-free readers. The previous one is freed once
+ * no reader can be using it anymore. Must be called with an RCULock held.
+ */
+template <typename T>
+static void ReplacePublished(std::atomic<const T *> &published,
+                             const T *value) {
+    const T *previous = published.exchange(value);
+    RCUPtr<const T>::acquire(previous);
+}
+
 AddrManImpl::AddrManImpl(std::vector<bool> &&asmap, bool deterministic,
                          int32_t consistency_check_ratio)
     : insecure_rand{deterministic},
@@ -149,6 +182,20 @@ AddrManImpl::AddrManImpl(std::vector<bool> &&asmap, bool deterministic,
 
 AddrManImpl::~AddrManImpl() {
     nKey.SetNull();
+
+    {
+        RCULock lock;
+        for (auto &bucket : m_new_buckets) {
+            ReplacePublished<AddrManBucket>(bucket, nullptr);
+        }
+        for (auto &bucket : m_tried_buckets) {
+            ReplacePublished<AddrManBucket>(bucket, nullptr);
+        }
+        ReplacePublished<AddrManEntries>(m_entries, nullptr);
+    }
+
+    // Free the buckets once no reader can be using them anymore.
+    RCULock::synchronize();
 }
 
 template <typename Stream> void AddrManImpl::Serialize(Stream &s_) const {
@@ -182,7 +229,7 @@ template <typename Stream> void AddrManImpl::Serialize(Stream &s_) const {
      * v0 detect it as incompatible. This is necessary because it did not check
      * the version number on deserialization.
      *
-     * vvNew, vvTried, mapInfo, mapAddr and vRandom are never encoded
+     * vvNew, vvTried, m_infos, mapAddr and vRandom are never encoded
      * explicitly; they are instead reconstructed from the other information.
      *
      * This format is more complex, but significantly smaller (at most 1.5 MiB),
@@ -211,9 +258,12 @@ template <typename Stream> void AddrManImpl::Serialize(Stream &s_) const {
     s << nUBuckets;
     std::unordered_map<nid_type, int> mapUnkIds;
     int nIds = 0;
-    for (const auto &entry : mapInfo) {
-        mapUnkIds[entry.first] = nIds;
-        const AddrInfo &info = entry.second;
+    for (nid_type nId = 0; nId < nid_type(m_infos.size()); ++nId) {
+        if (!IsUsed(nId)) {
+            continue;
+        }
+        mapUnkIds[nId] = nIds;
+        const AddrInfo &info = m_infos[nId];
         if (info.nRefCount) {
             // this means nNew was wrong, oh ow
             assert(nIds != nNew);
@@ -222,9 +272,8 @@ template <typename Stream> void AddrManImpl::Serialize(Stream &s_) const {
         }
     }
     nIds = 0;
-    for (const auto &entry : mapInfo) {
-        const AddrInfo &info = entry.second;
-        if (info.fInTried) {
+    for (const AddrInfo &info : m_infos) {
+        if (info.nRandomPos >= 0 && info.fInTried) {
             // this means nTried was wrong, oh ow
             assert(nIds != nTried);
             s << info;
@@ -309,14 +358,16 @@ template <typename Stream> void AddrManImpl::Unserialize(Stream &s_) {
     }
 
     // Deserialize entries from the new table.
+    m_infos.reserve(nNew + nTried);
+    m_select_entries.reserve(nNew + nTried);
     for (int n = 0; n < nNew; n++) {
-        AddrInfo &info = mapInfo[n];
+        AddrInfo &info = m_infos.emplace_back();
         s >> info;
+        m_select_entries.push_back(RCUPtr<AddrSelectEntry>::make(info));
         mapAddr[info] = n;
         info.nRandomPos = vRandom.size();
         vRandom.push_back(n);
     }
-    nIdCount = nNew;
 
     // Deserialize entries from the tried table.
     int nLost = 0;
@@ -326,13 +377,14 @@ template <typename Stream> void AddrManImpl::Unserialize(Stream &s_) {
         int nKBucket = info.GetTriedBucket(nKey, m_asmap);
         int nKBucketPos = info.GetBucketPosition(nKey, false, nKBucket);
         if (vvTried[nKBucket][nKBucketPos] == -1) {
+            const nid_type nId = m_infos.size();
             info.nRandomPos = vRandom.size();
             info.fInTried = true;
-            vRandom.push_back(nIdCount);
-            mapInfo[nIdCount] = info;
-            mapAddr[info] = nIdCount;
-            vvTried[nKBucket][nKBucketPos] = nIdCount;
-            nIdCount++;
+            vRandom.push_back(nId);
+            m_infos.push_back(info);
+            m_select_entries.push_back(RCUPtr<AddrSelectEntry>::make(info));
+            mapAddr[info] = nId;
+            SetTried(nKBucket, nKBucketPos, nId);
         } else {
             nLost++;
         }
@@ -381,7 +433,7 @@ template <typename Stream> void AddrManImpl::Unserialize(Stream &s_) {
     for (auto bucket_entry : bucket_entries) {
         int bucket{bucket_entry.first};
         const int entry_index{bucket_entry.second};
-        AddrInfo &info = mapInfo[entry_index];
+        AddrInfo &info = m_infos[entry_index];
 
         // The entry shouldn't appear in more than
         // ADDRMAN_NEW_BUCKETS_PER_ADDRESS. If it has already, just skip
@@ -394,7 +446,7 @@ template <typename Stream> void AddrManImpl::Unserialize(Stream &s_) {
         if (restore_bucketing && vvNew[bucket][bucket_position] == -1) {
             // Bucketing has not changed, using existing bucket positions
             // for the new table
-            vvNew[bucket][bucket_position] = entry_index;
+            SetNew(bucket, bucket_position, entry_index);
             ++info.nRefCount;
         } else {
             // In case the new table data cannot be used (bucket count
@@ -403,7 +455,7 @@ template <typename Stream> void AddrManImpl::Unserialize(Stream &s_) {
             bucket = info.GetNewBucket(nKey, m_asmap);
             bucket_position = info.GetBucketPosition(nKey, true, bucket);
             if (vvNew[bucket][bucket_position] == -1) {
-                vvNew[bucket][bucket_position] = entry_index;
+                SetNew(bucket, bucket_position, entry_index);
                 ++info.nRefCount;
             }
         }
@@ -411,15 +463,15 @@ template <typename Stream> void AddrManImpl::Unserialize(Stream &s_) {
 
     // Prune new entries with refcount 0 (as a result of collisions).
     int nLostUnk = 0;
-    for (auto it = mapInfo.cbegin(); it != mapInfo.cend();) {
-        if (it->second.fInTried == false && it->second.nRefCount == 0) {
-            const auto itCopy = it++;
-            Delete(itCopy->first);
+    for (nid_type nId = 0; nId < nid_type(m_infos.size()); ++nId) {
+        if (IsUsed(nId) && m_infos[nId].fInTried == false &&
+            m_infos[nId].nRefCount == 0) {
+            Delete(nId);
             ++nLostUnk;
-        } else {
-            ++it;
         }
     }
+    m_entries_dirty = true;
+    Publish();
     if (nLost + nLostUnk > 0) {
         LogPrint(BCLog::ADDRMAN,
                  "addrman lost %i new and %i tried addresses due to "
@@ -444,9 +496,8 @@ AddrInfo *AddrManImpl::Find(const CService &addr, nid_type *pnId) {
     if (pnId) {
         *pnId = (*it).second;
     }
-    const auto it2 = mapInfo.find((*it).second);
-    if (it2 != mapInfo.end()) {
-        return &(*it2).second;
+    if (IsUsed(it->second)) {
+        return &m_infos[it->second];
     }
     return nullptr;
 }
@@ -455,15 +506,26 @@ AddrInfo *AddrManImpl::Create(const CAddress &addr, const CNetAddr &addrSource,
                               nid_type *pnId) {
     AssertLockHeld(cs);
 
-    nid_type nId = nIdCount++;
-    mapInfo[nId] = AddrInfo(addr, addrSource);
+    nid_type nId;
+    if (m_free_ids.empty()) {
+        nId = m_infos.size();
+        m_infos.emplace_back();
+        m_select_entries.resize(m_infos.size());
+    } else {
+        nId = m_free_ids.back();
+        m_free_ids.pop_back();
+    }
+    AddrInfo &info = m_infos[nId];
+    info = AddrInfo(addr, addrSource);
     mapAddr[addr] = nId;
-    mapInfo[nId].nRandomPos = vRandom.size();
+    info.nRandomPos = vRandom.size();
     vRandom.push_back(nId);
+    m_select_entries[nId] = RCUPtr<AddrSelectEntry>::make(info);
+    m_entries_dirty = true;
     if (pnId) {
         *pnId = nId;
     }
-    return &mapInfo[nId];
+    return &info;
 }
 
 void AddrManImpl::SwapRandom(unsigned int nRndPos1,
@@ -479,13 +541,11 @@ void AddrManImpl::SwapRandom(unsigned int nRndPos1,
     nid_type nId1 = vRandom[nRndPos1];
     nid_type nId2 = vRandom[nRndPos2];
 
-    const auto it_1{mapInfo.find(nId1)};
-    const auto it_2{mapInfo.find(nId2)};
-    assert(it_1 != mapInfo.end());
-    assert(it_2 != mapInfo.end());
+    assert(IsUsed(nId1));
+    assert(IsUsed(nId2));
 
-    it_1->second.nRandomPos = nRndPos2;
-    it_2->second.nRandomPos = nRndPos1;
+    m_infos[nId1].nRandomPos = nRndPos2;
+    m_infos[nId2].nRandomPos = nRndPos1;
 
     vRandom[nRndPos1] = nId2;
     vRandom[nRndPos2] = nId1;
@@ -494,15 +554,20 @@ void AddrManImpl::SwapRandom(unsigned int nRndPos1,
 void AddrManImpl::Delete(nid_type nId) {
     AssertLockHeld(cs);
 
-    assert(mapInfo.count(nId) != 0);
-    AddrInfo &info = mapInfo[nId];
+    assert(IsUsed(nId));
+    AddrInfo &info = m_infos[nId];
     assert(!info.fInTried);
     assert(info.nRefCount == 0);
 
     SwapRandom(info.nRandomPos, vRandom.size() - 1);
     vRandom.pop_back();
     mapAddr.erase(info);
-    mapInfo.erase(nId);
+    // The nId will be reused, so it can't be left as a pending collision.
+    m_tried_collisions.erase(nId);
+    info = AddrInfo();
+    m_select_entries[nId] = RCUPtr<AddrSelectEntry>();
+    m_free_ids.push_back(nId);
+    m_entries_dirty = true;
     nNew--;
 }
 
@@ -512,10 +577,10 @@ void AddrManImpl::ClearNew(int nUBucket, int nUBucketPos) {
     // if there is an entry in the specified bucket, delete it.
     if (vvNew[nUBucket][nUBucketPos] != -1) {
         nid_type nIdDelete = vvNew[nUBucket][nUBucketPos];
-        AddrInfo &infoDelete = mapInfo[nIdDelete];
+        AddrInfo &infoDelete = m_infos[nIdDelete];
         assert(infoDelete.nRefCount > 0);
         infoDelete.nRefCount--;
-        vvNew[nUBucket][nUBucketPos] = -1;
+        SetNew(nUBucket, nUBucketPos, -1);
         LogPrint(BCLog::ADDRMAN, "Removed %s from new[%i][%i]\n",
                  infoDelete.ToStringAddrPort(), nUBucket, nUBucketPos);
         if (infoDelete.nRefCount == 0) {
@@ -524,6 +589,82 @@ void AddrManImpl::ClearNew(int nUBucket, int nUBucketPos) {
     }
 }
 
+void AddrManImpl::SetNew(int bucket, int pos, nid_type nId) {
+    AssertLockHeld(cs);
+
+    vvNew[bucket][pos] = nId;
+    m_dirty_new_buckets.push_back(bucket);
+}
+
+void AddrManImpl::SetTried(int bucket, int pos, nid_type nId) {
+    AssertLockHeld(cs);
+
+    vvTried[bucket][pos] = nId;
+    m_dirty_tried_buckets.push_back(bucket);
+}
+
+void AddrManImpl::UpdateSelectEntry(nid_type nId) {
+    AssertLockHeld(cs);
+
+    m_select_entries[nId]->Update(m_infos[nId]);
+}
+
+void AddrManImpl::Publish() {
+    AssertLockHeld(cs);
+
+    RCULock lock;
+    const auto publish = [&](std::vector<int> &dirty, auto &published,
+                             const auto &table) {
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        for (const int bucket : dirty) {
+            RCUPtr<AddrManBucket> copy;
+            for (int pos = 0; pos < ADDRMAN_BUCKET_SIZE; pos++) {
+                if (table[bucket][pos] == -1) {
+                    continue;
+                }
+                if (!copy) {
+                    copy = RCUPtr<AddrManBucket>::make();
+                }
+                copy->entries[pos] = m_select_entries[table[bucket][pos]];
+            }
+            ReplacePublished<AddrManBucket>(published[bucket],
+                                            copy.release());
+        }
+        dirty.clear();
+    };
+    publish(m_dirty_new_buckets, m_new_buckets, vvNew);
+    publish(m_dirty_tried_buckets, m_tried_buckets, vvTried);
+
+    if (m_entries_dirty) {
+        RCUPtr<AddrManEntries> entries;
+        if (!vRandom.empty()) {
+            entries = RCUPtr<AddrManEntries>::make();
+            entries->entries.reserve(vRandom.size());
+            for (const nid_type nId : vRandom) {
+                entries->entries.push_back(m_select_entries[nId]);
+            }
+        }
+        ReplacePublished<AddrManEntries>(m_entries, entries.release());
+        m_entries_dirty = false;
+    }
+
+    m_published_new = nNew;
+    m_published_tried = nTried;
+}
+
+FastRandomContext &AddrManImpl::GetReadRandomness() const {
+    // Seeding a context is expensive, so there is one per thread.
+    static thread_local FastRandomContext rng;
+    if (deterministic) {
+        // Make the reads reproducible, in the order they happen.
+        uint256 seed;
+        WriteLE64(seed.begin(), m_read_count++);
+        rng.Reseed(seed);
+    }
+    return rng;
+}
+
 void AddrManImpl::MakeTried(AddrInfo &info, nid_type nId) {
     AssertLockHeld(cs);
 
@@ -533,7 +674,7 @@ void AddrManImpl::MakeTried(AddrInfo &info, nid_type nId) {
         const int bucket{(start_bucket + n) % ADDRMAN_NEW_BUCKET_COUNT};
         const int pos{info.GetBucketPosition(nKey, true, bucket)};
         if (vvNew[bucket][pos] == nId) {
-            vvNew[bucket][pos] = -1;
+            SetNew(bucket, pos, -1);
             info.nRefCount--;
             if (info.nRefCount == 0) {
                 break;
@@ -553,12 +694,12 @@ void AddrManImpl::MakeTried(AddrInfo &info, nid_type nId) {
     if (vvTried[nKBucket][nKBucketPos] != -1) {
         // find an item to evict
         nid_type nIdEvict = vvTried[nKBucket][nKBucketPos];
-        assert(mapInfo.count(nIdEvict) == 1);
-        AddrInfo &infoOld = mapInfo[nIdEvict];
+        assert(IsUsed(nIdEvict));
+        AddrInfo &infoOld = m_infos[nIdEvict];
 
         // Remove the to-be-evicted item from the tried set.
         infoOld.fInTried = false;
-        vvTried[nKBucket][nKBucketPos] = -1;
+        SetTried(nKBucket, nKBucketPos, -1);
         nTried--;
 
         // find which new bucket it belongs to
@@ -569,7 +710,7 @@ void AddrManImpl::MakeTried(AddrInfo &info, nid_type nId) {
 
         // Enter it into the new set again.
         infoOld.nRefCount = 1;
-        vvNew[nUBucket][nUBucketPos] = nIdEvict;
+        SetNew(nUBucket, nUBucketPos, nIdEvict);
         nNew++;
         LogPrint(BCLog::ADDRMAN,
                  "Moved %s from tried[%i][%i] to new[%i][%i] to make space\n",
@@ -578,7 +719,7 @@ void AddrManImpl::MakeTried(AddrInfo &info, nid_type nId) {
     }
     assert(vvTried[nKBucket][nKBucketPos] == -1);
 
-    vvTried[nKBucket][nKBucketPos] = nId;
+    SetTried(nKBucket, nKBucketPos, nId);
     nTried++;
     info.fInTried = true;
 }
@@ -609,6 +750,7 @@ bool AddrManImpl::AddSingle(const CAddress &addr, const CNetAddr &source,
 
         // add services
         pinfo->nServices = ServiceFlags(pinfo->nServices | addr.nServices);
+        UpdateSelectEntry(nId);
 
         // do not update if no new information is present
         if (addr.nTime <= pinfo->nTime) {
@@ -638,6 +780,7 @@ bool AddrManImpl::AddSingle(const CAddress &addr, const CNetAddr &source,
     } else {
         pinfo = Create(addr, source, &nId);
         pinfo->nTime = std::max(NodeSeconds{0s}, pinfo->nTime - time_penalty);
+        UpdateSelectEntry(nId);
         nNew++;
     }
 
@@ -646,7 +789,7 @@ bool AddrManImpl::AddSingle(const CAddress &addr, const CNetAddr &source,
     bool fInsert = vvNew[nUBucket][nUBucketPos] == -1;
     if (vvNew[nUBucket][nUBucketPos] != nId) {
         if (!fInsert) {
-            AddrInfo &infoExisting = mapInfo[vvNew[nUBucket][nUBucketPos]];
+            AddrInfo &infoExisting = m_infos[vvNew[nUBucket][nUBucketPos]];
             if (infoExisting.IsTerrible() ||
                 (infoExisting.nRefCount > 1 && pinfo->nRefCount == 0)) {
                 // Overwrite the existing new table entry.
@@ -656,7 +799,7 @@ bool AddrManImpl::AddSingle(const CAddress &addr, const CNetAddr &source,
         if (fInsert) {
             ClearNew(nUBucket, nUBucketPos);
             pinfo->nRefCount++;
-            vvNew[nUBucket][nUBucketPos] = nId;
+            SetNew(nUBucket, nUBucketPos, nId);
             LogPrint(BCLog::ADDRMAN, "Added %s mapped to AS%i to new[%i][%i]\n",
                      addr.ToStringAddrPort(), addr.GetMappedAS(m_asmap),
                      nUBucket, nUBucketPos);
@@ -688,6 +831,7 @@ void AddrManImpl::Good_(const CService &addr, bool test_before_evict,
     info.m_last_success = time;
     info.m_last_try = time;
     info.nAttempts = 0;
+    UpdateSelectEntry(nId);
     // nTime is not updated here, to avoid leaking information about
     // currently-connected peers.
 
@@ -711,13 +855,12 @@ void AddrManImpl::Good_(const CService &addr, bool test_before_evict,
             m_tried_collisions.insert(nId);
         }
         // Output the entry we'd be colliding with, for debugging purposes
-        auto colliding_entry =
-            mapInfo.find(vvTried[tried_bucket][tried_bucket_pos]);
+        const nid_type colliding_id{vvTried[tried_bucket][tried_bucket_pos]};
         LogPrint(BCLog::ADDRMAN,
                  "Collision with %s while attempting to move %s to tried "
                  "table. Collisions=%d\n",
-                 colliding_entry != mapInfo.end()
-                     ? colliding_entry->second.ToStringAddrPort()
+                 IsUsed(colliding_id)
+                     ? m_infos[colliding_id].ToStringAddrPort()
                      : "",
                  addr.ToStringAddrPort(), m_tried_collisions.size());
     } else {
@@ -749,7 +892,8 @@ void AddrManImpl::Attempt_(const CService &addr, bool fCountFailure,
                            NodeSeconds time) {
     AssertLockHeld(cs);
 
-    AddrInfo *pinfo = Find(addr);
+    nid_type nId;
+    AddrInfo *pinfo = Find(addr, &nId);
 
     // if not found, bail out
     if (!pinfo) {
@@ -764,105 +908,104 @@ void AddrManImpl::Attempt_(const CService &addr, bool fCountFailure,
         info.m_last_count_attempt = time;
         info.nAttempts++;
     }
+    UpdateSelectEntry(nId);
 }
 
-std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(bool newOnly) const {
-    AssertLockHeld(cs);
+/**
+ * Select an entry from the published buckets of a table, or nothing if the
+ * table is empty. Must be called with an RCULock held.
+ */
+static std::optional<AddrInfo>
+SelectFromBuckets(Span<const std::atomic<const AddrManBucket *>> buckets,
+                  const std::atomic<int> &count, FastRandomContext &rng) {
+    double fChanceFactor = 1.0;
+    // The count is reloaded, so a table emptied concurrently does not make us
+    // loop forever.
+    while (count.load() > 0) {
+        // Pick a bucket, and an initial position in that bucket.
+        const AddrManBucket *bucket{
+            buckets[rng.randrange(buckets.size())].load()};
+        int nBucketPos = rng.randrange(ADDRMAN_BUCKET_SIZE);
+        // If the bucket is entirely empty, start over with a (likely)
+        // different one.
+        if (!bucket) {
+            continue;
+        }
+        // Iterate over the positions of that bucket, starting at the initial
+        // one, and looping around. Published buckets are never empty.
+        const AddrSelectEntry *entry{nullptr};
+        for (int i = 0; i < ADDRMAN_BUCKET_SIZE && !entry; ++i) {
+            entry =
+                bucket->entries[(nBucketPos + i) % ADDRMAN_BUCKET_SIZE].get();
+        }
+        assert(entry);
+        AddrInfo info{entry->Load()};
+        // With probability GetChance() * fChanceFactor, return the entry.
+        if (rng.randbits<30>() <
+            fChanceFactor * info.GetChance() * (1 << 30)) {
+            return info;
+        }
+        // Otherwise start over with a (likely) different bucket, and
+        // increased chance factor.
+        fChanceFactor *= 1.2;
+    }
+    return std::nullopt;
+}
+
+std::pair<CAddress, NodeSeconds> AddrManImpl::Select(bool newOnly) const {
+    FastRandomContext &rng{GetReadRandomness()};
+    RCULock lock;
 
-    if (vRandom.empty()) {
+    const int num_new{m_published_new.load()};
+    const int num_tried{m_published_tried.load()};
+    if (num_new + num_tried == 0) {
         return {};
     }
 
-    if (newOnly && nNew == 0) {
+    if (newOnly && num_new == 0) {
         return {};
     }
 
     // Use a 50% chance for choosing between tried and new table entries.
-    if (!newOnly &&
-        (nTried > 0 && (nNew == 0 || insecure_rand.randbool() == 0))) {
+    if (!newOnly && (num_tried > 0 && (num_new == 0 || rng.randbool() == 0))) {
         // use a tried node
-        double fChanceFactor = 1.0;
-        while (1) {
-            // Pick a tried bucket, and an initial position in that bucket.
-            int nKBucket = insecure_rand.randrange(ADDRMAN_TRIED_BUCKET_COUNT);
-            int nKBucketPos = insecure_rand.randrange(ADDRMAN_BUCKET_SIZE);
-            // Iterate over the positions of that bucket, starting at the
-            // initial one, and looping around.
-            int i;
-            for (i = 0; i < ADDRMAN_BUCKET_SIZE; ++i) {
-                if (vvTried[nKBucket]
-                           [(nKBucketPos + i) % ADDRMAN_BUCKET_SIZE] != -1) {
-                    break;
-                }
-            }
-            // If the bucket is entirely empty, start over with a (likely)
-            // different one.
-            if (i == ADDRMAN_BUCKET_SIZE) {
-                continue;
-            }
-            // Find the entry to return.
-            nid_type nId =
-                vvTried[nKBucket][(nKBucketPos + i) % ADDRMAN_BUCKET_SIZE];
-            const auto it_found{mapInfo.find(nId)};
-            assert(it_found != mapInfo.end());
-            const AddrInfo &info{it_found->second};
-            // With probability GetChance() * fChanceFactor, return the entry.
-            if (insecure_rand.randbits<30>() <
-                fChanceFactor * info.GetChance() * (1 << 30)) {
-                LogPrint(BCLog::ADDRMAN, "Selected %s from tried\n",
-                         info.ToStringAddrPort());
-                return {info, info.m_last_try};
-            }
-            // Otherwise start over with a (likely) different bucket, and
-            // increased chance factor.
-            fChanceFactor *= 1.2;
-        }
-    } else {
-        // use a new node
-        double fChanceFactor = 1.0;
-        while (1) {
-            // Pick a new bucket, and an initial position in that bucket.
-            int nUBucket = insecure_rand.randrange(ADDRMAN_NEW_BUCKET_COUNT);
-            int nUBucketPos = insecure_rand.randrange(ADDRMAN_BUCKET_SIZE);
-            // Iterate over the positions of that bucket, starting at the
-            // initial one, and looping around.
-            int i;
-            for (i = 0; i < ADDRMAN_BUCKET_SIZE; ++i) {
-                if (vvNew[nUBucket][(nUBucketPos + i) % ADDRMAN_BUCKET_SIZE] !=
-                    -1) {
-                    break;
-                }
-            }
-            // If the bucket is entirely empty, start over with a (likely)
-            // different one.
-            if (i == ADDRMAN_BUCKET_SIZE) {
-                continue;
-            }
-            // Find the entry to return.
-            int nId = vvNew[nUBucket][(nUBucketPos + i) % ADDRMAN_BUCKET_SIZE];
-            const auto it_found{mapInfo.find(nId)};
-            assert(it_found != mapInfo.end());
-            const AddrInfo &info{it_found->second};
-            // With probability GetChance() * fChanceFactor, return the entry.
-            if (insecure_rand.randbits(30) <
-                fChanceFactor * info.GetChance() * (1 << 30)) {
-                LogPrint(BCLog::ADDRMAN, "Selected %s from new\n",
-                         info.ToStringAddrPort());
-                return {info, info.m_last_try};
-            }
-            // Otherwise start over with a (likely) different bucket, and
-            // increased chance factor.
-            fChanceFactor *= 1.2;
+        const auto info{
+            SelectFromBuckets(m_tried_buckets, m_published_tried, rng)};
+        if (!info) {
+            return {};
         }
+        LogPrint(BCLog::ADDRMAN, "Selected %s from tried\n",
+                 info->ToStringAddrPort());
+        return {*info, info->m_last_try};
     }
+
+    // use a new node
+    const auto info{SelectFromBuckets(m_new_buckets, m_published_new, rng)};
+    if (!info) {
+        return {};
+    }
+    LogPrint(BCLog::ADDRMAN, "Selected %s from new\n",
+             info->ToStringAddrPort());
+    return {*info, info->m_last_try};
 }
 
 std::vector<CAddress>
-AddrManImpl::GetAddr_(size_t max_addresses, size_t max_pct,
-                      std::optional<Network> network) const {
-    AssertLockHeld(cs);
+AddrManImpl::GetAddr(size_t max_addresses, size_t max_pct,
+                     std::optional<Network> network) const {
+    FastRandomContext &rng{GetReadRandomness()};
+    RCULock lock;
+
+    // Shuffle a copy of the pointers, the published entries are shared with
+    // the other readers.
+    std::vector<const AddrSelectEntry *> entries;
+    if (const AddrManEntries *published = m_entries.load()) {
+        entries.reserve(published->entries.size());
+        for (const auto &entry : published->entries) {
+            entries.push_back(entry.get());
+        }
+    }
 
-    size_t nNodes = vRandom.size();
+    size_t nNodes = entries.size();
     if (max_pct != 0) {
         nNodes = max_pct * nNodes / 100;
     }
@@ -873,17 +1016,14 @@ AddrManImpl::GetAddr_(size_t max_addresses, size_t max_pct,
     // gather a list of random nodes, skipping those of low quality
     const auto now{Now<NodeSeconds>()};
     std::vector<CAddress> addresses;
-    for (unsigned int n = 0; n < vRandom.size(); n++) {
+    for (size_t n = 0; n < entries.size(); n++) {
         if (addresses.size() >= nNodes) {
             break;
         }
 
-        int nRndPos = insecure_rand.randrange(vRandom.size() - n) + n;
-        SwapRandom(n, nRndPos);
-        const auto it{mapInfo.find(vRandom[n])};
-        assert(it != mapInfo.end());
-
-        const AddrInfo &ai{it->second};
+        size_t nRndPos = rng.randrange(entries.size() - n) + n;
+        std::swap(entries[n], entries[nRndPos]);
+        const AddrInfo ai{entries[n]->Load()};
 
         // Filter by network (optional)
         if (network != std::nullopt && ai.GetNetClass() != network) {
@@ -905,7 +1045,8 @@ AddrManImpl::GetAddr_(size_t max_addresses, size_t max_pct,
 void AddrManImpl::Connected_(const CService &addr, NodeSeconds time) {
     AssertLockHeld(cs);
 
-    AddrInfo *pinfo = Find(addr);
+    nid_type nId;
+    AddrInfo *pinfo = Find(addr, &nId);
 
     // if not found, bail out
     if (!pinfo) {
@@ -918,13 +1059,15 @@ void AddrManImpl::Connected_(const CService &addr, NodeSeconds time) {
     const auto update_interval{20min};
     if (time - info.nTime > update_interval) {
         info.nTime = time;
+        UpdateSelectEntry(nId);
     }
 }
 
 void AddrManImpl::SetServices_(const CService &addr, ServiceFlags nServices) {
     AssertLockHeld(cs);
 
-    AddrInfo *pinfo = Find(addr);
+    nid_type nId;
+    AddrInfo *pinfo = Find(addr, &nId);
 
     // if not found, bail out
     if (!pinfo) {
@@ -935,6 +1078,7 @@ void AddrManImpl::SetServices_(const CService &addr, ServiceFlags nServices) {
 
     // update info
     info.nServices = nServices;
+    UpdateSelectEntry(nId);
 }
 
 void AddrManImpl::ResolveCollisions_() {
@@ -948,13 +1092,12 @@ void AddrManImpl::ResolveCollisions_() {
 
         bool erase_collision = false;
 
-        // If id_new not found in mapInfo remove it from
+        // If id_new is not used anymore remove it from
         // m_tried_collisions.
-        auto id_new_it = mapInfo.find(id_new);
-        if (id_new_it == mapInfo.end()) {
+        if (!IsUsed(id_new)) {
             erase_collision = true;
         } else {
-            AddrInfo &info_new = mapInfo[id_new];
+            AddrInfo &info_new = m_infos[id_new];
 
             // Which tried bucket to move the entry to.
             int tried_bucket = info_new.GetTriedBucket(nKey, m_asmap);
@@ -968,7 +1111,7 @@ void AddrManImpl::ResolveCollisions_() {
 
                 // Get the to-be-evicted address that is being tested
                 nid_type id_old = vvTried[tried_bucket][tried_bucket_pos];
-                AddrInfo &info_old = mapInfo[id_old];
+                AddrInfo &info_old = m_infos[id_old];
 
                 // Has successfully connected in last X hours
                 if (current_time - info_old.m_last_success <
@@ -1033,20 +1176,24 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::SelectTriedCollision_() {
     std::advance(it, insecure_rand.randrange(m_tried_collisions.size()));
     nid_type id_new = *it;
 
-    // If id_new not found in mapInfo remove it from m_tried_collisions.
-    auto id_new_it = mapInfo.find(id_new);
-    if (id_new_it == mapInfo.end()) {
+    // If id_new is not used anymore remove it from m_tried_collisions.
+    if (!IsUsed(id_new)) {
         m_tried_collisions.erase(it);
         return {};
     }
 
-    const AddrInfo &newInfo = id_new_it->second;
+    const AddrInfo &newInfo = m_infos[id_new];
 
     // which tried bucket to move the entry to
     int tried_bucket = newInfo.GetTriedBucket(nKey, m_asmap);
     int tried_bucket_pos = newInfo.GetBucketPosition(nKey, false, tried_bucket);
 
-    const AddrInfo &info_old = mapInfo[vvTried[tried_bucket][tried_bucket_pos]];
+    const nid_type id_old{vvTried[tried_bucket][tried_bucket_pos]};
+    if (!IsUsed(id_old)) {
+        // Collision is not actually a collision anymore
+        return {};
+    }
+    const AddrInfo &info_old = m_infos[id_old];
     return {info_old, info_old.m_last_try};
 }
 
@@ -1082,9 +1229,20 @@ int AddrManImpl::CheckAddrman() const {
         return -7;
     }
 
-    for (const auto &entry : mapInfo) {
-        nid_type n = entry.first;
-        const AddrInfo &info = entry.second;
+    if (m_infos.size() != vRandom.size() + m_free_ids.size() ||
+        m_select_entries.size() != m_infos.size()) {
+        return -20;
+    }
+
+    for (nid_type n = 0; n < nid_type(m_infos.size()); n++) {
+        if (!IsUsed(n)) {
+            continue;
+        }
+        const AddrInfo &info = m_infos[n];
+        const AddrSelectEntry *entry = m_select_entries[n].get();
+        if (!entry || entry->GetService() != info) {
+            return -21;
+        }
         if (info.fInTried) {
             if (!TicksSinceEpoch<std::chrono::seconds>(info.m_last_success)) {
                 return -1;
@@ -1132,12 +1290,11 @@ int AddrManImpl::CheckAddrman() const {
                 if (!setTried.count(vvTried[n][i])) {
                     return -11;
                 }
-                const auto it{mapInfo.find(vvTried[n][i])};
-                if (it == mapInfo.end() ||
-                    it->second.GetTriedBucket(nKey, m_asmap) != n) {
+                const AddrInfo &info = m_infos[vvTried[n][i]];
+                if (info.GetTriedBucket(nKey, m_asmap) != n) {
                     return -17;
                 }
-                if (it->second.GetBucketPosition(nKey, false, n) != i) {
+                if (info.GetBucketPosition(nKey, false, n) != i) {
                     return -18;
                 }
                 setTried.erase(vvTried[n][i]);
@@ -1151,9 +1308,8 @@ int AddrManImpl::CheckAddrman() const {
                 if (!mapNew.count(vvNew[n][i])) {
                     return -12;
                 }
-                const auto it{mapInfo.find(vvNew[n][i])};
-                if (it == mapInfo.end() ||
-                    it->second.GetBucketPosition(nKey, true, n) != i) {
+                if (m_infos[vvNew[n][i]].GetBucketPosition(nKey, true, n) !=
+                    i) {
                     return -19;
                 }
                 if (--mapNew[vvNew[n][i]] == 0) {
@@ -1173,6 +1329,42 @@ int AddrManImpl::CheckAddrman() const {
         return -16;
     }
 
+    // The published buckets must mirror the tables once the dirty ones are
+    // published.
+    if (m_dirty_new_buckets.empty() && m_dirty_tried_buckets.empty() &&
+        !m_entries_dirty) {
+        RCULock lock;
+        if (m_published_new.load() != nNew ||
+            m_published_tried.load() != nTried) {
+            return -22;
+        }
+        const AddrManEntries *entries = m_entries.load();
+        if ((entries ? entries->entries.size() : 0) != vRandom.size()) {
+            return -24;
+        }
+        const auto check_buckets = [&](const auto &published,
+                                       const auto &table) {
+            for (size_t n = 0; n < published.size(); n++) {
+                const AddrManBucket *bucket = published[n].load();
+                for (int i = 0; i < ADDRMAN_BUCKET_SIZE; i++) {
+                    const AddrSelectEntry *entry =
+                        bucket ? bucket->entries[i].get() : nullptr;
+                    const AddrSelectEntry *expected =
+                        table[n][i] == -1 ? nullptr
+                                          : m_select_entries[table[n][i]].get();
+                    if (entry != expected) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        };
+        if (!check_buckets(m_new_buckets, vvNew) ||
+            !check_buckets(m_tried_buckets, vvTried)) {
+            return -23;
+        }
+    }
+
     return 0;
 }
 
@@ -1188,6 +1380,7 @@ bool AddrManImpl::Add(const std::vector<CAddress> &vAddr,
     LOCK(cs);
     Check();
     auto ret = Add_(vAddr, source, time_penalty);
+    Publish();
     Check();
     return ret;
 }
@@ -1197,6 +1390,7 @@ void AddrManImpl::Good(const CService &addr, bool test_before_evict,
     LOCK(cs);
     Check();
     Good_(addr, test_before_evict, time);
+    Publish();
     Check();
 }
 
@@ -1212,6 +1406,7 @@ void AddrManImpl::ResolveCollisions() {
     LOCK(cs);
     Check();
     ResolveCollisions_();
+    Publish();
     Check();
 }
 
@@ -1223,24 +1418,6 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::SelectTriedCollision() {
     return ret;
 }
 
-std::pair<CAddress, NodeSeconds> AddrManImpl::Select(bool newOnly) const {
-    LOCK(cs);
-    Check();
-    auto addrRet = Select_(newOnly);
-    Check();
-    return addrRet;
-}
-
-std::vector<CAddress>
-AddrManImpl::GetAddr(size_t max_addresses, size_t max_pct,
-                     std::optional<Network> network) const {
-    LOCK(cs);
-    Check();
-    auto addresses = GetAddr_(max_addresses, max_pct, network);
-    Check();
-    return addresses;
-}
-
 void AddrManImpl::Connected(const CService &addr, NodeSeconds time) {
     LOCK(cs);
     Check();
@@ -9,12 +9,15 @@
 #include <logging/timer.h>
 #include <netaddress.h>
 #include <protocol.h>
+#include <rcu.h>
 #include <serialize.h>
 #include <sync.h>
 #include <timedata.h>
 #include <uint256.h>
 #include <util/time.h>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <optional>
 #include <set>
@@ -112,6 +115,55 @@ public:
     double GetChance(NodeSeconds now = Now<NodeSeconds>()) const;
 };
 
+/**
+ * The data about an address that Select() and GetAddr() need, readable
+ * without holding the AddrMan lock. The statistics are updated in place by the
+ * writers.
+ */
+class AddrSelectEntry {
+    const CService m_service;
+    std::atomic<int64_t> m_time;
+    std::atomic<uint64_t> m_services;
+    std::atomic<int64_t> m_last_try;
+    std::atomic<int64_t> m_last_success;
+    std::atomic<int> m_attempts;
+
+    IMPLEMENT_RCU_REFCOUNT(uint64_t);
+
+public:
+    explicit AddrSelectEntry(const AddrInfo &info) : m_service(info) {
+        Update(info);
+    }
+
+    const CService &GetService() const { return m_service; }
+
+    //! Copy the statistics of the entry.
+    void Update(const AddrInfo &info);
+
+    //! Get an AddrInfo with the address and statistics of the entry.
+    AddrInfo Load() const;
+};
+
+/**
+ * A copy of a bucket of the new or tried table, published for the lock-free
+ * readers. It is replaced as a whole when the bucket changes.
+ */
+struct AddrManBucket {
+    std::array<RCUPtr<const AddrSelectEntry>, ADDRMAN_BUCKET_SIZE> entries;
+
+    IMPLEMENT_RCU_REFCOUNT(uint64_t);
+};
+
+/**
+ * The entries of all the addresses in random position order, published for
+ * GetAddr(). It is replaced as a whole when addresses are added or removed.
+ */
+struct AddrManEntries {
+    std::vector<RCUPtr<const AddrSelectEntry>> entries;
+
+    IMPLEMENT_RCU_REFCOUNT(uint64_t);
+};
+
 class AddrManImpl {
 public:
     AddrManImpl(std::vector<bool> &&asmap, bool deterministic,
@@ -141,12 +193,10 @@ public:
     std::pair<CAddress, NodeSeconds> SelectTriedCollision()
         EXCLUSIVE_LOCKS_REQUIRED(!cs);
 
-    std::pair<CAddress, NodeSeconds> Select(bool newOnly) const
-        EXCLUSIVE_LOCKS_REQUIRED(!cs);
+    std::pair<CAddress, NodeSeconds> Select(bool newOnly) const;
 
     std::vector<CAddress> GetAddr(size_t max_addresses, size_t max_pct,
-                                  std::optional<Network> network) const
-        EXCLUSIVE_LOCKS_REQUIRED(!cs);
+                                  std::optional<Network> network) const;
 
     void Connected(const CService &addr, NodeSeconds time)
         EXCLUSIVE_LOCKS_REQUIRED(!cs);
@@ -198,11 +248,15 @@ private:
     //! `Serialize()` instead.
     static constexpr uint8_t INCOMPATIBILITY_BASE = 32;
 
-    //! last used nId
-    nid_type nIdCount GUARDED_BY(cs){0};
+    //! information about all nIds, indexed by nId. The entries of the
+    //! unused nIds have a negative nRandomPos.
+    std::vector<AddrInfo> m_infos GUARDED_BY(cs);
 
-    //! table with information about all nIds
-    std::unordered_map<nid_type, AddrInfo> mapInfo GUARDED_BY(cs);
+    //! unused nIds, reused before growing m_infos.
+    std::vector<nid_type> m_free_ids GUARDED_BY(cs);
+
+    //! the entries published for the lock-free readers, indexed by nId.
+    std::vector<RCUPtr<AddrSelectEntry>> m_select_entries GUARDED_BY(cs);
 
     //! find an nId based on its network address and port.
     std::unordered_map<CService, nid_type, CServiceHash> mapAddr GUARDED_BY(cs);
@@ -226,6 +280,29 @@ private:
     nid_type
         vvNew[ADDRMAN_NEW_BUCKET_COUNT][ADDRMAN_BUCKET_SIZE] GUARDED_BY(cs);
 
+    //! Copies of the "new" and "tried" buckets for Select() and GetAddr(),
+    //! which read them under RCU instead of taking cs. Empty buckets are null.
+    std::array<std::atomic<const AddrManBucket *>, ADDRMAN_NEW_BUCKET_COUNT>
+        m_new_buckets{};
+    std::array<std::atomic<const AddrManBucket *>, ADDRMAN_TRIED_BUCKET_COUNT>
+        m_tried_buckets{};
+    //! nNew and nTried as of the last publication of the buckets.
+    std::atomic<int> m_published_new{0};
+    std::atomic<int> m_published_tried{0};
+    //! All the entries, for GetAddr(). Null when there is none.
+    std::atomic<const AddrManEntries *> m_entries{nullptr};
+
+    //! Buckets modified since they were last published. Only the last change
+    //! of a bucket is published when a batch of addresses is added.
+    std::vector<int> m_dirty_new_buckets GUARDED_BY(cs);
+    std::vector<int> m_dirty_tried_buckets GUARDED_BY(cs);
+    //! Whether entries were created or deleted since m_entries was published.
+    bool m_entries_dirty GUARDED_BY(cs){false};
+
+    //! Number of lock-free reads, used to seed their randomness in
+    //! deterministic mode.
+    mutable std::atomic<uint64_t> m_read_count{0};
+
     //! last time Good was called (memory only).
     //! Initially set to 1 so that "never" is strictly worse.
     NodeSeconds m_last_good GUARDED_BY(cs){1s};
@@ -260,6 +337,12 @@ private:
     //! For testing purpose only.
     bool deterministic = false;
 
+    //! Whether nId is used by an entry.
+    bool IsUsed(nid_type nId) const EXCLUSIVE_LOCKS_REQUIRED(cs) {
+        return nId >= 0 && size_t(nId) < m_infos.size() &&
+               m_infos[nId].nRandomPos >= 0;
+    }
+
     //! Find an entry.
     AddrInfo *Find(const CService &addr, nid_type *pnId = nullptr)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
@@ -280,6 +363,22 @@ private:
     //! are actually deleted.
     void ClearNew(int nUBucket, int nUBucketPos) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    //! Set a position in the "new" or "tried" table, and mark the bucket for
+    //! publication.
+    void SetNew(int bucket, int pos, nid_type nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    void SetTried(int bucket, int pos, nid_type nId)
+        EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    //! Publish the statistics of an entry for the lock-free readers.
+    void UpdateSelectEntry(nid_type nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    //! Publish the changes since the last call for the lock-free readers.
+    void Publish() EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    //! The randomness of the lock-free reads of the calling thread. It is
+    //! reseeded from m_read_count at each call in deterministic mode.
+    FastRandomContext &GetReadRandomness() const;
+
     //! Move an entry from the "new" table(s) to the "tried" table
     void MakeTried(AddrInfo &info, nid_type nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
@@ -300,13 +399,6 @@ private:
     void Attempt_(const CService &addr, bool fCountFailure, NodeSeconds time)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
 
-    std::pair<CAddress, NodeSeconds> Select_(bool newOnly) const
-        EXCLUSIVE_LOCKS_REQUIRED(cs);
-
-    std::vector<CAddress> GetAddr_(size_t max_addresses, size_t max_pct,
-                                   std::optional<Network> network) const
-        EXCLUSIVE_LOCKS_REQUIRED(cs);
-
     void Connected_(const CService &addr, NodeSeconds time)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
 
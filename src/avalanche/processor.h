@@ -395,6 +395,10 @@ public:
     bool SendMessages(const ::Config &config, CNode *pnode) override {
         return false;
     }
+    bool ServeRequests(const ::Config &config, CNode *pnode,
+                       const std::atomic<bool> &interrupt) override {
+        return false;
+    }
 
     /** Handle removal of a node */
     void FinalizeNode(const ::Config &config,
@@ -8,7 +8,9 @@
 #include <util/check.h>
 #include <util/time.h>
 
+#include <atomic>
 #include <optional>
+#include <thread>
 #include <vector>
 
 /*
@@ -109,6 +111,48 @@ static void AddrManGetAddr(benchmark::Bench &bench) {
     });
 }
 
+/**
+ * Run bench_fn while another thread keeps adding the addresses again, like the
+ * message handler does when peers relay addresses. Select() and GetAddr() do
+ * not wait for it.
+ */
+template <typename Callable>
+static void RunWhileAdding(benchmark::Bench &bench, Callable &&bench_fn) {
+    AddrMan addrman(/*asmap=*/std::vector<bool>(),
+                    /*deterministic=*/false,
+                    /*consistency_check_ratio=*/0);
+
+    FillAddrMan(addrman);
+
+    std::atomic<bool> stop{false};
+    std::thread adder([&] {
+        while (!stop) {
+            AddAddressesToAddrMan(addrman);
+        }
+    });
+
+    bench.run([&] { bench_fn(addrman); });
+
+    stop = true;
+    adder.join();
+}
+
+static void AddrManSelectWhileAdding(benchmark::Bench &bench) {
+    RunWhileAdding(bench, [](const AddrMan &addrman) {
+        const auto &address = addrman.Select();
+        assert(address.first.GetPort() > 0);
+    });
+}
+
+static void AddrManGetAddrWhileAdding(benchmark::Bench &bench) {
+    RunWhileAdding(bench, [](const AddrMan &addrman) {
+        const auto &addresses =
+            addrman.GetAddr(/* max_addresses */ 2500, /* max_pct */ 23,
+                            /* network */ std::nullopt);
+        assert(addresses.size() > 0);
+    });
+}
+
 static void AddrManAddThenGood(benchmark::Bench &bench) {
     auto markSomeAsGood = [](AddrMan &addrman) {
         for (size_t source_i = 0; source_i < NUM_SOURCES; ++source_i) {
@@ -143,4 +187,6 @@ static void AddrManAddThenGood(benchmark::Bench &bench) {
 BENCHMARK(AddrManAdd);
 BENCHMARK(AddrManSelect);
 BENCHMARK(AddrManGetAddr);
+BENCHMARK(AddrManSelectWhileAdding);
+BENCHMARK(AddrManGetAddrWhileAdding);
 BENCHMARK(AddrManAddThenGood);
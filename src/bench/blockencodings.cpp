@@ -0,0 +1,86 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <blockencodings.h>
+#include <kernel/mempool_entry.h>
+#include <random.h>
+#include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <util/chaintype.h>
+#include <validation.h>
+
+#include <vector>
+
+/** Number of transactions in the compact block, all from the mempool */
+static constexpr size_t BLOCK_TX_COUNT{500};
+
+static void AddTx(const CTransactionRef &tx, CTxMemPool &pool)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs) {
+    LockPoints lp;
+    pool.addUnchecked(CTxMemPoolEntryRef::make(tx, 1000 * SATOSHI, /*time=*/0,
+                                               /*height=*/1,
+                                               /*_sigChecks=*/1, lp));
+}
+
+/**
+ * Measure how long it takes to match a compact block against a mempool of
+ * mempool_size transactions, which is what delays the block relay.
+ */
+static void BlockEncodingReconstruction(benchmark::Bench &bench,
+                                        size_t mempool_size) {
+    const auto testing_setup =
+        MakeNoLogFileContext<const TestingSetup>(ChainType::REGTEST);
+    CTxMemPool &pool = *Assert(testing_setup->m_node.mempool);
+    FastRandomContext det_rand{true};
+
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vout.resize(1);
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+
+    {
+        LOCK2(cs_main, pool.cs);
+        for (size_t i = 0; i < mempool_size; ++i) {
+            CMutableTransaction tx;
+            tx.vin.resize(1);
+            tx.vin[0].prevout = COutPoint(TxId(det_rand.rand256()), 0);
+            tx.vout.resize(1);
+            tx.vout[0].nValue = 42 * SATOSHI;
+            const CTransactionRef tx_ref{MakeTransactionRef(tx)};
+            AddTx(tx_ref, pool);
+            // Spread the block transactions over the mempool
+            if (i % (mempool_size / BLOCK_TX_COUNT) == 0 &&
+                block.vtx.size() <= BLOCK_TX_COUNT) {
+                block.vtx.push_back(tx_ref);
+            }
+        }
+    }
+
+    const CBlockHeaderAndShortTxIDs cmpctblock{block, det_rand.rand64()};
+    const std::vector<CTransactionRef> extra_txn;
+
+    bench.unit("block").run([&] {
+        PartiallyDownloadedBlock partial_block{
+            testing_setup->m_node.chainman->GetConfig(), &pool};
+        const auto status{partial_block.InitData(cmpctblock, extra_txn)};
+        assert(status == READ_STATUS_OK);
+        assert(partial_block.IsTxAvailable(BLOCK_TX_COUNT));
+    });
+}
+
+static void BlockEncodingReconstruction1k(benchmark::Bench &bench) {
+    BlockEncodingReconstruction(bench, 1'000);
+}
+static void BlockEncodingReconstruction10k(benchmark::Bench &bench) {
+    BlockEncodingReconstruction(bench, 10'000);
+}
+static void BlockEncodingReconstruction100k(benchmark::Bench &bench) {
+    BlockEncodingReconstruction(bench, 100'000);
+}
+
+BENCHMARK(BlockEncodingReconstruction1k);
+BENCHMARK(BlockEncodingReconstruction10k);
+BENCHMARK(BlockEncodingReconstruction100k);
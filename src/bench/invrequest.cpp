@@ -0,0 +1,79 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <invrequest.h>
+#include <primitives/txid.h>
+#include <random.h>
+
+#include <chrono>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/** Number of peers announcing each transaction */
+static constexpr NodeId ANNOUNCERS_PER_TX{10};
+static constexpr NodeId NUM_PEERS{100};
+/** Number of transactions tracked, 100k announcements in total */
+static constexpr size_t NUM_TXIDS{10'000};
+
+/**
+ * Measure the cost of tracking one more transaction while 100k announcements
+ * are outstanding, following what PeerManagerImpl does: the transaction is
+ * announced by several peers, requested from one of them and eventually
+ * received, and the oldest transaction is forgotten.
+ */
+static void InvRequestTrackerChurn(benchmark::Bench &bench,
+                                   InvRequestTrackerImplType type) {
+    FastRandomContext rng{/*fDeterministic=*/true};
+    InvRequestTracker<TxId> tracker{/*deterministic=*/false, type};
+
+    std::vector<TxId> txids;
+    txids.reserve(NUM_TXIDS);
+    std::chrono::microseconds now{1h};
+    size_t next{0};
+
+    auto announce = [&](const TxId &txid) {
+        for (NodeId i = 0; i < ANNOUNCERS_PER_TX; ++i) {
+            const NodeId peer = (next + i * (NUM_PEERS / ANNOUNCERS_PER_TX)) %
+                                NUM_PEERS;
+            const bool preferred = peer % 4 == 0;
+            tracker.ReceivedInv(peer, txid, preferred,
+                                preferred ? now : now + 2s);
+        }
+    };
+
+    for (size_t i = 0; i < NUM_TXIDS; ++i) {
+        txids.emplace_back(rng.rand256());
+        announce(txids.back());
+        ++next;
+    }
+    assert(tracker.Size() == NUM_TXIDS * ANNOUNCERS_PER_TX);
+
+    bench.unit("tx").run([&] {
+        now += 1ms;
+
+        TxId &slot = txids[next % NUM_TXIDS];
+        tracker.ReceivedResponse(next % NUM_PEERS, slot);
+        tracker.ForgetInvId(slot);
+        slot = TxId(rng.rand256());
+        announce(slot);
+
+        const NodeId peer = next % NUM_PEERS;
+        for (const TxId &txid : tracker.GetRequestable(peer, now, nullptr)) {
+            tracker.RequestedData(peer, txid, now + 60s);
+        }
+        ++next;
+    });
+}
+
+static void InvRequestTrackerOrdered(benchmark::Bench &bench) {
+    InvRequestTrackerChurn(bench, InvRequestTrackerImplType::ORDERED);
+}
+static void InvRequestTrackerFlat(benchmark::Bench &bench) {
+    InvRequestTrackerChurn(bench, InvRequestTrackerImplType::FLAT);
+}
+
+BENCHMARK(InvRequestTrackerOrdered);
+BENCHMARK(InvRequestTrackerFlat);
@@ -0,0 +1,82 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chain.h>
+#include <consensus/validation.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <sync.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <test/util/setup_common.h>
+
+#include <vector>
+
+/** Number of transactions in each of the blocks that get disconnected. */
+static constexpr size_t TXS_PER_BLOCK{200};
+
+/**
+ * Disconnect the last reorg_depth blocks, which re-adds all their transactions
+ * to the mempool, then connect them back.
+ */
+static void Reorg(benchmark::Bench &bench, int reorg_depth) {
+    auto test_setup = MakeNoLogFileContext<TestChain100Setup>();
+    ChainstateManager &chainman = *test_setup->m_node.chainman;
+    CTxMemPool &mempool = *test_setup->m_node.mempool;
+
+    const CScript spk = CScript()
+                        << ToByteVector(test_setup->coinbaseKey.GetPubKey())
+                        << OP_CHECKSIG;
+
+    // Mine blocks full of signed transactions, as a chain of transactions
+    // spending the first mature coinbase.
+    CTransactionRef prev_tx = test_setup->m_coinbase_txns[0];
+    int prev_height = 1;
+    CBlockIndex *fork_block = nullptr;
+    for (int b = 0; b < reorg_depth; ++b) {
+        std::vector<CMutableTransaction> txns;
+        txns.reserve(TXS_PER_BLOCK);
+        for (size_t i = 0; i < TXS_PER_BLOCK; ++i) {
+            const Amount amount = prev_tx->vout[0].nValue - 10000 * SATOSHI;
+            txns.push_back(test_setup->CreateValidMempoolTransaction(
+                prev_tx, /*input_vout=*/0, prev_height,
+                test_setup->coinbaseKey, spk, amount, /*submit=*/false));
+            prev_tx = MakeTransactionRef(txns.back());
+        }
+        test_setup->CreateAndProcessBlock(txns, spk);
+        prev_height = WITH_LOCK(::cs_main, return chainman.ActiveHeight());
+        if (!fork_block) {
+            fork_block = WITH_LOCK(::cs_main, return chainman.ActiveTip());
+        }
+    }
+
+    const size_t num_txs = TXS_PER_BLOCK * reorg_depth;
+
+    bench.unit("reorg").run([&] {
+        BlockValidationState state;
+        chainman.ActiveChainstate().InvalidateBlock(state, fork_block);
+        assert(state.IsValid());
+        assert(mempool.size() == num_txs);
+
+        WITH_LOCK(::cs_main,
+                  chainman.ActiveChainstate().ResetBlockFailureFlags(
+                      fork_block));
+        chainman.ActiveChainstate().ActivateBestChain(state);
+        assert(state.IsValid());
+        assert(mempool.size() == 0);
+    });
+}
+
+static void ReorgDepth1(benchmark::Bench &bench) {
+    Reorg(bench, 1);
+}
+
+static void ReorgDepth5(benchmark::Bench &bench) {
+    Reorg(bench, 5);
+}
+
+BENCHMARK(ReorgDepth1);
+BENCHMARK(ReorgDepth5);
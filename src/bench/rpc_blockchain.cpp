@@ -6,6 +6,7 @@
 #include <bench/data.h>
 
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <streams.h>
 #include <util/chaintype.h>
 #include <validation.h>
@@ -14,6 +15,8 @@
 
 #include <univalue.h>
 
+#include <string_view>
+
 namespace {
 
 struct TestBlockAndIndex {
@@ -64,3 +67,19 @@ static void BlockToJsonVerboseWrite(benchmark::Bench &bench) {
 }
 
 BENCHMARK(BlockToJsonVerboseWrite);
+
+static void BlockToJsonVerboseStream(benchmark::Bench &bench) {
+    TestBlockAndIndex data;
+    bench.run([&] {
+        size_t size{0};
+        JSONStreamWriter writer{
+            [&](std::string_view chunk) { size += chunk.size(); }};
+        blockToJSON(data.testing_setup->m_node.chainman->m_blockman,
+                    data.block, data.blockindex, data.blockindex,
+                    TxVerbosity::SHOW_DETAILS_AND_PREVOUT, writer);
+        writer.Finish();
+        ankerl::nanobench::doNotOptimizeAway(size);
+    });
+}
+
+BENCHMARK(BlockToJsonVerboseStream);
@@ -0,0 +1,136 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat/compat.h>
+#include <util/sock.h>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/socket.h>
+
+/**
+ * Number of idle and active peers. The total number of sockets is kept below
+ * the usual default limit of 1024 open files.
+ */
+static constexpr size_t NUM_IDLE_PEERS{400};
+static constexpr size_t NUM_ACTIVE_PEERS{16};
+
+/**
+ * Connected pairs of sockets. The first socket is the one the node waits on,
+ * the second one plays the remote peer.
+ */
+struct SockPairs {
+    std::vector<std::shared_ptr<Sock>> local;
+    std::vector<std::shared_ptr<Sock>> remote;
+
+    explicit SockPairs(size_t num_pairs) {
+        for (size_t i = 0; i < num_pairs; ++i) {
+            int fds[2];
+            const int ret{socketpair(AF_UNIX, SOCK_STREAM, 0, fds)};
+            assert(ret == 0);
+            local.push_back(std::make_shared<Sock>(fds[0]));
+            remote.push_back(std::make_shared<Sock>(fds[1]));
+            const bool non_blocking{local.back()->SetNonBlocking()};
+            assert(non_blocking);
+        }
+    }
+
+    /** Make the active peers send a byte each */
+    void SendFromActive() const {
+        const uint8_t byte{0};
+        for (size_t i = NUM_IDLE_PEERS; i < remote.size(); ++i) {
+            const auto ret{remote[i]->Send(&byte, 1, 0)};
+            assert(ret == 1);
+        }
+    }
+};
+
+/**
+ * Build the set of all the sockets to wait on at each iteration and poll
+ * them, as CConnman::SocketHandler() does.
+ */
+static void SockWaitMany(benchmark::Bench &bench) {
+    const SockPairs pairs{NUM_IDLE_PEERS + NUM_ACTIVE_PEERS};
+
+    bench.run([&] {
+        pairs.SendFromActive();
+
+        Sock::EventsPerSock events_per_sock;
+        for (const auto &sock : pairs.local) {
+            events_per_sock.emplace(sock, Sock::Events{Sock::RECV});
+        }
+        const bool ret{
+            pairs.local[0]->WaitMany(std::chrono::milliseconds{50},
+                                     events_per_sock)};
+        assert(ret);
+
+        size_t num_ready{0};
+        uint8_t buf[16];
+        for (const auto &[sock, events] : events_per_sock) {
+            if (events.occurred & Sock::RECV) {
+                while (sock->Recv(buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+                }
+                ++num_ready;
+            }
+        }
+        assert(num_ready == NUM_ACTIVE_PEERS);
+    });
+}
+
+BENCHMARK(SockWaitMany);
+
+#ifdef USE_EPOLL
+/**
+ * Register the sockets once and only deal with the ready ones at each
+ * iteration, as CConnman::SocketHandlerEpoll() does.
+ */
+static void SockWaitEpoll(benchmark::Bench &bench) {
+    const SockPairs pairs{NUM_IDLE_PEERS + NUM_ACTIVE_PEERS};
+
+    SockEpoll epoll;
+    assert(epoll.IsValid());
+    for (size_t i = 0; i < pairs.local.size(); ++i) {
+        const bool ret{
+            epoll.Add(*pairs.local[i], i, /*edge_triggered=*/true)};
+        assert(ret);
+    }
+
+    // Consume the initial send readiness of all the sockets
+    std::vector<SockEpoll::ReadyEvent> ready;
+    do {
+        ready.clear();
+        const bool ret{epoll.Wait(std::chrono::milliseconds{0}, ready)};
+        assert(ret);
+    } while (!ready.empty());
+
+    bench.run([&] {
+        pairs.SendFromActive();
+
+        ready.clear();
+        const bool ret{epoll.Wait(std::chrono::milliseconds{50}, ready)};
+        assert(ret);
+
+        size_t num_ready{0};
+        uint8_t buf[16];
+        for (const auto &[key, occurred] : ready) {
+            if (occurred & Sock::RECV) {
+                // Edge-triggered: drain the socket
+                while (pairs.local[key]->Recv(buf, sizeof(buf),
+                                              MSG_DONTWAIT) > 0) {
+                }
+                ++num_ready;
+            }
+        }
+        assert(num_ready == NUM_ACTIVE_PEERS);
+    });
+}
+
+BENCHMARK(SockWaitEpoll);
+#endif // USE_EPOLL
+
+#endif // WIN32
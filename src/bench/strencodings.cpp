@@ -6,6 +6,9 @@
 #include <bench/data.h>
 #include <util/strencodings.h>
 
+#include <string>
+#include <vector>
+
 static void HexStrBench(benchmark::Bench &bench) {
     auto const &data = benchmark::data::block413567;
     bench.batch(data.size()).unit("byte").run([&] {
@@ -14,4 +17,33 @@ static void HexStrBench(benchmark::Bench &bench) {
     });
 }
 
+static void HexEncodeBench(benchmark::Bench &bench) {
+    auto const &data = benchmark::data::block413567;
+    std::string hex(data.size() * 2, '\0');
+    bench.batch(data.size()).unit("byte").run([&] {
+        HexEncode(data, hex);
+        ankerl::nanobench::doNotOptimizeAway(hex);
+    });
+}
+
+static void ParseHexBench(benchmark::Bench &bench) {
+    const std::string hex{HexStr(benchmark::data::block413567)};
+    bench.batch(hex.size() / 2).unit("byte").run([&] {
+        auto data = ParseHex(hex);
+        ankerl::nanobench::doNotOptimizeAway(data);
+    });
+}
+
+static void HexDecodePrefixBench(benchmark::Bench &bench) {
+    const std::string hex{HexStr(benchmark::data::block413567)};
+    std::vector<uint8_t> data(hex.size() / 2);
+    bench.batch(data.size()).unit("byte").run([&] {
+        auto size = HexDecodePrefix(hex, data);
+        ankerl::nanobench::doNotOptimizeAway(size);
+    });
+}
+
 BENCHMARK(HexStrBench);
+BENCHMARK(HexEncodeBench);
+BENCHMARK(ParseHexBench);
+BENCHMARK(HexDecodePrefixBench);
@@ -0,0 +1,91 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <common/bloom.h>
+#include <feerate.h>
+#include <kernel/mempool_entry.h>
+#include <test/util/setup_common.h>
+#include <txannouncementqueue.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <vector>
+
+/** Number of transactions relayed per trickle */
+static constexpr size_t TXS_PER_TRICKLE{1000};
+
+/**
+ * Measure the cost of announcing each relayed transaction to num_peers peers,
+ * following what PeerManagerImpl::SendMessages() does at every trickle.
+ */
+static void AnnounceTxs(benchmark::Bench &bench, size_t num_peers) {
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>();
+    CTxMemPool &pool = *Assert(testing_setup->m_node.mempool);
+
+    std::vector<TxId> txids;
+    {
+        LOCK2(cs_main, pool.cs);
+        TestMemPoolEntryHelper entry;
+        for (size_t i = 0; i < TXS_PER_TRICKLE; ++i) {
+            CMutableTransaction tx;
+            tx.vin.resize(1);
+            tx.vin[0].scriptSig = CScript() << i;
+            tx.vout.resize(1);
+            tx.vout[0].nValue = 42 * SATOSHI;
+            pool.addUnchecked(entry.Fee(1000 * SATOSHI).FromTx(tx));
+            txids.push_back(tx.GetId());
+        }
+    }
+
+    struct BenchPeer {
+        CRollingBloomFilter known_filter{1000, 0.000001};
+        CFeeRate fee_filter;
+        std::vector<TxId> invs;
+    };
+    std::vector<BenchPeer> peers(num_peers);
+    TxAnnouncementQueue queue{pool};
+    for (size_t i = 0; i < num_peers; ++i) {
+        queue.AddPeer(i);
+    }
+
+    bench.batch(TXS_PER_TRICKLE).unit("tx").run([&] {
+        for (const TxId &txid : txids) {
+            queue.Push(txid);
+        }
+        for (size_t i = 0; i < num_peers; ++i) {
+            BenchPeer &peer = peers[i];
+            peer.invs.clear();
+            queue.Seal();
+            LOCK(pool.cs);
+            queue.Consume(i, TXS_PER_TRICKLE,
+                          [&](const TxAnnouncement &announcement) {
+                              if (peer.known_filter.contains(
+                                      announcement.txid) ||
+                                  announcement.fee < peer.fee_filter.GetFee(
+                                                         announcement.vsize) ||
+                                  !pool.exists(announcement.txid)) {
+                                  return false;
+                              }
+                              peer.invs.push_back(announcement.txid);
+                              return true;
+                          });
+            assert(peer.invs.size() == TXS_PER_TRICKLE);
+        }
+    });
+}
+
+static void AnnounceTxsTo1Peer(benchmark::Bench &bench) {
+    AnnounceTxs(bench, 1);
+}
+static void AnnounceTxsTo100Peers(benchmark::Bench &bench) {
+    AnnounceTxs(bench, 100);
+}
+static void AnnounceTxsTo500Peers(benchmark::Bench &bench) {
+    AnnounceTxs(bench, 500);
+}
+
+BENCHMARK(AnnounceTxsTo1Peer);
+BENCHMARK(AnnounceTxsTo100Peers);
+BENCHMARK(AnnounceTxsTo500Peers);
@@ -0,0 +1,96 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <txpool.h>
+
+#include <cassert>
+#include <vector>
+
+/** Number of transactions added to the pool in each run */
+static constexpr size_t NUM_TXS{100'000};
+/** Number of distinct peers the transactions are received from */
+static constexpr NodeId NUM_PEERS{1000};
+
+/**
+ * Create NUM_TXS transactions spending random outpoints, and a block that
+ * spends the same outpoints so it conflicts with all of them.
+ */
+static void CreateTxs(std::vector<CTransactionRef> &txs, CBlock &block) {
+    FastRandomContext det_rand{true};
+
+    txs.reserve(NUM_TXS);
+    block.vtx.reserve(NUM_TXS);
+    for (size_t i = 0; i < NUM_TXS; ++i) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(TxId(det_rand.rand256()), 0);
+        tx.vin[0].scriptSig = CScript() << OP_TRUE;
+        tx.vout.resize(1);
+        tx.vout[0].nValue = 10 * COIN;
+        tx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        txs.push_back(MakeTransactionRef(tx));
+
+        // Same input, different output
+        tx.vout[0].nValue = 5 * COIN;
+        block.vtx.push_back(MakeTransactionRef(tx));
+    }
+}
+
+static void FillTxPool(TxPool &txpool, const std::vector<CTransactionRef> &txs) {
+    for (size_t i = 0; i < txs.size(); ++i) {
+        txpool.AddTx(txs[i], NodeId(i % NUM_PEERS));
+    }
+    assert(txpool.Size() == txs.size());
+}
+
+static void TxPoolAdd(benchmark::Bench &bench) {
+    std::vector<CTransactionRef> txs;
+    CBlock block;
+    CreateTxs(txs, block);
+
+    bench.batch(NUM_TXS).unit("tx").run([&] {
+        TxPool txpool("bench", 20min, 5min);
+        FillTxPool(txpool, txs);
+    });
+}
+
+static void TxPoolEraseForBlock(benchmark::Bench &bench) {
+    std::vector<CTransactionRef> txs;
+    CBlock block;
+    CreateTxs(txs, block);
+
+    bench.batch(NUM_TXS).unit("tx").run([&] {
+        TxPool txpool("bench", 20min, 5min);
+        FillTxPool(txpool, txs);
+        txpool.EraseForBlock(block);
+        assert(txpool.Size() == 0);
+    });
+}
+
+static void TxPoolLimit(benchmark::Bench &bench) {
+    std::vector<CTransactionRef> txs;
+    CBlock block;
+    CreateTxs(txs, block);
+
+    FastRandomContext rng{true};
+    bench.batch(NUM_TXS).unit("tx").run([&] {
+        TxPool txpool("bench", 20min, 5min);
+        FillTxPool(txpool, txs);
+        txpool.LimitTxs(NUM_TXS / 2, rng);
+        assert(txpool.Size() == NUM_TXS / 2);
+        // Evicting entries from peers one by one also walks the whole pool
+        for (NodeId peer = 0; peer < NUM_PEERS; ++peer) {
+            txpool.EraseForPeer(peer);
+        }
+        assert(txpool.Size() == 0);
+    });
+}
+
+BENCHMARK(TxPoolAdd);
+BENCHMARK(TxPoolEraseForBlock);
+BENCHMARK(TxPoolLimit);
@@ -0,0 +1,112 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <random.h>
+#include <tinyformat.h>
+#include <util/strencodings.h>
+
+#include <univalue.h>
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+/**
+ * An object with many keys, like the amounts of a large sendmany, about 6MB
+ * once written.
+ */
+static UniValue MakeLargeObject() {
+    FastRandomContext rng{/*fDeterministic=*/true};
+    UniValue obj(UniValue::VOBJ);
+    for (int i = 0; i < 100'000; ++i) {
+        obj.pushKVEnd("ecash:qq" + HexStr(rng.randbytes(20)),
+                      UniValue(UniValue::VNUM, strprintf("%d.%08d", i % 1000,
+                                                         rng.randrange(1000))));
+    }
+    return obj;
+}
+
+/**
+ * An array of small objects, like the inputs of a large transaction, about
+ * 4MB once written.
+ */
+static UniValue MakeLargeArray() {
+    FastRandomContext rng{/*fDeterministic=*/true};
+    UniValue arr(UniValue::VARR);
+    for (int i = 0; i < 20'000; ++i) {
+        UniValue input(UniValue::VOBJ);
+        input.pushKV("txid", HexStr(rng.randbytes(32)));
+        input.pushKV("vout", i % 7);
+        input.pushKV("scriptPubKey", HexStr(rng.randbytes(25)));
+        input.pushKV("amount", UniValue(UniValue::VNUM, "12.34567890"));
+        input.pushKV("label", "a \"quoted\" label \xc3\xa9");
+        input.pushKV("spent", false);
+        arr.push_back(std::move(input));
+    }
+    return arr;
+}
+
+static void UniValueReadLargeObject(benchmark::Bench &bench) {
+    const std::string json{MakeLargeObject().write()};
+    bench.batch(json.size()).unit("byte").run([&] {
+        UniValue value;
+        bool ok{value.read(json)};
+        assert(ok);
+    });
+}
+
+static void UniValueReadLargeArray(benchmark::Bench &bench) {
+    const std::string json{MakeLargeArray().write()};
+    bench.batch(json.size()).unit("byte").run([&] {
+        UniValue value;
+        bool ok{value.read(json)};
+        assert(ok);
+    });
+}
+
+static void UniValueWriteLargeObject(benchmark::Bench &bench) {
+    const UniValue obj{MakeLargeObject()};
+    bench.run([&] {
+        std::string json{obj.write()};
+        ankerl::nanobench::doNotOptimizeAway(json);
+    });
+}
+
+static void UniValueWriteLargeArray(benchmark::Bench &bench) {
+    const UniValue arr{MakeLargeArray()};
+    bench.run([&] {
+        std::string json{arr.write()};
+        ankerl::nanobench::doNotOptimizeAway(json);
+    });
+}
+
+static void UniValueFindValueLargeObject(benchmark::Bench &bench) {
+    const UniValue obj{MakeLargeObject()};
+    const std::vector<std::string> &keys{obj.getKeys()};
+    size_t i{0};
+    bench.run([&] {
+        i = (i + 7919) % keys.size();
+        const UniValue &value{obj.find_value(keys[i])};
+        assert(value.isNum());
+    });
+}
+
+static void UniValueGetReal(benchmark::Bench &bench) {
+    const UniValue obj{MakeLargeObject()};
+    bench.batch(obj.size()).unit("number").run([&] {
+        double sum{0};
+        for (const UniValue &value : obj.getValues()) {
+            sum += value.get_real();
+        }
+        ankerl::nanobench::doNotOptimizeAway(sum);
+    });
+}
+
+BENCHMARK(UniValueReadLargeObject);
+BENCHMARK(UniValueReadLargeArray);
+BENCHMARK(UniValueWriteLargeObject);
+BENCHMARK(UniValueWriteLargeArray);
+BENCHMARK(UniValueFindValueLargeObject);
+BENCHMARK(UniValueGetReal);
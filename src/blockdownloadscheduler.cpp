@@ -0,0 +1,120 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockdownloadscheduler.h>
+
+#include <algorithm>
+#include <cmath>
+
+/** Weight of a new sample in the smoothed throughput and block size */
+static constexpr double SAMPLE_WEIGHT{0.25};
+
+void BlockDownloadScheduler::BlockReceived(
+    NodeId peer, size_t block_size, std::chrono::microseconds request_time,
+    std::chrono::microseconds now) {
+    PeerState &state = m_peers[peer];
+    PeerStats &stats = state.stats;
+
+    // If the peer was busy sending us another block when this one was
+    // requested, only count the time since that block was received.
+    const auto start{std::max(request_time, state.last_received)};
+    const double elapsed_seconds{
+        double(std::max<int64_t>(1, (now - start).count())) / 1e6};
+    const double rate{double(block_size) / elapsed_seconds};
+
+    const double old_throughput{stats.throughput};
+    stats.throughput = stats.num_blocks == 0
+                           ? rate
+                           : old_throughput +
+                                 (rate - old_throughput) * SAMPLE_WEIGHT;
+    stats.min_latency = std::min(
+        stats.min_latency,
+        std::max(std::chrono::microseconds{0}, now - request_time));
+    state.last_received = now;
+
+    ++stats.num_blocks;
+    if (stats.num_blocks == MIN_BLOCKS_FOR_COMPARISON) {
+        m_total_throughput += stats.throughput;
+        ++m_num_measured_peers;
+    } else if (stats.num_blocks > MIN_BLOCKS_FOR_COMPARISON) {
+        m_total_throughput += stats.throughput - old_throughput;
+    }
+
+    m_avg_block_size =
+        m_avg_block_size == 0.
+            ? double(block_size)
+            : m_avg_block_size +
+                  (double(block_size) - m_avg_block_size) * SAMPLE_WEIGHT;
+}
+
+void BlockDownloadScheduler::RemovePeer(NodeId peer) {
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end()) {
+        return;
+    }
+
+    if (it->second.stats.num_blocks >= MIN_BLOCKS_FOR_COMPARISON) {
+        --m_num_measured_peers;
+        // Don't accumulate rounding errors once all the peers are gone
+        m_total_throughput =
+            m_num_measured_peers == 0
+                ? 0.
+                : std::max(0., m_total_throughput - it->second.stats.throughput);
+    }
+    m_peers.erase(it);
+}
+
+unsigned int BlockDownloadScheduler::GetInFlightTarget(NodeId peer) const {
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end() ||
+        it->second.stats.num_blocks < MIN_BLOCKS_FOR_COMPARISON ||
+        m_total_throughput <= 0.) {
+        return DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER;
+    }
+    const PeerStats &stats = it->second.stats;
+
+    // Share the blocks in flight in proportion to the throughput, so the
+    // total stays the same as if all the peers were equally fast.
+    const double mean_throughput{m_total_throughput / m_num_measured_peers};
+    double target{DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER * stats.throughput /
+                  mean_throughput};
+
+    // Keep enough blocks in flight to cover the round trip, otherwise the peer
+    // idles while our next request reaches it.
+    if (m_avg_block_size > 0.) {
+        const double latency_seconds{double(stats.min_latency.count()) / 1e6};
+        target = std::max(
+            target, stats.throughput * latency_seconds / m_avg_block_size + 1.);
+    }
+
+    return std::clamp<unsigned int>(
+        std::lround(std::min(target, double(MAX_BLOCKS_IN_FLIGHT_PER_PEER))),
+        MIN_BLOCKS_IN_FLIGHT_PER_PEER, MAX_BLOCKS_IN_FLIGHT_PER_PEER);
+}
+
+bool BlockDownloadScheduler::ShouldDuplicateRequest(NodeId peer,
+                                                    NodeId staller) const {
+    auto peer_it = m_peers.find(peer);
+    auto staller_it = m_peers.find(staller);
+    if (peer == staller || peer_it == m_peers.end() ||
+        staller_it == m_peers.end()) {
+        return false;
+    }
+
+    const PeerStats &peer_stats = peer_it->second.stats;
+    const PeerStats &staller_stats = staller_it->second.stats;
+    return peer_stats.num_blocks >= MIN_BLOCKS_FOR_COMPARISON &&
+           staller_stats.num_blocks >= MIN_BLOCKS_FOR_COMPARISON &&
+           peer_stats.throughput >=
+               staller_stats.throughput * DUPLICATE_REQUEST_SPEEDUP;
+}
+
+std::optional<BlockDownloadScheduler::PeerStats>
+BlockDownloadScheduler::GetPeerStats(NodeId peer) const {
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end()) {
+        return std::nullopt;
+    }
+    return it->second.stats;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BLOCKDOWNLOADSCHEDULER_H
+#define BITCOIN_BLOCKDOWNLOADSCHEDULER_H
+
+#include <nodeid.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+/**
+ * Number of blocks that can be requested at any given time from a peer we
+ * don't have measurements for yet.
+ */
+static constexpr unsigned int DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER{16};
+/** Bounds of the number of blocks in flight from a measured peer. */
+static constexpr unsigned int MIN_BLOCKS_IN_FLIGHT_PER_PEER{2};
+static constexpr unsigned int MAX_BLOCKS_IN_FLIGHT_PER_PEER{64};
+/**
+ * Number of blocks a peer must have delivered before its measurements are used
+ * to compare it with other peers.
+ */
+static constexpr uint64_t MIN_BLOCKS_FOR_COMPARISON{4};
+/**
+ * How much faster than the peer holding back the download window a peer must
+ * be for the blocking block to also be requested from it.
+ */
+static constexpr double DUPLICATE_REQUEST_SPEEDUP{2.};
+
+/**
+ * Measure how fast each peer delivers the blocks we request and decide how
+ * many blocks each of them should have in flight.
+ *
+ * During the initial block download, giving the same number of blocks to all
+ * the peers makes the download window wait for the slowest of them, while the
+ * fastest ones are idle. Instead, the blocks in flight are split between the
+ * peers in proportion to their throughput, and each peer gets at least enough
+ * requests to cover its round trip so its link never idles.
+ *
+ * The throughput of a peer is measured from the time between two consecutive
+ * blocks it delivers, or between the request and the delivery when it was
+ * idle. The latency is the shortest time it took to get a block since it was
+ * requested. Both are smoothed over the last few blocks.
+ *
+ * This class is not thread-safe, the caller is responsible for locking.
+ */
+class BlockDownloadScheduler {
+public:
+    struct PeerStats {
+        /** Smoothed download rate, in bytes per second */
+        double throughput{0.};
+        /** Shortest time between a request and the block delivery */
+        std::chrono::microseconds min_latency{std::chrono::microseconds::max()};
+        /** Number of blocks delivered */
+        uint64_t num_blocks{0};
+    };
+
+    /**
+     * A block of block_size bytes, requested at request_time, was received
+     * from the peer at time now.
+     */
+    void BlockReceived(NodeId peer, size_t block_size,
+                       std::chrono::microseconds request_time,
+                       std::chrono::microseconds now);
+
+    /** Forget about a peer, e.g. after it disconnected */
+    void RemovePeer(NodeId peer);
+
+    /** Number of blocks we want in flight from this peer */
+    unsigned int GetInFlightTarget(NodeId peer) const;
+
+    /**
+     * Whether a block held back by the staller should also be requested from
+     * the peer, because the peer is much faster.
+     */
+    bool ShouldDuplicateRequest(NodeId peer, NodeId staller) const;
+
+    std::optional<PeerStats> GetPeerStats(NodeId peer) const;
+
+private:
+    struct PeerState {
+        PeerStats stats;
+        /** When the last block from this peer was received */
+        std::chrono::microseconds last_received{0};
+    };
+
+    std::unordered_map<NodeId, PeerState> m_peers;
+    /** Sum of the throughput of the peers we have measurements for */
+    double m_total_throughput{0.};
+    size_t m_num_measured_peers{0};
+    /** Smoothed size of the blocks we download, in bytes */
+    double m_avg_block_size{0.};
+};
+
+#endif // BITCOIN_BLOCKDOWNLOADSCHEDULER_H
@@ -101,13 +101,17 @@ ReadStatus PartiallyDownloadedBlock::InitData(
 
     {
         LOCK(pool->cs);
-        auto it = pool->mapTx.begin();
-        while (it != pool->mapTx.end()) {
-            uint64_t shortid = cmpctblock.GetShortID((*it)->GetTx().GetHash());
+        // The short ids depend on the block, so there is no way around hashing
+        // all the mempool, but only the entries matching the block need to be
+        // dereferenced.
+        for (const auto &[txhash, it] : pool->txns_randomized) {
+            uint64_t shortid = cmpctblock.GetShortID(txhash);
+            if (!shortidProcessor->hasShortId(shortid)) {
+                continue;
+            }
 
             mempool_count +=
                 shortidProcessor->matchKnownItem(shortid, (*it)->GetSharedTx());
-            it++;
 
             if (mempool_count == shortidProcessor->getShortIdCount()) {
                 break;
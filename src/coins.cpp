@@ -28,6 +28,12 @@ void CCoinsView::BatchWrite(CoinsViewCacheCursor &cursor,
 CCoinsViewCursor *CCoinsView::Cursor() const {
     return nullptr;
 }
+std::vector<std::unique_ptr<CCoinsViewCursor>>
+CCoinsView::Cursors(size_t count) const {
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    cursors.emplace_back(Cursor());
+    return cursors;
+}
 bool CCoinsView::HaveCoin(const COutPoint &outpoint) const {
     return GetCoin(outpoint).has_value();
 }
@@ -55,6 +61,10 @@ void CCoinsViewBacked::BatchWrite(CoinsViewCacheCursor &cursor,
 CCoinsViewCursor *CCoinsViewBacked::Cursor() const {
     return base->Cursor();
 }
+std::vector<std::unique_ptr<CCoinsViewCursor>>
+CCoinsViewBacked::Cursors(size_t count) const {
+    return base->Cursors(count);
+}
 size_t CCoinsViewBacked::EstimateSize() const {
     return base->EstimateSize();
 }
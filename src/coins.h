@@ -18,7 +18,9 @@
 #include <cassert>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 /**
  * A UTXO entry.
@@ -320,6 +322,12 @@ public:
     //! Get a cursor to iterate over the whole state
     virtual CCoinsViewCursor *Cursor() const;
 
+    //! Get cursors over consecutive ranges of the state, together covering
+    //! all of it, to iterate over it by parts concurrently. Views which can't
+    //! be split return a single cursor over the whole state.
+    virtual std::vector<std::unique_ptr<CCoinsViewCursor>>
+    Cursors(size_t count) const;
+
     //! As we use CCoinsViews polymorphically, have a virtual destructor
     virtual ~CCoinsView() {}
 
@@ -342,6 +350,8 @@ public:
     void BatchWrite(CoinsViewCacheCursor &cursor,
                     const BlockHash &hashBlock) override;
     CCoinsViewCursor *Cursor() const override;
+    std::vector<std::unique_ptr<CCoinsViewCursor>>
+    Cursors(size_t count) const override;
     size_t EstimateSize() const override;
 };
 
@@ -395,6 +405,11 @@ public:
         throw std::logic_error(
             "CCoinsViewCache cursor iteration not supported.");
     }
+    std::vector<std::unique_ptr<CCoinsViewCursor>>
+    Cursors(size_t count) const override {
+        throw std::logic_error(
+            "CCoinsViewCache cursor iteration not supported.");
+    }
 
     /**
      * Check if we have the given utxo already loaded in this cache.
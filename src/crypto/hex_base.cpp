@@ -4,11 +4,29 @@
 
 #include <crypto/hex_base.h>
 
+#include <compat/cpuid.h>
+
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <cstdint>
 #include <cstring>
 #include <string>
 
+#if defined(ENABLE_SSE41) && !defined(BUILD_BITCOIN_INTERNAL)
+namespace hex_sse41 {
+size_t Encode(const uint8_t *in, size_t size, char *out);
+size_t Decode(const char *in, size_t size, uint8_t *out);
+} // namespace hex_sse41
+#endif
+
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+namespace hex_avx2 {
+size_t Encode(const uint8_t *in, size_t size, char *out);
+size_t Decode(const char *in, size_t size, uint8_t *out);
+} // namespace hex_avx2
+#endif
+
 namespace {
 
 using ByteAsHex = std::array<char, 2>;
@@ -25,23 +43,108 @@ constexpr std::array<ByteAsHex, 256> CreateByteToHexMap() {
     return byte_to_hex;
 }
 
+/**
+ * The vectorized kernels encode or decode the leading whole blocks of their
+ * input and return the number of bytes done, leaving the rest to the generic
+ * code. Decoding stops at the first block with a character which is not a hex
+ * digit.
+ */
+struct HexKernels {
+    size_t (*encode)(const uint8_t *in, size_t size, char *out){nullptr};
+    size_t (*decode)(const char *in, size_t size, uint8_t *out){nullptr};
+};
+
+#if defined(HAVE_GETCPUID) &&                                                  \
+    (defined(ENABLE_SSE41) || defined(ENABLE_AVX2)) &&                         \
+    !defined(BUILD_BITCOIN_INTERNAL)
+/** Check whether the OS has enabled AVX registers. */
+bool AVXEnabled() {
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+
+HexKernels DetectHexKernels() {
+    HexKernels kernels;
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_sse4{((ecx >> 19) & 1) != 0};
+    const bool enabled_avx{((ecx >> 27) & 1) && ((ecx >> 28) & 1) &&
+                           AVXEnabled()};
+    if (!have_sse4) {
+        return kernels;
+    }
+#if defined(ENABLE_SSE41)
+    kernels = {hex_sse41::Encode, hex_sse41::Decode};
+#endif
+#if defined(ENABLE_AVX2)
+    GetCPUID(7, 0, eax, ebx, ecx, edx);
+    if (((ebx >> 5) & 1) && enabled_avx) {
+        kernels = {hex_avx2::Encode, hex_avx2::Decode};
+    }
+#endif
+    return kernels;
+}
+#else
+HexKernels DetectHexKernels() {
+    return {};
+}
+#endif
+
+const HexKernels &GetHexKernels() {
+    static const HexKernels kernels{DetectHexKernels()};
+    return kernels;
+}
+
+/** Inputs below this size are not worth calling a kernel for */
+constexpr size_t MIN_KERNEL_SIZE{16};
+
 } // namespace
 
-std::string HexStr(const Span<const uint8_t> s) {
-    std::string rv(s.size() * 2, '\0');
+void HexEncode(Span<const uint8_t> s, Span<char> out) {
+    assert(out.size() == s.size() * 2);
     static constexpr auto byte_to_hex = CreateByteToHexMap();
     static_assert(sizeof(byte_to_hex) == 512);
 
-    char *it = rv.data();
-    for (uint8_t v : s) {
+    size_t done{0};
+    const HexKernels &kernels{GetHexKernels()};
+    if (kernels.encode && s.size() >= MIN_KERNEL_SIZE) {
+        done = kernels.encode(s.data(), s.size(), out.data());
+    }
+
+    char *it = out.data() + done * 2;
+    for (uint8_t v : s.subspan(done)) {
         std::memcpy(it, byte_to_hex[v].data(), 2);
         it += 2;
     }
+}
 
-    assert(it == rv.data() + rv.size());
+std::string HexStr(const Span<const uint8_t> s) {
+    std::string rv(s.size() * 2, '\0');
+    HexEncode(s, rv);
     return rv;
 }
 
+size_t HexDecodePrefix(std::string_view str, Span<uint8_t> out) {
+    const size_t size{std::min(str.size() / 2, out.size())};
+
+    size_t done{0};
+    const HexKernels &kernels{GetHexKernels()};
+    if (kernels.decode && size >= MIN_KERNEL_SIZE) {
+        done = kernels.decode(str.data(), size, out.data());
+    }
+
+    for (; done < size; ++done) {
+        const signed char c1{HexDigit(str[done * 2])};
+        const signed char c2{HexDigit(str[done * 2 + 1])};
+        if (c1 < 0 || c2 < 0) {
+            break;
+        }
+        out[done] = uint8_t(c1 << 4) | uint8_t(c2);
+    }
+    return done;
+}
+
 const signed char p_util_hexdigit[256] = {
     -1, -1,  -1,  -1,  -1,  -1,  -1,  -1, -1, -1, -1, -1, -1, -1, -1, -1,
     -1, -1,  -1,  -1,  -1,  -1,  -1,  -1, -1, -1, -1, -1, -1, -1, -1, -1,
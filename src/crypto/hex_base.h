@@ -10,6 +10,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 /**
  * Convert a span of bytes to a lower-case hexadecimal string.
@@ -22,6 +23,23 @@ inline std::string HexStr(const Span<const std::byte> s) {
     return HexStr(MakeUCharSpan(s));
 }
 
+/**
+ * Write the lower-case hexadecimal encoding of a span of bytes to out, which
+ * must be twice as large. Unlike HexStr, this doesn't allocate, so a buffer
+ * can be reused across encodings.
+ */
+void HexEncode(Span<const uint8_t> s, Span<char> out);
+inline void HexEncode(Span<const std::byte> s, Span<char> out) {
+    HexEncode(MakeUCharSpan(s), out);
+}
+
+/**
+ * Decode the pairs of hexadecimal digits at the start of str into out,
+ * stopping at the first pair which isn't, at the end of str or once out is
+ * full. Return the number of bytes written, each one consuming two characters.
+ */
+size_t HexDecodePrefix(std::string_view str, Span<uint8_t> out);
+
 signed char HexDigit(char c);
 
 #endif // BITCOIN_CRYPTO_HEX_BASE_H
@@ -0,0 +1,92 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace hex_avx2 {
+namespace {
+
+    __m256i inline K(char c) {
+        return _mm256_set1_epi8(c);
+    }
+
+    /** Convert 32 hex digits to their value, all bits are set if invalid */
+    __m256i inline DigitValues(__m256i chars) {
+        // '0'-'9' become 0-9, anything else 10 or more
+        const __m256i digit = _mm256_sub_epi8(chars, K('0'));
+        const __m256i is_digit =
+            _mm256_cmpeq_epi8(_mm256_min_epu8(digit, K(9)), digit);
+        // 'a'-'f' and 'A'-'F' become 0-5, anything else 6 or more
+        const __m256i alpha =
+            _mm256_sub_epi8(_mm256_or_si256(chars, K(0x20)), K('a'));
+        const __m256i is_alpha =
+            _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, K(5)), alpha);
+
+        const __m256i value = _mm256_or_si256(
+            _mm256_and_si256(is_digit, digit),
+            _mm256_and_si256(is_alpha, _mm256_add_epi8(alpha, K(10))));
+        const __m256i invalid = _mm256_cmpeq_epi8(
+            _mm256_or_si256(is_digit, is_alpha), _mm256_setzero_si256());
+        return _mm256_or_si256(value, invalid);
+    }
+
+} // namespace
+
+size_t Encode(const uint8_t *in, size_t size, char *out) {
+    const __m256i lut = _mm256_setr_epi8(
+        '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd',
+        'e', 'f', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b',
+        'c', 'd', 'e', 'f');
+    const __m256i mask = K(0x0f);
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i bytes =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        const __m256i hi = _mm256_shuffle_epi8(
+            lut, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask));
+        const __m256i lo =
+            _mm256_shuffle_epi8(lut, _mm256_and_si256(bytes, mask));
+        // The unpacking is done within each 128 bits lane, so the halves of
+        // the output are swapped back in order
+        const __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        __m256i *dst = reinterpret_cast<__m256i *>(out + i * 2);
+        _mm256_storeu_si256(dst,
+                            _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(dst + 1,
+                            _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return i;
+}
+
+size_t Decode(const char *in, size_t size, uint8_t *out) {
+    // Multiplying the pairs of nibbles by 16 and 1 gives the bytes
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i *src = reinterpret_cast<const __m256i *>(in + i * 2);
+        const __m256i v0 = DigitValues(_mm256_loadu_si256(src));
+        const __m256i v1 = DigitValues(_mm256_loadu_si256(src + 1));
+        if (_mm256_movemask_epi8(_mm256_or_si256(v0, v1)) != 0) {
+            break;
+        }
+        // The packing is done within each 128 bits lane too
+        const __m256i bytes =
+            _mm256_packus_epi16(_mm256_maddubs_epi16(v0, weights),
+                                _mm256_maddubs_epi16(v1, weights));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                            _mm256_permute4x64_epi64(bytes, 0xd8));
+    }
+    return i;
+}
+
+} // namespace hex_avx2
+
+#endif
@@ -0,0 +1,76 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_SSE41
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace hex_sse41 {
+namespace {
+
+    /** Convert 16 hex digits to their value, all bits are set if invalid */
+    __m128i inline DigitValues(__m128i chars) {
+        // '0'-'9' become 0-9, anything else 10 or more
+        const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+        const __m128i is_digit =
+            _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        // 'a'-'f' and 'A'-'F' become 0-5, anything else 6 or more
+        const __m128i alpha = _mm_sub_epi8(
+            _mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        const __m128i is_alpha =
+            _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+        const __m128i value = _mm_or_si128(
+            _mm_and_si128(is_digit, digit),
+            _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+        const __m128i invalid = _mm_cmpeq_epi8(
+            _mm_or_si128(is_digit, is_alpha), _mm_setzero_si128());
+        return _mm_or_si128(value, invalid);
+    }
+
+} // namespace
+
+size_t Encode(const uint8_t *in, size_t size, char *out) {
+    const __m128i lut = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m128i mask = _mm_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i bytes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        const __m128i hi = _mm_shuffle_epi8(
+            lut, _mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+        const __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(bytes, mask));
+        __m128i *dst = reinterpret_cast<__m128i *>(out + i * 2);
+        _mm_storeu_si128(dst, _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(dst + 1, _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+size_t Decode(const char *in, size_t size, uint8_t *out) {
+    // Multiplying the pairs of nibbles by 16 and 1 gives the bytes
+    const __m128i weights = _mm_set1_epi16(0x0110);
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i *src = reinterpret_cast<const __m128i *>(in + i * 2);
+        const __m128i v0 = DigitValues(_mm_loadu_si128(src));
+        const __m128i v1 = DigitValues(_mm_loadu_si128(src + 1));
+        if (_mm_movemask_epi8(_mm_or_si128(v0, v1)) != 0) {
+            break;
+        }
+        const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(v0, weights),
+                                               _mm_maddubs_epi16(v1, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), bytes);
+    }
+    return i;
+}
+
+} // namespace hex_sse41
+
+#endif
@@ -246,6 +246,21 @@ bool CDBWrapper::IsEmpty() {
     return !(it->Valid());
 }
 
+std::vector<std::unique_ptr<CDBIterator>>
+CDBWrapper::NewIterators(size_t count) {
+    leveldb::ReadOptions options{iteroptions};
+    options.snapshot = pdb->GetSnapshot();
+    std::vector<std::unique_ptr<CDBIterator>> iterators;
+    iterators.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        iterators.push_back(
+            std::make_unique<CDBIterator>(*this, pdb->NewIterator(options)));
+    }
+    // An iterator keeps the state it was created from alive by itself
+    pdb->ReleaseSnapshot(options.snapshot);
+    return iterators;
+}
+
 CDBIterator::~CDBIterator() {
     delete piter;
 }
@@ -16,7 +16,9 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <memory>
 #include <optional>
+#include <vector>
 
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
@@ -316,6 +318,12 @@ public:
         return new CDBIterator(*this, pdb->NewIterator(iteroptions));
     }
 
+    /**
+     * Create iterators which all see the database as it is now, whatever is
+     * written to it later, so it can be read by parts from several threads.
+     */
+    std::vector<std::unique_ptr<CDBIterator>> NewIterators(size_t count);
+
     /**
      * Return true if the database managed by this class contains no entries.
      */
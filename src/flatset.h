@@ -0,0 +1,93 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_FLATSET_H
+#define BITCOIN_FLATSET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * Set backed by a sorted contiguous vector.
+ *
+ * This is a drop-in replacement for the subset of the std::set interface that
+ * is useful for small sets: lookups are a binary search over a contiguous
+ * buffer, and inserting or erasing an element doesn't allocate a tree node.
+ * The tradeoff is that insert and erase are linear in the size of the set and
+ * invalidate all the iterators, so this should only be used for sets that are
+ * expected to remain small.
+ *
+ * Iteration order is the same as for a std::set with the same comparator.
+ */
+template <typename K, typename Compare = std::less<K>> class flatset {
+private:
+    using base = std::vector<K>;
+    base m_data;
+    Compare m_comp;
+
+public:
+    using key_type = K;
+    using value_type = K;
+    using size_type = typename base::size_type;
+    using iterator = typename base::const_iterator;
+    using const_iterator = typename base::const_iterator;
+
+    flatset() = default;
+    flatset(std::initializer_list<K> init) {
+        for (const auto &k : init) {
+            insert(k);
+        }
+    }
+
+    const_iterator begin() const { return m_data.begin(); }
+    const_iterator end() const { return m_data.end(); }
+    size_type size() const { return m_data.size(); }
+    bool empty() const { return m_data.empty(); }
+    size_type capacity() const { return m_data.capacity(); }
+    void reserve(size_type n) { m_data.reserve(n); }
+    void clear() { m_data.clear(); }
+    void shrink_to_fit() { m_data.shrink_to_fit(); }
+
+    const_iterator lower_bound(const K &key) const {
+        return std::lower_bound(m_data.begin(), m_data.end(), key, m_comp);
+    }
+
+    const_iterator find(const K &key) const {
+        auto it = lower_bound(key);
+        if (it != m_data.end() && !m_comp(key, *it)) {
+            return it;
+        }
+        return m_data.end();
+    }
+
+    size_type count(const K &key) const { return find(key) != end(); }
+
+    std::pair<iterator, bool> insert(const K &key) {
+        auto it = lower_bound(key);
+        if (it != m_data.end() && !m_comp(key, *it)) {
+            return {it, false};
+        }
+        return {m_data.insert(it, key), true};
+    }
+
+    iterator erase(const_iterator it) { return m_data.erase(it); }
+
+    size_type erase(const K &key) {
+        auto it = find(key);
+        if (it == m_data.end()) {
+            return 0;
+        }
+        m_data.erase(it);
+        return 1;
+    }
+
+    friend bool operator==(const flatset &a, const flatset &b) {
+        return a.m_data == b.m_data;
+    }
+};
+
+#endif // BITCOIN_FLATSET_H
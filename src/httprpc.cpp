@@ -7,8 +7,12 @@
 #include <common/args.h>
 #include <config.h>
 #include <crypto/hmac_sha256.h>
+#include <hash.h>
 #include <logging.h>
+#include <rpc/jsonstream.h>
 #include <rpc/protocol.h>
+#include <sync.h>
+#include <uint256.h>
 #include <util/strencodings.h>
 #include <util/string.h>
 #include <walletinitinterface.h>
@@ -20,7 +24,9 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using util::SplitString;
@@ -77,6 +83,19 @@ static std::vector<std::vector<std::string>> g_rpcauth;
 /* RPC Auth Whitelist */
 static std::map<std::string, std::set<std::string>> g_rpc_whitelist;
 static bool g_rpc_whitelist_default = false;
+/* Maximum number of threads executing the requests of a batch */
+static int g_rpc_batch_threads = DEFAULT_RPC_BATCH_THREADS;
+
+/**
+ * The Authorization headers which were accepted already, by hash, with their
+ * user name. A client sending many requests then only pays for checking its
+ * credentials once. Rejected headers are never cached, so each failed attempt
+ * still goes through the brute-force delay.
+ */
+static Mutex g_rpc_auth_cache_mutex;
+static std::map<uint256, std::string>
+    g_rpc_auth_cache GUARDED_BY(g_rpc_auth_cache_mutex);
+static constexpr size_t MAX_RPC_AUTH_CACHE_SIZE{64};
 
 static void JSONErrorReply(HTTPRequest *req, const UniValue &objError,
                            const UniValue &id) {
@@ -134,13 +153,8 @@ static bool multiUserAuthorized(std::string strUserPass) {
     return false;
 }
 
-static bool RPCAuthorized(const std::string &strAuth,
-                          std::string &strAuthUsernameOut) {
-    // Belt-and-suspenders measure if InitRPCAuthentication was not called.
-    if (strRPCUserColonPass.empty()) {
-        return false;
-    }
-
+static bool CheckRPCCredentials(const std::string &strAuth,
+                                std::string &strAuthUsernameOut) {
     if (strAuth.substr(0, 6) != "Basic ") {
         return false;
     }
@@ -165,6 +179,35 @@ static bool RPCAuthorized(const std::string &strAuth,
     return multiUserAuthorized(strUserPass);
 }
 
+static bool RPCAuthorized(const std::string &strAuth,
+                          std::string &strAuthUsernameOut) {
+    // Belt-and-suspenders measure if InitRPCAuthentication was not called.
+    if (strRPCUserColonPass.empty()) {
+        return false;
+    }
+
+    const uint256 auth_hash{Hash(strAuth)};
+    {
+        LOCK(g_rpc_auth_cache_mutex);
+        auto it = g_rpc_auth_cache.find(auth_hash);
+        if (it != g_rpc_auth_cache.end()) {
+            strAuthUsernameOut = it->second;
+            return true;
+        }
+    }
+
+    if (!CheckRPCCredentials(strAuth, strAuthUsernameOut)) {
+        return false;
+    }
+
+    LOCK(g_rpc_auth_cache_mutex);
+    if (g_rpc_auth_cache.size() >= MAX_RPC_AUTH_CACHE_SIZE) {
+        g_rpc_auth_cache.clear();
+    }
+    g_rpc_auth_cache.emplace(auth_hash, strAuthUsernameOut);
+    return true;
+}
+
 static bool checkCORS(HTTPRequest *req) {
     // https://www.w3.org/TR/cors/#resource-requests
 
@@ -286,6 +329,41 @@ static bool checkCORS(HTTPRequest *req) {
     return false;
 }
 
+/**
+ * Send the reply of a request while its result is written, see
+ * JSONRPCRequest::StreamResult().
+ */
+static void
+StreamJSONRPCReply(HTTPRequest *req, const UniValue &id,
+                   const JSONRPCRequest::ResultWriter &write_result) {
+    req->WriteHeader("Content-Type", "application/json");
+    req->StartChunkedReply(HTTP_OK);
+    try {
+        JSONStreamWriter writer{[req](std::string_view chunk) {
+            if (!req->WriteReplyChunk(chunk)) {
+                throw std::runtime_error("connection closed");
+            }
+        }};
+        writer.BeginObject();
+        writer.Key("result");
+        write_result(writer);
+        writer.Key("error");
+        writer.Value(NullUniValue);
+        writer.Key("id");
+        writer.Value(id);
+        writer.EndObject();
+        writer.Finish();
+    } catch (const UniValue &objError) {
+        // The status was sent already, so the client can only notice the
+        // reply is truncated
+        LogPrint(BCLog::RPC, "Reply was not completed: %s\n",
+                 objError.write());
+    } catch (const std::exception &e) {
+        LogPrint(BCLog::RPC, "Reply was not completed: %s\n", e.what());
+    }
+    req->EndChunkedReply();
+}
+
 bool HTTPRPCRequestProcessor::ProcessHTTPRequest(HTTPRequest *req) {
     // First, check and/or set CORS headers
     if (checkCORS(req)) {
@@ -354,7 +432,19 @@ bool HTTPRPCRequestProcessor::ProcessHTTPRequest(HTTPRequest *req) {
                 req->WriteReply(HTTP_FORBIDDEN);
                 return false;
             }
+            // Large results can be sent while they are produced. The request
+            // may be copied before reaching the command.
+            bool streamed{false};
+            jreq.resultStreamer =
+                [req, &jreq, &streamed](
+                    const JSONRPCRequest::ResultWriter &write_result) {
+                    streamed = true;
+                    StreamJSONRPCReply(req, jreq.id, write_result);
+                };
             UniValue result = rpcServer.ExecuteCommand(config, jreq);
+            if (streamed) {
+                return true;
+            }
 
             // Send reply
             strReply = JSONRPCReply(result, NullUniValue, jreq.id);
@@ -383,7 +473,8 @@ bool HTTPRPCRequestProcessor::ProcessHTTPRequest(HTTPRequest *req) {
                 }
             }
             strReply = JSONRPCExecBatch(config, rpcServer, jreq,
-                                        valRequest.get_array());
+                                        valRequest.get_array(),
+                                        g_rpc_batch_threads);
         } else {
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
         }
@@ -434,6 +525,9 @@ static bool InitRPCAuthentication() {
         }
     }
 
+    g_rpc_batch_threads = std::max<int64_t>(
+        gArgs.GetIntArg("-rpcbatchthreads", DEFAULT_RPC_BATCH_THREADS), 1);
+
     g_rpc_whitelist_default = gArgs.GetBoolArg("-rpcwhitelistdefault",
                                                gArgs.IsArgSet("-rpcwhitelist"));
     for (const std::string &strRPCWhitelist : gArgs.GetArgs("-rpcwhitelist")) {
@@ -498,4 +592,5 @@ void StopHTTPRPC() {
         RPCUnsetTimerInterface(httpRPCTimerInterface.get());
         httpRPCTimerInterface.reset();
     }
+    WITH_LOCK(g_rpc_auth_cache_mutex, g_rpc_auth_cache.clear());
 }
@@ -12,6 +12,8 @@
 
 class Config;
 
+static const int DEFAULT_RPC_BATCH_THREADS = 1;
+
 class HTTPRPCRequestProcessor {
 private:
     Config &config;
@@ -16,8 +16,12 @@
 #include <shutdown.h>
 #include <sync.h>
 #include <util/check.h>
+#include <util/latency.h>
+#include <util/mpmcqueue.h>
 #include <util/strencodings.h>
+#include <util/string.h>
 #include <util/threadnames.h>
+#include <util/time.h>
 #include <util/translation.h>
 
 #include <event2/buffer.h>
@@ -32,13 +36,19 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <deque>
 #include <memory>
+#include <optional>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
@@ -49,38 +59,29 @@ static const size_t MAX_HEADERS_SIZE = 8192;
  */
 static const size_t MIN_SUPPORTED_BODY_SIZE = 0x02000000;
 
-/** HTTP request work item */
-class HTTPWorkItem final : public HTTPClosure {
-public:
-    HTTPWorkItem(Config &_config, std::unique_ptr<HTTPRequest> _req,
-                 const std::string &_path, const HTTPRequestHandler &_func)
-        : req(std::move(_req)), path(_path), func(_func), config(&_config) {}
-
-    void operator()() override { func(*config, req.get(), path); }
-
-    std::unique_ptr<HTTPRequest> req;
-
-private:
-    std::string path;
-    HTTPRequestHandler func;
-    Config *config;
-};
-
 /**
- * Simple work queue for distributing work over multiple threads.
+ * Work queue for distributing work over multiple threads.
  * Work items are simply callable objects.
+ *
+ * Enqueuing and dequeuing never take a lock, the mutex is only used by the
+ * worker threads to sleep while the queue is empty.
  */
 template <typename WorkItem> class WorkQueue {
 private:
-    /** Mutex protects entire object */
+    MPMCQueue<std::unique_ptr<WorkItem>> queue;
+    const size_t maxDepth;
+    //! Number of items enqueued and not dequeued yet
+    std::atomic<size_t> depth{0};
+    std::atomic<bool> running{true};
+
     Mutex cs;
     std::condition_variable cond;
-    std::deque<std::unique_ptr<WorkItem>> queue;
-    bool running{true};
-    size_t maxDepth;
+    //! Number of worker threads sleeping, or about to, on cond
+    std::atomic<int> sleeping{0};
 
 public:
-    explicit WorkQueue(size_t _maxDepth) : maxDepth(_maxDepth) {}
+    explicit WorkQueue(size_t _maxDepth)
+        : queue(_maxDepth), maxDepth(_maxDepth) {}
     /**
      * Precondition: worker threads have all stopped (they have all been joined)
      */
@@ -88,12 +89,25 @@ public:
 
     /** Enqueue a work item */
     bool Enqueue(WorkItem *item) EXCLUSIVE_LOCKS_REQUIRED(!cs) {
-        LOCK(cs);
-        if (queue.size() >= maxDepth) {
+        if (depth.fetch_add(1) >= maxDepth) {
+            depth.fetch_sub(1);
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
-        cond.notify_one();
+        // The queue has room for maxDepth items, so this succeeds
+        std::unique_ptr<WorkItem> owned{item};
+        if (!Assume(queue.TryPush(std::move(owned)))) {
+            owned.release();
+            depth.fetch_sub(1);
+            return false;
+        }
+
+        // A read-modify-write, so it is ordered with the increment in Run():
+        // either the worker sees the item, or this sees the worker sleeping and
+        // wakes it up.
+        if (sleeping.fetch_add(0) > 0) {
+            LOCK(cs);
+            cond.notify_one();
+        }
         return true;
     }
 
@@ -101,27 +115,88 @@ public:
     void Run() EXCLUSIVE_LOCKS_REQUIRED(!cs) {
         while (true) {
             std::unique_ptr<WorkItem> i;
-            {
+            if (!queue.TryPop(i)) {
                 WAIT_LOCK(cs, lock);
-                while (running && queue.empty()) {
+                sleeping.fetch_add(1);
+                while (running && !queue.TryPop(i)) {
                     cond.wait(lock);
                 }
-                if (!running) {
-                    break;
-                }
-                i = std::move(queue.front());
-                queue.pop_front();
+                sleeping.fetch_sub(1);
+            }
+            if (!running) {
+                break;
             }
+            depth.fetch_sub(1);
             (*i)();
         }
     }
 
     /** Interrupt and exit loops */
     void Interrupt() EXCLUSIVE_LOCKS_REQUIRED(!cs) {
-        LOCK(cs);
         running = false;
+        LOCK(cs);
         cond.notify_all();
     }
+
+    /** Number of items waiting for a worker */
+    size_t Depth() const { return depth.load(); }
+    size_t MaxDepth() const { return maxDepth; }
+};
+
+/**
+ * A work queue with its own worker threads, so the requests it serves are
+ * never stuck behind the slow requests of other lanes.
+ */
+struct HTTPWorkLane {
+    HTTPWorkLane(std::string _name, int _threads,
+                 std::vector<std::string> _targets, size_t max_depth)
+        : name(_name), threads(_threads), targets(std::move(_targets)),
+          queue(max_depth),
+          wait_time("http_queue_wait_" + _name,
+                    "Time requests of the " + _name +
+                        " RPC work lane waited for a worker"),
+          run_time("http_request_" + _name,
+                   "Time spent handling requests of the " + _name +
+                       " RPC work lane") {}
+
+    const std::string name;
+    const int threads;
+    //! RPC methods and endpoints (starting with '/') served by the lane
+    const std::vector<std::string> targets;
+    WorkQueue<HTTPClosure> queue;
+    std::vector<std::thread> workers;
+
+    std::atomic<uint64_t> processed{0};
+    std::atomic<uint64_t> rejected{0};
+    LatencyHistogram wait_time;
+    LatencyHistogram run_time;
+};
+
+/** HTTP request work item */
+class HTTPWorkItem final : public HTTPClosure {
+public:
+    HTTPWorkItem(Config &_config, std::unique_ptr<HTTPRequest> _req,
+                 const std::string &_path, const HTTPRequestHandler &_func,
+                 HTTPWorkLane &_lane)
+        : req(std::move(_req)), path(_path), func(_func), config(&_config),
+          lane(_lane), queued(SteadyClock::now()) {}
+
+    void operator()() override {
+        const auto start{SteadyClock::now()};
+        lane.wait_time.Observe(start - queued);
+        func(*config, req.get(), path);
+        lane.run_time.Observe(SteadyClock::now() - start);
+        ++lane.processed;
+    }
+
+    std::unique_ptr<HTTPRequest> req;
+
+private:
+    std::string path;
+    HTTPRequestHandler func;
+    Config *config;
+    HTTPWorkLane &lane;
+    const SteadyClock::time_point queued;
 };
 
 struct HTTPPathHandler {
@@ -141,8 +216,9 @@ static struct event_base *eventBase = nullptr;
 static struct evhttp *eventHTTP = nullptr;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
-//! Work queue for handling longer requests off the event loop thread
-static WorkQueue<HTTPClosure> *workQueue = nullptr;
+//! Work queues for handling longer requests off the event loop thread, the
+//! first one being the default lane
+static std::vector<std::unique_ptr<HTTPWorkLane>> g_work_lanes;
 //! Handlers for (sub)paths
 static std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
@@ -275,6 +351,79 @@ std::string RequestMethodString(HTTPRequest::RequestMethod m) {
     }
 }
 
+/** Connection close callback, while no chunked reply is being sent */
+static void http_connection_close_cb(evhttp_connection *conn, void *arg) {
+    g_requests.RemoveConnection(conn);
+}
+
+/**
+ * Name of the method of a single JSON-RPC request, looked up at the start of
+ * the body without parsing it. This is only a hint to pick a work lane: the
+ * request is still authenticated and parsed by its handler.
+ */
+static std::string GetJSONRPCMethodHint(struct evhttp_request *req) {
+    static constexpr size_t MAX_SCANNED_SIZE{1024};
+    static constexpr std::string_view WHITESPACE{" \t\r\n"};
+
+    struct evbuffer *buf = evhttp_request_get_input_buffer(req);
+    if (!buf) {
+        return "";
+    }
+    char data[MAX_SCANNED_SIZE];
+    const ev_ssize_t size{evbuffer_copyout(buf, data, sizeof(data))};
+    if (size <= 0) {
+        return "";
+    }
+    const std::string_view body(data, size);
+
+    // A batch is served by the default lane
+    size_t pos{body.find_first_not_of(WHITESPACE)};
+    if (pos == std::string_view::npos || body[pos] != '{') {
+        return "";
+    }
+    static constexpr std::string_view KEY{"\"method\""};
+    pos = body.find(KEY);
+    if (pos == std::string_view::npos) {
+        return "";
+    }
+    pos = body.find_first_not_of(WHITESPACE, pos + KEY.size());
+    if (pos == std::string_view::npos || body[pos] != ':') {
+        return "";
+    }
+    pos = body.find_first_not_of(WHITESPACE, pos + 1);
+    if (pos == std::string_view::npos || body[pos] != '"') {
+        return "";
+    }
+    const size_t end{body.find('"', pos + 1)};
+    if (end == std::string_view::npos) {
+        return "";
+    }
+    return std::string{body.substr(pos + 1, end - pos - 1)};
+}
+
+/** Find the work lane serving a request, the default one if none matches */
+static HTTPWorkLane &SelectWorkLane(struct evhttp_request *req,
+                                    const std::string &uri) {
+    std::optional<std::string> method;
+    for (size_t i = 1; i < g_work_lanes.size(); ++i) {
+        for (const std::string &target : g_work_lanes[i]->targets) {
+            if (target[0] == '/') {
+                if (uri.compare(0, target.size(), target) == 0) {
+                    return *g_work_lanes[i];
+                }
+                continue;
+            }
+            if (!method) {
+                method = GetJSONRPCMethodHint(req);
+            }
+            if (*method == target) {
+                return *g_work_lanes[i];
+            }
+        }
+    }
+    return *g_work_lanes[0];
+}
+
 /** HTTP request callback */
 static void http_request_cb(struct evhttp_request *req, void *arg) {
     Config &config = *reinterpret_cast<Config *>(arg);
@@ -289,12 +438,8 @@ static void http_request_cb(struct evhttp_request *req, void *arg) {
                 g_requests.RemoveRequest(req);
             },
             nullptr);
-        evhttp_connection_set_closecb(
-            conn,
-            [](evhttp_connection *conn, void *arg) {
-                g_requests.RemoveConnection(conn);
-            },
-            nullptr);
+        evhttp_connection_set_closecb(conn, http_connection_close_cb,
+                                      nullptr);
     }
 
     // Disable reading to work around a libevent bug, fixed in 2.2.0.
@@ -353,16 +498,19 @@ static void http_request_cb(struct evhttp_request *req, void *arg) {
 
     // Dispatch to worker thread.
     if (i != iend) {
+        assert(!g_work_lanes.empty());
+        HTTPWorkLane &lane = SelectWorkLane(req, strURI);
         std::unique_ptr<HTTPWorkItem> item(
-            new HTTPWorkItem(config, std::move(hreq), path, i->handler));
-        assert(workQueue);
-        if (workQueue->Enqueue(item.get())) {
+            new HTTPWorkItem(config, std::move(hreq), path, i->handler, lane));
+        if (lane.queue.Enqueue(item.get())) {
             /* if true, queue took ownership */
             item.release();
         } else {
+            ++lane.rejected;
             LogPrintf("WARNING: request rejected because http work queue depth "
-                      "exceeded, it can be increased with the -rpcworkqueue= "
-                      "setting\n");
+                      "exceeded for the %s lane, it can be increased with the "
+                      "-rpcworkqueue= setting\n",
+                      lane.name);
             item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE,
                                   "Work queue depth exceeded");
         }
@@ -441,9 +589,70 @@ static bool HTTPBindAddresses(struct evhttp *http) {
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure> *queue, int worker_num) {
-    util::ThreadRename(strprintf("httpworker.%i", worker_num));
-    queue->Run();
+static void HTTPWorkQueueRun(HTTPWorkLane *lane, int worker_num) {
+    if (lane == g_work_lanes[0].get()) {
+        util::ThreadRename(strprintf("httpworker.%i", worker_num));
+    } else {
+        util::ThreadRename(strprintf("http%s.%i", lane->name, worker_num));
+    }
+    lane->queue.Run();
+}
+
+/**
+ * Parse the -rpcworklane=<name>:<threads>:<target>[,<target>...] options into
+ * the work lanes, after the default one.
+ */
+static bool InitHTTPWorkLanes(size_t max_depth) {
+    for (const std::string &lane_arg : gArgs.GetArgs("-rpcworklane")) {
+        const std::vector<std::string> parts{util::SplitString(lane_arg, ':')};
+        const auto error = [&](const std::string &reason) {
+            uiInterface.ThreadSafeMessageBox(
+                strprintf(Untranslated("Invalid -rpcworklane=%s: %s"),
+                          lane_arg, reason),
+                "", CClientUIInterface::MSG_ERROR);
+            return false;
+        };
+        if (parts.size() != 3) {
+            return error("expected <name>:<threads>:<method or /endpoint>"
+                         "[,<method or /endpoint>...]");
+        }
+
+        const std::string &name{parts[0]};
+        if (name.empty() ||
+            !std::all_of(name.begin(), name.end(), [](char c) {
+                return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                       c == '_';
+            })) {
+            return error("the name can only contain lowercase letters, digits "
+                         "and underscores");
+        }
+        if (std::any_of(g_work_lanes.begin(), g_work_lanes.end(),
+                        [&](const auto &lane) { return lane->name == name; })) {
+            return error("the lane " + name + " is defined already");
+        }
+
+        int threads;
+        if (!ParseInt32(parts[1], &threads) || threads < 1) {
+            return error("the number of threads must be at least 1");
+        }
+
+        std::vector<std::string> targets;
+        for (const std::string &target : util::SplitString(parts[2], ',')) {
+            const std::string trimmed{util::TrimString(target)};
+            if (!trimmed.empty()) {
+                targets.push_back(trimmed);
+            }
+        }
+        if (targets.empty()) {
+            return error("no method or endpoint to serve");
+        }
+
+        LogDebug(BCLog::HTTP, "creating work lane %s with %d threads for %s\n",
+                 name, threads, util::Join(targets, ", "));
+        g_work_lanes.push_back(std::make_unique<HTTPWorkLane>(
+            name, threads, std::move(targets), max_depth));
+    }
+    return true;
 }
 
 /** libevent event log callback */
@@ -519,7 +728,14 @@ bool InitHTTPServer(Config &config) {
         (long)gArgs.GetIntArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
     LogDebug(BCLog::HTTP, "creating work queue of depth %d\n", workQueueDepth);
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    int rpcThreads = std::max(
+        (long)gArgs.GetIntArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    g_work_lanes.push_back(std::make_unique<HTTPWorkLane>(
+        "default", rpcThreads, std::vector<std::string>{}, workQueueDepth));
+    if (!InitHTTPWorkLanes(workQueueDepth)) {
+        g_work_lanes.clear();
+        return false;
+    }
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -535,16 +751,20 @@ void UpdateHTTPServerLogging(bool enable) {
 }
 
 static std::thread g_thread_http;
-static std::vector<std::thread> g_thread_http_workers;
 
 void StartHTTPServer() {
-    int rpcThreads = std::max(
-        (long)gArgs.GetIntArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogInfo("Starting HTTP server with %d worker threads\n", rpcThreads);
+    LogInfo("Starting HTTP server with %d worker threads\n",
+            g_work_lanes[0]->threads);
     g_thread_http = std::thread(ThreadHTTP, eventBase);
 
-    for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue, i);
+    for (const auto &lane : g_work_lanes) {
+        if (lane != g_work_lanes[0]) {
+            LogInfo("Starting %d worker threads for the %s RPC work lane\n",
+                    lane->threads, lane->name);
+        }
+        for (int i = 0; i < lane->threads; i++) {
+            lane->workers.emplace_back(HTTPWorkQueueRun, lane.get(), i);
+        }
     }
 }
 
@@ -554,21 +774,21 @@ void InterruptHTTPServer() {
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
-    if (workQueue) {
-        workQueue->Interrupt();
+    for (const auto &lane : g_work_lanes) {
+        lane->queue.Interrupt();
     }
 }
 
 void StopHTTPServer() {
     LogPrint(BCLog::HTTP, "Stopping HTTP server\n");
-    if (workQueue) {
+    if (!g_work_lanes.empty()) {
         LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
-        for (auto &thread : g_thread_http_workers) {
-            thread.join();
+        for (const auto &lane : g_work_lanes) {
+            for (auto &thread : lane->workers) {
+                thread.join();
+            }
         }
-        g_thread_http_workers.clear();
-        delete workQueue;
-        workQueue = nullptr;
+        g_work_lanes.clear();
     }
     // Unlisten sockets, these are what make the event loop running, which means
     // that after this and all connections are closed the event loop will quit.
@@ -612,6 +832,18 @@ struct event_base *EventBase() {
     return eventBase;
 }
 
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats() {
+    std::vector<HTTPWorkQueueStats> stats;
+    for (const auto &lane : g_work_lanes) {
+        stats.push_back({lane->name, lane->threads, lane->targets,
+                         lane->queue.Depth(), lane->queue.MaxDepth(),
+                         lane->processed.load(), lane->rejected.load(),
+                         lane->wait_time.GetSnapshot(),
+                         lane->run_time.GetSnapshot()});
+    }
+    return stats;
+}
+
 static void httpevent_callback_fn(evutil_socket_t, short, void *data) {
     // Static handler: simply call inner handler
     HTTPEvent *self = static_cast<HTTPEvent *>(data);
@@ -639,9 +871,58 @@ void HTTPEvent::trigger(struct timeval *tv) {
         evtimer_add(ev, tv);
     }
 }
+/** Size of a chunked reply that can wait to be sent to the client */
+static constexpr size_t MAX_CHUNKED_REPLY_PENDING{4 * 1024 * 1024};
+
+/**
+ * State of a chunked reply, shared by the worker thread producing it and the
+ * main http thread sending it.
+ */
+struct HTTPChunkedReply {
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Size of the chunks not entirely written to the connection yet
+    size_t m_pending GUARDED_BY(m_mutex){0};
+    //! Set when the connection is closed before the reply was completed
+    bool m_closed GUARDED_BY(m_mutex){false};
+};
+
+/** Connection close callback while a chunked reply is being sent */
+static void http_chunked_reply_close_cb(evhttp_connection *conn, void *arg) {
+    auto &reply{*static_cast<HTTPChunkedReply *>(arg)};
+    WITH_LOCK(reply.m_mutex, reply.m_closed = true);
+    reply.m_cv.notify_all();
+    http_connection_close_cb(conn, nullptr);
+}
+
+/** Called once everything sent so far was written to the connection */
+static void http_chunked_reply_sent_cb(evhttp_connection *conn, void *arg) {
+    auto &reply{*static_cast<HTTPChunkedReply *>(arg)};
+    WITH_LOCK(reply.m_mutex, reply.m_pending = 0);
+    reply.m_cv.notify_all();
+}
+
+/** Re-enable reading from the socket, see the libevent workaround above */
+static void http_reenable_reading(evhttp_request *req) {
+    if (event_get_version_number() >= 0x02010600 &&
+        event_get_version_number() < 0x02020001) {
+        evhttp_connection *conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent *bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 HTTPRequest::HTTPRequest(struct evhttp_request *_req, bool _replySent)
     : req(_req), replySent(_replySent) {}
 HTTPRequest::~HTTPRequest() {
+    if (m_chunked_reply) {
+        LogPrintf("%s: Unfinished chunked reply\n", __func__);
+        EndChunkedReply();
+    }
     if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
@@ -699,7 +980,7 @@ void HTTPRequest::WriteHeader(const std::string &hdr,
  * done from worker threads.
  */
 void HTTPRequest::WriteReply(int nStatus, const std::string &strReply) {
-    assert(!replySent && req);
+    assert(!replySent && req && !m_chunked_reply);
     if (ShutdownRequested()) {
         WriteHeader("Connection", "close");
     }
@@ -712,23 +993,176 @@ void HTTPRequest::WriteReply(int nStatus, const std::string &strReply) {
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
         // Re-enable reading from the socket. This is the second part of the
         // libevent workaround above.
-        if (event_get_version_number() >= 0x02010600 &&
-            event_get_version_number() < 0x02020001) {
+        http_reenable_reading(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    // transferred back to main thread.
+    req = nullptr;
+}
+
+void HTTPRequest::StartChunkedReply(int nStatus) {
+    assert(!replySent && req && !m_chunked_reply);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    m_chunked_reply = std::make_shared<HTTPChunkedReply>();
+    auto req_copy = req;
+    HTTPEvent *ev = new HTTPEvent(
+        eventBase, true, [req_copy, nStatus, reply = m_chunked_reply] {
+            // Get notified if the client goes away, as libevent then detaches
+            // the request from the connection until the reply is completed
             evhttp_connection *conn = evhttp_request_get_connection(req_copy);
             if (conn) {
-                bufferevent *bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
+                evhttp_connection_set_closecb(conn, http_chunked_reply_close_cb,
+                                              reply.get());
+            }
+            evhttp_send_reply_start(req_copy, nStatus, nullptr);
+        });
+    ev->trigger(nullptr);
+}
+
+bool HTTPRequest::WriteReplyChunk(std::string_view chunk) {
+    assert(!replySent && req && m_chunked_reply);
+    HTTPChunkedReply &reply{*m_chunked_reply};
+    {
+        WAIT_LOCK(reply.m_mutex, lock);
+        while (!reply.m_closed &&
+               reply.m_pending >= MAX_CHUNKED_REPLY_PENDING) {
+            if (ShutdownRequested()) {
+                return false;
             }
+            reply.m_cv.wait_for(lock, std::chrono::milliseconds{100});
         }
-    });
+        if (reply.m_closed) {
+            return false;
+        }
+        reply.m_pending += chunk.size();
+    }
+
+    auto req_copy = req;
+    HTTPEvent *ev = new HTTPEvent(
+        eventBase, true,
+        [req_copy, reply = m_chunked_reply, data = std::string{chunk}] {
+            if (WITH_LOCK(reply->m_mutex, return reply->m_closed)) {
+                return;
+            }
+            struct evbuffer *evb = evbuffer_new();
+            evbuffer_add(evb, data.data(), data.size());
+            evhttp_send_reply_chunk_with_cb(
+                req_copy, evb, http_chunked_reply_sent_cb, reply.get());
+            evbuffer_free(evb);
+        });
+    ev->trigger(nullptr);
+    return true;
+}
+
+void HTTPRequest::EndChunkedReply() {
+    assert(!replySent && req && m_chunked_reply);
+    auto req_copy = req;
+    HTTPEvent *ev = new HTTPEvent(
+        eventBase, true, [req_copy, reply = std::move(m_chunked_reply)] {
+            if (!WITH_LOCK(reply->m_mutex, return reply->m_closed)) {
+                evhttp_connection *conn =
+                    evhttp_request_get_connection(req_copy);
+                if (conn) {
+                    evhttp_connection_set_closecb(
+                        conn, http_connection_close_cb, nullptr);
+                }
+                // The request may be freed as soon as the reply is completed
+                http_reenable_reading(req_copy);
+            }
+            // If the connection was closed, this frees the request
+            evhttp_send_reply_end(req_copy);
+        });
     ev->trigger(nullptr);
     replySent = true;
     // transferred back to main thread.
     req = nullptr;
 }
 
+void HTTPRequest::StartEventStream(
+    int nStatus,
+    std::function<void(std::shared_ptr<HTTPEventStream>)> on_start) {
+    assert(!replySent && req && !m_chunked_reply);
+    auto req_copy = req;
+    HTTPEvent *ev = new HTTPEvent(
+        eventBase, true, [req_copy, nStatus, on_start = std::move(on_start)] {
+            auto stream{std::make_shared<HTTPEventStream>(req_copy)};
+            if (!stream->IsClosed()) {
+                evhttp_send_reply_start(req_copy, nStatus, nullptr);
+            }
+            on_start(std::move(stream));
+        });
+    ev->trigger(nullptr);
+    replySent = true;
+    // transferred to main thread.
+    req = nullptr;
+}
+
+HTTPEventStream::HTTPEventStream(struct evhttp_request *req) : m_req(req) {
+    // Get notified if the client goes away, as libevent then detaches the
+    // request from the connection until the reply is completed
+    evhttp_connection *conn = evhttp_request_get_connection(m_req);
+    if (conn) {
+        evhttp_connection_set_closecb(conn, OnConnectionClosed, this);
+    } else {
+        m_closed = true;
+    }
+}
+
+HTTPEventStream::~HTTPEventStream() {
+    Close();
+}
+
+void HTTPEventStream::OnConnectionClosed(evhttp_connection *conn, void *arg) {
+    static_cast<HTTPEventStream *>(arg)->m_closed = true;
+    http_connection_close_cb(conn, nullptr);
+}
+
+void HTTPEventStream::OnSent(evhttp_connection *conn, void *arg) {
+    static_cast<HTTPEventStream *>(arg)->m_pending = 0;
+}
+
+bool HTTPEventStream::Send(std::string_view data) {
+    if (m_closed) {
+        return false;
+    }
+    if (m_pending + data.size() > MAX_PENDING) {
+        LogPrint(BCLog::HTTP,
+                 "Closing event stream, the client is too far behind\n");
+        Close();
+        return false;
+    }
+    m_pending += data.size();
+
+    struct evbuffer *evb = evbuffer_new();
+    evbuffer_add(evb, data.data(), data.size());
+    evhttp_send_reply_chunk_with_cb(m_req, evb, OnSent, this);
+    evbuffer_free(evb);
+    return true;
+}
+
+void HTTPEventStream::Close() {
+    if (!m_req) {
+        return;
+    }
+    if (!m_closed) {
+        evhttp_connection *conn = evhttp_request_get_connection(m_req);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, http_connection_close_cb,
+                                          nullptr);
+        }
+        // The request may be freed as soon as the reply is completed
+        http_reenable_reading(m_req);
+    }
+    // If the connection was closed, this frees the request. Otherwise libevent
+    // takes over the write callback, so OnSent() is not called anymore.
+    evhttp_send_reply_end(m_req);
+    m_req = nullptr;
+    m_closed = true;
+}
+
 CService HTTPRequest::GetPeer() const {
     evhttp_connection *con = evhttp_request_get_connection(req);
     CService peer;
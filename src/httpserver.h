@@ -6,18 +6,28 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <util/latency.h>
+
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 static const int DEFAULT_HTTP_THREADS = 4;
 static const int DEFAULT_HTTP_WORKQUEUE = 16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT = 30;
 
+struct evhttp_connection;
 struct evhttp_request;
 struct event_base;
 
 class Config;
 class CService;
+struct HTTPChunkedReply;
+class HTTPEventStream;
 class HTTPRequest;
 
 /**
@@ -64,6 +74,24 @@ void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
  */
 struct event_base *EventBase();
 
+/** State of a work queue, along with the threads serving it */
+struct HTTPWorkQueueStats {
+    std::string name;
+    int threads;
+    //! RPC methods and endpoint prefixes served, none for the default queue
+    std::vector<std::string> targets;
+    size_t depth;
+    size_t max_depth;
+    uint64_t processed;
+    uint64_t rejected;
+    //! Time spent by the requests waiting for a thread, then being handled
+    LatencyHistogram::Snapshot wait_time;
+    LatencyHistogram::Snapshot run_time;
+};
+
+/** Get the state of the default work queue followed by the -rpcworklane ones */
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats();
+
 /**
  * In-flight HTTP request.
  * Thin C++ wrapper around evhttp_request.
@@ -72,6 +100,8 @@ class HTTPRequest {
 private:
     struct evhttp_request *req;
     bool replySent;
+    //! Set while a chunked reply is being sent
+    std::shared_ptr<HTTPChunkedReply> m_chunked_reply;
 
 public:
     explicit HTTPRequest(struct evhttp_request *req, bool replySent = false);
@@ -120,6 +150,83 @@ public:
      * this.
      */
     void WriteReply(int nStatus, const std::string &strReply = "");
+
+    /**
+     * Start a chunked reply, to send a large body while it is produced rather
+     * than building it in memory first. The body is then sent with
+     * WriteReplyChunk() and the reply completed with EndChunkedReply().
+     *
+     * @note Call this instead of WriteReply(), after WriteHeader().
+     */
+    void StartChunkedReply(int nStatus);
+
+    /**
+     * Send a part of the body of a chunked reply. This blocks while the client
+     * is too far behind.
+     * Return false if the connection was closed, in which case the rest of
+     * the body can be skipped.
+     */
+    bool WriteReplyChunk(std::string_view chunk);
+
+    /**
+     * Complete a chunked reply.
+     *
+     * @note Like WriteReply(), do not call any other HTTPRequest methods
+     * after calling this.
+     */
+    void EndChunkedReply();
+
+    /**
+     * Start a reply whose body is an open-ended stream of events, such as
+     * server-sent events, and hand the request over to the main http thread.
+     * on_start is then called from that thread with the stream, which can be
+     * kept for as long as events are to be sent. Unlike a chunked reply, no
+     * worker thread is held while the client is connected.
+     *
+     * @note Like WriteReply(), do not call any other HTTPRequest methods
+     * after calling this.
+     */
+    void StartEventStream(
+        int nStatus,
+        std::function<void(std::shared_ptr<HTTPEventStream>)> on_start);
+};
+
+/**
+ * Body of a reply streaming events to a client for as long as it is
+ * connected. It must only be used from the main http thread, see
+ * HTTPRequest::StartEventStream().
+ */
+class HTTPEventStream {
+public:
+    /**
+     * Size of the events sent but not written to the connection yet, beyond
+     * which the client is considered gone and the stream closed.
+     */
+    static constexpr size_t MAX_PENDING{1024 * 1024};
+
+    explicit HTTPEventStream(struct evhttp_request *req);
+    ~HTTPEventStream();
+
+    HTTPEventStream(const HTTPEventStream &) = delete;
+    HTTPEventStream &operator=(const HTTPEventStream &) = delete;
+
+    /** Send data to the client. Return false if the stream is closed. */
+    bool Send(std::string_view data);
+
+    /** Whether the stream was closed, or the client went away */
+    bool IsClosed() const { return m_closed; }
+
+    /** Complete the reply */
+    void Close();
+
+private:
+    static void OnConnectionClosed(struct evhttp_connection *conn, void *arg);
+    static void OnSent(struct evhttp_connection *conn, void *arg);
+
+    struct evhttp_request *m_req;
+    //! Size of the data not entirely written to the connection yet
+    size_t m_pending{0};
+    bool m_closed{false};
 };
 
 /** Event handler closure */
@@ -47,6 +47,7 @@
 #include <net_processing.h>
 #include <netbase.h>
 #include <node/blockmanager_args.h>
+#include <node/blockservecache.h>
 #include <node/blockstorage.h>
 #include <node/caches.h>
 #include <node/chainstate.h>
@@ -524,6 +525,12 @@ void SetupServerArgs(NodeContext &node) {
                              "block reconstructions (default: %u)",
                              DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN),
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-blockservecachesize=<n>",
+                   strprintf("Memory in MiB used to cache the blocks served to "
+                             "peers, 0 to disable (default: %d, maximum: %d)",
+                             node::DEFAULT_BLOCK_SERVE_CACHE_SIZE,
+                             node::MAX_BLOCK_SERVE_CACHE_SIZE),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg(
         "-blocksonly",
         strprintf("Whether to reject transactions from network peers.  "
@@ -911,6 +918,13 @@ void SetupServerArgs(NodeContext &node) {
                   "the specified value (default: %u)",
                   DEFAULT_MAX_PEER_CONNECTIONS),
         ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    argsman.AddArg(
+        "-msghandlerthreads=<n>",
+        strprintf("Number of threads processing the peer messages. The peers "
+                  "are spread over the threads, each peer always being handled "
+                  "by the same thread (1 to %d, default: %d)",
+                  MAX_MSG_HANDLER_THREADS, DEFAULT_MSG_HANDLER_THREADS),
+        ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxreceivebuffer=<n>",
                    strprintf("Maximum per-connection receive buffer, <n>*1000 "
                              "bytes (default: %u)",
@@ -1028,6 +1042,17 @@ void SetupServerArgs(NodeContext &node) {
                              "(minimum: 1, default: %d)",
                              DEFAULT_CONNECT_TIMEOUT),
                    ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+#ifdef USE_EPOLL
+    argsman.AddArg(
+        "-useepoll",
+        strprintf("Wait for peer socket events with epoll instead of polling "
+                  "all the sockets at each network loop iteration (default: "
+                  "%d)",
+                  DEFAULT_USE_EPOLL),
+        ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+#else
+    hidden_args.emplace_back("-useepoll");
+#endif
     argsman.AddArg(
         "-peertimeout=<n>",
         strprintf("Specify p2p connection timeout in seconds. This option "
@@ -1131,6 +1156,12 @@ void SetupServerArgs(NodeContext &node) {
                              " (default: %d)",
                              CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM),
                    ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqqueuesize=<n>",
+                   strprintf("Maximum number of messages waiting to be "
+                             "published, beyond which they are dropped "
+                             "(default: %u)",
+                             CZMQPublishQueue::DEFAULT_MAX_SIZE),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
 #else
     hidden_args.emplace_back("-zmqpubhashblock=<address>");
     hidden_args.emplace_back("-zmqpubhashtx=<address>");
@@ -1142,6 +1173,7 @@ void SetupServerArgs(NodeContext &node) {
     hidden_args.emplace_back("-zmqpubrawblockhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawtxhwm=<n>");
     hidden_args.emplace_back("-zmqpubsequencehwm=<n>");
+    hidden_args.emplace_back("-zmqqueuesize=<n>");
 #endif
 
     argsman.AddArg(
@@ -1411,6 +1443,14 @@ void SetupServerArgs(NodeContext &node) {
             "Set the number of threads to service RPC calls (default: %d)",
             DEFAULT_HTTP_THREADS),
         ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    argsman.AddArg(
+        "-rpcbatchthreads=<n>",
+        strprintf("Set the number of threads executing the requests of a "
+                  "JSON-RPC batch concurrently. The replies keep the order of "
+                  "the requests, but the requests of a batch must then not "
+                  "depend on each other (default: %d)",
+                  DEFAULT_RPC_BATCH_THREADS),
+        ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg(
         "-rpccorsdomain=value",
         "Domain from which to accept cross origin requests (browser enforced)",
@@ -1422,6 +1462,14 @@ void SetupServerArgs(NodeContext &node) {
                              DEFAULT_HTTP_WORKQUEUE),
                    ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY,
                    OptionsCategory::RPC);
+    argsman.AddArg(
+        "-rpcworklane=<name>:<n>:<method or /endpoint>[,<method or /endpoint>]",
+        "Serve the listed RPC methods and the endpoints starting with the "
+        "listed prefixes from a separate work queue with <n> dedicated "
+        "threads, so they are not delayed by slow requests. The queue has the "
+        "depth set by -rpcworkqueue. This option can be specified multiple "
+        "times",
+        ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::RPC);
     argsman.AddArg("-rpcservertimeout=<n>",
                    strprintf("Timeout during HTTP requests (default: %d)",
                              DEFAULT_HTTP_SERVER_TIMEOUT),
@@ -3032,6 +3080,11 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
     connOptions.nReceiveFloodSize =
         1000 * args.GetIntArg("-maxreceivebuffer", DEFAULT_MAXRECEIVEBUFFER);
     connOptions.m_added_nodes = args.GetArgs("-addnode");
+#ifdef USE_EPOLL
+    connOptions.m_use_epoll = args.GetBoolArg("-useepoll", DEFAULT_USE_EPOLL);
+#endif
+    connOptions.m_msg_handler_threads =
+        args.GetIntArg("-msghandlerthreads", DEFAULT_MSG_HANDLER_THREADS);
 
     connOptions.nMaxOutboundLimit =
         1024 * 1024 *
@@ -11,11 +11,15 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace {
 
@@ -296,11 +300,14 @@ bool operator==(const PeerInfo &a, const PeerInfo &b) {
 };
 
 /**
- * (Re)compute the PeerInfo map from the index. Only used for sanity checking.
+ * (Re)compute the PeerInfo map from the announcements. Only used for sanity
+ * checking.
  */
-std::unordered_map<NodeId, PeerInfo> RecomputePeerInfo(const Index &index) {
+template <typename Announcements>
+std::unordered_map<NodeId, PeerInfo>
+RecomputePeerInfo(const Announcements &anns) {
     std::unordered_map<NodeId, PeerInfo> ret;
-    for (const Announcement &ann : index) {
+    for (const Announcement &ann : anns) {
         PeerInfo &info = ret[ann.m_peer];
         ++info.m_total;
         info.m_requested += (ann.GetState() == State::REQUESTED);
@@ -310,10 +317,11 @@ std::unordered_map<NodeId, PeerInfo> RecomputePeerInfo(const Index &index) {
 }
 
 /** Compute the InvIdInfo map. Only used for sanity checking. */
+template <typename Announcements>
 std::map<uint256, InvIdInfo>
-ComputeInvIdInfo(const Index &index, const PriorityComputer &computer) {
+ComputeInvIdInfo(const Announcements &anns, const PriorityComputer &computer) {
     std::map<uint256, InvIdInfo> ret;
-    for (const Announcement &ann : index) {
+    for (const Announcement &ann : anns) {
         InvIdInfo &info = ret[ann.m_invid];
         // Classify how many announcements of each state we have for this invid.
         info.m_candidate_delayed +=
@@ -337,6 +345,77 @@ ComputeInvIdInfo(const Index &index, const PriorityComputer &computer) {
     return ret;
 }
 
+/**
+ * Check the invariants of a set of announcements, and that the peerinfo
+ * statistics match them. Only used for sanity checking.
+ */
+template <typename Announcements>
+void SanityCheckAnnouncements(
+    const Announcements &anns, const PriorityComputer &computer,
+    const std::unordered_map<NodeId, PeerInfo> &peerinfo) {
+    // Recompute the peer info from the announcements. This verifies the data
+    // in it as it should just be caching statistics on the announcements. It
+    // also verifies the invariant that no PeerInfo announcements with
+    // m_total==0 exist.
+    assert(peerinfo == RecomputePeerInfo(anns));
+
+    // Calculate per-invid statistics from the announcements, and validate
+    // invariants.
+    for (auto &item : ComputeInvIdInfo(anns, computer)) {
+        InvIdInfo &info = item.second;
+
+        // Cannot have only COMPLETED peer (invid should have been forgotten
+        // already)
+        assert(info.m_candidate_delayed + info.m_candidate_ready +
+                   info.m_candidate_best + info.m_requested >
+               0);
+
+        // Can have at most 1 CANDIDATE_BEST/REQUESTED peer
+        assert(info.m_candidate_best + info.m_requested <= 1);
+
+        // If there are any CANDIDATE_READY announcements, there must be
+        // exactly one CANDIDATE_BEST or REQUESTED announcement.
+        if (info.m_candidate_ready > 0) {
+            assert(info.m_candidate_best + info.m_requested == 1);
+        }
+
+        // If there is both a CANDIDATE_READY and a CANDIDATE_BEST
+        // announcement, the CANDIDATE_BEST one must be at least as good
+        // (equal or higher priority) as the best CANDIDATE_READY.
+        if (info.m_candidate_ready && info.m_candidate_best) {
+            assert(info.m_priority_candidate_best >=
+                   info.m_priority_best_candidate_ready);
+        }
+
+        // No invid can have been announced by the same peer twice.
+        std::sort(info.m_peers.begin(), info.m_peers.end());
+        assert(std::adjacent_find(info.m_peers.begin(), info.m_peers.end()) ==
+               info.m_peers.end());
+    }
+}
+
+/**
+ * Check the announcement times right after GetRequestable was called with the
+ * same 'now'. Only used for sanity checking.
+ */
+template <typename Announcements>
+void PostGetRequestableSanityCheckAnnouncements(const Announcements &anns,
+                                                std::chrono::microseconds now) {
+    for (const Announcement &ann : anns) {
+        if (ann.IsWaiting()) {
+            // REQUESTED and CANDIDATE_DELAYED must have a time in the future
+            // (they should have been converted to COMPLETED/CANDIDATE_READY
+            // respectively).
+            assert(ann.m_time > now);
+        } else if (ann.IsSelectable()) {
+            // CANDIDATE_READY and CANDIDATE_BEST cannot have a time in the
+            // future (they should have remained CANDIDATE_DELAYED, or should
+            // have been converted back to it if time went backwards).
+            assert(ann.m_time <= now);
+        }
+    }
+}
+
 } // namespace
 
 /** Actual implementation for InvRequestTracker's data structure. */
@@ -357,63 +436,12 @@ class InvRequestTrackerImpl : public InvRequestTrackerImplInterface {
 
 public:
     void SanityCheck() const override {
-        // Recompute m_peerdata from m_index. This verifies the data in it as it
-        // should just be caching statistics on m_index. It also verifies the
-        // invariant that no PeerInfo announcements with m_total==0 exist.
-        assert(m_peerinfo == RecomputePeerInfo(m_index));
-
-        // Calculate per-invid statistics from m_index, and validate
-        // invariants.
-        for (auto &item : ComputeInvIdInfo(m_index, m_computer)) {
-            InvIdInfo &info = item.second;
-
-            // Cannot have only COMPLETED peer (invid should have been forgotten
-            // already)
-            assert(info.m_candidate_delayed + info.m_candidate_ready +
-                       info.m_candidate_best + info.m_requested >
-                   0);
-
-            // Can have at most 1 CANDIDATE_BEST/REQUESTED peer
-            assert(info.m_candidate_best + info.m_requested <= 1);
-
-            // If there are any CANDIDATE_READY announcements, there must be
-            // exactly one CANDIDATE_BEST or REQUESTED announcement.
-            if (info.m_candidate_ready > 0) {
-                assert(info.m_candidate_best + info.m_requested == 1);
-            }
-
-            // If there is both a CANDIDATE_READY and a CANDIDATE_BEST
-            // announcement, the CANDIDATE_BEST one must be at least as good
-            // (equal or higher priority) as the best CANDIDATE_READY.
-            if (info.m_candidate_ready && info.m_candidate_best) {
-                assert(info.m_priority_candidate_best >=
-                       info.m_priority_best_candidate_ready);
-            }
-
-            // No invid can have been announced by the same peer twice.
-            std::sort(info.m_peers.begin(), info.m_peers.end());
-            assert(
-                std::adjacent_find(info.m_peers.begin(), info.m_peers.end()) ==
-                info.m_peers.end());
-        }
+        SanityCheckAnnouncements(m_index, m_computer, m_peerinfo);
     }
 
     void PostGetRequestableSanityCheck(
         std::chrono::microseconds now) const override {
-        for (const Announcement &ann : m_index) {
-            if (ann.IsWaiting()) {
-                // REQUESTED and CANDIDATE_DELAYED must have a time in the
-                // future (they should have been converted to
-                // COMPLETED/CANDIDATE_READY respectively).
-                assert(ann.m_time > now);
-            } else if (ann.IsSelectable()) {
-                // CANDIDATE_READY and CANDIDATE_BEST cannot have a time in the
-                // future (they should have remained CANDIDATE_DELAYED, or
-                // should have been converted back to it if time went
-                // backwards).
-                assert(ann.m_time <= now);
-            }
-        }
+        PostGetRequestableSanityCheckAnnouncements(m_index, now);
     }
 
 private:
@@ -847,7 +875,957 @@ public:
     }
 };
 
+namespace {
+
+//! Position of an entry in one of the FlatInvRequestTrackerImpl slabs.
+using SlotIndex = uint32_t;
+constexpr SlotIndex NO_SLOT{std::numeric_limits<SlotIndex>::max()};
+
+/**
+ * Open addressing hash index over slab slots, with linear probing.
+ *
+ * Only the slot and 32 bits of its hash are stored, the caller compares the
+ * keys by looking the slot up. The home bucket is derived from the stored
+ * hash, so growing or shrinking the table does not need the keys.
+ */
+class FlatHashIndex {
+    struct Bucket {
+        SlotIndex slot{NO_SLOT};
+        uint32_t hash{0};
+    };
+
+    static constexpr size_t MIN_BUCKETS{16};
+
+    std::vector<Bucket> m_buckets{MIN_BUCKETS};
+    size_t m_count{0};
+
+    size_t Mask() const { return m_buckets.size() - 1; }
+
+    size_t FindPosition(uint32_t hash, SlotIndex slot) const {
+        for (size_t pos = hash & Mask();; pos = (pos + 1) & Mask()) {
+            assert(m_buckets[pos].slot != NO_SLOT);
+            if (m_buckets[pos].slot == slot) {
+                return pos;
+            }
+        }
+    }
+
+    void Place(const Bucket &bucket) {
+        size_t pos = bucket.hash & Mask();
+        while (m_buckets[pos].slot != NO_SLOT) {
+            pos = (pos + 1) & Mask();
+        }
+        m_buckets[pos] = bucket;
+    }
+
+    void Resize(size_t num_buckets) {
+        std::vector<Bucket> old_buckets(num_buckets);
+        old_buckets.swap(m_buckets);
+        for (const Bucket &bucket : old_buckets) {
+            if (bucket.slot != NO_SLOT) {
+                Place(bucket);
+            }
+        }
+    }
+
+public:
+    /** Return the slot with this hash for which match(slot) is true. */
+    template <typename Match>
+    SlotIndex Find(uint32_t hash, Match match) const {
+        for (size_t pos = hash & Mask();; pos = (pos + 1) & Mask()) {
+            const Bucket &bucket = m_buckets[pos];
+            if (bucket.slot == NO_SLOT) {
+                return NO_SLOT;
+            }
+            if (bucket.hash == hash && match(bucket.slot)) {
+                return bucket.slot;
+            }
+        }
+    }
+
+    void Insert(uint32_t hash, SlotIndex slot) {
+        // Keep the load factor under 1/2 so the probe sequences stay short
+        if ((m_count + 1) * 2 > m_buckets.size()) {
+            Resize(m_buckets.size() * 2);
+        }
+        Place(Bucket{slot, hash});
+        ++m_count;
+    }
+
+    void Erase(uint32_t hash, SlotIndex slot) {
+        size_t pos = FindPosition(hash, slot);
+        // Shift the following entries back instead of leaving a tombstone, so
+        // lookups never probe deleted entries.
+        for (size_t next = (pos + 1) & Mask(); m_buckets[next].slot != NO_SLOT;
+             next = (next + 1) & Mask()) {
+            const size_t home = m_buckets[next].hash & Mask();
+            if (((next - home) & Mask()) >= ((next - pos) & Mask())) {
+                m_buckets[pos] = m_buckets[next];
+                pos = next;
+            }
+        }
+        m_buckets[pos].slot = NO_SLOT;
+        --m_count;
+
+        // Release the memory after a burst of announcements
+        if (m_buckets.size() > MIN_BUCKETS && m_count * 8 < m_buckets.size()) {
+            Resize(m_buckets.size() / 2);
+        }
+    }
+
+    size_t Size() const { return m_count; }
+};
+
+/** An announcement in the FlatInvRequestTrackerImpl slab. */
+struct FlatAnnouncement {
+    uint256 m_invid;
+    /**
+     * For CANDIDATE_{DELAYED,BEST,READY} the reqtime; for REQUESTED the
+     * expiry.
+     */
+    std::chrono::microseconds m_time;
+    NodeId m_peer;
+    /** Computed once when the announcement is received. */
+    Priority m_priority;
+    SequenceNumber m_sequence;
+    /** Group of the announcements with the same invid, NO_SLOT if unused. */
+    SlotIndex m_group{NO_SLOT};
+    /** Next announcement of the same group. */
+    SlotIndex m_next_in_group{NO_SLOT};
+    /** Doubly linked list of the announcements of the same peer. */
+    SlotIndex m_prev_of_peer{NO_SLOT};
+    SlotIndex m_next_of_peer{NO_SLOT};
+    /** Doubly linked list of the CANDIDATE_BEST announcements of the peer. */
+    SlotIndex m_prev_best{NO_SLOT};
+    SlotIndex m_next_best{NO_SLOT};
+    /**
+     * Bumped whenever the timer entries for this slot become obsolete, i.e.
+     * when its time is changed or the slot is released.
+     */
+    uint32_t m_timer_generation{0};
+    bool m_preferred;
+    State m_state;
+
+    bool IsWaiting() const {
+        return m_state == State::REQUESTED ||
+               m_state == State::CANDIDATE_DELAYED;
+    }
+    bool IsSelectable() const {
+        return m_state == State::CANDIDATE_READY ||
+               m_state == State::CANDIDATE_BEST;
+    }
+};
+
+/** The announcements for an invid. */
+struct FlatInvIdGroup {
+    /** First announcement of the group, NO_SLOT if the group is unused. */
+    SlotIndex m_head{NO_SLOT};
+    /** The CANDIDATE_BEST or REQUESTED announcement, if any. */
+    SlotIndex m_selected{NO_SLOT};
+    /** Number of announcements that are not COMPLETED. */
+    uint32_t m_num_non_completed{0};
+};
+
+/** Per-peer statistics and lists. */
+struct FlatPeerInfo {
+    PeerInfo m_info;
+    SlotIndex m_head{NO_SLOT};
+    SlotIndex m_best_head{NO_SLOT};
+};
+
+} // namespace
+
+/**
+ * Implementation of InvRequestTracker's data structure with flat hash tables
+ * and a timer wheel.
+ *
+ * The semantics are exactly the same as InvRequestTrackerImpl's, but instead
+ * of keeping every announcement in 3 ordered indexes, which costs several
+ * allocations and tree rebalancing per announcement:
+ * - The announcements live in a slab and are found by (peer, invid) through
+ *   an open addressing hash table.
+ * - The announcements for an invid are linked together in a group, found by
+ *   invid through another hash table. The group tracks its selected
+ *   (CANDIDATE_BEST or REQUESTED) announcement so the best candidate only has
+ *   to be looked for when the selected one goes away.
+ * - The announcements of a peer, and its CANDIDATE_BEST ones, are kept in
+ *   linked lists so DisconnectedPeer and GetRequestable only visit them.
+ * - CANDIDATE_DELAYED and REQUESTED announcements are kept in a timer wheel
+ *   keyed by their time, so moving the time forward only visits the events
+ *   that passed. The entries are invalidated lazily.
+ * - Time going backwards is rare, so it is handled by scanning all the
+ *   announcements, only when the time goes back below the latest time of a
+ *   CANDIDATE_READY or CANDIDATE_BEST announcement.
+ */
+class FlatInvRequestTrackerImpl : public InvRequestTrackerImplInterface {
+    //! Width of a timer wheel bucket, about 65ms.
+    static constexpr int WHEEL_BUCKET_BITS{16};
+    //! Number of timer wheel buckets, covering about 4.5 minutes.
+    static constexpr int64_t WHEEL_SIZE{4096};
+
+    struct TimerEntry {
+        //! The time of the announcement when the timer was added.
+        std::chrono::microseconds time;
+        SlotIndex slot;
+        uint32_t generation;
+    };
+
+    //! Comparator making the current wheel bucket a min-heap by time.
+    static bool LaterTimer(const TimerEntry &a, const TimerEntry &b) {
+        return a.time > b.time;
+    }
+
+    //! The current sequence number. Increases for every announcement. This is
+    //! used to sort invid returned by GetRequestable in announcement order.
+    SequenceNumber m_current_sequence{0};
+
+    //! This tracker's priority computer.
+    const PriorityComputer m_computer;
+
+    //! Salt for the hash tables.
+    const uint64_t m_k0, m_k1;
+
+    std::vector<FlatAnnouncement> m_anns;
+    std::vector<SlotIndex> m_free_anns;
+    std::vector<FlatInvIdGroup> m_groups;
+    std::vector<SlotIndex> m_free_groups;
+
+    //! Announcements by (peer, invid).
+    FlatHashIndex m_by_peer_invid;
+    //! Groups by invid.
+    FlatHashIndex m_by_invid;
+
+    //! Map with this tracker's per-peer statistics.
+    std::unordered_map<NodeId, FlatPeerInfo> m_peerinfo;
+
+    //! Timer wheel of the CANDIDATE_DELAYED and REQUESTED announcements. The
+    //! bucket for time t is (t >> WHEEL_BUCKET_BITS) % WHEEL_SIZE. The current
+    //! bucket is kept as a heap so only the timers that passed are visited.
+    std::vector<std::vector<TimerEntry>> m_wheel{size_t(WHEEL_SIZE)};
+    //! All the wheel buckets before this one have been processed.
+    int64_t m_wheel_bucket{0};
+    //! Whether m_wheel_bucket was initialized from the first time point.
+    bool m_wheel_started{false};
+    //! Entries before m_wheel_bucket, e.g. because the time went backwards.
+    std::vector<TimerEntry> m_late_timers;
+    //! Entries beyond the wheel range.
+    std::vector<TimerEntry> m_far_timers;
+    int64_t m_far_timers_min_bucket{std::numeric_limits<int64_t>::max()};
+
+    //! Upper bound of the time of the CANDIDATE_READY and CANDIDATE_BEST
+    //! announcements.
+    std::chrono::microseconds m_max_selectable_time{
+        std::chrono::microseconds::min()};
+
+    static int64_t WheelBucket(std::chrono::microseconds time) {
+        return time.count() >> WHEEL_BUCKET_BITS;
+    }
+
+    uint32_t HashPeerInvId(NodeId peer, const uint256 &invid) const {
+        return SipHashUint256Extra(m_k0, m_k1, invid, uint32_t(peer));
+    }
+
+    uint32_t HashInvId(const uint256 &invid) const {
+        return SipHashUint256(m_k0, m_k1, invid);
+    }
+
+    SlotIndex FindAnnouncement(NodeId peer, const uint256 &invid) const {
+        return m_by_peer_invid.Find(
+            HashPeerInvId(peer, invid), [&](SlotIndex slot) {
+                return m_anns[slot].m_peer == peer &&
+                       m_anns[slot].m_invid == invid;
+            });
+    }
+
+    SlotIndex FindGroup(const uint256 &invid) const {
+        return m_by_invid.Find(HashInvId(invid), [&](SlotIndex group) {
+            return m_anns[m_groups[group].m_head].m_invid == invid;
+        });
+    }
+
+    //! Put a still valid timer entry where it belongs.
+    void PlaceTimer(const TimerEntry &entry) {
+        const int64_t bucket{WheelBucket(entry.time)};
+        if (!m_wheel_started || bucket < m_wheel_bucket) {
+            m_late_timers.push_back(entry);
+        } else if (bucket == m_wheel_bucket) {
+            auto &current = m_wheel[bucket & (WHEEL_SIZE - 1)];
+            current.push_back(entry);
+            std::push_heap(current.begin(), current.end(), LaterTimer);
+        } else if (bucket - m_wheel_bucket < WHEEL_SIZE) {
+            m_wheel[bucket & (WHEEL_SIZE - 1)].push_back(entry);
+        } else {
+            m_far_timers.push_back(entry);
+            m_far_timers_min_bucket = std::min(m_far_timers_min_bucket, bucket);
+        }
+    }
+
+    //! Add a timer for a CANDIDATE_DELAYED or REQUESTED announcement.
+    void Schedule(SlotIndex slot) {
+        FlatAnnouncement &ann = m_anns[slot];
+        assert(ann.IsWaiting());
+        PlaceTimer(TimerEntry{ann.m_time, slot, ++ann.m_timer_generation});
+    }
+
+    bool IsTimerValid(const TimerEntry &entry) const {
+        const FlatAnnouncement &ann = m_anns[entry.slot];
+        return ann.m_group != NO_SLOT &&
+               ann.m_timer_generation == entry.generation && ann.IsWaiting();
+    }
+
+    //! Change the state of an announcement, keeping the statistics, the
+    //! group and the CANDIDATE_BEST list up to date.
+    void SetState(SlotIndex slot, State state) {
+        FlatAnnouncement &ann = m_anns[slot];
+        const State old_state{ann.m_state};
+        if (old_state == state) {
+            return;
+        }
+        FlatPeerInfo &peerinfo = m_peerinfo.find(ann.m_peer)->second;
+        FlatInvIdGroup &group = m_groups[ann.m_group];
+
+        peerinfo.m_info.m_completed -= old_state == State::COMPLETED;
+        peerinfo.m_info.m_requested -= old_state == State::REQUESTED;
+        peerinfo.m_info.m_completed += state == State::COMPLETED;
+        peerinfo.m_info.m_requested += state == State::REQUESTED;
+        group.m_num_non_completed -= state == State::COMPLETED;
+        group.m_num_non_completed += old_state == State::COMPLETED;
+
+        if (old_state == State::CANDIDATE_BEST) {
+            UnlinkBest(peerinfo, slot);
+        }
+        if (state == State::CANDIDATE_BEST) {
+            ann.m_prev_best = NO_SLOT;
+            ann.m_next_best = peerinfo.m_best_head;
+            if (peerinfo.m_best_head != NO_SLOT) {
+                m_anns[peerinfo.m_best_head].m_prev_best = slot;
+            }
+            peerinfo.m_best_head = slot;
+        }
+
+        const bool was_selected{old_state == State::CANDIDATE_BEST ||
+                                old_state == State::REQUESTED};
+        const bool is_selected{state == State::CANDIDATE_BEST ||
+                               state == State::REQUESTED};
+        if (was_selected && group.m_selected == slot) {
+            group.m_selected = NO_SLOT;
+        }
+        if (is_selected) {
+            assert(group.m_selected == NO_SLOT);
+            group.m_selected = slot;
+        }
+
+        if (state == State::CANDIDATE_READY ||
+            state == State::CANDIDATE_BEST) {
+            m_max_selectable_time = std::max(m_max_selectable_time, ann.m_time);
+        }
+
+        ann.m_state = state;
+    }
+
+    void UnlinkBest(FlatPeerInfo &peerinfo, SlotIndex slot) {
+        FlatAnnouncement &ann = m_anns[slot];
+        if (ann.m_prev_best != NO_SLOT) {
+            m_anns[ann.m_prev_best].m_next_best = ann.m_next_best;
+        } else {
+            peerinfo.m_best_head = ann.m_next_best;
+        }
+        if (ann.m_next_best != NO_SLOT) {
+            m_anns[ann.m_next_best].m_prev_best = ann.m_prev_best;
+        }
+    }
+
+    //! Remove an announcement from the peer lists, the (peer, invid) index
+    //! and the statistics, and release its slot. The group is left to the
+    //! caller.
+    void ReleaseAnnouncement(SlotIndex slot) {
+        FlatAnnouncement &ann = m_anns[slot];
+        auto peerit = m_peerinfo.find(ann.m_peer);
+        FlatPeerInfo &peerinfo = peerit->second;
+
+        if (ann.m_state == State::CANDIDATE_BEST) {
+            UnlinkBest(peerinfo, slot);
+        }
+        if (ann.m_prev_of_peer != NO_SLOT) {
+            m_anns[ann.m_prev_of_peer].m_next_of_peer = ann.m_next_of_peer;
+        } else {
+            peerinfo.m_head = ann.m_next_of_peer;
+        }
+        if (ann.m_next_of_peer != NO_SLOT) {
+            m_anns[ann.m_next_of_peer].m_prev_of_peer = ann.m_prev_of_peer;
+        }
+
+        peerinfo.m_info.m_completed -= ann.m_state == State::COMPLETED;
+        peerinfo.m_info.m_requested -= ann.m_state == State::REQUESTED;
+        if (--peerinfo.m_info.m_total == 0) {
+            m_peerinfo.erase(peerit);
+        }
+
+        m_by_peer_invid.Erase(HashPeerInvId(ann.m_peer, ann.m_invid), slot);
+        ann.m_group = NO_SLOT;
+        ++ann.m_timer_generation;
+        m_free_anns.push_back(slot);
+    }
+
+    //! Delete a single announcement (the wrapper around Index::erase in
+    //! InvRequestTrackerImpl).
+    void Erase(SlotIndex slot) {
+        const SlotIndex group_slot{m_anns[slot].m_group};
+        FlatInvIdGroup &group = m_groups[group_slot];
+
+        // Unlink from the group
+        if (group.m_head == slot) {
+            group.m_head = m_anns[slot].m_next_in_group;
+        } else {
+            SlotIndex prev{group.m_head};
+            while (m_anns[prev].m_next_in_group != slot) {
+                prev = m_anns[prev].m_next_in_group;
+            }
+            m_anns[prev].m_next_in_group = m_anns[slot].m_next_in_group;
+        }
+        group.m_num_non_completed -= m_anns[slot].m_state != State::COMPLETED;
+        if (group.m_selected == slot) {
+            group.m_selected = NO_SLOT;
+        }
+
+        if (group.m_head == NO_SLOT) {
+            // The invid of the group is read from the announcement, release
+            // the group first.
+            m_by_invid.Erase(HashInvId(m_anns[slot].m_invid), group_slot);
+            group = FlatInvIdGroup{};
+            m_free_groups.push_back(group_slot);
+        }
+        ReleaseAnnouncement(slot);
+    }
+
+    //! Delete all the announcements for an invid.
+    void EraseGroup(SlotIndex group_slot) {
+        FlatInvIdGroup &group = m_groups[group_slot];
+        m_by_invid.Erase(HashInvId(m_anns[group.m_head].m_invid), group_slot);
+        for (SlotIndex slot = group.m_head; slot != NO_SLOT;) {
+            const SlotIndex next{m_anns[slot].m_next_in_group};
+            ReleaseAnnouncement(slot);
+            slot = next;
+        }
+        group = FlatInvIdGroup{};
+        m_free_groups.push_back(group_slot);
+    }
+
+    //! Convert a CANDIDATE_DELAYED announcement into a CANDIDATE_READY. If this
+    //! makes it the new best CANDIDATE_READY (and no REQUESTED exists) and
+    //! better than the CANDIDATE_BEST (if any), it becomes the new
+    //! CANDIDATE_BEST.
+    void PromoteCandidateReady(SlotIndex slot) {
+        assert(m_anns[slot].m_state == State::CANDIDATE_DELAYED);
+        SetState(slot, State::CANDIDATE_READY);
+        const SlotIndex selected{m_groups[m_anns[slot].m_group].m_selected};
+        if (selected == NO_SLOT) {
+            // There are no other CANDIDATE_READY announcements either, as
+            // there would be a selected one otherwise.
+            SetState(slot, State::CANDIDATE_BEST);
+        } else if (m_anns[selected].m_state == State::CANDIDATE_BEST &&
+                   m_anns[slot].m_priority > m_anns[selected].m_priority) {
+            SetState(selected, State::CANDIDATE_READY);
+            SetState(slot, State::CANDIDATE_BEST);
+        }
+    }
+
+    //! Change the state of an announcement to something non-IsSelected(). If it
+    //! was IsSelected(), the next best announcement will be marked
+    //! CANDIDATE_BEST.
+    void ChangeAndReselect(SlotIndex slot, State new_state) {
+        assert(new_state == State::COMPLETED ||
+               new_state == State::CANDIDATE_DELAYED);
+        const FlatInvIdGroup &group = m_groups[m_anns[slot].m_group];
+        if (group.m_selected == slot) {
+            SetState(slot, new_state);
+            SlotIndex best{NO_SLOT};
+            for (SlotIndex other = group.m_head; other != NO_SLOT;
+                 other = m_anns[other].m_next_in_group) {
+                if (m_anns[other].m_state == State::CANDIDATE_READY &&
+                    (best == NO_SLOT ||
+                     m_anns[other].m_priority > m_anns[best].m_priority)) {
+                    best = other;
+                }
+            }
+            if (best != NO_SLOT) {
+                SetState(best, State::CANDIDATE_BEST);
+            }
+        } else {
+            SetState(slot, new_state);
+        }
+    }
+
+    /**
+     * Convert any announcement to a COMPLETED one. If there are no
+     * non-COMPLETED announcements left for this invid, they are deleted. If
+     * this was a REQUESTED announcement, and there are other CANDIDATEs left,
+     * the best one is made CANDIDATE_BEST. Returns whether the announcement
+     * still exists.
+     */
+    bool MakeCompleted(SlotIndex slot) {
+        if (m_anns[slot].m_state == State::COMPLETED) {
+            return true;
+        }
+
+        const SlotIndex group_slot{m_anns[slot].m_group};
+        if (m_groups[group_slot].m_num_non_completed == 1) {
+            // This is the last non-COMPLETED announcement for this invid.
+            // Delete all.
+            EraseGroup(group_slot);
+            return false;
+        }
+
+        ChangeAndReselect(slot, State::COMPLETED);
+        return true;
+    }
+
+    //! Fire a timer whose time passed.
+    void FireTimer(const TimerEntry &entry, EmplaceExpiredFun emplaceExpired) {
+        const FlatAnnouncement &ann = m_anns[entry.slot];
+        if (ann.m_state == State::CANDIDATE_DELAYED) {
+            PromoteCandidateReady(entry.slot);
+        } else {
+            emplaceExpired(ann.m_peer, ann.m_invid);
+            MakeCompleted(entry.slot);
+        }
+    }
+
+    //! Fire the valid timers of the list whose time passed, and keep the
+    //! others where they belong.
+    void ProcessTimers(std::vector<TimerEntry> &timers,
+                       std::chrono::microseconds now,
+                       EmplaceExpiredFun emplaceExpired) {
+        std::vector<TimerEntry> pending;
+        pending.swap(timers);
+        for (const TimerEntry &entry : pending) {
+            if (!IsTimerValid(entry)) {
+                continue;
+            }
+            if (entry.time <= now) {
+                FireTimer(entry, emplaceExpired);
+            } else {
+                PlaceTimer(entry);
+            }
+        }
+    }
+
+    //! Make the data structure consistent with a given point in time:
+    //! - REQUESTED annoucements with expiry <= now are turned into COMPLETED.
+    //! - CANDIDATE_DELAYED announcements with reqtime <= now are turned into
+    //!   CANDIDATE_{READY,BEST}.
+    //! - CANDIDATE_{READY,BEST} announcements with reqtime > now are turned
+    //!   into CANDIDATE_DELAYED.
+    void SetTimePoint(std::chrono::microseconds now,
+                      ClearExpiredFun clearExpired,
+                      EmplaceExpiredFun emplaceExpired) {
+        clearExpired();
+
+        const int64_t now_bucket{WheelBucket(now)};
+        if (!m_wheel_started) {
+            m_wheel_started = true;
+            m_wheel_bucket = now_bucket;
+        }
+
+        // Process the buckets the time went past. If it jumped by more than
+        // the wheel size, all of them are in the past.
+        if (now_bucket > m_wheel_bucket) {
+            const int64_t end{
+                std::min(now_bucket, m_wheel_bucket + WHEEL_SIZE)};
+            for (int64_t bucket = m_wheel_bucket; bucket < end; ++bucket) {
+                std::vector<TimerEntry> entries;
+                entries.swap(m_wheel[bucket & (WHEEL_SIZE - 1)]);
+                for (const TimerEntry &entry : entries) {
+                    if (IsTimerValid(entry)) {
+                        FireTimer(entry, emplaceExpired);
+                    }
+                }
+            }
+            m_wheel_bucket = now_bucket;
+            auto &current = m_wheel[m_wheel_bucket & (WHEEL_SIZE - 1)];
+            std::make_heap(current.begin(), current.end(), LaterTimer);
+        }
+
+        // Bring the far timers that are now within range into the wheel
+        if (m_far_timers_min_bucket < m_wheel_bucket + WHEEL_SIZE) {
+            m_far_timers_min_bucket = std::numeric_limits<int64_t>::max();
+            ProcessTimers(m_far_timers, now, emplaceExpired);
+        }
+
+        // The current bucket, and the timers that were scheduled in the past
+        auto &current = m_wheel[m_wheel_bucket & (WHEEL_SIZE - 1)];
+        while (!current.empty() && current.front().time <= now) {
+            std::pop_heap(current.begin(), current.end(), LaterTimer);
+            const TimerEntry entry{current.back()};
+            current.pop_back();
+            if (IsTimerValid(entry)) {
+                FireTimer(entry, emplaceExpired);
+            }
+        }
+        if (!m_late_timers.empty()) {
+            ProcessTimers(m_late_timers, now, emplaceExpired);
+        }
+
+        // If time went backwards, we may need to demote CANDIDATE_BEST and
+        // CANDIDATE_READY announcements back to CANDIDATE_DELAYED. This is an
+        // unusual edge case, and unlikely to matter in production.
+        if (m_max_selectable_time > now) {
+            for (SlotIndex slot = 0; slot < m_anns.size(); ++slot) {
+                const FlatAnnouncement &ann = m_anns[slot];
+                if (ann.m_group != NO_SLOT && ann.IsSelectable() &&
+                    ann.m_time > now) {
+                    ChangeAndReselect(slot, State::CANDIDATE_DELAYED);
+                    Schedule(slot);
+                }
+            }
+            m_max_selectable_time = std::chrono::microseconds::min();
+            for (const FlatAnnouncement &ann : m_anns) {
+                if (ann.m_group != NO_SLOT && ann.IsSelectable()) {
+                    m_max_selectable_time =
+                        std::max(m_max_selectable_time, ann.m_time);
+                }
+            }
+        }
+    }
+
+public:
+    explicit FlatInvRequestTrackerImpl(bool deterministic)
+        : m_computer(deterministic),
+          m_k0{deterministic ? 0 : FastRandomContext().rand64()},
+          m_k1{deterministic ? 0 : FastRandomContext().rand64()} {}
+
+    FlatInvRequestTrackerImpl(const FlatInvRequestTrackerImpl &) = delete;
+    FlatInvRequestTrackerImpl &
+    operator=(const FlatInvRequestTrackerImpl &) = delete;
+
+    ~FlatInvRequestTrackerImpl() = default;
+
+    void SanityCheck() const override {
+        // Check the flat structures against each other.
+        size_t num_anns{0};
+        for (SlotIndex slot = 0; slot < m_anns.size(); ++slot) {
+            const FlatAnnouncement &ann = m_anns[slot];
+            if (ann.m_group == NO_SLOT) {
+                continue;
+            }
+            ++num_anns;
+            assert(FindAnnouncement(ann.m_peer, ann.m_invid) == slot);
+            assert(FindGroup(ann.m_invid) == ann.m_group);
+            assert(ann.m_priority ==
+                   m_computer(ann.m_invid, ann.m_peer, ann.m_preferred));
+            if (ann.IsSelectable()) {
+                assert(ann.m_time <= m_max_selectable_time);
+            }
+        }
+        assert(num_anns == m_by_peer_invid.Size());
+        assert(num_anns + m_free_anns.size() == m_anns.size());
+
+        size_t num_groups{0};
+        for (SlotIndex group_slot = 0; group_slot < m_groups.size();
+             ++group_slot) {
+            const FlatInvIdGroup &group = m_groups[group_slot];
+            if (group.m_head == NO_SLOT) {
+                continue;
+            }
+            ++num_groups;
+            uint32_t non_completed{0};
+            SlotIndex selected{NO_SLOT};
+            for (SlotIndex slot = group.m_head; slot != NO_SLOT;
+                 slot = m_anns[slot].m_next_in_group) {
+                const FlatAnnouncement &ann = m_anns[slot];
+                assert(ann.m_group == group_slot);
+                assert(ann.m_invid == m_anns[group.m_head].m_invid);
+                non_completed += ann.m_state != State::COMPLETED;
+                if (ann.m_state == State::CANDIDATE_BEST ||
+                    ann.m_state == State::REQUESTED) {
+                    selected = slot;
+                }
+            }
+            assert(non_completed == group.m_num_non_completed);
+            assert(selected == group.m_selected);
+        }
+        assert(num_groups == m_by_invid.Size());
+
+        // Every CANDIDATE_DELAYED and REQUESTED announcement has exactly one
+        // valid timer.
+        std::vector<size_t> num_timers(m_anns.size());
+        auto count_timers = [&](const std::vector<TimerEntry> &timers) {
+            for (const TimerEntry &entry : timers) {
+                if (IsTimerValid(entry)) {
+                    assert(entry.time == m_anns[entry.slot].m_time);
+                    ++num_timers[entry.slot];
+                }
+            }
+        };
+        for (const auto &bucket : m_wheel) {
+            count_timers(bucket);
+        }
+        count_timers(m_late_timers);
+        count_timers(m_far_timers);
+        for (SlotIndex slot = 0; slot < m_anns.size(); ++slot) {
+            const bool waiting{m_anns[slot].m_group != NO_SLOT &&
+                               m_anns[slot].IsWaiting()};
+            assert(num_timers[slot] == (waiting ? 1 : 0));
+        }
+        assert(num_groups + m_free_groups.size() == m_groups.size());
+
+        std::unordered_map<NodeId, PeerInfo> peerinfo;
+        for (const auto &[peer, info] : m_peerinfo) {
+            peerinfo.emplace(peer, info.m_info);
+            size_t num_peer_anns{0};
+            for (SlotIndex slot = info.m_head; slot != NO_SLOT;
+                 slot = m_anns[slot].m_next_of_peer) {
+                assert(m_anns[slot].m_peer == peer);
+                ++num_peer_anns;
+            }
+            assert(num_peer_anns == info.m_info.m_total);
+            for (SlotIndex slot = info.m_best_head; slot != NO_SLOT;
+                 slot = m_anns[slot].m_next_best) {
+                assert(m_anns[slot].m_peer == peer);
+                assert(m_anns[slot].m_state == State::CANDIDATE_BEST);
+            }
+        }
+
+        // And check the same invariants as InvRequestTrackerImpl.
+        SanityCheckAnnouncements(GetAnnouncements(), m_computer, peerinfo);
+    }
+
+    void PostGetRequestableSanityCheck(
+        std::chrono::microseconds now) const override {
+        PostGetRequestableSanityCheckAnnouncements(GetAnnouncements(), now);
+    }
+
+private:
+    //! Convert the announcements for the sanity checks.
+    std::vector<Announcement> GetAnnouncements() const {
+        std::vector<Announcement> anns;
+        for (const FlatAnnouncement &ann : m_anns) {
+            if (ann.m_group == NO_SLOT) {
+                continue;
+            }
+            anns.emplace_back(ann.m_invid, ann.m_peer, ann.m_preferred,
+                              ann.m_time, ann.m_sequence);
+            anns.back().SetState(ann.m_state);
+        }
+        return anns;
+    }
+
+public:
+    void DisconnectedPeer(NodeId peer) override {
+        auto it = m_peerinfo.find(peer);
+        if (it == m_peerinfo.end()) {
+            return;
+        }
+        SlotIndex slot{it->second.m_head};
+        while (slot != NO_SLOT) {
+            // Deleting the announcements of the same invid can only delete
+            // this peer's announcement, as (peer, invid) is unique, so the
+            // next one is still valid afterwards.
+            const SlotIndex next{m_anns[slot].m_next_of_peer};
+            // If the announcement isn't already COMPLETED, first make it
+            // COMPLETED (which will mark other CANDIDATEs as CANDIDATE_BEST, or
+            // delete all of a invid's announcements if no non-COMPLETED ones
+            // are left).
+            if (MakeCompleted(slot)) {
+                // Then actually delete the announcement (unless it was already
+                // deleted by MakeCompleted).
+                Erase(slot);
+            }
+            slot = next;
+        }
+    }
+
+    void ForgetInvId(const uint256 &invid) override {
+        const SlotIndex group_slot{FindGroup(invid)};
+        if (group_slot != NO_SLOT) {
+            EraseGroup(group_slot);
+        }
+    }
+
+    void ReceivedInv(NodeId peer, const uint256 &invid, bool preferred,
+                     std::chrono::microseconds reqtime) override {
+        const uint32_t hash{HashPeerInvId(peer, invid)};
+        if (m_by_peer_invid.Find(hash, [&](SlotIndex slot) {
+                return m_anns[slot].m_peer == peer &&
+                       m_anns[slot].m_invid == invid;
+            }) != NO_SLOT) {
+            return;
+        }
+
+        SlotIndex slot;
+        if (m_free_anns.empty()) {
+            assert(m_anns.size() < NO_SLOT);
+            slot = m_anns.size();
+            m_anns.emplace_back();
+        } else {
+            slot = m_free_anns.back();
+            m_free_anns.pop_back();
+        }
+
+        SlotIndex group_slot{FindGroup(invid)};
+        if (group_slot == NO_SLOT) {
+            if (m_free_groups.empty()) {
+                assert(m_groups.size() < NO_SLOT);
+                group_slot = m_groups.size();
+                m_groups.emplace_back();
+            } else {
+                group_slot = m_free_groups.back();
+                m_free_groups.pop_back();
+            }
+        }
+        FlatInvIdGroup &group = m_groups[group_slot];
+
+        FlatPeerInfo &peerinfo = m_peerinfo[peer];
+
+        FlatAnnouncement &ann = m_anns[slot];
+        ann.m_invid = invid;
+        ann.m_time = reqtime;
+        ann.m_peer = peer;
+        ann.m_priority = m_computer(invid, peer, preferred);
+        ann.m_sequence = m_current_sequence++;
+        ann.m_group = group_slot;
+        ann.m_preferred = preferred;
+        ann.m_state = State::CANDIDATE_DELAYED;
+
+        if (group.m_head == NO_SLOT) {
+            // The group key is read from its first announcement, which is set
+            // now.
+            ann.m_next_in_group = NO_SLOT;
+            group.m_head = slot;
+            m_by_invid.Insert(HashInvId(invid), group_slot);
+        } else {
+            ann.m_next_in_group = group.m_head;
+            group.m_head = slot;
+        }
+        ++group.m_num_non_completed;
+
+        ann.m_prev_of_peer = NO_SLOT;
+        ann.m_next_of_peer = peerinfo.m_head;
+        if (peerinfo.m_head != NO_SLOT) {
+            m_anns[peerinfo.m_head].m_prev_of_peer = slot;
+        }
+        peerinfo.m_head = slot;
+        ++peerinfo.m_info.m_total;
+
+        m_by_peer_invid.Insert(hash, slot);
+        Schedule(slot);
+    }
+
+    //! Find the InvIds to request now from peer.
+    std::vector<uint256>
+    GetRequestable(NodeId peer, std::chrono::microseconds now,
+                   ClearExpiredFun clearExpired,
+                   EmplaceExpiredFun emplaceExpired) override {
+        // Move time.
+        SetTimePoint(now, clearExpired, emplaceExpired);
+
+        // Find all CANDIDATE_BEST announcements for this peer.
+        std::vector<const FlatAnnouncement *> selected;
+        auto it = m_peerinfo.find(peer);
+        if (it != m_peerinfo.end()) {
+            for (SlotIndex slot = it->second.m_best_head; slot != NO_SLOT;
+                 slot = m_anns[slot].m_next_best) {
+                selected.push_back(&m_anns[slot]);
+            }
+        }
+
+        // Sort by sequence number.
+        std::sort(selected.begin(), selected.end(),
+                  [](const FlatAnnouncement *a, const FlatAnnouncement *b) {
+                      return a->m_sequence < b->m_sequence;
+                  });
+
+        // Convert to InvId and return.
+        std::vector<uint256> ret;
+        ret.reserve(selected.size());
+        std::transform(
+            selected.begin(), selected.end(), std::back_inserter(ret),
+            [](const FlatAnnouncement *ann) { return ann->m_invid; });
+        return ret;
+    }
+
+    void RequestedData(NodeId peer, const uint256 &invid,
+                       std::chrono::microseconds expiry) override {
+        const SlotIndex slot{FindAnnouncement(peer, invid)};
+        if (slot == NO_SLOT) {
+            return;
+        }
+        const State state{m_anns[slot].m_state};
+        if (state != State::CANDIDATE_BEST) {
+            // See InvRequestTrackerImpl::RequestedData: this branch is only
+            // taken when the caller requests something GetRequestable did not
+            // advise.
+            if (state != State::CANDIDATE_DELAYED &&
+                state != State::CANDIDATE_READY) {
+                return;
+            }
+
+            // There can be at most one CANDIDATE_BEST or one REQUESTED
+            // announcement per invid. An existing CANDIDATE_BEST becomes a
+            // CANDIDATE_READY, and we're no longer waiting for a response to
+            // an existing REQUESTED.
+            const SlotIndex selected{m_groups[m_anns[slot].m_group].m_selected};
+            if (selected != NO_SLOT) {
+                SetState(selected,
+                         m_anns[selected].m_state == State::CANDIDATE_BEST
+                             ? State::CANDIDATE_READY
+                             : State::COMPLETED);
+            }
+        }
+
+        m_anns[slot].m_time = expiry;
+        SetState(slot, State::REQUESTED);
+        Schedule(slot);
+    }
+
+    void ReceivedResponse(NodeId peer, const uint256 &invid) override {
+        const SlotIndex slot{FindAnnouncement(peer, invid)};
+        if (slot != NO_SLOT) {
+            MakeCompleted(slot);
+        }
+    }
+
+    size_t CountInFlight(NodeId peer) const override {
+        auto it = m_peerinfo.find(peer);
+        if (it != m_peerinfo.end()) {
+            return it->second.m_info.m_requested;
+        }
+        return 0;
+    }
+
+    size_t CountCandidates(NodeId peer) const override {
+        auto it = m_peerinfo.find(peer);
+        if (it != m_peerinfo.end()) {
+            return it->second.m_info.m_total - it->second.m_info.m_requested -
+                   it->second.m_info.m_completed;
+        }
+        return 0;
+    }
+
+    size_t Count(NodeId peer) const override {
+        auto it = m_peerinfo.find(peer);
+        if (it != m_peerinfo.end()) {
+            return it->second.m_info.m_total;
+        }
+        return 0;
+    }
+
+    size_t Size() const override { return m_by_peer_invid.Size(); }
+
+    uint64_t ComputePriority(const uint256 &invid, NodeId peer,
+                             bool preferred) const override {
+        return uint64_t{m_computer(invid, peer, preferred)};
+    }
+};
+
 std::unique_ptr<InvRequestTrackerImplInterface>
-InvRequestTrackerImplInterface::BuildImpl(bool deterministic) {
-    return std::make_unique<InvRequestTrackerImpl>(deterministic);
+InvRequestTrackerImplInterface::BuildImpl(bool deterministic,
+                                          InvRequestTrackerImplType type) {
+    switch (type) {
+        case InvRequestTrackerImplType::ORDERED:
+            return std::make_unique<InvRequestTrackerImpl>(deterministic);
+        case InvRequestTrackerImplType::FLAT:
+            return std::make_unique<FlatInvRequestTrackerImpl>(deterministic);
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
 }
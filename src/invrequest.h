@@ -114,9 +114,19 @@
  *   announcements.
  * - CPU usage is generally logarithmic in the total number of tracked
  *   announcements, plus the number of announcements affected by an operation
- *   (amortized O(1) per announcement).
+ *   (amortized O(1) per announcement). With the FLAT implementation, lookups
+ *   and time updates are expected O(1) instead, except when the time goes
+ *   backwards, which costs a scan of all the announcements.
  */
 
+/** The data structures an InvRequestTracker can be backed by. */
+enum class InvRequestTrackerImplType {
+    //! Ordered multi-index containers, kept as a reference implementation.
+    ORDERED,
+    //! Flat hash tables and a timer wheel.
+    FLAT,
+};
+
 // Avoid littering this header file with implementation details.
 class InvRequestTrackerImplInterface {
     template <class InvId> friend class InvRequestTracker;
@@ -125,7 +135,7 @@ class InvRequestTrackerImplInterface {
     // This is a hack that allows for hiding the concrete implementation details
     // from the callsite.
     static std::unique_ptr<InvRequestTrackerImplInterface>
-    BuildImpl(bool deterministic);
+    BuildImpl(bool deterministic, InvRequestTrackerImplType type);
 
 public:
     using ClearExpiredFun = const std::function<void()> &;
@@ -167,9 +177,13 @@ template <class InvId> class InvRequestTracker {
     const std::unique_ptr<InvRequestTrackerImplInterface> m_impl;
 
 public:
-    //! Construct a InvRequestTracker.
-    explicit InvRequestTracker(bool deterministic = false)
-        : m_impl{InvRequestTrackerImplInterface::BuildImpl(deterministic)} {}
+    //! Construct a InvRequestTracker. Both implementation types have the same
+    //! behavior.
+    explicit InvRequestTracker(
+        bool deterministic = false,
+        InvRequestTrackerImplType type = InvRequestTrackerImplType::FLAT)
+        : m_impl{InvRequestTrackerImplInterface::BuildImpl(deterministic,
+                                                           type)} {}
     ~InvRequestTracker() = default;
 
     // Conceptually, the data structure consists of a collection of
@@ -11,11 +11,18 @@
 #include <primitives/txid.h>
 #include <serialize.h>
 #include <util/check.h>
+#include <util/parallel.h>
 #include <validation.h>
 
 #include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace kernel {
+//! Number of ranges of the coins per thread computing the statistics
+static constexpr size_t RANGES_PER_THREAD{4};
+
 CCoinsStats::CCoinsStats(int block_height, const BlockHash &block_hash)
     : nHeight(block_height), hashBlock(block_hash) {}
 
@@ -90,22 +97,18 @@ static void ApplyStats(CCoinsStats &stats, const TxId &txid,
     }
 }
 
-//! Calculate statistics about the unspent transaction output set
+//! Add the statistics about the coins a cursor iterates over to stats
 template <typename T>
-static bool ComputeUTXOStats(CCoinsView *view, CCoinsStats &stats, T hash_obj,
-                             const std::function<void()> &interruption_point) {
-    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
-    assert(pcursor);
-
-    PrepareHash(hash_obj, stats);
-
+static bool ApplyCursor(CCoinsViewCursor &cursor, CCoinsStats &stats,
+                        T &hash_obj,
+                        const std::function<void()> &interruption_point) {
     TxId prevkey;
     std::map<uint32_t, Coin> outputs;
-    while (pcursor->Valid()) {
+    while (cursor.Valid()) {
         interruption_point();
         COutPoint key;
         Coin coin;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+        if (cursor.GetKey(key) && cursor.GetValue(coin)) {
             if (!outputs.empty() && key.GetTxId() != prevkey) {
                 ApplyStats(stats, prevkey, outputs);
                 ApplyHash(hash_obj, prevkey, outputs);
@@ -118,12 +121,81 @@ static bool ComputeUTXOStats(CCoinsView *view, CCoinsStats &stats, T hash_obj,
             LogError("%s: unable to read value\n", __func__);
             return false;
         }
-        pcursor->Next();
+        cursor.Next();
     }
     if (!outputs.empty()) {
         ApplyStats(stats, prevkey, outputs);
         ApplyHash(hash_obj, prevkey, outputs);
     }
+    return true;
+}
+
+static void CombineStats(CCoinsStats &stats, const CCoinsStats &range_stats) {
+    stats.nTransactions += range_stats.nTransactions;
+    stats.nTransactionOutputs += range_stats.nTransactionOutputs;
+    stats.nBogoSize += range_stats.nBogoSize;
+    stats.coins_count += range_stats.coins_count;
+    if (stats.total_amount.has_value() &&
+        range_stats.total_amount.has_value()) {
+        stats.total_amount =
+            (*stats.total_amount).CheckedAdd(*range_stats.total_amount);
+    } else {
+        stats.total_amount = std::nullopt;
+    }
+}
+
+static void CombineHash(MuHash3072 &muhash, const MuHash3072 &range_muhash) {
+    muhash *= range_muhash;
+}
+static void CombineHash(std::nullptr_t, std::nullptr_t) {}
+
+/**
+ * Add the statistics about the coins to stats, splitting them into ranges
+ * which are read on num_threads threads. The hashes of the ranges are
+ * combined, so the hash must not depend on the order of the coins.
+ */
+template <typename T>
+static bool ApplyCursors(CCoinsView *view, CCoinsStats &stats, T &hash_obj,
+                         const std::function<void()> &interruption_point,
+                         size_t num_threads) {
+    // Several ranges per thread even out the work between the threads
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors{view->Cursors(
+        num_threads > 1 ? num_threads * RANGES_PER_THREAD : 1)};
+    std::vector<CCoinsStats> range_stats(cursors.size());
+    std::vector<T> range_hashes(cursors.size());
+    if (!util::ParallelFor(cursors.size(), num_threads, [&](size_t i) {
+            return ApplyCursor(*Assert(cursors[i]), range_stats[i],
+                               range_hashes[i], interruption_point);
+        })) {
+        return false;
+    }
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        CombineStats(stats, range_stats[i]);
+        CombineHash(hash_obj, range_hashes[i]);
+    }
+    return true;
+}
+
+//! Calculate statistics about the unspent transaction output set
+template <typename T>
+static bool ComputeUTXOStats(CCoinsView *view, CCoinsStats &stats, T hash_obj,
+                             const std::function<void()> &interruption_point,
+                             size_t num_threads) {
+    PrepareHash(hash_obj, stats);
+
+    if constexpr (std::is_same_v<T, HashWriter>) {
+        // The serialized hash depends on the order of the coins
+        std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
+        assert(pcursor);
+        if (!ApplyCursor(*pcursor, stats, hash_obj, interruption_point)) {
+            return false;
+        }
+    } else {
+        if (!ApplyCursors(view, stats, hash_obj, interruption_point,
+                          num_threads)) {
+            return false;
+        }
+    }
 
     FinalizeHash(hash_obj, stats);
 
@@ -135,7 +207,8 @@ static bool ComputeUTXOStats(CCoinsView *view, CCoinsStats &stats, T hash_obj,
 std::optional<CCoinsStats>
 ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView *view,
                  node::BlockManager &blockman,
-                 const std::function<void()> &interruption_point) {
+                 const std::function<void()> &interruption_point,
+                 size_t num_threads) {
     CBlockIndex *pindex = WITH_LOCK(
         ::cs_main, return blockman.LookupBlockIndex(view->GetBestBlock()));
     CCoinsStats stats{Assert(pindex)->nHeight, pindex->GetBlockHash()};
@@ -144,16 +217,17 @@ ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView *view,
         switch (hash_type) {
             case (CoinStatsHashType::HASH_SERIALIZED): {
                 HashWriter ss{};
-                return ComputeUTXOStats(view, stats, ss, interruption_point);
+                return ComputeUTXOStats(view, stats, ss, interruption_point,
+                                        num_threads);
             }
             case (CoinStatsHashType::MUHASH): {
                 MuHash3072 muhash;
                 return ComputeUTXOStats(view, stats, muhash,
-                                        interruption_point);
+                                        interruption_point, num_threads);
             }
             case (CoinStatsHashType::NONE): {
                 return ComputeUTXOStats(view, stats, nullptr,
-                                        interruption_point);
+                                        interruption_point, num_threads);
             }
         } // no default case, so the compiler can warn about missing cases
         assert(false);
@@ -11,6 +11,7 @@
 #include <streams.h>
 #include <uint256.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <optional>
@@ -79,10 +80,18 @@ uint64_t GetBogoSize(const CScript &script_pub_key);
 
 DataStream TxOutSer(const COutPoint &outpoint, const Coin &coin);
 
+/**
+ * Calculate statistics about the unspent transaction output set.
+ *
+ * @param[in] num_threads  Number of threads reading the coins. The serialized
+ *                         hash depends on their order, it is always computed
+ *                         on a single thread.
+ */
 std::optional<CCoinsStats>
 ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView *view,
                  node::BlockManager &blockman,
-                 const std::function<void()> &interruption_point = {});
+                 const std::function<void()> &interruption_point = {},
+                 size_t num_threads = 1);
 } // namespace kernel
 
 #endif // BITCOIN_KERNEL_COINSTATS_H
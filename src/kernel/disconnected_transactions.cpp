@@ -13,6 +13,8 @@
 #include <validation.h>
 #include <validationinterface.h>
 
+#include <vector>
+
 /** Maximum bytes for transactions to store for processing during reorg */
 static const size_t MAX_DISCONNECTED_TX_POOL_SIZE = 20 * DEFAULT_MAX_BLOCK_SIZE;
 
@@ -184,11 +186,26 @@ void DisconnectedBlockTransactions::updateMempoolForReorg(
         // Iterate disconnectpool in reverse, so that we add transactions back
         // to the mempool starting with the earliest transaction that had been
         // previously seen in a block.
+        std::vector<CTransactionRef> vtx;
+        vtx.reserve(queuedTx.size());
         for (const CTransactionRef &tx :
              reverse_iterate(queuedTx.get<insertion_order>())) {
-            if (tx->IsCoinBase()) {
-                continue;
+            if (!tx->IsCoinBase()) {
+                vtx.push_back(tx);
             }
+        }
+
+        // The whole set is topologically ordered, so the scripts can be
+        // verified at once on the script check threads. The signature checks
+        // run by AcceptToMemoryPool below will then hit the signature cache.
+        const size_t num_checks =
+            PreverifyMempoolTransactions(active_chainstate, vtx);
+        LogPrint(BCLog::MEMPOOL,
+                 "Pre-verified %u scripts for %u transactions to re-add after "
+                 "reorg\n",
+                 num_checks, vtx.size());
+
+        for (const CTransactionRef &tx : vtx) {
             // restore saved PrioritiseTransaction state and nAcceptTime
             const auto ptxInfo = getTxInfo(tx);
             bool hasFeeDelta = false;
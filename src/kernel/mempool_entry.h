@@ -7,6 +7,7 @@
 
 #include <consensus/amount.h>
 #include <core_memusage.h>
+#include <flatset.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
 #include <primitives/transaction.h>
@@ -64,12 +65,14 @@ using CTxMemPoolEntryRef = RCUPtr<CTxMemPoolEntry>;
 
 class CTxMemPoolEntry {
 public:
-    // two aliases, should the types ever diverge
-    typedef std::set<std::reference_wrapper<const CTxMemPoolEntryRef>,
-                     CompareIteratorById>
+    // two aliases, should the types ever diverge.
+    // Most entries only have a handful of parents and children, so these are
+    // stored contiguously to avoid allocating a tree node per link.
+    typedef flatset<std::reference_wrapper<const CTxMemPoolEntryRef>,
+                    CompareIteratorById>
         Parents;
-    typedef std::set<std::reference_wrapper<const CTxMemPoolEntryRef>,
-                     CompareIteratorById>
+    typedef flatset<std::reference_wrapper<const CTxMemPoolEntryRef>,
+                    CompareIteratorById>
         Children;
 
 private:
@@ -100,6 +103,9 @@ private:
     IMPLEMENT_RCU_REFCOUNT(uint64_t);
 
 public:
+    //! Index in the mempool's txns_randomized
+    mutable size_t idx_randomized{0};
+
     CTxMemPoolEntry(const CTransactionRef &_tx, const Amount fee, int64_t time,
                     unsigned int entry_height, int64_t sigchecks, LockPoints lp)
         : tx{_tx}, nFee{fee}, nTxSize(tx->GetTotalSize()),
@@ -115,7 +121,8 @@ public:
           nTime(other.nTime), entryHeight(other.entryHeight),
           sigChecks(other.sigChecks), feeDelta(other.feeDelta),
           lockPoints(std::move(other.lockPoints)),
-          refcount(other.refcount.load()){};
+          refcount(other.refcount.load()),
+          idx_randomized(other.idx_randomized){};
 
     uint64_t GetEntryId() const { return entryId; }
     //! This should only be set by addUnchecked() before entry insertion into
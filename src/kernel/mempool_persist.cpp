@@ -7,6 +7,7 @@
 #include <consensus/amount.h>
 #include <logging.h>
 #include <primitives/transaction.h>
+#include <primitives/txid.h>
 #include <serialize.h>
 #include <streams.h>
 #include <sync.h>
@@ -14,10 +15,12 @@
 #include <uint256.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
+#include <util/hasher.h>
 #include <util/signalinterrupt.h>
 #include <util/time.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <cstdio>
@@ -27,6 +30,7 @@
 #include <memory>
 #include <set>
 #include <stdexcept>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -35,6 +39,52 @@ using fsbridge::FopenFn;
 namespace kernel {
 static const uint64_t MEMPOOL_DUMP_VERSION = 1;
 
+/**
+ * Number of transactions read from the mempool file before they are verified
+ * and submitted to the mempool as a batch.
+ */
+static constexpr size_t MEMPOOL_LOAD_BATCH_SIZE{1000};
+
+/**
+ * Sort a batch of loaded transactions so that parents always come before their
+ * children. The mempool file is written in entry order which should already
+ * satisfy this, but don't rely on it. The sort is stable so the file order is
+ * preserved for unrelated transactions.
+ */
+static void SortTopologically(std::vector<CTransactionRef> &txs) {
+    std::unordered_map<TxId, size_t, SaltedTxIdHasher> depth;
+    depth.reserve(txs.size());
+    for (const auto &tx : txs) {
+        depth.emplace(tx->GetId(), 0);
+    }
+
+    // Iterate until the depths are stable. In the common case the batch is
+    // already sorted and a single pass computes the final depths, a second
+    // pass confirms it. The depth is capped to the batch size to avoid looping
+    // forever on a (bogus) cyclic file.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto &tx : txs) {
+            size_t &tx_depth = depth[tx->GetId()];
+            for (const CTxIn &txin : tx->vin) {
+                auto it = depth.find(txin.prevout.GetTxId());
+                if (it != depth.end() && it->second >= tx_depth &&
+                    it->second < txs.size()) {
+                    tx_depth = it->second + 1;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    std::stable_sort(txs.begin(), txs.end(),
+                     [&depth](const CTransactionRef &a,
+                              const CTransactionRef &b) {
+                         return depth.at(a->GetId()) < depth.at(b->GetId());
+                     });
+}
+
 bool LoadMempool(CTxMemPool &pool, const fs::path &load_path,
                  Chainstate &active_chainstate,
                  FopenFn mockable_fopen_function) {
@@ -55,6 +105,46 @@ bool LoadMempool(CTxMemPool &pool, const fs::path &load_path,
     int64_t already_there = 0;
     int64_t unbroadcast = 0;
     auto now = NodeClock::now();
+    const auto load_start = SteadyClock::now();
+
+    std::vector<CTransactionRef> batch;
+    std::map<TxId, int64_t> batch_times;
+    batch.reserve(MEMPOOL_LOAD_BATCH_SIZE);
+
+    // Verify the scripts of the whole batch in parallel first, then submit the
+    // transactions in topological order. The signature checks done by
+    // AcceptToMemoryPool will then be served from the signature cache.
+    auto process_batch = [&]() {
+        SortTopologically(batch);
+
+        LOCK(cs_main);
+        PreverifyMempoolTransactions(active_chainstate, batch);
+
+        for (const auto &tx : batch) {
+            const auto &accepted =
+                AcceptToMemoryPool(active_chainstate, tx,
+                                   batch_times.at(tx->GetId()),
+                                   /*bypass_limits=*/false,
+                                   /*test_accept=*/false);
+            if (accepted.m_result_type ==
+                MempoolAcceptResult::ResultType::VALID) {
+                ++count;
+            } else {
+                // mempool may contain the transaction already, e.g. from
+                // wallet(s) having loaded it while we were processing
+                // mempool transactions; consider these as valid, instead of
+                // failed, but mark them as 'already there'
+                if (pool.exists(tx->GetId())) {
+                    ++already_there;
+                } else {
+                    ++failed;
+                }
+            }
+        }
+
+        batch.clear();
+        batch_times.clear();
+    };
 
     try {
         uint64_t version;
@@ -80,29 +170,21 @@ bool LoadMempool(CTxMemPool &pool, const fs::path &load_path,
             }
             if (nTime >
                 TicksSinceEpoch<std::chrono::seconds>(now - pool.m_expiry)) {
-                LOCK(cs_main);
-                const auto &accepted =
-                    AcceptToMemoryPool(active_chainstate, tx, nTime,
-                                       /*bypass_limits=*/false,
-                                       /*test_accept=*/false);
-                if (accepted.m_result_type ==
-                    MempoolAcceptResult::ResultType::VALID) {
-                    ++count;
+                // A duplicated transaction in the file is processed only once,
+                // the later copies will be reported as already there.
+                if (batch_times.emplace(tx->GetId(), nTime).second) {
+                    batch.push_back(std::move(tx));
                 } else {
-                    // mempool may contain the transaction already, e.g. from
-                    // wallet(s) having loaded it while we were processing
-                    // mempool transactions; consider these as valid, instead of
-                    // failed, but mark them as 'already there'
-                    if (pool.exists(tx->GetId())) {
-                        ++already_there;
-                    } else {
-                        ++failed;
-                    }
+                    ++already_there;
                 }
             } else {
                 ++expired;
             }
 
+            if (batch.size() >= MEMPOOL_LOAD_BATCH_SIZE || num == 0) {
+                process_batch();
+            }
+
             if (active_chainstate.m_chainman.m_interrupt) {
                 return false;
             }
@@ -131,10 +213,13 @@ bool LoadMempool(CTxMemPool &pool, const fs::path &load_path,
         return false;
     }
 
+    const auto load_duration = SteadyClock::now() - load_start;
+    const double load_seconds = Ticks<SecondsDouble>(load_duration);
     LogPrintf("Imported mempool transactions from disk: %i succeeded, %i "
               "failed, %i expired, %i already there, %i waiting for initial "
-              "broadcast\n",
-              count, failed, expired, already_there, unbroadcast);
+              "broadcast in %.2fs (%.1f tx/s)\n",
+              count, failed, expired, already_there, unbroadcast, load_seconds,
+              load_seconds > 0 ? (count + failed) / load_seconds : 0.);
     return true;
 }
 
@@ -5,6 +5,7 @@
 #ifndef BITCOIN_MEMUSAGE_H
 #define BITCOIN_MEMUSAGE_H
 
+#include <flatset.h>
 #include <indirectmap.h>
 #include <prevector.h>
 #include <support/allocators/pool.h>
@@ -115,6 +116,11 @@ static inline size_t DynamicUsage(const prevector<N, X, S, D> &v) {
     return MallocUsage(v.allocated_memory());
 }
 
+template <typename X, typename Y>
+static inline size_t DynamicUsage(const flatset<X, Y> &s) {
+    return MallocUsage(s.capacity() * sizeof(X));
+}
+
 template <typename X, typename Y>
 static inline size_t DynamicUsage(const std::set<X, Y> &s) {
     return MallocUsage(sizeof(stl_tree_node<X>)) * s.size();
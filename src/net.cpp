@@ -96,6 +96,13 @@ static constexpr std::chrono::seconds MAX_UPLOAD_TIMEFRAME{60 * 60 * 24};
 // prevent synchronization.
 static constexpr auto FEELER_SLEEP_WINDOW{1s};
 
+/**
+ * Payloads up to this size are copied right after the message header in the
+ * send queue, so small messages are a single buffer. Larger payloads are
+ * queued as they are.
+ */
+static constexpr size_t MAX_COALESCED_PAYLOAD_SIZE{1024};
+
 /** Used to pass flags to the Bind() function */
 enum BindFlags {
     BF_NONE = 0,
@@ -677,11 +684,13 @@ void CNode::copyStats(CNodeStats &stats) {
         stats.mapRecvBytesPerMsgType = mapRecvBytesPerMsgType;
         stats.nRecvBytes = nRecvBytes;
     }
+    stats.mapProcessingPerMsgType = m_msg_processing.GetStats();
     stats.nInflightBytes = nInflightBytes;
     stats.m_permission_flags = m_permission_flags;
 
     stats.m_last_ping_time = m_last_ping_time;
     stats.m_min_ping_time = m_min_ping_time;
+    stats.m_msg_queue_delay = m_msg_queue_delay;
 
     // Leave string empty if addrLocal invalid (not filled in yet)
     CService addrLocalUnlocked = GetAddrLocal();
@@ -891,14 +900,16 @@ V1TransportDeserializer::GetMessage(const std::chrono::microseconds time,
 }
 
 void V1TransportSerializer::prepareForTransport(
-    const Config &config, CSerializedNetMsg &msg,
+    const Config &config, const CSerializedNetMsg &msg,
     std::vector<uint8_t> &header) const {
-    // create dbl-sha256 checksum
-    uint256 hash = Hash(msg.data);
+    // create dbl-sha256 checksum, computed once for shared payloads
+    const Span<const uint8_t> payload{msg.GetPayload()};
+    const uint256 hash =
+        msg.shared_payload ? msg.shared_payload->hash : Hash(payload);
 
     // create header
     CMessageHeader hdr(config.GetChainParams().NetMagic(), msg.m_type.c_str(),
-                       msg.data.size());
+                       payload.size());
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
     // serialize header
@@ -908,11 +919,24 @@ void V1TransportSerializer::prepareForTransport(
 
 std::pair<size_t, bool> CConnman::SocketSendData(CNode &node) const {
     size_t nSentSize = 0;
-    size_t nMsgCount = 0;
 
-    for (auto it = node.vSendMsg.begin(); it != node.vSendMsg.end(); ++it) {
-        const auto &data = *it;
-        assert(data.size() > node.nSendOffset);
+    while (!node.vSendMsg.empty()) {
+        // Gather as many queued buffers as possible into a single send
+        std::array<Span<const uint8_t>, Sock::MAX_SEND_BUFFERS> buffers;
+        size_t num_buffers{0};
+        size_t num_bytes{0};
+        for (const auto &data : node.vSendMsg) {
+            if (num_buffers == buffers.size()) {
+                break;
+            }
+            Span<const uint8_t> buffer{*data};
+            if (num_buffers == 0) {
+                assert(buffer.size() > node.nSendOffset);
+                buffer = buffer.subspan(node.nSendOffset);
+            }
+            buffers[num_buffers++] = buffer;
+            num_bytes += buffer.size();
+        }
         int nBytes = 0;
 
         {
@@ -922,13 +946,12 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode &node) const {
             }
             int flags = MSG_NOSIGNAL | MSG_DONTWAIT;
 #ifdef MSG_MORE
-            if (it + 1 != node.vSendMsg.end()) {
+            if (num_buffers < node.vSendMsg.size()) {
                 flags |= MSG_MORE;
             }
 #endif
-            nBytes = node.m_sock->Send(
-                reinterpret_cast<const char *>(data.data()) + node.nSendOffset,
-                data.size() - node.nSendOffset, flags);
+            nBytes = node.m_sock->SendMany(Span{buffers.data(), num_buffers},
+                                           flags);
         }
 
         if (nBytes == 0) {
@@ -952,26 +975,30 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode &node) const {
         assert(nBytes > 0);
         node.m_last_send = GetTime<std::chrono::seconds>();
         node.nSendBytes += nBytes;
-        node.nSendOffset += nBytes;
         nSentSize += nBytes;
-        if (node.nSendOffset != data.size()) {
-            // could not send full message; stop sending more
-            break;
-        }
 
-        node.nSendOffset = 0;
-        node.nSendSize -= data.size();
+        // Drop the buffers that have been fully sent
+        size_t offset{node.nSendOffset + nBytes};
+        while (!node.vSendMsg.empty() &&
+               offset >= node.vSendMsg.front()->size()) {
+            offset -= node.vSendMsg.front()->size();
+            node.nSendSize -= node.vSendMsg.front()->size();
+            node.vSendMsg.pop_front();
+        }
+        node.nSendOffset = offset;
         node.fPauseSend = node.nSendSize > nSendBufferMaxSize;
-        nMsgCount++;
-    }
 
-    node.vSendMsg.erase(node.vSendMsg.begin(),
-                        node.vSendMsg.begin() + nMsgCount);
+        if (size_t(nBytes) != num_bytes) {
+            // could not send everything; stop sending more
+            break;
+        }
+    }
 
     if (node.vSendMsg.empty()) {
         assert(node.nSendOffset == 0);
         assert(node.nSendSize == 0);
     }
+    node.m_send_pending = !node.vSendMsg.empty();
 
     return {nSentSize, !node.vSendMsg.empty()};
 }
@@ -1011,7 +1038,9 @@ bool CConnman::AttemptToEvictConnection() {
                 .availabilityScore =
                     node->m_avalanche_enabled
                         ? node->getAvailabilityScore()
-                        : -std::numeric_limits<double>::infinity()};
+                        : -std::numeric_limits<double>::infinity(),
+                .m_recent_msg_processing_time =
+                    node->m_msg_processing.GetRecentTime()};
             vEvictionCandidates.push_back(candidate);
         }
     }
@@ -1162,6 +1191,10 @@ void CConnman::CreateNodeFromAcceptedSocket(std::unique_ptr<Sock> &&sock,
     LogPrint(BCLog::NET, "connection from %s accepted\n",
              addr.ToStringAddrPort());
 
+#ifdef USE_EPOLL
+    EpollAddNode(*pnode);
+#endif
+
     {
         LOCK(m_nodes_mutex);
         m_nodes.push_back(pnode);
@@ -1452,88 +1485,234 @@ void CConnman::SocketHandlerConnected(
             }
         }
 
-        if (sendSet) {
-            // Send data
-            auto [bytes_sent, data_left] =
-                WITH_LOCK(pnode->cs_vSend, return SocketSendData(*pnode));
-            if (bytes_sent) {
-                RecordBytesSent(bytes_sent);
-
-                // If both receiving and (non-optimistic) sending were possible,
-                // we first attempt sending. If that succeeds, but does not
-                // fully drain the send queue, do not attempt to receive. This
-                // avoids needlessly queueing data if the remote peer is slow at
-                // receiving data, by means of TCP flow control. We only do this
-                // when sending actually succeeded to make sure progress is
-                // always made; otherwise a deadlock would be possible when both
-                // sides have data to send, but neither is receiving.
-                if (data_left) {
-                    recvSet = false;
-                }
+        SocketHandlerNode(*pnode, recvSet, sendSet, errorSet);
+
+        if (InactivityCheck(*pnode)) {
+            pnode->fDisconnect = true;
+        }
+    }
+
+    UpdateInflightThrottle(nTotalInflightBytes);
+}
+
+CConnman::SocketIOResult CConnman::SocketHandlerNode(CNode &node, bool recv,
+                                                     bool send, bool error) {
+    SocketIOResult result;
+    CNode *pnode = &node;
+
+    if (send) {
+        // Send data
+        auto [bytes_sent, data_left] =
+            WITH_LOCK(pnode->cs_vSend, return SocketSendData(*pnode));
+        result.send_blocked = data_left;
+        if (bytes_sent) {
+            RecordBytesSent(bytes_sent);
+
+            // If both receiving and (non-optimistic) sending were possible,
+            // we first attempt sending. If that succeeds, but does not
+            // fully drain the send queue, do not attempt to receive. This
+            // avoids needlessly queueing data if the remote peer is slow at
+            // receiving data, by means of TCP flow control. We only do this
+            // when sending actually succeeded to make sure progress is
+            // always made; otherwise a deadlock would be possible when both
+            // sides have data to send, but neither is receiving.
+            if (data_left) {
+                recv = false;
             }
         }
+    }
 
-        if (recvSet || errorSet) {
-            // typical socket buffer is 8K-64K
-            uint8_t pchBuf[0x10000];
-            int32_t nBytes = 0;
-            {
-                LOCK(pnode->m_sock_mutex);
-                if (!pnode->m_sock) {
-                    continue;
-                }
-                nBytes =
-                    pnode->m_sock->Recv(pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-            }
-            if (nBytes > 0) {
-                bool notify = false;
-                if (!pnode->ReceiveMsgBytes(*config, {pchBuf, (size_t)nBytes},
-                                            notify)) {
-                    pnode->CloseSocketDisconnect();
-                }
-                RecordBytesRecv(nBytes);
-                if (notify) {
-                    pnode->MarkReceivedMsgsForProcessing();
-                    WakeMessageHandler();
-                }
-            } else if (nBytes == 0) {
-                // socket closed gracefully
+    if (recv || error) {
+        // typical socket buffer is 8K-64K
+        uint8_t pchBuf[0x10000];
+        int32_t nBytes = 0;
+        {
+            LOCK(pnode->m_sock_mutex);
+            if (!pnode->m_sock) {
+                result.recv_drained = true;
+                return result;
+            }
+            nBytes = pnode->m_sock->Recv(pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+        }
+        // A short read means the socket has nothing more to give for now.
+        result.recv_drained = nBytes < int32_t(sizeof(pchBuf));
+        if (nBytes > 0) {
+            bool notify = false;
+            if (!pnode->ReceiveMsgBytes(*config, {pchBuf, (size_t)nBytes},
+                                        notify)) {
+                pnode->CloseSocketDisconnect();
+            }
+            RecordBytesRecv(nBytes);
+            if (notify) {
+                pnode->MarkReceivedMsgsForProcessing();
+                WakeMessageHandler();
+            }
+        } else if (nBytes == 0) {
+            // socket closed gracefully
+            if (!pnode->fDisconnect) {
+                LogPrint(BCLog::NET, "socket closed for peer=%d\n",
+                         pnode->GetId());
+            }
+            pnode->CloseSocketDisconnect();
+        } else if (nBytes < 0) {
+            // error
+            int nErr = WSAGetLastError();
+            if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE &&
+                nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
                 if (!pnode->fDisconnect) {
-                    LogPrint(BCLog::NET, "socket closed for peer=%d\n",
-                             pnode->GetId());
+                    LogPrint(BCLog::NET, "socket recv error for peer=%d: %s\n",
+                             pnode->GetId(), NetworkErrorString(nErr));
                 }
                 pnode->CloseSocketDisconnect();
-            } else if (nBytes < 0) {
-                // error
-                int nErr = WSAGetLastError();
-                if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE &&
-                    nErr != WSAEINTR && nErr != WSAEINPROGRESS) {
-                    if (!pnode->fDisconnect) {
-                        LogPrint(BCLog::NET,
-                                 "socket recv error for peer=%d: %s\n",
-                                 pnode->GetId(), NetworkErrorString(nErr));
-                    }
-                    pnode->CloseSocketDisconnect();
-                }
+            } else if (nErr == WSAEINTR) {
+                // Interrupted before anything was read, try again later
+                result.recv_drained = false;
             }
         }
-
-        if (InactivityCheck(*pnode)) {
-            pnode->fDisconnect = true;
-        }
     }
 
+    return result;
+}
+
+void CConnman::UpdateInflightThrottle(uint64_t total_inflight_bytes) {
     const size_t max_inflight_bytes = DEFAULT_MAXINFLIGHTBUFFER * 1000;
 
     bool prev_inflight_throttle = inflight_throttle;
-    inflight_throttle = nTotalInflightBytes > max_inflight_bytes;
+    inflight_throttle = total_inflight_bytes > max_inflight_bytes;
     if (prev_inflight_throttle != inflight_throttle) {
         LogPrintf("Inflight throttling %s (%d/%d)\n",
                   inflight_throttle ? "enabled" : "disabled",
-                  nTotalInflightBytes, max_inflight_bytes);
+                  total_inflight_bytes, max_inflight_bytes);
     }
 }
 
+#ifdef USE_EPOLL
+/**
+ * Keys of the listening sockets in m_epoll. The connected sockets use their
+ * NodeId, which is never negative.
+ */
+static constexpr uint64_t EPOLL_LISTEN_KEY_BASE{uint64_t{1} << 63};
+
+void CConnman::EpollAddNode(CNode &node) {
+    if (!m_epoll) {
+        return;
+    }
+    // The edge may be reported before the node is in m_nodes, or before the
+    // socket handler takes its snapshot of them. Assume the socket is ready
+    // until a recv or send would block, so the events can't be missed.
+    node.m_sock_recv_ready = true;
+    node.m_sock_send_ready = true;
+    LOCK(node.m_sock_mutex);
+    if (node.m_sock &&
+        !m_epoll->Add(*node.m_sock, node.GetId(), /*edge_triggered=*/true)) {
+        // Without a registration we would never hear from this peer again
+        LogPrint(BCLog::NET, "failed to register socket for peer=%d: %s\n",
+                 node.GetId(), NetworkErrorString(WSAGetLastError()));
+        node.fDisconnect = true;
+    }
+}
+
+void CConnman::SocketHandlerEpoll() {
+    std::vector<bool> listen_ready(vhListenSocket.size(), false);
+
+    {
+        // Don't block if some sockets were left ready by the previous round,
+        // as we won't be notified again until they would block.
+        const auto timeout =
+            m_epoll_io_pending
+                ? 0ms
+                : std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS);
+
+        m_epoll_events.clear();
+        if (!m_epoll->Wait(timeout, m_epoll_events)) {
+            interruptNet.sleep_for(timeout);
+        }
+
+        // Taken after the wait, so it includes the nodes connected meanwhile
+        const NodesSnapshot snap{*this, /*shuffle=*/false};
+
+        std::unordered_map<NodeId, Sock::Event> node_events;
+        for (const auto &[key, occurred] : m_epoll_events) {
+            if (key >= EPOLL_LISTEN_KEY_BASE) {
+                const size_t index = key - EPOLL_LISTEN_KEY_BASE;
+                if (index < listen_ready.size()) {
+                    listen_ready[index] = occurred & Sock::RECV;
+                }
+                continue;
+            }
+            node_events[NodeId(key)] |= occurred;
+        }
+
+        m_epoll_io_pending = false;
+        uint64_t nTotalInflightBytes{0};
+        int inbound_candidates{0};
+        for (CNode *pnode : snap.Nodes()) {
+            if (interruptNet) {
+                return;
+            }
+
+            // Always account for the node inflight bytes, even if the socket
+            // is paused.
+            nTotalInflightBytes += pnode->nInflightBytes;
+            inbound_candidates += pnode->IsInboundConn();
+
+            bool error = false;
+            if (const auto it = node_events.find(pnode->GetId());
+                it != node_events.end()) {
+                // On error the next recv tells what happened
+                if (it->second & (Sock::RECV | Sock::ERR)) {
+                    pnode->m_sock_recv_ready = true;
+                }
+                if (it->second & Sock::SEND) {
+                    pnode->m_sock_send_ready = true;
+                }
+                error = it->second & Sock::ERR;
+            }
+
+            // Same policy as GenerateWaitSockets(), but it is applied to the
+            // remembered readiness instead of the set of sockets to wait for.
+            const bool can_recv =
+                !pnode->fPauseRecv &&
+                (!inflight_throttle || !pnode->IsInboundConn() ||
+                 inbound_candidates <= 3);
+            const bool recv = can_recv && pnode->m_sock_recv_ready;
+            const bool send = pnode->m_sock_send_ready && pnode->m_send_pending;
+
+            if (recv || send || error) {
+                const SocketIOResult result =
+                    SocketHandlerNode(*pnode, recv, send, error);
+                if (send && result.send_blocked) {
+                    pnode->m_sock_send_ready = false;
+                }
+                if ((recv || error) && result.recv_drained) {
+                    pnode->m_sock_recv_ready = false;
+                }
+                if ((can_recv && pnode->m_sock_recv_ready) ||
+                    (send && !result.send_blocked && pnode->m_send_pending)) {
+                    m_epoll_io_pending = true;
+                }
+            }
+
+            if (InactivityCheck(*pnode)) {
+                pnode->fDisconnect = true;
+            }
+        }
+
+        UpdateInflightThrottle(nTotalInflightBytes);
+    }
+
+    // Accept new connections from listening sockets.
+    for (size_t i = 0; i < vhListenSocket.size(); ++i) {
+        if (interruptNet) {
+            return;
+        }
+        if (listen_ready[i]) {
+            AcceptConnection(vhListenSocket[i]);
+        }
+    }
+}
+#endif
+
 void CConnman::SocketHandlerListening(
     const Sock::EventsPerSock &events_per_sock) {
     for (const ListenSocket &listen_socket : vhListenSocket) {
@@ -1551,6 +1730,12 @@ void CConnman::ThreadSocketHandler() {
     while (!interruptNet) {
         DisconnectNodes();
         NotifyNumConnectionsChanged();
+#ifdef USE_EPOLL
+        if (m_epoll) {
+            SocketHandlerEpoll();
+            continue;
+        }
+#endif
         SocketHandler();
     }
 }
@@ -1558,9 +1743,9 @@ void CConnman::ThreadSocketHandler() {
 void CConnman::WakeMessageHandler() {
     {
         LOCK(mutexMsgProc);
-        fMsgProcWake = true;
+        ++m_msgproc_wake_count;
     }
-    condMsgProc.notify_one();
+    condMsgProc.notify_all();
 }
 
 void CConnman::ThreadDNSAddressSeed() {
@@ -2261,6 +2446,10 @@ void CConnman::OpenNetworkConnection(const CAddress &addrConnect,
         interface->InitializeNode(*config, *pnode, nLocalServices);
     }
 
+#ifdef USE_EPOLL
+    EpollAddNode(*pnode);
+#endif
+
     {
         LOCK(m_nodes_mutex);
         m_nodes.push_back(pnode);
@@ -2269,8 +2458,8 @@ void CConnman::OpenNetworkConnection(const CAddress &addrConnect,
 
 Mutex NetEventsInterface::g_msgproc_mutex;
 
-void CConnman::ThreadMessageHandler() {
-    LOCK(NetEventsInterface::g_msgproc_mutex);
+void CConnman::ThreadMessageHandler(int thread_index) {
+    uint64_t last_wake_count{0};
 
     while (!flagInterruptMsgProc) {
         bool fMoreWork = false;
@@ -2282,24 +2471,41 @@ void CConnman::ThreadMessageHandler() {
             const NodesSnapshot snap{*this, /*shuffle=*/true};
 
             for (CNode *pnode : snap.Nodes()) {
-                if (pnode->fDisconnect) {
+                if (pnode->fDisconnect ||
+                    pnode->GetId() % m_msg_handler_threads != thread_index) {
                     continue;
                 }
 
                 bool fMoreNodeWork = false;
-                // Receive messages
+                // Serve the requested data. This is the expensive part of
+                // answering e.g. getdata, and it doesn't need
+                // g_msgproc_mutex so it runs concurrently with the other
+                // threads.
                 for (auto interface : m_msgproc) {
-                    fMoreNodeWork |= interface->ProcessMessages(
+                    fMoreNodeWork |= interface->ServeRequests(
                         *config, pnode, flagInterruptMsgProc);
                 }
-                fMoreWork |= (fMoreNodeWork && !pnode->fPauseSend);
                 if (flagInterruptMsgProc) {
                     return;
                 }
 
-                // Send messages
-                for (auto interface : m_msgproc) {
-                    interface->SendMessages(*config, pnode);
+                {
+                    LOCK(NetEventsInterface::g_msgproc_mutex);
+
+                    // Receive messages
+                    for (auto interface : m_msgproc) {
+                        fMoreNodeWork |= interface->ProcessMessages(
+                            *config, pnode, flagInterruptMsgProc);
+                    }
+                    fMoreWork |= (fMoreNodeWork && !pnode->fPauseSend);
+                    if (flagInterruptMsgProc) {
+                        return;
+                    }
+
+                    // Send messages
+                    for (auto interface : m_msgproc) {
+                        interface->SendMessages(*config, pnode);
+                    }
                 }
 
                 if (flagInterruptMsgProc) {
@@ -2310,13 +2516,15 @@ void CConnman::ThreadMessageHandler() {
 
         WAIT_LOCK(mutexMsgProc, lock);
         if (!fMoreWork) {
-            condMsgProc.wait_until(lock,
-                                   std::chrono::steady_clock::now() +
-                                       std::chrono::milliseconds(100),
-                                   [this]() EXCLUSIVE_LOCKS_REQUIRED(
-                                       mutexMsgProc) { return fMsgProcWake; });
+            condMsgProc.wait_until(
+                lock,
+                std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(100),
+                [&]() EXCLUSIVE_LOCKS_REQUIRED(mutexMsgProc) {
+                    return m_msgproc_wake_count != last_wake_count;
+                });
         }
-        fMsgProcWake = false;
+        last_wake_count = m_msgproc_wake_count;
     }
 }
 
@@ -2619,10 +2827,30 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
     interruptNet.reset();
     flagInterruptMsgProc = false;
 
-    {
-        LOCK(mutexMsgProc);
-        fMsgProcWake = false;
+#ifdef USE_EPOLL
+    if (m_use_epoll) {
+        m_epoll = std::make_unique<SockEpoll>();
+        for (size_t i = 0; m_epoll->IsValid() && i < vhListenSocket.size();
+             ++i) {
+            // Level-triggered, so all the pending connections get accepted
+            // eventually even though we accept one per iteration.
+            if (!m_epoll->Add(*vhListenSocket[i].sock,
+                              EPOLL_LISTEN_KEY_BASE + i,
+                              /*edge_triggered=*/false)) {
+                m_epoll.reset();
+                break;
+            }
+        }
+        if (m_epoll && m_epoll->IsValid()) {
+            LogPrint(BCLog::NET, "Using epoll for socket events\n");
+        } else {
+            LogPrintf("Failed to set up epoll, falling back to polling the "
+                      "sockets: %s\n",
+                      NetworkErrorString(WSAGetLastError()));
+            m_epoll.reset();
+        }
     }
+#endif
 
     // Send and receive from sockets, accept connections
     threadSocketHandler = std::thread(&util::TraceThread, "net",
@@ -2659,8 +2887,12 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
     }
 
     // Process messages
-    threadMessageHandler = std::thread(&util::TraceThread, "msghand",
-                                       [this] { ThreadMessageHandler(); });
+    for (int i = 0; i < m_msg_handler_threads; ++i) {
+        m_message_handler_threads.emplace_back(
+            &util::TraceThread,
+            m_msg_handler_threads == 1 ? "msghand" : strprintf("msghand.%d", i),
+            [this, i] { ThreadMessageHandler(i); });
+    }
 
     if (m_i2p_sam_session) {
         threadI2PAcceptIncoming =
@@ -2719,9 +2951,10 @@ void CConnman::StopThreads() {
     if (threadI2PAcceptIncoming.joinable()) {
         threadI2PAcceptIncoming.join();
     }
-    if (threadMessageHandler.joinable()) {
-        threadMessageHandler.join();
+    for (std::thread &thread : m_message_handler_threads) {
+        thread.join();
     }
+    m_message_handler_threads.clear();
     if (threadOpenConnections.joinable()) {
         threadOpenConnections.join();
     }
@@ -2767,6 +3000,9 @@ void CConnman::StopNodes() {
     }
     m_nodes_disconnected.clear();
     vhListenSocket.clear();
+#ifdef USE_EPOLL
+    m_epoll.reset();
+#endif
     semOutbound.reset();
     semAddnode.reset();
 }
@@ -3122,11 +3358,13 @@ void CNode::MarkReceivedMsgsForProcessing() {
     AssertLockNotHeld(m_msg_process_queue_mutex);
 
     size_t nSizeAdded = 0;
-    for (const auto &msg : vRecvMsg) {
+    const auto now{SteadyClock::now()};
+    for (auto &msg : vRecvMsg) {
         // vRecvMsg contains only completed CNetMessage
         // the single possible partially deserialized message are held by
         // TransportDeserializer
         nSizeAdded += msg.m_raw_message_size;
+        msg.m_queued_time = now;
     }
 
     LOCK(m_msg_process_queue_mutex);
@@ -3135,6 +3373,86 @@ void CNode::MarkReceivedMsgsForProcessing() {
     pauseRecv(m_msg_process_queue_size > m_recv_flood_size);
 }
 
+MsgProcessingTracker::MsgProcessingTracker(SteadyClock::time_point now)
+    : m_window_start(now) {
+    for (const std::string &msg_type : getAllNetMessageTypes()) {
+        m_entries[msg_type];
+    }
+    m_entries[NET_MESSAGE_TYPE_OTHER];
+}
+
+void MsgProcessingTracker::Record(const std::string &msg_type,
+                                  const MsgProcessingStats &stats,
+                                  SteadyClock::time_point now) {
+    LOCK(m_mutex);
+
+    if (now - m_window_start >= MSG_PROCESSING_WINDOW) {
+        // The current window becomes the previous one, unless a whole window
+        // elapsed without any message.
+        const bool contiguous{now - m_window_start <
+                              2 * MSG_PROCESSING_WINDOW};
+        for (auto &[type, entry] : m_entries) {
+            entry.previous = contiguous ? entry.current : MsgProcessingStats{};
+            entry.current = {};
+        }
+        m_window_start =
+            contiguous ? m_window_start + MSG_PROCESSING_WINDOW : now;
+    }
+
+    auto it = m_entries.find(msg_type);
+    if (it == m_entries.end()) {
+        it = m_entries.find(NET_MESSAGE_TYPE_OTHER);
+    }
+    assert(it != m_entries.end());
+    it->second.total += stats;
+    it->second.current += stats;
+}
+
+MsgProcessingStats
+MsgProcessingTracker::GetRecent(const Entry &entry,
+                                SteadyClock::time_point now) const {
+    AssertLockHeld(m_mutex);
+
+    // The windows are only rolled when a message is recorded
+    const auto elapsed{now - m_window_start};
+    if (elapsed < MSG_PROCESSING_WINDOW) {
+        MsgProcessingStats recent{entry.previous};
+        recent += entry.current;
+        return recent;
+    }
+    if (elapsed < 2 * MSG_PROCESSING_WINDOW) {
+        return entry.current;
+    }
+    return {};
+}
+
+mapMsgTypeProcessing
+MsgProcessingTracker::GetStats(SteadyClock::time_point now) const {
+    LOCK(m_mutex);
+
+    mapMsgTypeProcessing stats;
+    for (const auto &[msg_type, entry] : m_entries) {
+        if (entry.total.count > 0 || entry.total.time > 0us) {
+            stats.emplace(msg_type, MsgTypeProcessingStats{
+                                        entry.total, GetRecent(entry, now)});
+        }
+    }
+    return stats;
+}
+
+std::chrono::microseconds
+MsgProcessingTracker::GetRecentTime(SteadyClock::time_point now) const {
+    LOCK(m_mutex);
+
+    std::chrono::microseconds time{0us};
+    for (const auto &[msg_type, entry] : m_entries) {
+        if (msg_type != NetMsgType::GETDATA) {
+            time += GetRecent(entry, now).time;
+        }
+    }
+    return time;
+}
+
 std::optional<std::pair<CNetMessage, bool>> CNode::PollMessage() {
     LOCK(m_msg_process_queue_mutex);
     if (m_msg_process_queue.empty()) {
@@ -3147,6 +3465,13 @@ std::optional<std::pair<CNetMessage, bool>> CNode::PollMessage() {
     m_msg_process_queue_size -= msgs.front().m_raw_message_size;
     pauseRecv(m_msg_process_queue_size > m_recv_flood_size);
 
+    // Exponential moving average of the queueing delay, with a weight of 1/8
+    // for the new sample
+    const auto delay{std::chrono::duration_cast<std::chrono::microseconds>(
+        SteadyClock::now() - msgs.front().m_queued_time)};
+    const auto average{m_msg_queue_delay.load()};
+    m_msg_queue_delay = average + (delay - average) / 8;
+
     return std::make_pair(std::move(msgs.front()),
                           !m_msg_process_queue.empty());
 }
@@ -3156,17 +3481,18 @@ bool CConnman::NodeFullyConnected(const CNode *pnode) {
 }
 
 void CConnman::PushMessage(CNode *pnode, CSerializedNetMsg &&msg) {
-    size_t nMessageSize = msg.data.size();
+    const Span<const uint8_t> payload{msg.GetPayload()};
+    size_t nMessageSize = payload.size();
     LogPrint(BCLog::NETDEBUG, "sending %s (%d bytes) peer=%d\n", msg.m_type,
              nMessageSize, pnode->GetId());
     if (gArgs.GetBoolArg("-capturemessages", false)) {
-        CaptureMessage(pnode->addr, msg.m_type, msg.data,
+        CaptureMessage(pnode->addr, msg.m_type, payload,
                        /*is_incoming=*/false);
     }
 
     TRACE6(net, outbound_message, pnode->GetId(), pnode->m_addr_name.c_str(),
            pnode->ConnectionTypeAsString().c_str(), msg.m_type.c_str(),
-           msg.data.size(), msg.data.data());
+           payload.size(), payload.data());
 
     // make sure we use the appropriate network transport format
     std::vector<uint8_t> serializedHeader;
@@ -3185,11 +3511,31 @@ void CConnman::PushMessage(CNode *pnode, CSerializedNetMsg &&msg) {
         if (pnode->nSendSize > nSendBufferMaxSize) {
             pnode->fPauseSend = true;
         }
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
-        if (nMessageSize) {
-            pnode->vSendMsg.push_back(std::move(msg.data));
+        if (!msg.shared_payload && nMessageSize <= MAX_COALESCED_PAYLOAD_SIZE) {
+            // Small payloads are appended to the header, so the message is a
+            // single buffer
+            serializedHeader.insert(serializedHeader.end(), msg.data.begin(),
+                                    msg.data.end());
+            pnode->vSendMsg.push_back(
+                std::make_shared<const std::vector<uint8_t>>(
+                    std::move(serializedHeader)));
+        } else {
+            pnode->vSendMsg.push_back(
+                std::make_shared<const std::vector<uint8_t>>(
+                    std::move(serializedHeader)));
+            if (msg.shared_payload && nMessageSize) {
+                // Reference the shared payload, without copying it
+                pnode->vSendMsg.emplace_back(msg.shared_payload,
+                                             &msg.shared_payload->data);
+            } else if (nMessageSize) {
+                pnode->vSendMsg.push_back(
+                    std::make_shared<const std::vector<uint8_t>>(
+                        std::move(msg.data)));
+            }
         }
 
+        pnode->m_send_pending = true;
+
         // If write queue empty, attempt "optimistic write"
         bool data_left;
         if (optimisticSend) {
@@ -37,6 +37,7 @@
 #include <util/sock.h>
 #include <util/time.h>
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
@@ -108,6 +109,12 @@ static const bool DEFAULT_FIXEDSEEDS = true;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER = 1 * 1000;
 static const size_t DEFAULT_MAXINFLIGHTBUFFER = 1 * 1000 * 1000;
+/** Default for -useepoll, only available where epoll(7) is supported */
+static const bool DEFAULT_USE_EPOLL = true;
+/** Default for -msghandlerthreads */
+static const int DEFAULT_MSG_HANDLER_THREADS = 1;
+/** Maximum number of message handler threads */
+static const int MAX_MSG_HANDLER_THREADS = 16;
 
 struct AddedNodeInfo {
     std::string strAddedNode;
@@ -119,6 +126,19 @@ struct AddedNodeInfo {
 struct CNodeStats;
 class CClientUIInterface;
 
+/**
+ * Immutable message payload that can be queued for several peers without being
+ * copied, e.g. a block served to many peers.
+ */
+struct SharedNetPayload {
+    const std::vector<uint8_t> data;
+    /** Double SHA256 of the data, computed once for the message checksum */
+    const uint256 hash;
+
+    explicit SharedNetPayload(std::vector<uint8_t> &&data_in)
+        : data(std::move(data_in)), hash(Hash(data)) {}
+};
+
 struct CSerializedNetMsg {
     CSerializedNetMsg() = default;
     CSerializedNetMsg(CSerializedNetMsg &&) = default;
@@ -130,11 +150,23 @@ struct CSerializedNetMsg {
     CSerializedNetMsg Copy() const {
         CSerializedNetMsg copy;
         copy.data = data;
+        copy.shared_payload = shared_payload;
         copy.m_type = m_type;
         return copy;
     }
 
+    /** The payload to send: shared_payload if set, data otherwise */
+    Span<const uint8_t> GetPayload() const {
+        return shared_payload ? Span<const uint8_t>{shared_payload->data}
+                              : Span<const uint8_t>{data};
+    }
+
     std::vector<uint8_t> data;
+    /**
+     * If set, the payload is shared with other messages and data is unused.
+     * Copying the message only copies the pointer.
+     */
+    std::shared_ptr<const SharedNetPayload> shared_payload;
     std::string m_type;
 };
 
@@ -209,6 +241,88 @@ extern const std::string NET_MESSAGE_TYPE_OTHER;
 typedef std::map</* message type */ std::string, /* total bytes */ uint64_t>
     mapMsgTypeSize;
 
+/** Length of the windows the recent message processing stats are kept for */
+static constexpr auto MSG_PROCESSING_WINDOW{10min};
+
+/** Number of messages processed and time spent processing them */
+struct MsgProcessingStats {
+    uint64_t count{0};
+    std::chrono::microseconds time{0us};
+
+    MsgProcessingStats &operator+=(const MsgProcessingStats &other) {
+        count += other.count;
+        time += other.time;
+        return *this;
+    }
+};
+
+/**
+ * Processing stats of the messages of a type, since the connection and over
+ * the recent windows.
+ */
+struct MsgTypeProcessingStats {
+    MsgProcessingStats total;
+    MsgProcessingStats recent;
+};
+
+typedef std::map</* message type */ std::string, MsgTypeProcessingStats>
+    mapMsgTypeProcessing;
+
+/**
+ * Account for the time the message handler threads spend on the messages of a
+ * peer, per message type.
+ *
+ * The recent stats cover the current window of MSG_PROCESSING_WINDOW and the
+ * previous one, so they follow a change of behavior of the peer without
+ * dropping to zero at each window boundary.
+ *
+ * This class is thread-safe.
+ */
+class MsgProcessingTracker {
+public:
+    explicit MsgProcessingTracker(
+        SteadyClock::time_point now = SteadyClock::now());
+
+    /**
+     * Account for processed messages. Unknown message types are accounted as
+     * NET_MESSAGE_TYPE_OTHER.
+     */
+    void Record(const std::string &msg_type, const MsgProcessingStats &stats,
+                SteadyClock::time_point now = SteadyClock::now())
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Get the stats of the message types that were processed */
+    mapMsgTypeProcessing
+    GetStats(SteadyClock::time_point now = SteadyClock::now()) const
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Get the recent processing time of all the message types but GETDATA.
+     * That one is mostly the time spent serving the data the peer requested,
+     * which an honest peer syncing from us costs too.
+     */
+    std::chrono::microseconds
+    GetRecentTime(SteadyClock::time_point now = SteadyClock::now()) const
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Entry {
+        MsgProcessingStats total;
+        MsgProcessingStats current;
+        MsgProcessingStats previous;
+    };
+
+    /** Stats of the windows that are still recent as of now */
+    MsgProcessingStats GetRecent(const Entry &entry,
+                                 SteadyClock::time_point now) const
+        EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    mutable Mutex m_mutex;
+    std::map<std::string, Entry> m_entries GUARDED_BY(m_mutex);
+    /** Start of the current window */
+    SteadyClock::time_point m_window_start GUARDED_BY(m_mutex);
+};
+
 /**
  * POD that contains various stats about a node.
  * Usually constructed from CConman::GetNodeStats. Stats are filled from the
@@ -237,10 +351,12 @@ struct CNodeStats {
     mapMsgTypeSize mapSendBytesPerMsgType;
     uint64_t nRecvBytes;
     mapMsgTypeSize mapRecvBytesPerMsgType;
+    mapMsgTypeProcessing mapProcessingPerMsgType;
     uint64_t nInflightBytes;
     NetPermissionFlags m_permission_flags;
     std::chrono::microseconds m_last_ping_time;
     std::chrono::microseconds m_min_ping_time;
+    std::chrono::microseconds m_msg_queue_delay;
     // Our address, as reported by the peer
     std::string addrLocal;
     // Address of this peer
@@ -265,6 +381,8 @@ public:
     DataStream m_recv;
     //! time of message receipt
     std::chrono::microseconds m_time{0};
+    //! time the message was queued for processing
+    SteadyClock::time_point m_queued_time{};
     //! size of the payload
     uint32_t m_message_size{0};
     //! used wire size of the message (including header/checksum)
@@ -373,14 +491,14 @@ public:
     // prepare message for transport (header construction, error-correction
     // computation, payload encryption, etc.)
     virtual void prepareForTransport(const Config &config,
-                                     CSerializedNetMsg &msg,
+                                     const CSerializedNetMsg &msg,
                                      std::vector<uint8_t> &header) const = 0;
     virtual ~TransportSerializer() {}
 };
 
 class V1TransportSerializer : public TransportSerializer {
 public:
-    void prepareForTransport(const Config &config, CSerializedNetMsg &msg,
+    void prepareForTransport(const Config &config, const CSerializedNetMsg &msg,
                              std::vector<uint8_t> &header) const override;
 };
 
@@ -416,7 +534,18 @@ public:
     /** Offset inside the first vSendMsg already sent */
     size_t nSendOffset GUARDED_BY(cs_vSend){0};
     uint64_t nSendBytes GUARDED_BY(cs_vSend){0};
-    std::deque<std::vector<uint8_t>> vSendMsg GUARDED_BY(cs_vSend);
+    /**
+     * Buffers waiting to be sent. They are immutable and may be shared with
+     * the send queues of other nodes, so queueing a large payload (e.g. a
+     * block) for several peers does not copy it.
+     */
+    std::deque<std::shared_ptr<const std::vector<uint8_t>>>
+        vSendMsg GUARDED_BY(cs_vSend);
+    /**
+     * Whether vSendMsg is not empty, so the socket handler can tell which
+     * nodes have data to send without taking cs_vSend.
+     */
+    std::atomic_bool m_send_pending{false};
     Mutex cs_vSend;
     Mutex m_sock_mutex;
     Mutex cs_vRecv;
@@ -466,6 +595,15 @@ public:
     std::atomic_bool fPauseRecv{false};
     std::atomic_bool fPauseSend{false};
 
+    /**
+     * Readiness of the socket as last reported by the edge-triggered epoll
+     * event loop. Set when the socket is registered, only cleared once a recv
+     * or send would block, and otherwise only used by the socket handler
+     * thread.
+     */
+    std::atomic_bool m_sock_recv_ready{false};
+    std::atomic_bool m_sock_send_ready{false};
+
     const ConnectionType m_conn_type;
 
     /** Move all messages from the received queue to the processing queue. */
@@ -670,6 +808,19 @@ public:
     std::atomic<std::chrono::microseconds> m_min_ping_time{
         std::chrono::microseconds::max()};
 
+    /**
+     * Moving average of the time the messages from this peer wait in the
+     * processing queue before being handled. Used only for RPC stats.
+     */
+    std::atomic<std::chrono::microseconds> m_msg_queue_delay{0us};
+
+    /**
+     * Time spent processing the messages from this peer. Used for RPC stats,
+     * and as an inbound peer eviction criterium in
+     * CConnman::AttemptToEvictConnection.
+     */
+    MsgProcessingTracker m_msg_processing;
+
     CNode(NodeId id, std::shared_ptr<Sock> sock, const CAddress &addrIn,
           uint64_t nKeyedNetGroupIn, uint64_t nLocalHostNonceIn,
           uint64_t nLocalExtraEntropyIn, const CAddress &addrBindIn,
@@ -824,6 +975,21 @@ public:
     virtual bool SendMessages(const Config &config, CNode *pnode)
         EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex) = 0;
 
+    /**
+     * Serve the data requested by a given node, e.g. blocks and transactions.
+     * This does not need g_msgproc_mutex so the message handler threads can
+     * serve different nodes concurrently, but it is never called concurrently
+     * for the same node.
+     *
+     * @param[in]   config          The applicable configuration object.
+     * @param[in]   pnode           The node which requested the data.
+     * @param[in]   interrupt       Interrupt condition for processing threads
+     * @return                      True if there is more work to be done
+     */
+    virtual bool ServeRequests(const Config &config, CNode *pnode,
+                               const std::atomic<bool> &interrupt)
+        EXCLUSIVE_LOCKS_REQUIRED(!g_msgproc_mutex) = 0;
+
 protected:
     /**
      * Protected destructor so that instances can only be deleted by derived
@@ -870,6 +1036,10 @@ public:
         bool m_i2p_accept_incoming = true;
         bool whitelist_forcerelay = DEFAULT_WHITELISTFORCERELAY;
         bool whitelist_relay = DEFAULT_WHITELISTRELAY;
+        /// Wait for socket events with epoll instead of polling every socket
+        /// at each iteration. Ignored if epoll is not supported.
+        bool m_use_epoll = false;
+        int m_msg_handler_threads = DEFAULT_MSG_HANDLER_THREADS;
     };
 
     void Init(const Options &connOptions)
@@ -912,6 +1082,9 @@ public:
         m_onion_binds = connOptions.onion_binds;
         whitelist_forcerelay = connOptions.whitelist_forcerelay;
         whitelist_relay = connOptions.whitelist_relay;
+        m_use_epoll = connOptions.m_use_epoll;
+        m_msg_handler_threads = std::clamp(connOptions.m_msg_handler_threads,
+                                           1, MAX_MSG_HANDLER_THREADS);
     }
 
     CConnman(const Config &configIn, uint64_t seed0, uint64_t seed1,
@@ -1119,7 +1292,13 @@ private:
                               mockOpenConnection)
         EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_added_nodes_mutex,
                                  !m_nodes_mutex, !m_unused_i2p_sessions_mutex);
-    void ThreadMessageHandler() EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
+    /**
+     * Process the messages of the nodes whose id modulo the number of message
+     * handler threads is thread_index, so the messages of a node are always
+     * processed in order by the same thread.
+     */
+    void ThreadMessageHandler(int thread_index)
+        EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
     void ThreadI2PAcceptIncoming();
     void AcceptConnection(const ListenSocket &hListenSocket);
 
@@ -1170,6 +1349,42 @@ private:
      */
     void SocketHandlerListening(const Sock::EventsPerSock &events_per_sock);
 
+    struct SocketIOResult {
+        /** Some data could not be sent because the socket would block */
+        bool send_blocked{false};
+        /** The socket receive buffer was emptied by the last recv */
+        bool recv_drained{false};
+    };
+
+    /**
+     * Do the read/write for a connected socket.
+     * @param[in] node The node which socket to service.
+     * @param[in] recv Whether to receive from the socket.
+     * @param[in] send Whether to send the queued messages.
+     * @param[in] error Whether an exceptional condition occurred on the socket,
+     *     in which case we receive to find out what happened.
+     */
+    SocketIOResult SocketHandlerNode(CNode &node, bool recv, bool send,
+                                     bool error)
+        EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
+
+    /** Enable or disable the inbound throttling after an IO round. */
+    void UpdateInflightThrottle(uint64_t total_inflight_bytes);
+
+#ifdef USE_EPOLL
+    /**
+     * Same as SocketHandler(), using the persistent m_epoll registrations
+     * instead of building the set of sockets to wait for at each iteration.
+     */
+    void SocketHandlerEpoll() EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
+
+    /**
+     * Register a newly connected node's socket with m_epoll, if in use. The
+     * socket is considered ready to recv and send until it would block.
+     */
+    void EpollAddNode(CNode &node);
+#endif
+
     void ThreadSocketHandler() EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
     void ThreadDNSAddressSeed()
         EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_nodes_mutex);
@@ -1247,6 +1462,24 @@ private:
     unsigned int nReceiveFloodSize{0};
 
     std::vector<ListenSocket> vhListenSocket;
+
+    bool m_use_epoll{false};
+#ifdef USE_EPOLL
+    /**
+     * Persistent registrations of the listening sockets (level-triggered) and
+     * of the connected sockets (edge-triggered). Only set between Start() and
+     * StopNodes() if m_use_epoll.
+     */
+    std::unique_ptr<SockEpoll> m_epoll;
+    /** Events returned by the last wait, kept to reuse the allocation */
+    std::vector<SockEpoll::ReadyEvent> m_epoll_events;
+    /**
+     * Whether a node could still make progress without a new event, so the
+     * next wait should not block.
+     */
+    bool m_epoll_io_pending{false};
+#endif
+
     std::atomic<bool> fNetworkActive{true};
     bool fAddressesInitialized{false};
     AddrMan &addrman;
@@ -1336,8 +1569,11 @@ private:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0, nSeed1;
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake GUARDED_BY(mutexMsgProc);
+    /**
+     * Incremented for waking the message processors. Each thread keeps track
+     * of the last value it has seen.
+     */
+    uint64_t m_msgproc_wake_count GUARDED_BY(mutexMsgProc){0};
 
     std::condition_variable condMsgProc;
     Mutex mutexMsgProc;
@@ -1362,7 +1598,8 @@ private:
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
-    std::thread threadMessageHandler;
+    std::vector<std::thread> m_message_handler_threads;
+    int m_msg_handler_threads{DEFAULT_MSG_HANDLER_THREADS};
     std::thread threadI2PAcceptIncoming;
 
     /**
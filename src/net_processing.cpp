@@ -14,6 +14,7 @@
 #include <avalanche/statistics.h>
 #include <avalanche/validation.h>
 #include <banman.h>
+#include <blockdownloadscheduler.h>
 #include <blockencodings.h>
 #include <blockfilter.h>
 #include <blockvalidity.h>
@@ -44,9 +45,11 @@
 #include <streams.h>
 #include <timedata.h>
 #include <tinyformat.h>
+#include <txannouncementqueue.h>
 #include <txmempool.h>
 #include <txorphanage.h>
 #include <util/check.h>
+#include <util/latency.h>
 #include <util/strencodings.h>
 #include <util/trace.h>
 #include <validation.h>
@@ -326,6 +329,8 @@ struct QueuedBlock {
     const CBlockIndex *pindex;
     /** Optional, used for CMPCTBLOCK downloads */
     std::unique_ptr<PartiallyDownloadedBlock> partialBlock;
+    /** When the block was requested */
+    std::chrono::microseconds m_requested_time{0};
 };
 
 struct StalledTxId {
@@ -462,12 +467,10 @@ struct Peer {
             m_bloom_filter PT_GUARDED_BY(m_bloom_filter_mutex)
                 GUARDED_BY(m_bloom_filter_mutex){nullptr};
 
+        mutable RecursiveMutex m_tx_inventory_mutex;
         /** A rolling bloom filter of all announced tx CInvs to this peer. */
         CRollingBloomFilter m_recently_announced_invs GUARDED_BY(
-            NetEventsInterface::g_msgproc_mutex){INVENTORY_MAX_RECENT_RELAY,
-                                                 0.000001};
-
-        mutable RecursiveMutex m_tx_inventory_mutex;
+            m_tx_inventory_mutex){INVENTORY_MAX_RECENT_RELAY, 0.000001};
         /**
          * A filter of all the txids that the peer has announced to us or we
          * have announced to the peer. We use this to avoid announcing
@@ -475,12 +478,6 @@ struct Peer {
          */
         CRollingBloomFilter m_tx_inventory_known_filter
             GUARDED_BY(m_tx_inventory_mutex){50000, 0.000001};
-        /**
-         * Set of transaction ids we still have to announce. We use the
-         * mempool to sort transactions in dependency order before relay, so
-         * this does not have to be sorted.
-         */
-        std::set<TxId> m_tx_inventory_to_send GUARDED_BY(m_tx_inventory_mutex);
         /**
          * Whether the peer has requested us to send our complete mempool. Only
          * permitted if the peer has NetPermissionFlags::Mempool.
@@ -539,8 +536,7 @@ struct Peer {
          * A rolling bloom filter of all announced Proofs CInvs to this peer.
          */
         CRollingBloomFilter m_recently_announced_proofs GUARDED_BY(
-            NetEventsInterface::g_msgproc_mutex){INVENTORY_MAX_RECENT_RELAY,
-                                                 0.000001};
+            m_proof_inventory_mutex){INVENTORY_MAX_RECENT_RELAY, 0.000001};
         std::chrono::microseconds m_next_inv_send_time{0};
 
         RadixTree<const avalanche::Proof, avalanche::ProofRadixTreeAdapter>
@@ -806,6 +802,10 @@ public:
                                  !m_recent_confirmed_transactions_mutex,
                                  !m_most_recent_block_mutex, !cs_proofrequest,
                                  g_msgproc_mutex);
+    bool ServeRequests(const Config &config, CNode *pfrom,
+                       const std::atomic<bool> &interrupt) override
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex,
+                                 !g_msgproc_mutex);
 
     /** Implement PeerManager */
     void StartScheduledTasks(CScheduler &scheduler) override;
@@ -815,6 +815,9 @@ public:
                const CBlockIndex &block_index) override;
     bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats) const override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
+    node::BlockServeCache::Stats GetBlockServeCacheStats() const override {
+        return m_block_serve_cache.GetStats();
+    }
     bool IgnoresIncomingTxs() override { return m_opts.ignore_incoming_txs; }
     void SendPings() override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void RelayTransaction(const TxId &txid) override
@@ -1144,6 +1147,14 @@ private:
         m_connman.PushMessage(&node, NetMsg::Make(std::move(msg_type),
                                                   std::forward<Args>(args)...));
     }
+    /** Send a message whose payload is shared with other peers, not copied */
+    void PushSharedMessage(CNode &node, std::string msg_type,
+                           std::shared_ptr<const SharedNetPayload> payload) const {
+        CSerializedNetMsg msg;
+        msg.m_type = std::move(msg_type);
+        msg.shared_payload = std::move(payload);
+        m_connman.PushMessage(&node, std::move(msg));
+    }
 
     /** Send a version message to a peer */
     void PushNodeVersion(const Config &config, CNode &pnode, const Peer &peer);
@@ -1203,6 +1214,8 @@ private:
     CTxMemPool &m_mempool;
     avalanche::Processor *const m_avalanche;
     InvRequestTracker<TxId> m_txrequest GUARDED_BY(::cs_main);
+    /** Transactions to announce, shared between all the peers */
+    TxAnnouncementQueue m_tx_announcement_queue{m_mempool};
 
     Mutex cs_proofrequest;
     InvRequestTracker<avalanche::ProofId>
@@ -1379,6 +1392,29 @@ private:
     BlockHash m_most_recent_block_hash GUARDED_BY(m_most_recent_block_mutex);
     std::unique_ptr<const std::map<TxId, CTransactionRef>>
         m_most_recent_block_txs GUARDED_BY(m_most_recent_block_mutex);
+    /**
+     * Serialized m_most_recent_block and m_most_recent_compact_block, created
+     * on first use so they are serialized once however many peers request
+     * them.
+     */
+    std::shared_ptr<const SharedNetPayload>
+        m_most_recent_block_payload GUARDED_BY(m_most_recent_block_mutex);
+    std::shared_ptr<const SharedNetPayload> m_most_recent_compact_block_payload
+        GUARDED_BY(m_most_recent_block_mutex);
+
+    /** Blocks recently served to our peers, older than the most recent one */
+    node::BlockServeCache m_block_serve_cache;
+
+    /**
+     * Return the serialized payload of a block (resp. compact block), cached
+     * if it is still m_most_recent_block (resp. m_most_recent_compact_block).
+     */
+    std::shared_ptr<const SharedNetPayload>
+    GetBlockPayload(const std::shared_ptr<const CBlock> &block)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
+    std::shared_ptr<const SharedNetPayload> GetCompactBlockPayload(
+        const std::shared_ptr<const CBlockHeaderAndShortTxIDs> &cmpctblock)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
 
     // Data about the low-work headers synchronization, aggregated from all
     // peers' HeadersSyncStates.
@@ -1444,11 +1480,14 @@ private:
 
     /**
      * Update pindexLastCommonBlock and add not-in-flight missing successors to
-     * vBlocks, until it has at most count entries.
+     * vBlocks, until it has at most count entries. If the download window is
+     * full, nodeStaller and stallingBlock are set to the peer and the block
+     * holding it back.
      */
     void FindNextBlocksToDownload(const Peer &peer, unsigned int count,
                                   std::vector<const CBlockIndex *> &vBlocks,
-                                  NodeId &nodeStaller)
+                                  NodeId &nodeStaller,
+                                  const CBlockIndex *&stallingBlock)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /** Request blocks for the background chainstate, if one is in use. */
@@ -1485,12 +1524,15 @@ private:
      *                     stalled because every block in the window is in
      *                     flight and no other peer is trying to download the
      *                     next block).
+     * \param stallingBlock Optional pointer receiving the in-flight block
+     *                     requested from nodeStaller, set together with it.
      */
     void FindNextBlocks(std::vector<const CBlockIndex *> &vBlocks,
                         const Peer &peer, CNodeState *state,
                         const CBlockIndex *pindexWalk, unsigned int count,
                         int nWindowEnd, const CChain *activeChain = nullptr,
-                        NodeId *nodeStaller = nullptr)
+                        NodeId *nodeStaller = nullptr,
+                        const CBlockIndex **stallingBlock = nullptr)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /** Multimap used to preserve insertion order */
@@ -1499,6 +1541,9 @@ private:
         BlockDownloadMap;
     BlockDownloadMap mapBlocksInFlight GUARDED_BY(cs_main);
 
+    /** Decides how many blocks to request from each peer */
+    BlockDownloadScheduler m_block_download_scheduler GUARDED_BY(cs_main);
+
     /** When our tip was last updated. */
     std::atomic<std::chrono::seconds> m_last_tip_update{0s};
 
@@ -1510,15 +1555,13 @@ private:
                                      const std::chrono::seconds mempool_req,
                                      const std::chrono::seconds now)
         LOCKS_EXCLUDED(cs_main)
-            EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex,
-                                     NetEventsInterface::g_msgproc_mutex);
+            EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
 
     void ProcessGetData(const Config &config, CNode &pfrom, Peer &peer,
                         const std::atomic<bool> &interruptMsgProc)
         EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex,
                                  peer.m_getdata_requests_mutex,
-                                 NetEventsInterface::g_msgproc_mutex)
-            LOCKS_EXCLUDED(cs_main);
+                                 !g_msgproc_mutex) LOCKS_EXCLUDED(cs_main);
 
     /** Process a new block. Perform any post-processing housekeeping */
     void ProcessBlock(const Config &config, CNode &node,
@@ -1688,8 +1731,7 @@ private:
 
     avalanche::ProofRef FindProofForGetData(const Peer &peer,
                                             const avalanche::ProofId &proofid,
-                                            const std::chrono::seconds now)
-        EXCLUSIVE_LOCKS_REQUIRED(NetEventsInterface::g_msgproc_mutex);
+                                            const std::chrono::seconds now);
 
     bool isPreferredDownloadPeer(const CNode &pfrom);
 };
@@ -1872,9 +1914,10 @@ bool PeerManagerImpl::BlockRequested(const Config &config, NodeId nodeid,
 
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(
         state->vBlocksInFlight.end(),
-        {&block, std::unique_ptr<PartiallyDownloadedBlock>(
-                     pit ? new PartiallyDownloadedBlock(config, &m_mempool)
-                         : nullptr)});
+        {&block,
+         std::unique_ptr<PartiallyDownloadedBlock>(
+             pit ? new PartiallyDownloadedBlock(config, &m_mempool) : nullptr),
+         GetTime<std::chrono::microseconds>()});
     if (state->vBlocksInFlight.size() == 1) {
         // We're starting a block download (batch) from this peer.
         state->m_downloading_since = GetTime<std::chrono::microseconds>();
@@ -2039,7 +2082,8 @@ void PeerManagerImpl::UpdateBlockAvailability(NodeId nodeid,
 // our current tip.
 void PeerManagerImpl::FindNextBlocksToDownload(
     const Peer &peer, unsigned int count,
-    std::vector<const CBlockIndex *> &vBlocks, NodeId &nodeStaller) {
+    std::vector<const CBlockIndex *> &vBlocks, NodeId &nodeStaller,
+    const CBlockIndex *&stallingBlock) {
     if (count == 0) {
         return;
     }
@@ -2104,7 +2148,7 @@ void PeerManagerImpl::FindNextBlocksToDownload(
         state->pindexLastCommonBlock->nHeight + BLOCK_DOWNLOAD_WINDOW;
 
     FindNextBlocks(vBlocks, peer, state, pindexWalk, count, nWindowEnd,
-                   &m_chainman.ActiveChain(), &nodeStaller);
+                   &m_chainman.ActiveChain(), &nodeStaller, &stallingBlock);
 }
 
 void PeerManagerImpl::TryDownloadingHistoricalBlocks(
@@ -2147,11 +2191,13 @@ void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex *> &vBlocks,
                                      const CBlockIndex *pindexWalk,
                                      unsigned int count, int nWindowEnd,
                                      const CChain *activeChain,
-                                     NodeId *nodeStaller) {
+                                     NodeId *nodeStaller,
+                                     const CBlockIndex **stallingBlock) {
     std::vector<const CBlockIndex *> vToFetch;
     int nMaxHeight =
         std::min<int>(state->pindexBestKnownBlock->nHeight, nWindowEnd + 1);
     NodeId waitingfor = -1;
+    const CBlockIndex *waitingforBlock = nullptr;
     while (pindexWalk->nHeight < nMaxHeight) {
         // Read up to 128 (or more, if more blocks than that are needed)
         // successors of pindexWalk (towards pindexBestKnownBlock) into
@@ -2192,6 +2238,9 @@ void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex *> &vBlocks,
                         if (nodeStaller) {
                             *nodeStaller = waitingfor;
                         }
+                        if (stallingBlock) {
+                            *stallingBlock = waitingforBlock;
+                        }
                     }
                     return;
                 }
@@ -2204,6 +2253,7 @@ void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex *> &vBlocks,
                 waitingfor =
                     mapBlocksInFlight.lower_bound(pindex->GetBlockHash())
                         ->second.first;
+                waitingforBlock = pindex;
             }
         }
     }
@@ -2556,6 +2606,8 @@ void PeerManagerImpl::FinalizeNode(const Config &config, const CNode &node) {
             orphanage.EraseForPeer(nodeid);
         });
         m_txrequest.DisconnectedPeer(nodeid);
+        m_block_download_scheduler.RemovePeer(nodeid);
+        m_tx_announcement_queue.RemovePeer(nodeid);
         m_num_preferred_download_peers -= state->fPreferredDownload;
         m_peers_downloading_from -= (!state->vBlocksInFlight.empty());
         assert(m_peers_downloading_from >= 0);
@@ -2864,7 +2916,8 @@ PeerManagerImpl::PeerManagerImpl(CConnman &connman, AddrMan &addrman,
       m_fee_filter_rounder{CFeeRate{DEFAULT_MIN_RELAY_TX_FEE_PER_KB}, m_rng},
       m_chainparams(chainman.GetParams()), m_connman(connman),
       m_addrman(addrman), m_banman(banman), m_chainman(chainman),
-      m_mempool(pool), m_avalanche(avalanche), m_opts{opts} {}
+      m_mempool(pool), m_avalanche(avalanche), m_opts{opts},
+      m_block_serve_cache{opts.block_serve_cache_size} {}
 
 void PeerManagerImpl::StartScheduledTasks(CScheduler &scheduler) {
     // Stale tip checking and peer eviction are on two different timers, but we
@@ -2989,9 +3042,9 @@ void PeerManagerImpl::NewPoWValidBlock(
     m_highest_fast_announce = pindex->nHeight;
 
     BlockHash hashBlock(pblock->GetHash());
-    const std::shared_future<CSerializedNetMsg> lazy_ser{
+    const std::shared_future<std::shared_ptr<const SharedNetPayload>> lazy_ser{
         std::async(std::launch::deferred, [&] {
-            return NetMsg::Make(NetMsgType::CMPCTBLOCK, *pcmpctblock);
+            return GetCompactBlockPayload(pcmpctblock);
         })};
 
     {
@@ -3006,6 +3059,8 @@ void PeerManagerImpl::NewPoWValidBlock(
         m_most_recent_block = pblock;
         m_most_recent_compact_block = pcmpctblock;
         m_most_recent_block_txs = std::move(most_recent_block_txs);
+        m_most_recent_block_payload.reset();
+        m_most_recent_compact_block_payload.reset();
     }
 
     m_connman.ForEachNode(
@@ -3030,8 +3085,8 @@ void PeerManagerImpl::NewPoWValidBlock(
                              "PeerManager::NewPoWValidBlock",
                              hashBlock.ToString(), pnode->GetId());
 
-                    const CSerializedNetMsg &ser_cmpctblock{lazy_ser.get()};
-                    PushMessage(*pnode, ser_cmpctblock.Copy());
+                    PushSharedMessage(*pnode, NetMsgType::CMPCTBLOCK,
+                                      lazy_ser.get());
                     state.pindexBestHeaderSent = pindex;
                 }
             });
@@ -3189,28 +3244,9 @@ void PeerManagerImpl::SendPings() {
 }
 
 void PeerManagerImpl::RelayTransaction(const TxId &txid) {
-    LOCK(m_peer_mutex);
-    for (auto &it : m_peer_map) {
-        Peer &peer = *it.second;
-        auto tx_relay = peer.GetTxRelay();
-        if (!tx_relay) {
-            continue;
-        }
-        LOCK(tx_relay->m_tx_inventory_mutex);
-        // Only queue transactions for announcement once the version handshake
-        // is completed. The time of arrival for these transactions is
-        // otherwise at risk of leaking to a spy, if the spy is able to
-        // distinguish transactions received during the handshake from the rest
-        // in the announcement.
-        if (tx_relay->m_next_inv_send_time == 0s) {
-            continue;
-        }
-
-        if (!tx_relay->m_tx_inventory_known_filter.contains(txid) ||
-            tx_relay->m_avalanche_stalled_txids.count(txid) > 0) {
-            tx_relay->m_tx_inventory_to_send.insert(txid);
-        }
-    }
+    // The peers that already know about the transaction are filtered out when
+    // it is announced.
+    m_tx_announcement_queue.Push(txid);
 }
 
 void PeerManagerImpl::RelayProof(const avalanche::ProofId &proofid) {
@@ -3405,16 +3441,25 @@ void PeerManagerImpl::ProcessGetBlockData(const Config &config, CNode &pfrom,
 
     if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
         pblock = a_recent_block;
-    } else if (!inv.IsMsgCmpctBlk()) {
+    } else if (inv.IsMsgBlk()) {
         // Fast-path: in this case it is possible to serve the block directly
         // from disk, as the network format matches the format on disk
-        std::vector<uint8_t> block_data;
-        if (!m_chainman.m_blockman.ReadRawBlock(block_data, block_pos)) {
-            handle_block_read_error();
-            return;
+        auto payload{m_block_serve_cache.GetSerialized(hash)};
+        if (!payload) {
+            std::vector<uint8_t> block_data;
+            if (!m_chainman.m_blockman.ReadRawBlock(block_data, block_pos)) {
+                handle_block_read_error();
+                return;
+            }
+            payload =
+                std::make_shared<const SharedNetPayload>(std::move(block_data));
+            m_block_serve_cache.AddSerialized(hash, payload);
         }
-        MakeAndPushMessage(pfrom, NetMsgType::BLOCK, Span{block_data});
+        // Queue the data as read, without copying it
+        PushSharedMessage(pfrom, NetMsgType::BLOCK, std::move(payload));
         // Don't set pblock as we've sent the block
+    } else if (auto cached_block{m_block_serve_cache.GetDecoded(hash)}) {
+        pblock = std::move(cached_block);
     } else {
         // Send block from disk
         std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
@@ -3422,11 +3467,17 @@ void PeerManagerImpl::ProcessGetBlockData(const Config &config, CNode &pfrom,
             handle_block_read_error();
             return;
         }
+        m_block_serve_cache.AddDecoded(hash, pblockRead);
         pblock = pblockRead;
     }
     if (pblock) {
         if (inv.IsMsgBlk()) {
-            MakeAndPushMessage(pfrom, NetMsgType::BLOCK, *pblock);
+            if (pblock == a_recent_block) {
+                PushSharedMessage(pfrom, NetMsgType::BLOCK,
+                                  GetBlockPayload(a_recent_block));
+            } else {
+                MakeAndPushMessage(pfrom, NetMsgType::BLOCK, *pblock);
+            }
         } else if (inv.IsMsgFilteredBlk()) {
             bool sendMerkleBlock = false;
             CMerkleBlock merkleBlock;
@@ -3467,8 +3518,9 @@ void PeerManagerImpl::ProcessGetBlockData(const Config &config, CNode &pfrom,
                 if (a_recent_compact_block &&
                     a_recent_compact_block->header.GetHash() ==
                         pindex->GetBlockHash()) {
-                    MakeAndPushMessage(pfrom, NetMsgType::CMPCTBLOCK,
-                                       *a_recent_compact_block);
+                    PushSharedMessage(
+                        pfrom, NetMsgType::CMPCTBLOCK,
+                        GetCompactBlockPayload(a_recent_compact_block));
                 } else {
                     CBlockHeaderAndShortTxIDs cmpctblock(
                         *pblock, FastRandomContext().rand64());
@@ -3497,6 +3549,51 @@ void PeerManagerImpl::ProcessGetBlockData(const Config &config, CNode &pfrom,
     }
 }
 
+template <typename T>
+static std::shared_ptr<const SharedNetPayload> MakeSharedPayload(const T &obj) {
+    std::vector<uint8_t> data;
+    VectorWriter{data, 0, obj};
+    return std::make_shared<const SharedNetPayload>(std::move(data));
+}
+
+std::shared_ptr<const SharedNetPayload>
+PeerManagerImpl::GetBlockPayload(const std::shared_ptr<const CBlock> &block) {
+    if (auto payload = WITH_LOCK(
+            m_most_recent_block_mutex,
+            return block == m_most_recent_block ? m_most_recent_block_payload
+                                                : nullptr)) {
+        return payload;
+    }
+
+    // Serialize without holding the lock, this takes a while for a big block
+    auto payload = MakeSharedPayload(*block);
+
+    LOCK(m_most_recent_block_mutex);
+    if (block == m_most_recent_block) {
+        m_most_recent_block_payload = payload;
+    }
+    return payload;
+}
+
+std::shared_ptr<const SharedNetPayload> PeerManagerImpl::GetCompactBlockPayload(
+    const std::shared_ptr<const CBlockHeaderAndShortTxIDs> &cmpctblock) {
+    if (auto payload =
+            WITH_LOCK(m_most_recent_block_mutex,
+                      return cmpctblock == m_most_recent_compact_block
+                                 ? m_most_recent_compact_block_payload
+                                 : nullptr)) {
+        return payload;
+    }
+
+    auto payload = MakeSharedPayload(*cmpctblock);
+
+    LOCK(m_most_recent_block_mutex);
+    if (cmpctblock == m_most_recent_compact_block) {
+        m_most_recent_compact_block_payload = payload;
+    }
+    return payload;
+}
+
 CTransactionRef
 PeerManagerImpl::FindTxForGetData(const Peer &peer, const TxId &txid,
                                   const std::chrono::seconds mempool_req,
@@ -3516,8 +3613,10 @@ PeerManagerImpl::FindTxForGetData(const Peer &peer, const TxId &txid,
         LOCK(cs_main);
 
         // Otherwise, the transaction might have been announced recently.
-        bool recent =
-            Assume(peer.GetTxRelay())->m_recently_announced_invs.contains(txid);
+        const auto tx_relay = Assume(peer.GetTxRelay());
+        bool recent = WITH_LOCK(
+            tx_relay->m_tx_inventory_mutex,
+            return tx_relay->m_recently_announced_invs.contains(txid));
         if (recent && txinfo.tx) {
             return std::move(txinfo.tx);
         }
@@ -3576,7 +3675,9 @@ PeerManagerImpl::FindProofForGetData(const Peer &peer,
     }
 
     // Otherwise, the proofs must have been announced recently.
-    if (peer.m_proof_relay->m_recently_announced_proofs.contains(proofid)) {
+    if (WITH_LOCK(peer.m_proof_relay->m_proof_inventory_mutex,
+                  return peer.m_proof_relay->m_recently_announced_proofs
+                      .contains(proofid))) {
         return proof;
     }
 
@@ -3667,12 +3768,12 @@ void PeerManagerImpl::ProcessGetData(
                         }
                     }
                 }
+                LOCK(tx_relay->m_tx_inventory_mutex);
                 for (const TxId &parent_txid : parent_ids_to_add) {
                     // Relaying a transaction with a recent but unconfirmed
                     // parent.
-                    if (WITH_LOCK(tx_relay->m_tx_inventory_mutex,
-                                  return !tx_relay->m_tx_inventory_known_filter
-                                              .contains(parent_txid))) {
+                    if (!tx_relay->m_tx_inventory_known_filter.contains(
+                            parent_txid)) {
                         tx_relay->m_recently_announced_invs.insert(parent_txid);
                     }
                 }
@@ -4114,10 +4215,14 @@ void PeerManagerImpl::UpdatePeerStateForReceivedHeaders(
     }
 }
 
+static LatencyHistogram latency_process_headers{
+    "process_headers", "Time spent processing a headers message"};
+
 void PeerManagerImpl::ProcessHeadersMessage(const Config &config, CNode &pfrom,
                                             Peer &peer,
                                             std::vector<CBlockHeader> &&headers,
                                             bool via_compact_block) {
+    LatencyTimer timer{latency_process_headers};
     size_t nCount = headers.size();
 
     if (nCount == 0) {
@@ -5173,6 +5278,7 @@ void PeerManagerImpl::ProcessMessage(
                     // Add our proof id to the list or the recently announced
                     // proof INVs to this peer. This is used for filtering which
                     // INV can be requested for download.
+                    LOCK(peer->m_proof_relay->m_proof_inventory_mutex);
                     peer->m_proof_relay->m_recently_announced_proofs.insert(
                         localProof->getId());
                 }
@@ -5180,16 +5286,16 @@ void PeerManagerImpl::ProcessMessage(
         }
 
         if (auto tx_relay = peer->GetTxRelay()) {
-            // `TxRelay::m_tx_inventory_to_send` must be empty before the
-            // version handshake is completed as
-            // `TxRelay::m_next_inv_send_time` is first initialised in
-            // `SendMessages` after the verack is received. Any transactions
-            // received during the version handshake would otherwise
-            // immediately be advertised without random delay, potentially
-            // leaking the time of arrival to a spy.
-            Assume(WITH_LOCK(tx_relay->m_tx_inventory_mutex,
-                             return tx_relay->m_tx_inventory_to_send.empty() &&
-                                    tx_relay->m_next_inv_send_time == 0s));
+            // The peer must not get any transaction announcement before the
+            // version handshake is completed, as it is only added to the
+            // announcement queue when `TxRelay::m_next_inv_send_time` is first
+            // initialised in `SendMessages` after the verack is received. Any
+            // transactions received during the version handshake would
+            // otherwise immediately be advertised without random delay,
+            // potentially leaking the time of arrival to a spy.
+            Assume(!m_tx_announcement_queue.HasPeer(pfrom.GetId()) &&
+                   WITH_LOCK(tx_relay->m_tx_inventory_mutex,
+                             return tx_relay->m_next_inv_send_time == 0s));
         }
 
         pfrom.fSuccessfullyConnected = true;
@@ -5506,13 +5612,13 @@ void PeerManagerImpl::ProcessMessage(
                      vInv[0].ToString(), pfrom.GetId());
         }
 
-        {
-            LOCK(peer->m_getdata_requests_mutex);
-            peer->m_getdata_requests.insert(peer->m_getdata_requests.end(),
-                                            vInv.begin(), vInv.end());
-            ProcessGetData(config, pfrom, *peer, interruptMsgProc);
-        }
-
+        // The requests are served by ServeRequests(), without
+        // g_msgproc_mutex, once the message processing loop goes around
+        // again.
+        WITH_LOCK(peer->m_getdata_requests_mutex,
+                  peer->m_getdata_requests.insert(
+                      peer->m_getdata_requests.end(), vInv.begin(),
+                      vInv.end()));
         return;
     }
 
@@ -6529,6 +6635,7 @@ void PeerManagerImpl::ProcessMessage(
             return;
         }
 
+        const size_t block_size{vRecv.size()};
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
         vRecv >> *pblock;
 
@@ -6562,6 +6669,16 @@ void PeerManagerImpl::ProcessMessage(
             // Always process the block if we requested it, since we may
             // need it even when it's not a candidate for a new best tip.
             forceProcessing = IsBlockRequested(hash);
+            for (auto range = mapBlocksInFlight.equal_range(hash);
+                 range.first != range.second; range.first++) {
+                auto [node_id, list_it] = range.first->second;
+                if (node_id == pfrom.GetId()) {
+                    m_block_download_scheduler.BlockReceived(
+                        node_id, block_size, list_it->m_requested_time,
+                        time_received);
+                    break;
+                }
+            }
             RemoveBlockRequest(hash, pfrom.GetId());
             // mapBlockSource is only used for punishing peers and setting
             // which peers send us compact blocks, so the race between here and
@@ -7923,7 +8040,7 @@ void PeerManagerImpl::ProcessMessage(
         // A peer might send up to 1 notfound per getdata request, but no more
         if (vInv.size() <= PROOF_REQUEST_PARAMS.max_peer_announcements +
                                TX_REQUEST_PARAMS.max_peer_announcements +
-                               MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+                               MAX_BLOCKS_IN_FLIGHT_PER_PEER) {
             for (CInv &inv : vInv) {
                 if (inv.IsMsgTx()) {
                     // If we receive a NOTFOUND message for a tx we requested,
@@ -7999,6 +8116,38 @@ bool PeerManagerImpl::MaybeDiscourageAndDisconnect(CNode &pnode, Peer &peer) {
     return true;
 }
 
+/**
+ * Account the time elapsed since start to the processing of count messages of
+ * type msg_type from the peer.
+ */
+static void RecordMsgProcessing(CNode &node, const std::string &msg_type,
+                                uint64_t count, SteadyClock::time_point start) {
+    node.m_msg_processing.Record(
+        msg_type, {count, std::chrono::duration_cast<std::chrono::microseconds>(
+                              SteadyClock::now() - start)});
+}
+
+bool PeerManagerImpl::ServeRequests(const Config &config, CNode *pfrom,
+                                    const std::atomic<bool> &interruptMsgProc) {
+    AssertLockNotHeld(g_msgproc_mutex);
+
+    PeerRef peer = GetPeerRef(pfrom->GetId());
+    if (peer == nullptr) {
+        return false;
+    }
+
+    LOCK(peer->m_getdata_requests_mutex);
+    if (peer->m_getdata_requests.empty()) {
+        return false;
+    }
+    const auto start{SteadyClock::now()};
+    ProcessGetData(config, *pfrom, *peer, interruptMsgProc);
+    // Serving the data is part of the cost of the getdata messages received
+    // earlier.
+    RecordMsgProcessing(*pfrom, NetMsgType::GETDATA, 0, start);
+    return !peer->m_getdata_requests.empty() && !pfrom->fPauseSend;
+}
+
 bool PeerManagerImpl::ProcessMessages(const Config &config, CNode *pfrom,
                                       std::atomic<bool> &interruptMsgProc) {
     AssertLockHeld(g_msgproc_mutex);
@@ -8008,13 +8157,6 @@ bool PeerManagerImpl::ProcessMessages(const Config &config, CNode *pfrom,
         return false;
     }
 
-    {
-        LOCK(peer->m_getdata_requests_mutex);
-        if (!peer->m_getdata_requests.empty()) {
-            ProcessGetData(config, *pfrom, *peer, interruptMsgProc);
-        }
-    }
-
     const bool processed_orphan = ProcessOrphanTx(config, *peer);
 
     if (pfrom->fDisconnect) {
@@ -8057,6 +8199,7 @@ bool PeerManagerImpl::ProcessMessages(const Config &config, CNode *pfrom,
                        /*is_incoming=*/true);
     }
 
+    const auto processing_start{SteadyClock::now()};
     try {
         ProcessMessage(config, *pfrom, msg.m_type, msg.m_recv, msg.m_time,
                        interruptMsgProc);
@@ -8087,6 +8230,7 @@ bool PeerManagerImpl::ProcessMessages(const Config &config, CNode *pfrom,
         LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n",
                  __func__, SanitizeString(msg.m_type), msg.m_message_size);
     }
+    RecordMsgProcessing(*pfrom, msg.m_type, 1, processing_start);
 
     return fMoreWork;
 }
@@ -8560,23 +8704,6 @@ void PeerManagerImpl::MaybeSendFeefilter(
     }
 }
 
-namespace {
-class CompareInvMempoolOrder {
-    CTxMemPool *mp;
-
-public:
-    explicit CompareInvMempoolOrder(CTxMemPool *_mempool) : mp(_mempool) {}
-
-    bool operator()(std::set<TxId>::iterator a, std::set<TxId>::iterator b) {
-        /**
-         * As std::make_heap produces a max-heap, we want the entries which
-         * are topologically earlier to sort later.
-         */
-        return mp->CompareTopologically(*b, *a);
-    }
-};
-} // namespace
-
 bool PeerManagerImpl::RejectIncomingTxs(const CNode &peer) const {
     // block-relay-only peers may never send txs to us
     if (peer.IsBlockOnlyConn()) {
@@ -8976,6 +9103,16 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
 
         if (auto tx_relay = peer->GetTxRelay()) {
             LOCK(tx_relay->m_tx_inventory_mutex);
+            // Only queue transactions for announcement once the version
+            // handshake is completed. The time of arrival for these
+            // transactions is otherwise at risk of leaking to a spy, if the
+            // spy is able to distinguish transactions received during the
+            // handshake from the rest in the announcement.
+            if (tx_relay->m_next_inv_send_time == 0s) {
+                m_tx_announcement_queue.Seal();
+                m_tx_announcement_queue.AddPeer(pto->GetId());
+            }
+
             // Check whether periodic sends should happen
             const bool fSendTrickle =
                 computeNextInvSendTime(tx_relay->m_next_inv_send_time);
@@ -8985,7 +9122,7 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
             if (fSendTrickle) {
                 LOCK(tx_relay->m_bloom_filter_mutex);
                 if (!tx_relay->m_relay_txs) {
-                    tx_relay->m_tx_inventory_to_send.clear();
+                    m_tx_announcement_queue.Skip(pto->GetId());
                 }
             }
 
@@ -9000,7 +9137,6 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
 
                 for (const auto &txinfo : vtxinfo) {
                     const TxId &txid = txinfo.tx->GetId();
-                    tx_relay->m_tx_inventory_to_send.erase(txid);
                     // Don't send transactions that peers will not put into
                     // their mempool
                     if (txinfo.fee < filterrate.GetFee(txinfo.vsize)) {
@@ -9023,67 +9159,57 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
 
             // Determine transactions to relay
             if (fSendTrickle) {
-                // Produce a vector with all candidates for sending
-                std::vector<std::set<TxId>::iterator> vInvTx;
-                vInvTx.reserve(tx_relay->m_tx_inventory_to_send.size());
-                for (std::set<TxId>::iterator it =
-                         tx_relay->m_tx_inventory_to_send.begin();
-                     it != tx_relay->m_tx_inventory_to_send.end(); it++) {
-                    vInvTx.push_back(it);
-                }
+                // The queue is sorted in the order of admission to our
+                // mempool, which is guaranteed to be a topological sort order.
+                m_tx_announcement_queue.Seal();
                 const CFeeRate filterrate{
                     tx_relay->m_fee_filter_received.load()};
-                // Send out the inventory in the order of admission to our
-                // mempool, which is guaranteed to be a topological sort order.
-                // A heap is used so that not all items need sorting if only a
-                // few are being sent.
-                CompareInvMempoolOrder compareInvMempoolOrder(&m_mempool);
-                std::make_heap(vInvTx.begin(), vInvTx.end(),
-                               compareInvMempoolOrder);
+                LOCK(tx_relay->m_bloom_filter_mutex);
+                LOCK(m_mempool.cs);
                 // No reason to drain out at many times the network's
                 // capacity, especially since we have many peers and some
-                // will draw much shorter delays.
-                unsigned int nRelayedTransactions = 0;
-                LOCK(tx_relay->m_bloom_filter_mutex);
-                while (!vInvTx.empty() &&
-                       nRelayedTransactions < INVENTORY_BROADCAST_MAX_PER_MB *
-                                                  config.GetMaxBlockSize() /
-                                                  1000000) {
-                    // Fetch the top element from the heap
-                    std::pop_heap(vInvTx.begin(), vInvTx.end(),
-                                  compareInvMempoolOrder);
-                    std::set<TxId>::iterator it = vInvTx.back();
-                    vInvTx.pop_back();
-                    const TxId txid = *it;
-                    // Remove it from the to-be-sent set
-                    tx_relay->m_tx_inventory_to_send.erase(it);
-                    // Check if not in the filter already
-                    if (tx_relay->m_tx_inventory_known_filter.contains(txid) &&
-                        tx_relay->m_avalanche_stalled_txids.count(txid) == 0) {
-                        continue;
-                    }
-                    // Not in the mempool anymore? don't bother sending it.
-                    auto txinfo = m_mempool.info(txid);
-                    if (!txinfo.tx) {
-                        continue;
-                    }
-                    // Peer told you to not send transactions at that
-                    // feerate? Don't bother sending it.
-                    if (txinfo.fee < filterrate.GetFee(txinfo.vsize)) {
-                        continue;
-                    }
-                    if (tx_relay->m_bloom_filter &&
-                        !tx_relay->m_bloom_filter->IsRelevantAndUpdate(
-                            *txinfo.tx)) {
-                        continue;
-                    }
-                    // Send
-                    tx_relay->m_recently_announced_invs.insert(txid);
-                    addInvAndMaybeFlush(MSG_TX, txid);
-                    nRelayedTransactions++;
-                    tx_relay->m_tx_inventory_known_filter.insert(txid);
-                    tx_relay->m_avalanche_stalled_txids.erase(txid);
-                }
+                // will draw much shorter delays. The transactions that are
+                // not announced are kept for the next trickle.
+                m_tx_announcement_queue.Consume(
+                    pto->GetId(),
+                    INVENTORY_BROADCAST_MAX_PER_MB * config.GetMaxBlockSize() /
+                        1000000,
+                    [&](const TxAnnouncement &announcement) {
+                        AssertLockHeld(tx_relay->m_tx_inventory_mutex);
+                        AssertLockHeld(tx_relay->m_bloom_filter_mutex);
+                        const TxId &txid = announcement.txid;
+                        // Check if not in the filter already
+                        if (tx_relay->m_tx_inventory_known_filter.contains(
+                                txid) &&
+                            tx_relay->m_avalanche_stalled_txids.count(txid) ==
+                                0) {
+                            return false;
+                        }
+                        // Peer told you to not send transactions at that
+                        // feerate? Don't bother sending it.
+                        if (announcement.fee <
+                            filterrate.GetFee(announcement.vsize)) {
+                            return false;
+                        }
+                        // Not in the mempool anymore? don't bother sending
+                        // it.
+                        if (tx_relay->m_bloom_filter) {
+                            const CTransactionRef tx{m_mempool.get(txid)};
+                            if (!tx ||
+                                !tx_relay->m_bloom_filter->IsRelevantAndUpdate(
+                                    *tx)) {
+                                return false;
+                            }
+                        } else if (!m_mempool.exists(txid)) {
+                            return false;
+                        }
+                        // Send
+                        tx_relay->m_recently_announced_invs.insert(txid);
+                        addInvAndMaybeFlush(MSG_TX, txid);
+                        tx_relay->m_tx_inventory_known_filter.insert(txid);
+                        tx_relay->m_avalanche_stalled_txids.erase(txid);
+                        return true;
+                    });
             }
         }
     } // release cs_main
@@ -9205,15 +9331,18 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
 
         CNodeState &state = *State(pto->GetId());
 
+        const unsigned int inflight_target{
+            m_block_download_scheduler.GetInFlightTarget(pto->GetId())};
         if (CanServeBlocks(*peer) &&
             ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) ||
              !m_chainman.IsInitialBlockDownload()) &&
-            state.vBlocksInFlight.size() < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+            state.vBlocksInFlight.size() < inflight_target) {
             std::vector<const CBlockIndex *> vToDownload;
             NodeId staller = -1;
-            auto get_inflight_budget = [&state]() {
+            const CBlockIndex *stalling_block = nullptr;
+            auto get_inflight_budget = [&state, inflight_target]() {
                 return std::max(
-                    0, MAX_BLOCKS_IN_TRANSIT_PER_PEER -
+                    0, static_cast<int>(inflight_target) -
                            static_cast<int>(state.vBlocksInFlight.size()));
             };
 
@@ -9221,7 +9350,20 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
             // blocks before the background chainstate to prioritize getting to
             // network tip.
             FindNextBlocksToDownload(*peer, get_inflight_budget(), vToDownload,
-                                     staller);
+                                     staller, stalling_block);
+            // The download window is held back by a block in flight from a much
+            // slower peer, also request it from this one rather than waiting.
+            if (vToDownload.empty() && staller != -1 && stalling_block &&
+                mapBlocksInFlight.count(stalling_block->GetBlockHash()) == 1 &&
+                m_block_download_scheduler.ShouldDuplicateRequest(
+                    pto->GetId(), staller)) {
+                LogPrint(BCLog::NET,
+                         "Block %s (%d) stalled by peer=%d, also requesting it "
+                         "from peer=%d\n",
+                         stalling_block->GetBlockHash().ToString(),
+                         stalling_block->nHeight, staller, pto->GetId());
+                vToDownload.push_back(stalling_block);
+            }
             if (m_chainman.BackgroundSyncInProgress() &&
                 !IsLimitedPeer(*peer)) {
                 // If the background tip is not an ancestor of the snapshot
@@ -8,6 +8,7 @@
 
 #include <avalanche/avalanche.h>
 #include <net.h>
+#include <node/blockservecache.h>
 #include <sync.h>
 #include <validationinterface.h>
 
@@ -75,6 +76,9 @@ public:
         //! Number of non-mempool transactions to keep around for block
         //! reconstruction. Includes orphan and rejected transactions.
         uint32_t max_extra_txs{DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN};
+        //! Memory budget in bytes of the cache of blocks served to peers
+        size_t block_serve_cache_size{
+            size_t(node::DEFAULT_BLOCK_SERVE_CACHE_SIZE) << 20};
         //! Whether all P2P messages are captured to disk
         bool capture_messages{false};
         //! Number of addresses a node may send in an ADDR message.
@@ -121,6 +125,9 @@ public:
     virtual bool GetNodeStateStats(NodeId nodeid,
                                    CNodeStateStats &stats) const = 0;
 
+    /** Get statistics of the cache of blocks served to peers */
+    virtual node::BlockServeCache::Stats GetBlockServeCacheStats() const = 0;
+
     /** Whether this node ignores txs received over p2p. */
     virtual bool IgnoresIncomingTxs() = 0;
 
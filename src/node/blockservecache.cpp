@@ -0,0 +1,104 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockservecache.h>
+
+#include <core_memusage.h>
+#include <memusage.h>
+#include <net.h>
+#include <primitives/block.h>
+
+namespace node {
+
+/** Approximate memory usage of a decoded block, ignoring its header */
+static size_t BlockUsage(const CBlock &block) {
+    size_t usage{sizeof(CBlock) + memusage::DynamicUsage(block.vtx)};
+    for (const auto &tx : block.vtx) {
+        usage += RecursiveDynamicUsage(tx);
+    }
+    return usage;
+}
+
+std::shared_ptr<const SharedNetPayload>
+BlockServeCache::GetSerialized(const BlockHash &hash) {
+    LOCK(m_mutex);
+    auto it = m_serialized.find(hash);
+    if (it == m_serialized.end()) {
+        ++m_serialized_misses;
+        return nullptr;
+    }
+    ++m_serialized_hits;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->serialized;
+}
+
+void BlockServeCache::AddSerialized(
+    const BlockHash &hash, std::shared_ptr<const SharedNetPayload> payload) {
+    const size_t usage{sizeof(SharedNetPayload) +
+                       memusage::DynamicUsage(payload->data)};
+    LOCK(m_mutex);
+    AddEntry(m_serialized, Entry{.hash = hash,
+                                 .serialized = std::move(payload),
+                                 .decoded = nullptr,
+                                 .usage = usage});
+}
+
+std::shared_ptr<const CBlock>
+BlockServeCache::GetDecoded(const BlockHash &hash) {
+    LOCK(m_mutex);
+    auto it = m_decoded.find(hash);
+    if (it == m_decoded.end()) {
+        ++m_decoded_misses;
+        return nullptr;
+    }
+    ++m_decoded_hits;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->decoded;
+}
+
+void BlockServeCache::AddDecoded(const BlockHash &hash,
+                                 std::shared_ptr<const CBlock> block) {
+    const size_t usage{BlockUsage(*block)};
+    LOCK(m_mutex);
+    AddEntry(m_decoded, Entry{.hash = hash,
+                              .serialized = nullptr,
+                              .decoded = std::move(block),
+                              .usage = usage});
+}
+
+void BlockServeCache::AddEntry(EntryMap &map, Entry &&entry) {
+    AssertLockHeld(m_mutex);
+
+    // Don't let a single block flush the whole cache
+    if (entry.usage > m_max_usage / 2 || map.count(entry.hash)) {
+        return;
+    }
+
+    while (!m_entries.empty() && m_usage + entry.usage > m_max_usage) {
+        const Entry &lru = m_entries.back();
+        (lru.serialized ? m_serialized : m_decoded).erase(lru.hash);
+        m_usage -= lru.usage;
+        m_entries.pop_back();
+    }
+
+    m_usage += entry.usage;
+    m_entries.push_front(std::move(entry));
+    map.emplace(m_entries.front().hash, m_entries.begin());
+}
+
+BlockServeCache::Stats BlockServeCache::GetStats() const {
+    LOCK(m_mutex);
+    return Stats{
+        .usage = m_usage,
+        .max_usage = m_max_usage,
+        .serialized_count = m_serialized.size(),
+        .serialized_hits = m_serialized_hits,
+        .serialized_misses = m_serialized_misses,
+        .decoded_count = m_decoded.size(),
+        .decoded_hits = m_decoded_hits,
+        .decoded_misses = m_decoded_misses,
+    };
+}
+
+} // namespace node
@@ -0,0 +1,101 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKSERVECACHE_H
+#define BITCOIN_NODE_BLOCKSERVECACHE_H
+
+#include <primitives/blockhash.h>
+#include <sync.h>
+#include <util/hasher.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+class CBlock;
+struct SharedNetPayload;
+
+namespace node {
+
+/** Default for -blockservecachesize, in MiB */
+static constexpr int64_t DEFAULT_BLOCK_SERVE_CACHE_SIZE{64};
+/** Maximum for -blockservecachesize, in MiB */
+static constexpr int64_t MAX_BLOCK_SERVE_CACHE_SIZE{4096};
+
+/**
+ * Cache of the blocks we serve to our peers, shared by all of them.
+ *
+ * When several peers sync from us at the same time they request the same
+ * blocks at about the same time. Keeping the recently served blocks avoids
+ * reading them from disk, and for the decoded blocks checking them again,
+ * for each peer.
+ *
+ * Blocks are cached both serialized, as sent in block messages, and decoded,
+ * as needed to build compact and merkle blocks. Both share the same memory
+ * budget and are evicted in least recently used order. Entries are refcounted
+ * so an evicted block stays alive as long as a peer still has it in its send
+ * queue.
+ */
+class BlockServeCache {
+public:
+    struct Stats {
+        size_t usage;
+        size_t max_usage;
+        size_t serialized_count;
+        uint64_t serialized_hits;
+        uint64_t serialized_misses;
+        size_t decoded_count;
+        uint64_t decoded_hits;
+        uint64_t decoded_misses;
+    };
+
+    explicit BlockServeCache(size_t max_usage) : m_max_usage{max_usage} {}
+
+    std::shared_ptr<const SharedNetPayload>
+    GetSerialized(const BlockHash &hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void AddSerialized(const BlockHash &hash,
+                       std::shared_ptr<const SharedNetPayload> payload)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    std::shared_ptr<const CBlock> GetDecoded(const BlockHash &hash)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void AddDecoded(const BlockHash &hash, std::shared_ptr<const CBlock> block)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    Stats GetStats() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Entry {
+        BlockHash hash;
+        /** Exactly one of them is set */
+        std::shared_ptr<const SharedNetPayload> serialized;
+        std::shared_ptr<const CBlock> decoded;
+        size_t usage;
+    };
+    /** Most recently used first */
+    using EntryList = std::list<Entry>;
+    using EntryMap =
+        std::unordered_map<BlockHash, EntryList::iterator, SaltedBlockHashHasher>;
+
+    /** Insert a new entry, evicting the least recently used ones */
+    void AddEntry(EntryMap &map, Entry &&entry)
+        EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    mutable Mutex m_mutex;
+    const size_t m_max_usage;
+    size_t m_usage GUARDED_BY(m_mutex){0};
+    EntryList m_entries GUARDED_BY(m_mutex);
+    EntryMap m_serialized GUARDED_BY(m_mutex);
+    EntryMap m_decoded GUARDED_BY(m_mutex);
+    uint64_t m_serialized_hits GUARDED_BY(m_mutex){0};
+    uint64_t m_serialized_misses GUARDED_BY(m_mutex){0};
+    uint64_t m_decoded_hits GUARDED_BY(m_mutex){0};
+    uint64_t m_decoded_misses GUARDED_BY(m_mutex){0};
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCKSERVECACHE_H
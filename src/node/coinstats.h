@@ -15,6 +15,7 @@
 #include <streams.h>
 #include <uint256.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <optional>
@@ -30,12 +31,15 @@ namespace node {
  *
  * @param[in] index_requested Signals if the coinstatsindex should be used (when
  * available).
+ * @param[in] num_threads Number of threads reading the coins when the
+ * statistics are computed from the view.
  */
 std::optional<kernel::CCoinsStats>
 GetUTXOStats(CCoinsView *view, node::BlockManager &blockman,
              kernel::CoinStatsHashType hash_type,
              const std::function<void()> &interruption_point = {},
-             const CBlockIndex *pindex = nullptr, bool index_requested = true);
+             const CBlockIndex *pindex = nullptr, bool index_requested = true,
+             size_t num_threads = 1);
 } // namespace node
 
 #endif // BITCOIN_NODE_COINSTATS_H
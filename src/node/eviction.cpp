@@ -321,6 +321,30 @@ SelectNodeToEvict(std::vector<NodeEvictionCandidate> &&vEvictionCandidates) {
             vEvictionCandidates.end());
     }
 
+    // If any remaining peers recently made us spend much more time processing
+    // their messages than the others consider only them, so a peer eating our
+    // message handler threads is shed first.
+    std::chrono::microseconds total_processing_time{0};
+    for (const NodeEvictionCandidate &node : vEvictionCandidates) {
+        total_processing_time += node.m_recent_msg_processing_time;
+    }
+    const auto is_expensive = [&](NodeEvictionCandidate const &n) {
+        return n.m_recent_msg_processing_time >= EXPENSIVE_PEER_MIN_TIME &&
+               n.m_recent_msg_processing_time *
+                       int64_t(vEvictionCandidates.size()) >
+                   total_processing_time * EXPENSIVE_PEER_FACTOR;
+    };
+    if (std::any_of(vEvictionCandidates.begin(), vEvictionCandidates.end(),
+                    is_expensive)) {
+        vEvictionCandidates.erase(
+            std::remove_if(vEvictionCandidates.begin(),
+                           vEvictionCandidates.end(),
+                           [&](NodeEvictionCandidate const &n) {
+                               return !is_expensive(n);
+                           }),
+            vEvictionCandidates.end());
+    }
+
     // Identify the network group with the most connections and youngest member.
     // (vEvictionCandidates is already sorted by reverse connect time)
     uint64_t naMostConnections;
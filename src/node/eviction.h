@@ -15,6 +15,16 @@
 
 typedef int64_t NodeId;
 
+/**
+ * An eviction candidate is considered expensive if the recent time spent
+ * processing its messages is over EXPENSIVE_PEER_FACTOR times the average of
+ * the remaining candidates, and at least EXPENSIVE_PEER_MIN_TIME. The time
+ * spent serving the data it requested doesn't count.
+ */
+static constexpr int64_t EXPENSIVE_PEER_FACTOR{4};
+static constexpr std::chrono::microseconds EXPENSIVE_PEER_MIN_TIME{
+    std::chrono::seconds{10}};
+
 struct NodeEvictionCandidate {
     NodeId id;
     std::chrono::seconds m_connected;
@@ -32,6 +42,7 @@ struct NodeEvictionCandidate {
     bool m_noban;
     ConnectionType m_conn_type;
     double availabilityScore;
+    std::chrono::microseconds m_recent_msg_processing_time;
 };
 
 /**
@@ -2,6 +2,7 @@
 
 #include <common/args.h>
 #include <net_processing.h>
+#include <node/blockservecache.h>
 
 #include <algorithm>
 #include <limits>
@@ -20,6 +21,12 @@ void ApplyArgsManOptions(const ArgsManager &argsman,
             *value, 0, std::numeric_limits<uint32_t>::max()));
     }
 
+    if (auto value{argsman.GetIntArg("-blockservecachesize")}) {
+        options.block_serve_cache_size =
+            size_t(std::clamp<int64_t>(*value, 0, MAX_BLOCK_SERVE_CACHE_SIZE))
+            << 20;
+    }
+
     if (auto value{argsman.GetBoolArg("-capturemessages")}) {
         options.capture_messages = *value;
     }
@@ -9,11 +9,13 @@
 #include <core_io.h>
 #include <httpserver.h>
 #include <index/txindex.h>
+#include <logging.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <rpc/mempool.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
@@ -23,10 +25,18 @@
 #include <txmempool.h>
 #include <util/any.h>
 #include <validation.h>
+#include <validationinterface.h>
 
 #include <univalue.h>
 
+#include <algorithm>
 #include <any>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
 
 using node::GetTransaction;
 using node::NodeContext;
@@ -34,6 +44,15 @@ using util::SplitString;
 
 // Allow a max of 15 outpoints to be queried at once.
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15;
+// Allow a max of 1000 blocks to be fetched at once.
+static const long MAX_REST_BLOCKS_COUNT = 1000;
+// Allow a max of 10000 transactions to be fetched at once.
+static const size_t MAX_REST_TXS = 10000;
+// Allow a max of 10000 clients to be subscribed to events at once.
+static const size_t MAX_REST_EVENT_SUBSCRIBERS = 10000;
+// Send a comment to the event subscribers every 15 seconds, so proxies and
+// clients can tell an idle stream from a dead one.
+static const int REST_EVENT_KEEPALIVE_SECONDS = 15;
 
 enum class RetFormat {
     UNDEF,
@@ -73,6 +92,115 @@ static bool RESTERR(HTTPRequest *req, enum HTTPStatusCode status,
     return false;
 }
 
+/** Hex encode data followed by a newline, like the hex replies are */
+static std::string HexReply(Span<const std::byte> data) {
+    std::string reply(data.size() * 2 + 1, '\n');
+    HexEncode(data, Span{reply}.first(data.size() * 2));
+    return reply;
+}
+
+/**
+ * Send a JSON reply while it is written by write_json, so it doesn't need to
+ * be held in memory as a whole.
+ */
+template <typename Callable>
+static bool WriteJSONStream(HTTPRequest *req, Callable &&write_json) {
+    req->WriteHeader("Content-Type", "application/json");
+    req->StartChunkedReply(HTTP_OK);
+    try {
+        JSONStreamWriter writer{[req](std::string_view chunk) {
+            if (!req->WriteReplyChunk(chunk)) {
+                throw std::runtime_error("connection closed");
+            }
+        }};
+        write_json(writer);
+        writer.Finish();
+    } catch (const std::exception &e) {
+        // The status was sent already, so the client can only notice the
+        // reply is truncated
+        LogPrint(BCLog::HTTP, "REST reply was not completed: %s\n", e.what());
+    }
+    req->EndChunkedReply();
+    return true;
+}
+
+/**
+ * Send a binary or hex reply while it is serialized, so it doesn't need to be
+ * held in memory as a whole. The reply is started on construction, so any
+ * error must be reported before.
+ */
+class BinaryReplyStream {
+public:
+    static constexpr size_t CHUNK_SIZE{256 * 1024};
+
+    BinaryReplyStream(HTTPRequest *req, RetFormat rf)
+        : m_req{req}, m_hex{rf == RetFormat::HEX} {
+        m_req->WriteHeader("Content-Type",
+                           m_hex ? "text/plain" : "application/octet-stream");
+        m_req->StartChunkedReply(HTTP_OK);
+    }
+
+    /**
+     * Serialize obj into the reply. Returns false if the connection was
+     * closed, in which case the rest of the reply can be skipped.
+     */
+    template <typename T> bool Write(const T &obj) {
+        m_stream << obj;
+        return m_stream.size() < CHUNK_SIZE || Flush();
+    }
+
+    /** Append data which is serialized already */
+    bool WriteRaw(Span<const std::byte> data) {
+        if (m_stream.size() + data.size() < CHUNK_SIZE) {
+            m_stream.write(data);
+            return true;
+        }
+        // Send large data as is rather than copying it into the buffer
+        return Flush() && Send(data);
+    }
+
+    /** Send the pending data and complete the reply */
+    void Finish() {
+        if (Flush() && m_hex) {
+            m_req->WriteReplyChunk("\n");
+        }
+        m_req->EndChunkedReply();
+    }
+
+private:
+    bool Flush() {
+        if (m_stream.empty()) {
+            return true;
+        }
+        const bool sent{Send(m_stream)};
+        m_stream.clear();
+        return sent;
+    }
+
+    bool Send(Span<const std::byte> data) {
+        if (!m_hex) {
+            return m_req->WriteReplyChunk(
+                {reinterpret_cast<const char *>(data.data()), data.size()});
+        }
+        // Encode large data piecewise, into the same buffer every time
+        while (!data.empty()) {
+            const size_t size{std::min(data.size(), CHUNK_SIZE)};
+            m_hex_buffer.resize(size * 2);
+            HexEncode(data.first(size), m_hex_buffer);
+            if (!m_req->WriteReplyChunk(m_hex_buffer)) {
+                return false;
+            }
+            data = data.subspan(size);
+        }
+        return true;
+    }
+
+    HTTPRequest *const m_req;
+    const bool m_hex;
+    DataStream m_stream{};
+    std::string m_hex_buffer;
+};
+
 /**
  * Get the node context.
  *
@@ -251,7 +379,7 @@ static bool rest_headers(Config &config, const std::any &context,
                     ssHeader << header->GetBlockHeader(chainman.m_blockman);
                 }
 
-                std::string strHex = HexStr(ssHeader) + "\n";
+                std::string strHex = HexReply(ssHeader);
                 req->WriteHeader("Content-Type", "text/plain");
                 req->WriteReply(HTTP_OK, strHex);
                 return true;
@@ -331,21 +459,19 @@ static bool rest_block(const Config &config, const std::any &context,
         }
 
         case RetFormat::HEX: {
-            DataStream ssBlock{};
-            ssBlock << block;
-            std::string strHex = HexStr(ssBlock) + "\n";
-            req->WriteHeader("Content-Type", "text/plain");
-            req->WriteReply(HTTP_OK, strHex);
+            // Encode the block piecewise rather than building a string twice
+            // its size
+            BinaryReplyStream stream{req, rf};
+            stream.Write(block);
+            stream.Finish();
             return true;
         }
 
         case RetFormat::JSON: {
-            UniValue objBlock = blockToJSON(chainman.m_blockman, block, *tip,
-                                            *pblockindex, tx_verbosity);
-            std::string strJSON = objBlock.write() + "\n";
-            req->WriteHeader("Content-Type", "application/json");
-            req->WriteReply(HTTP_OK, strJSON);
-            return true;
+            return WriteJSONStream(req, [&](JSONStreamWriter &writer) {
+                blockToJSON(chainman.m_blockman, block, *tip, *pblockindex,
+                            tx_verbosity, writer);
+            });
         }
 
         default: {
@@ -369,6 +495,82 @@ static bool rest_block_notxdetails(Config &config, const std::any &context,
     return rest_block(config, context, req, strURIPart, TxVerbosity::SHOW_TXID);
 }
 
+static bool rest_blocks(Config &config, const std::any &context,
+                        HTTPRequest *req, const std::string &strURIPart) {
+    if (!CheckWarmup(req)) {
+        return false;
+    }
+
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    if (rf != RetFormat::BINARY && rf != RetFormat::HEX) {
+        return RESTERR(req, HTTP_NOT_FOUND,
+                       "output format not found (available: .bin, .hex)");
+    }
+
+    std::vector<std::string> path = SplitString(param, '/');
+    if (path.size() != 2) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "No block count specified. Use "
+                       "/rest/blocks/<height>/<count>.<ext>.");
+    }
+
+    int32_t height;
+    if (!ParseInt32(path[0], &height) || height < 0) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Invalid height: " + SanitizeString(path[0]));
+    }
+    long count = strtol(path[1].c_str(), nullptr, 10);
+    if (count < 1 || count > MAX_REST_BLOCKS_COUNT) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Block count out of range: " + SanitizeString(path[1]));
+    }
+
+    ChainstateManager *maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) {
+        return false;
+    }
+    ChainstateManager &chainman = *maybe_chainman;
+
+    // Only the positions of the blocks are looked up under the lock, the
+    // blocks are read from disk while the reply is being sent.
+    std::vector<FlatFilePos> positions;
+    {
+        LOCK(cs_main);
+        const CChain &active_chain = chainman.ActiveChain();
+        if (height > active_chain.Height()) {
+            return RESTERR(req, HTTP_NOT_FOUND, "Block height out of range");
+        }
+        const int end_height{
+            int(std::min<long>(active_chain.Height() + 1, height + count))};
+        positions.reserve(end_height - height);
+        for (int h = height; h < end_height; ++h) {
+            const CBlockIndex &index{*active_chain[h]};
+            if (chainman.m_blockman.IsBlockPruned(index)) {
+                return RESTERR(req, HTTP_NOT_FOUND,
+                               strprintf("Block at height %d not available "
+                                         "(pruned data)",
+                                         h));
+            }
+            positions.push_back(index.GetBlockPos());
+        }
+    }
+
+    BinaryReplyStream stream{req, rf};
+    std::vector<uint8_t> block;
+    for (const FlatFilePos &pos : positions) {
+        // The blocks are sent as stored, without deserializing them. If one
+        // went missing in the meantime, the client can only notice the reply
+        // is truncated.
+        if (!chainman.m_blockman.ReadRawBlock(block, pos) ||
+            !stream.WriteRaw(MakeByteSpan(block))) {
+            break;
+        }
+    }
+    stream.Finish();
+    return true;
+}
+
 static bool rest_chaininfo(Config &config, const std::any &context,
                            HTTPRequest *req, const std::string &strURIPart) {
     if (!CheckWarmup(req)) {
@@ -444,12 +646,9 @@ static bool rest_mempool_contents(Config &config, const std::any &context,
 
     switch (rf) {
         case RetFormat::JSON: {
-            UniValue mempoolObject = MempoolToJSON(*mempool, true);
-
-            std::string strJSON = mempoolObject.write() + "\n";
-            req->WriteHeader("Content-Type", "application/json");
-            req->WriteReply(HTTP_OK, strJSON);
-            return true;
+            return WriteJSONStream(req, [&](JSONStreamWriter &writer) {
+                MempoolToJSON(*mempool, writer);
+            });
         }
         default: {
             return RESTERR(req, HTTP_NOT_FOUND,
@@ -505,7 +704,7 @@ static bool rest_tx(Config &config, const std::any &context, HTTPRequest *req,
             DataStream ssTx{};
             ssTx << tx;
 
-            std::string strHex = HexStr(ssTx) + "\n";
+            std::string strHex = HexReply(ssTx);
             req->WriteHeader("Content-Type", "text/plain");
             req->WriteReply(HTTP_OK, strHex);
             return true;
@@ -528,6 +727,85 @@ static bool rest_tx(Config &config, const std::any &context, HTTPRequest *req,
     }
 }
 
+static bool rest_txs(Config &config, const std::any &context, HTTPRequest *req,
+                     const std::string &strURIPart) {
+    if (!CheckWarmup(req)) {
+        return false;
+    }
+
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    if (!param.empty()) {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Invalid URI. Use /rest/txs.<ext> and post the txids.");
+    }
+
+    std::string body = req->ReadBody();
+    if (body.empty()) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Error: empty request");
+    }
+    switch (rf) {
+        case RetFormat::HEX: {
+            if (!IsHex(util::TrimStringView(body))) {
+                return RESTERR(req, HTTP_BAD_REQUEST, "Parse error");
+            }
+            std::vector<uint8_t> data = ParseHex(body);
+            body.assign(data.begin(), data.end());
+            break;
+        }
+        case RetFormat::BINARY:
+            break;
+        default: {
+            return RESTERR(req, HTTP_NOT_FOUND,
+                           "output format not found (available: .bin, .hex)");
+        }
+    }
+
+    std::vector<TxId> txids;
+    try {
+        SpanReader{MakeUCharSpan(body)} >> txids;
+    } catch (const std::ios_base::failure &) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Parse error");
+    }
+    if (txids.empty()) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Error: empty request");
+    }
+    if (txids.size() > MAX_REST_TXS) {
+        return RESTERR(
+            req, HTTP_BAD_REQUEST,
+            strprintf("Error: max transactions exceeded (max: %d, tried: %d)",
+                      MAX_REST_TXS, txids.size()));
+    }
+
+    if (g_txindex) {
+        g_txindex->BlockUntilSyncedToCurrentChain();
+    }
+
+    const NodeContext *const node = GetNodeContext(context, req);
+    if (!node) {
+        return false;
+    }
+
+    // Each transaction is serialized as a byte vector, so a client can skip
+    // it without parsing it. An empty one stands for a transaction not found.
+    BinaryReplyStream stream{req, rf};
+    for (const TxId &txid : txids) {
+        BlockHash hashBlock;
+        const CTransactionRef tx =
+            GetTransaction(/* block_index */ nullptr, node->mempool.get(),
+                           txid, hashBlock, node->chainman->m_blockman);
+        std::vector<uint8_t> tx_data;
+        if (tx) {
+            VectorWriter{tx_data, 0} << tx;
+        }
+        if (!stream.Write(tx_data)) {
+            break;
+        }
+    }
+    stream.Finish();
+    return true;
+}
+
 static bool rest_getutxos(Config &config, const std::any &context,
                           HTTPRequest *req, const std::string &strURIPart) {
     if (!CheckWarmup(req)) {
@@ -712,7 +990,7 @@ static bool rest_getutxos(Config &config, const std::any &context,
         case RetFormat::HEX: {
             DataStream ssGetUTXOResponse{};
             ssGetUTXOResponse << active_height << active_hash << bitmap << outs;
-            std::string strHex = HexStr(ssGetUTXOResponse) + "\n";
+            std::string strHex = HexReply(ssGetUTXOResponse);
 
             req->WriteHeader("Content-Type", "text/plain");
             req->WriteReply(HTTP_OK, strHex);
@@ -814,14 +1092,266 @@ static bool rest_blockhash_by_height(Config &config, const std::any &context,
     }
 }
 
+static const uint32_t REST_EVENT_TIP = 1 << 0;
+static const uint32_t REST_EVENT_MEMPOOL = 1 << 1;
+static const uint32_t REST_EVENT_FINALIZATION = 1 << 2;
+
+static const struct {
+    uint32_t topic;
+    const char *name;
+} rest_event_topics[] = {
+    {REST_EVENT_TIP, "tip"},
+    {REST_EVENT_MEMPOOL, "mempool"},
+    {REST_EVENT_FINALIZATION, "finalization"},
+};
+
+/**
+ * Publish the validation events to the /rest/events subscribers as
+ * server-sent events. The subscribers are only accessed from the main http
+ * thread, so an idle subscriber holds a connection but no thread.
+ */
+class RESTEventNotifier final
+    : public CValidationInterface,
+      public std::enable_shared_from_this<RESTEventNotifier> {
+public:
+    /** Add a subscriber to the given topics, from the main http thread */
+    void Subscribe(std::shared_ptr<HTTPEventStream> stream, uint32_t topics);
+
+    /** Stop publishing events and close the streams of all the subscribers */
+    void Stop();
+
+    size_t NumSubscribers() const { return m_num_subscribers.load(); }
+
+protected:
+    void UpdatedBlockTip(const CBlockIndex *pindexNew,
+                         const CBlockIndex *pindexFork,
+                         bool fInitialDownload) override;
+    void TransactionAddedToMempool(
+        const CTransactionRef &tx,
+        std::shared_ptr<const std::vector<Coin>> spent_coins,
+        uint64_t mempool_sequence) override;
+    void TransactionRemovedFromMempool(const CTransactionRef &tx,
+                                       MemPoolRemovalReason reason,
+                                       uint64_t mempool_sequence) override;
+    void BlockFinalized(const CBlockIndex *pindex) override;
+    void TransactionFinalized(const CTransactionRef &tx) override;
+
+private:
+    struct Subscriber {
+        std::shared_ptr<HTTPEventStream> stream;
+        uint32_t topics;
+    };
+
+    /** Hand an event over to the main http thread, from any thread */
+    void Publish(uint32_t topic, const std::string &name, const UniValue &data);
+    /** Send an event to the subscribers of its topic */
+    void Broadcast(uint32_t topic, const std::string &event);
+    void RemoveClosedSubscribers();
+    /** Arm the timer sending a comment to all the subscribers */
+    void ScheduleKeepAlive();
+
+    Mutex m_mutex;
+    //! Once set, no more event is handed over to the main http thread
+    bool m_stopped GUARDED_BY(m_mutex){false};
+    //! Lets the validation callbacks skip formatting events for no one
+    std::atomic<size_t> m_num_subscribers{0};
+
+    //! Only accessed from the main http thread
+    std::vector<Subscriber> m_subscribers;
+    std::unique_ptr<HTTPEvent> m_keepalive_timer;
+};
+
+void RESTEventNotifier::Subscribe(std::shared_ptr<HTTPEventStream> stream,
+                                  uint32_t topics) {
+    if (WITH_LOCK(m_mutex, return m_stopped)) {
+        // The stream is closed when released
+        return;
+    }
+    // Let the client know it won't miss any event from now on
+    stream->Send(": subscribed\n\n");
+    m_subscribers.push_back({std::move(stream), topics});
+    m_num_subscribers = m_subscribers.size();
+
+    if (!m_keepalive_timer) {
+        m_keepalive_timer =
+            std::make_unique<HTTPEvent>(EventBase(), false, [this] {
+                Broadcast(~uint32_t{0}, ":\n\n");
+                ScheduleKeepAlive();
+            });
+        ScheduleKeepAlive();
+    }
+}
+
+void RESTEventNotifier::ScheduleKeepAlive() {
+    struct timeval tv = {REST_EVENT_KEEPALIVE_SECONDS, 0};
+    m_keepalive_timer->trigger(&tv);
+}
+
+void RESTEventNotifier::Stop() {
+    LOCK(m_mutex);
+    if (m_stopped) {
+        return;
+    }
+    m_stopped = true;
+    // The http server doesn't stop until the streams are closed
+    HTTPEvent *ev =
+        new HTTPEvent(EventBase(), true, [self = shared_from_this()] {
+            self->m_subscribers.clear();
+            self->m_num_subscribers = 0;
+            self->m_keepalive_timer.reset();
+        });
+    ev->trigger(nullptr);
+}
+
+void RESTEventNotifier::Publish(uint32_t topic, const std::string &name,
+                                const UniValue &data) {
+    if (m_num_subscribers == 0) {
+        return;
+    }
+    std::string event{strprintf("event: %s\ndata: %s\n\n", name, data.write())};
+
+    LOCK(m_mutex);
+    if (m_stopped) {
+        return;
+    }
+    HTTPEvent *ev = new HTTPEvent(
+        EventBase(), true,
+        [self = shared_from_this(), topic, event = std::move(event)] {
+            self->Broadcast(topic, event);
+        });
+    ev->trigger(nullptr);
+}
+
+void RESTEventNotifier::Broadcast(uint32_t topic, const std::string &event) {
+    for (const Subscriber &subscriber : m_subscribers) {
+        if (subscriber.topics & topic) {
+            subscriber.stream->Send(event);
+        }
+    }
+    RemoveClosedSubscribers();
+}
+
+void RESTEventNotifier::RemoveClosedSubscribers() {
+    m_subscribers.erase(std::remove_if(m_subscribers.begin(),
+                                       m_subscribers.end(),
+                                       [](const Subscriber &subscriber) {
+                                           return subscriber.stream->IsClosed();
+                                       }),
+                        m_subscribers.end());
+    m_num_subscribers = m_subscribers.size();
+}
+
+void RESTEventNotifier::UpdatedBlockTip(const CBlockIndex *pindexNew,
+                                        const CBlockIndex *pindexFork,
+                                        bool fInitialDownload) {
+    // In IBD or blocks were disconnected without any new ones
+    if (fInitialDownload || pindexNew == pindexFork) {
+        return;
+    }
+    UniValue data(UniValue::VOBJ);
+    data.pushKV("hash", pindexNew->GetBlockHash().GetHex());
+    data.pushKV("height", pindexNew->nHeight);
+    data.pushKV("time", pindexNew->GetBlockTime());
+    Publish(REST_EVENT_TIP, "tip", data);
+}
+
+void RESTEventNotifier::TransactionAddedToMempool(
+    const CTransactionRef &tx,
+    std::shared_ptr<const std::vector<Coin>> spent_coins,
+    uint64_t mempool_sequence) {
+    UniValue data(UniValue::VOBJ);
+    data.pushKV("txid", tx->GetId().GetHex());
+    data.pushKV("size", tx->GetTotalSize());
+    data.pushKV("sequence", mempool_sequence);
+    Publish(REST_EVENT_MEMPOOL, "mempooladd", data);
+}
+
+void RESTEventNotifier::TransactionRemovedFromMempool(
+    const CTransactionRef &tx, MemPoolRemovalReason reason,
+    uint64_t mempool_sequence) {
+    UniValue data(UniValue::VOBJ);
+    data.pushKV("txid", tx->GetId().GetHex());
+    data.pushKV("reason", RemovalReasonToString(reason));
+    data.pushKV("sequence", mempool_sequence);
+    Publish(REST_EVENT_MEMPOOL, "mempoolremove", data);
+}
+
+void RESTEventNotifier::BlockFinalized(const CBlockIndex *pindex) {
+    UniValue data(UniValue::VOBJ);
+    data.pushKV("hash", pindex->GetBlockHash().GetHex());
+    data.pushKV("height", pindex->nHeight);
+    Publish(REST_EVENT_FINALIZATION, "blockfinalized", data);
+}
+
+void RESTEventNotifier::TransactionFinalized(const CTransactionRef &tx) {
+    UniValue data(UniValue::VOBJ);
+    data.pushKV("txid", tx->GetId().GetHex());
+    Publish(REST_EVENT_FINALIZATION, "txfinalized", data);
+}
+
+static std::shared_ptr<RESTEventNotifier> g_rest_event_notifier;
+
+static bool rest_events(const std::shared_ptr<RESTEventNotifier> &notifier,
+                        HTTPRequest *req, const std::string &strURIPart) {
+    if (!CheckWarmup(req)) {
+        return false;
+    }
+
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    if (rf != RetFormat::JSON) {
+        return RESTERR(req, HTTP_NOT_FOUND,
+                       "output format not found (available: json)");
+    }
+
+    // All the topics, or /<topic>[,<topic>...] to select some
+    uint32_t topics{0};
+    if (param.empty()) {
+        for (const auto &topic : rest_event_topics) {
+            topics |= topic.topic;
+        }
+    } else if (param[0] == '/') {
+        for (const std::string &name : SplitString(param.substr(1), ',')) {
+            auto it = std::find_if(
+                std::begin(rest_event_topics), std::end(rest_event_topics),
+                [&](const auto &topic) { return name == topic.name; });
+            if (it == std::end(rest_event_topics)) {
+                return RESTERR(req, HTTP_BAD_REQUEST,
+                               "Invalid topic: " + SanitizeString(name));
+            }
+            topics |= it->topic;
+        }
+    } else {
+        return RESTERR(req, HTTP_BAD_REQUEST,
+                       "Invalid URI format. Expected "
+                       "/rest/events[/<topic>,...].json");
+    }
+
+    if (notifier->NumSubscribers() >= MAX_REST_EVENT_SUBSCRIBERS) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE,
+                       "Too many event subscribers");
+    }
+
+    req->WriteHeader("Content-Type", "text/event-stream");
+    req->WriteHeader("Cache-Control", "no-cache");
+    req->StartEventStream(
+        HTTP_OK,
+        [notifier, topics](std::shared_ptr<HTTPEventStream> stream) {
+            notifier->Subscribe(std::move(stream), topics);
+        });
+    return true;
+}
+
 static const struct {
     const char *prefix;
     bool (*handler)(Config &config, const std::any &context, HTTPRequest *req,
                     const std::string &strReq);
 } uri_prefixes[] = {
     {"/rest/tx/", rest_tx},
+    {"/rest/txs", rest_txs},
     {"/rest/block/notxdetails/", rest_block_notxdetails},
     {"/rest/block/", rest_block_extended},
+    {"/rest/blocks/", rest_blocks},
     {"/rest/chaininfo", rest_chaininfo},
     {"/rest/mempool/info", rest_mempool_info},
     {"/rest/mempool/contents", rest_mempool_contents},
@@ -838,6 +1368,15 @@ void StartREST(const std::any &context) {
         };
         RegisterHTTPHandler(up.prefix, false, handler);
     }
+
+    g_rest_event_notifier = std::make_shared<RESTEventNotifier>();
+    RegisterSharedValidationInterface(g_rest_event_notifier);
+    RegisterHTTPHandler("/rest/events", false,
+                        [notifier = g_rest_event_notifier](
+                            Config &config, HTTPRequest *req,
+                            const std::string &prefix) {
+                            return rest_events(notifier, req, prefix);
+                        });
 }
 
 void InterruptREST() {}
@@ -846,4 +1385,11 @@ void StopREST() {
     for (const auto &up : uri_prefixes) {
         UnregisterHTTPHandler(up.prefix, false);
     }
+
+    if (g_rest_event_notifier) {
+        UnregisterHTTPHandler("/rest/events", false);
+        UnregisterSharedValidationInterface(g_rest_event_notifier);
+        g_rest_event_notifier->Stop();
+        g_rest_event_notifier.reset();
+    }
 }
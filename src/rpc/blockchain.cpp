@@ -12,6 +12,7 @@
 #include <clientversion.h>
 #include <coins.h>
 #include <common/args.h>
+#include <common/system.h>
 #include <config.h>
 #include <consensus/amount.h>
 #include <consensus/params.h>
@@ -28,6 +29,7 @@
 #include <node/context.h>
 #include <node/utxo_snapshot.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
@@ -39,6 +41,7 @@
 #include <undo.h>
 #include <util/check.h>
 #include <util/fs.h>
+#include <util/parallel.h>
 #include <util/strencodings.h>
 #include <util/string.h>
 #include <util/translation.h>
@@ -46,6 +49,8 @@
 #include <validationinterface.h>
 #include <warnings.h>
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <memory>
@@ -70,6 +75,14 @@ static GlobalMutex cs_blockchange;
 static std::condition_variable cond_blockchange;
 static CUpdatedBlock latestblock GUARDED_BY(cs_blockchange);
 
+//! Maximum number of threads reading the UTXO set for gettxoutsetinfo and
+//! scantxoutset
+static constexpr int MAX_UTXO_SCAN_THREADS{8};
+
+static size_t GetUTXOScanThreads() {
+    return std::clamp(GetNumCores(), 1, MAX_UTXO_SCAN_THREADS);
+}
+
 std::tuple<std::unique_ptr<CCoinsViewCursor>, CCoinsStats, const CBlockIndex *>
 PrepareUTXOSnapshot(Chainstate &chainstate,
                     const std::function<void()> &interruption_point = {})
@@ -178,17 +191,15 @@ UniValue blockheaderToJSON(const CBlockIndex &tip,
     return result;
 }
 
-UniValue blockToJSON(BlockManager &blockman, const CBlock &block,
-                     const CBlockIndex &tip, const CBlockIndex &blockindex,
-                     TxVerbosity verbosity) {
-    UniValue result = blockheaderToJSON(tip, blockindex);
-
-    result.pushKV("size", (int)::GetSerializeSize(block));
-    UniValue txs(UniValue::VARR);
+/** Call fn with the description of each transaction of the block */
+template <typename Callable>
+static void ForEachBlockTxToJSON(BlockManager &blockman, const CBlock &block,
+                                 const CBlockIndex &blockindex,
+                                 TxVerbosity verbosity, Callable &&fn) {
     switch (verbosity) {
         case TxVerbosity::SHOW_TXID:
             for (const CTransactionRef &tx : block.vtx) {
-                txs.push_back(tx->GetId().GetHex());
+                fn(UniValue{tx->GetId().GetHex()});
             }
             break;
 
@@ -207,16 +218,46 @@ UniValue blockToJSON(BlockManager &blockman, const CBlock &block,
                                             : nullptr;
                 UniValue objTx(UniValue::VOBJ);
                 TxToUniv(*tx, BlockHash(), objTx, true, txundo, verbosity);
-                txs.push_back(std::move(objTx));
+                fn(std::move(objTx));
             }
             break;
     }
+}
+
+UniValue blockToJSON(BlockManager &blockman, const CBlock &block,
+                     const CBlockIndex &tip, const CBlockIndex &blockindex,
+                     TxVerbosity verbosity) {
+    UniValue result = blockheaderToJSON(tip, blockindex);
+
+    result.pushKV("size", (int)::GetSerializeSize(block));
+    UniValue txs(UniValue::VARR);
+    txs.reserve(block.vtx.size());
+    ForEachBlockTxToJSON(
+        blockman, block, blockindex, verbosity,
+        [&](UniValue &&tx) { txs.push_back(std::move(tx)); });
 
     result.pushKV("tx", std::move(txs));
 
     return result;
 }
 
+void blockToJSON(BlockManager &blockman, const CBlock &block,
+                 const CBlockIndex &tip, const CBlockIndex &blockindex,
+                 TxVerbosity verbosity, JSONStreamWriter &writer) {
+    writer.BeginObject();
+    writer.Members(blockheaderToJSON(tip, blockindex));
+
+    writer.Key("size");
+    writer.Value((int)::GetSerializeSize(block));
+    writer.Key("tx");
+    writer.BeginArray();
+    ForEachBlockTxToJSON(blockman, block, blockindex, verbosity,
+                         [&](UniValue &&tx) { writer.Value(tx); });
+    writer.EndArray();
+
+    writer.EndObject();
+}
+
 static RPCHelpMan getblockcount() {
     return RPCHelpMan{
         "getblockcount",
@@ -830,6 +871,14 @@ static RPCHelpMan getblock() {
             if (verbosity <= 0) {
                 DataStream ssBlock{};
                 ssBlock << block;
+                // Encode the hex right into the reply rather than building a
+                // string twice the size of the block
+                if (request.CanStreamResult()) {
+                    request.StreamResult([&](JSONStreamWriter &writer) {
+                        writer.HexValue(MakeUCharSpan(ssBlock));
+                    });
+                    return NullUniValue;
+                }
                 std::string strHex = HexStr(ssBlock);
                 return strHex;
             }
@@ -843,6 +892,17 @@ static RPCHelpMan getblock() {
                 tx_verbosity = TxVerbosity::SHOW_DETAILS_AND_PREVOUT;
             }
 
+            // With the details, the result can be several times the size of
+            // the block
+            if (tx_verbosity != TxVerbosity::SHOW_TXID &&
+                request.CanStreamResult()) {
+                request.StreamResult([&](JSONStreamWriter &writer) {
+                    blockToJSON(chainman.m_blockman, block, *tip, *pblockindex,
+                                tx_verbosity, writer);
+                });
+                return NullUniValue;
+            }
+
             return blockToJSON(chainman.m_blockman, block, *tip, *pblockindex,
                                tx_verbosity);
         },
@@ -1130,7 +1190,7 @@ static RPCHelpMan gettxoutsetinfo() {
 
             const std::optional<CCoinsStats> maybe_stats = GetUTXOStats(
                 coins_view, *blockman, hash_type, node.rpc_interruption_point,
-                pindex, index_requested);
+                pindex, index_requested, GetUTXOScanThreads());
             if (maybe_stats.has_value()) {
                 const CCoinsStats &stats = maybe_stats.value();
                 ret.pushKV("height", int64_t(stats.nHeight));
@@ -2024,10 +2084,228 @@ static inline bool SetHasKeys(const std::set<T> &set, const Tk &key,
     return (set.count(key) != 0) || SetHasKeys(set, args...);
 }
 
+//! Maximum number of threads reading blocks for getblockstatsrange
+static constexpr int MAX_BLOCK_STATS_THREADS{8};
+
 // outpoint (needed for the utxo index) + nHeight + fCoinBase
 static constexpr size_t PER_UTXO_OVERHEAD =
     sizeof(COutPoint) + sizeof(uint32_t) + sizeof(bool);
 
+/** The statistics returned by getblockstats and getblockstatsrange */
+static std::vector<RPCResult> BlockStatsResults() {
+    const auto &ticker = Currency::get().ticker;
+    return {
+        {RPCResult::Type::NUM, "avgfee", "Average fee in the block"},
+        {RPCResult::Type::NUM, "avgfeerate",
+         "Average feerate (in satoshis per virtual byte)"},
+        {RPCResult::Type::NUM, "avgtxsize", "Average transaction size"},
+        {RPCResult::Type::STR_HEX, "blockhash",
+         "The block hash (to check for potential reorgs)"},
+        {RPCResult::Type::NUM, "height", "The height of the block"},
+        {RPCResult::Type::NUM, "ins",
+         "The number of inputs (excluding coinbase)"},
+        {RPCResult::Type::NUM, "maxfee", "Maximum fee in the block"},
+        {RPCResult::Type::NUM, "maxfeerate",
+         "Maximum feerate (in satoshis per virtual byte)"},
+        {RPCResult::Type::NUM, "maxtxsize", "Maximum transaction size"},
+        {RPCResult::Type::NUM, "medianfee",
+         "Truncated median fee in the block"},
+        {RPCResult::Type::NUM, "medianfeerate",
+         "Truncated median feerate (in " + ticker + " per byte)"},
+        {RPCResult::Type::NUM, "mediantime", "The block median time past"},
+        {RPCResult::Type::NUM, "mediantxsize",
+         "Truncated median transaction size"},
+        {RPCResult::Type::NUM, "minfee", "Minimum fee in the block"},
+        {RPCResult::Type::NUM, "minfeerate",
+         "Minimum feerate (in satoshis per virtual byte)"},
+        {RPCResult::Type::NUM, "mintxsize", "Minimum transaction size"},
+        {RPCResult::Type::NUM, "outs", "The number of outputs"},
+        {RPCResult::Type::NUM, "subsidy", "The block subsidy"},
+        {RPCResult::Type::NUM, "time", "The block time"},
+        {RPCResult::Type::NUM, "total_out",
+         "Total amount in all outputs (excluding coinbase and thus "
+         "reward [ie subsidy + totalfee])"},
+        {RPCResult::Type::NUM, "total_size",
+         "Total size of all non-coinbase transactions"},
+        {RPCResult::Type::NUM, "totalfee", "The fee total"},
+        {RPCResult::Type::NUM, "txs",
+         "The number of transactions (including coinbase)"},
+        {RPCResult::Type::NUM, "utxo_increase",
+         "The increase/decrease in the number of unspent outputs"},
+        {RPCResult::Type::NUM, "utxo_size_inc",
+         "The increase/decrease in size for the utxo index (not "
+         "discounting op_return and similar)"},
+    };
+}
+
+/** Parse the statistics selected by the user, none meaning all of them */
+static std::set<std::string> ParseBlockStats(const UniValue &param) {
+    std::set<std::string> stats;
+    if (!param.isNull()) {
+        const UniValue stats_univalue = param.get_array();
+        for (unsigned int i = 0; i < stats_univalue.size(); i++) {
+            const std::string stat = stats_univalue[i].get_str();
+            stats.insert(stat);
+        }
+    }
+    return stats;
+}
+
+/**
+ * Compute the statistics of a block, all of them if none is selected. Throws if
+ * one of the selected statistics is unknown, or if the block or its undo data
+ * can't be read.
+ */
+static UniValue BlockStatsToJSON(const Config &config,
+                                 ChainstateManager &chainman,
+                                 const CBlockIndex &pindex,
+                                 const std::set<std::string> &stats) {
+    const CBlock &block = GetBlockChecked(chainman.m_blockman, pindex);
+    const CBlockUndo &blockUndo = GetUndoChecked(chainman.m_blockman, pindex);
+
+    // Calculate everything if nothing selected (default)
+    const bool do_all = stats.size() == 0;
+    const bool do_mediantxsize = do_all || stats.count("mediantxsize") != 0;
+    const bool do_medianfee = do_all || stats.count("medianfee") != 0;
+    const bool do_medianfeerate = do_all || stats.count("medianfeerate") != 0;
+    const bool loop_inputs =
+        do_all || do_medianfee || do_medianfeerate ||
+        SetHasKeys(stats, "utxo_size_inc", "totalfee", "avgfee", "avgfeerate",
+                   "minfee", "maxfee", "minfeerate", "maxfeerate");
+    const bool loop_outputs = do_all || loop_inputs || stats.count("total_out");
+    const bool do_calculate_size =
+        do_mediantxsize || loop_inputs ||
+        SetHasKeys(stats, "total_size", "avgtxsize", "mintxsize", "maxtxsize");
+
+    const int64_t blockMaxSize = config.GetMaxBlockSize();
+    Amount maxfee = Amount::zero();
+    Amount maxfeerate = Amount::zero();
+    Amount minfee = MAX_MONEY;
+    Amount minfeerate = MAX_MONEY;
+    Amount total_out = Amount::zero();
+    Amount totalfee = Amount::zero();
+    int64_t inputs = 0;
+    int64_t maxtxsize = 0;
+    int64_t mintxsize = blockMaxSize;
+    int64_t outputs = 0;
+    int64_t total_size = 0;
+    int64_t utxo_size_inc = 0;
+    std::vector<Amount> fee_array;
+    std::vector<Amount> feerate_array;
+    std::vector<int64_t> txsize_array;
+
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const auto &tx = block.vtx.at(i);
+        outputs += tx->vout.size();
+        Amount tx_total_out = Amount::zero();
+        if (loop_outputs) {
+            for (const CTxOut &out : tx->vout) {
+                tx_total_out += out.nValue;
+                utxo_size_inc += GetSerializeSize(out) + PER_UTXO_OVERHEAD;
+            }
+        }
+
+        if (tx->IsCoinBase()) {
+            continue;
+        }
+
+        // Don't count coinbase's fake input
+        inputs += tx->vin.size();
+        // Don't count coinbase reward
+        total_out += tx_total_out;
+
+        int64_t tx_size = 0;
+        if (do_calculate_size) {
+            tx_size = tx->GetTotalSize();
+            if (do_mediantxsize) {
+                txsize_array.push_back(tx_size);
+            }
+            maxtxsize = std::max(maxtxsize, tx_size);
+            mintxsize = std::min(mintxsize, tx_size);
+            total_size += tx_size;
+        }
+
+        if (loop_inputs) {
+            Amount tx_total_in = Amount::zero();
+            const auto &txundo = blockUndo.vtxundo.at(i - 1);
+            for (const Coin &coin : txundo.vprevout) {
+                const CTxOut &prevoutput = coin.GetTxOut();
+
+                tx_total_in += prevoutput.nValue;
+                utxo_size_inc -=
+                    GetSerializeSize(prevoutput) + PER_UTXO_OVERHEAD;
+            }
+
+            Amount txfee = tx_total_in - tx_total_out;
+            CHECK_NONFATAL(MoneyRange(txfee));
+            if (do_medianfee) {
+                fee_array.push_back(txfee);
+            }
+            maxfee = std::max(maxfee, txfee);
+            minfee = std::min(minfee, txfee);
+            totalfee += txfee;
+
+            Amount feerate = txfee / tx_size;
+            if (do_medianfeerate) {
+                feerate_array.push_back(feerate);
+            }
+            maxfeerate = std::max(maxfeerate, feerate);
+            minfeerate = std::min(minfeerate, feerate);
+        }
+    }
+
+    UniValue ret_all(UniValue::VOBJ);
+    ret_all.pushKV("avgfee", block.vtx.size() > 1
+                                 ? (totalfee / int((block.vtx.size() - 1)))
+                                 : Amount::zero());
+    ret_all.pushKV("avgfeerate",
+                   total_size > 0 ? (totalfee / total_size) : Amount::zero());
+    ret_all.pushKV("avgtxsize", (block.vtx.size() > 1)
+                                    ? total_size / (block.vtx.size() - 1)
+                                    : 0);
+    ret_all.pushKV("blockhash", pindex.GetBlockHash().GetHex());
+    ret_all.pushKV("height", (int64_t)pindex.nHeight);
+    ret_all.pushKV("ins", inputs);
+    ret_all.pushKV("maxfee", maxfee);
+    ret_all.pushKV("maxfeerate", maxfeerate);
+    ret_all.pushKV("maxtxsize", maxtxsize);
+    ret_all.pushKV("medianfee", CalculateTruncatedMedian(fee_array));
+    ret_all.pushKV("medianfeerate", CalculateTruncatedMedian(feerate_array));
+    ret_all.pushKV("mediantime", pindex.GetMedianTimePast());
+    ret_all.pushKV("mediantxsize", CalculateTruncatedMedian(txsize_array));
+    ret_all.pushKV("minfee", minfee == MAX_MONEY ? Amount::zero() : minfee);
+    ret_all.pushKV("minfeerate",
+                   minfeerate == MAX_MONEY ? Amount::zero() : minfeerate);
+    ret_all.pushKV("mintxsize", mintxsize == blockMaxSize ? 0 : mintxsize);
+    ret_all.pushKV("outs", outputs);
+    ret_all.pushKV("subsidy",
+                   GetBlockSubsidy(pindex.nHeight, chainman.GetConsensus(),
+                                   block.hashPrevBlock));
+    ret_all.pushKV("time", pindex.GetBlockTime());
+    ret_all.pushKV("total_out", total_out);
+    ret_all.pushKV("total_size", total_size);
+    ret_all.pushKV("totalfee", totalfee);
+    ret_all.pushKV("txs", (int64_t)block.vtx.size());
+    ret_all.pushKV("utxo_increase", outputs - inputs);
+    ret_all.pushKV("utxo_size_inc", utxo_size_inc);
+
+    if (do_all) {
+        return ret_all;
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    for (const std::string &stat : stats) {
+        const UniValue &value = ret_all[stat];
+        if (value.isNull()) {
+            throw JSONRPCError(
+                RPC_INVALID_PARAMETER,
+                strprintf("Invalid selected statistic %s", stat));
+        }
+        ret.pushKV(stat, value);
+    }
+    return ret;
+}
+
 static RPCHelpMan getblockstats() {
     const auto &ticker = Currency::get().ticker;
     return RPCHelpMan{
@@ -2054,53 +2332,7 @@ static RPCHelpMan getblockstats() {
              },
              RPCArgOptions{.oneline_description = "stats"}},
         },
-        RPCResult{
-            RPCResult::Type::OBJ,
-            "",
-            "",
-            {
-                {RPCResult::Type::NUM, "avgfee", "Average fee in the block"},
-                {RPCResult::Type::NUM, "avgfeerate",
-                 "Average feerate (in satoshis per virtual byte)"},
-                {RPCResult::Type::NUM, "avgtxsize", "Average transaction size"},
-                {RPCResult::Type::STR_HEX, "blockhash",
-                 "The block hash (to check for potential reorgs)"},
-                {RPCResult::Type::NUM, "height", "The height of the block"},
-                {RPCResult::Type::NUM, "ins",
-                 "The number of inputs (excluding coinbase)"},
-                {RPCResult::Type::NUM, "maxfee", "Maximum fee in the block"},
-                {RPCResult::Type::NUM, "maxfeerate",
-                 "Maximum feerate (in satoshis per virtual byte)"},
-                {RPCResult::Type::NUM, "maxtxsize", "Maximum transaction size"},
-                {RPCResult::Type::NUM, "medianfee",
-                 "Truncated median fee in the block"},
-                {RPCResult::Type::NUM, "medianfeerate",
-                 "Truncated median feerate (in " + ticker + " per byte)"},
-                {RPCResult::Type::NUM, "mediantime",
-                 "The block median time past"},
-                {RPCResult::Type::NUM, "mediantxsize",
-                 "Truncated median transaction size"},
-                {RPCResult::Type::NUM, "minfee", "Minimum fee in the block"},
-                {RPCResult::Type::NUM, "minfeerate",
-                 "Minimum feerate (in satoshis per virtual byte)"},
-                {RPCResult::Type::NUM, "mintxsize", "Minimum transaction size"},
-                {RPCResult::Type::NUM, "outs", "The number of outputs"},
-                {RPCResult::Type::NUM, "subsidy", "The block subsidy"},
-                {RPCResult::Type::NUM, "time", "The block time"},
-                {RPCResult::Type::NUM, "total_out",
-                 "Total amount in all outputs (excluding coinbase and thus "
-                 "reward [ie subsidy + totalfee])"},
-                {RPCResult::Type::NUM, "total_size",
-                 "Total size of all non-coinbase transactions"},
-                {RPCResult::Type::NUM, "totalfee", "The fee total"},
-                {RPCResult::Type::NUM, "txs",
-                 "The number of transactions (including coinbase)"},
-                {RPCResult::Type::NUM, "utxo_increase",
-                 "The increase/decrease in the number of unspent outputs"},
-                {RPCResult::Type::NUM, "utxo_size_inc",
-                 "The increase/decrease in size for the utxo index (not "
-                 "discounting op_return and similar)"},
-            }},
+        RPCResult{RPCResult::Type::OBJ, "", "", BlockStatsResults()},
         RPCExamples{
             HelpExampleCli(
                 "getblockstats",
@@ -2118,188 +2350,165 @@ static RPCHelpMan getblockstats() {
             const CBlockIndex &pindex{*CHECK_NONFATAL(
                 ParseHashOrHeight(request.params[0], chainman))};
 
-            std::set<std::string> stats;
-            if (!request.params[1].isNull()) {
-                const UniValue stats_univalue = request.params[1].get_array();
-                for (unsigned int i = 0; i < stats_univalue.size(); i++) {
-                    const std::string stat = stats_univalue[i].get_str();
-                    stats.insert(stat);
-                }
-            }
+            const std::set<std::string> stats{
+                ParseBlockStats(request.params[1])};
 
-            const CBlock &block = GetBlockChecked(chainman.m_blockman, pindex);
-            const CBlockUndo &blockUndo =
-                GetUndoChecked(chainman.m_blockman, pindex);
-
-            // Calculate everything if nothing selected (default)
-            const bool do_all = stats.size() == 0;
-            const bool do_mediantxsize =
-                do_all || stats.count("mediantxsize") != 0;
-            const bool do_medianfee = do_all || stats.count("medianfee") != 0;
-            const bool do_medianfeerate =
-                do_all || stats.count("medianfeerate") != 0;
-            const bool loop_inputs =
-                do_all || do_medianfee || do_medianfeerate ||
-                SetHasKeys(stats, "utxo_size_inc", "totalfee", "avgfee",
-                           "avgfeerate", "minfee", "maxfee", "minfeerate",
-                           "maxfeerate");
-            const bool loop_outputs =
-                do_all || loop_inputs || stats.count("total_out");
-            const bool do_calculate_size =
-                do_mediantxsize || loop_inputs ||
-                SetHasKeys(stats, "total_size", "avgtxsize", "mintxsize",
-                           "maxtxsize");
-
-            const int64_t blockMaxSize = config.GetMaxBlockSize();
-            Amount maxfee = Amount::zero();
-            Amount maxfeerate = Amount::zero();
-            Amount minfee = MAX_MONEY;
-            Amount minfeerate = MAX_MONEY;
-            Amount total_out = Amount::zero();
-            Amount totalfee = Amount::zero();
-            int64_t inputs = 0;
-            int64_t maxtxsize = 0;
-            int64_t mintxsize = blockMaxSize;
-            int64_t outputs = 0;
-            int64_t total_size = 0;
-            int64_t utxo_size_inc = 0;
-            std::vector<Amount> fee_array;
-            std::vector<Amount> feerate_array;
-            std::vector<int64_t> txsize_array;
-
-            for (size_t i = 0; i < block.vtx.size(); ++i) {
-                const auto &tx = block.vtx.at(i);
-                outputs += tx->vout.size();
-                Amount tx_total_out = Amount::zero();
-                if (loop_outputs) {
-                    for (const CTxOut &out : tx->vout) {
-                        tx_total_out += out.nValue;
-                        utxo_size_inc +=
-                            GetSerializeSize(out) + PER_UTXO_OVERHEAD;
-                    }
-                }
+            return BlockStatsToJSON(config, chainman, pindex, stats);
+        },
+    };
+}
 
-                if (tx->IsCoinBase()) {
-                    continue;
-                }
+/**
+ * Compute the statistics of the blocks on several threads, as reading and
+ * checking the blocks dominates. The results are in the order of the blocks.
+ * The interruption point is called before each block, and the first exception
+ * thrown while computing them is rethrown.
+ */
+static std::vector<UniValue>
+ComputeBlockStats(const Config &config, ChainstateManager &chainman,
+                  Span<const CBlockIndex *const> blocks,
+                  const std::set<std::string> &stats,
+                  const std::function<void()> &interruption_point) {
+    std::vector<UniValue> results(blocks.size());
+    const int num_threads{
+        std::clamp(GetNumCores(), 1, MAX_BLOCK_STATS_THREADS)};
+    util::ParallelFor(blocks.size(), num_threads, [&](size_t i) {
+        interruption_point();
+        results[i] = BlockStatsToJSON(config, chainman, *blocks[i], stats);
+        return true;
+    });
+    return results;
+}
 
-                // Don't count coinbase's fake input
-                inputs += tx->vin.size();
-                // Don't count coinbase reward
-                total_out += tx_total_out;
+static RPCHelpMan getblockstatsrange() {
+    const auto &ticker = Currency::get().ticker;
+    return RPCHelpMan{
+        "getblockstatsrange",
+        "Compute per block statistics for a range of heights of the active "
+        "chain, like getblockstats does for each of them. The blocks are read "
+        "on several threads. All amounts are in " +
+            ticker +
+            ".\n"
+            "It won't work for some heights with pruning.\n",
+        {
+            {"start_height", RPCArg::Type::NUM, RPCArg::Optional::NO,
+             "The height of the first block"},
+            {"end_height", RPCArg::Type::NUM, RPCArg::Optional::NO,
+             "The height of the last block"},
+            {"stats",
+             RPCArg::Type::ARR,
+             RPCArg::DefaultHint{"all values"},
+             "Values to plot (see getblockstats result)",
+             {
+                 {"height", RPCArg::Type::STR, RPCArg::Optional::OMITTED,
+                  "Selected statistic"},
+                 {"time", RPCArg::Type::STR, RPCArg::Optional::OMITTED,
+                  "Selected statistic"},
+             },
+             RPCArgOptions{.oneline_description = "stats"}},
+        },
+        RPCResult{RPCResult::Type::ARR,
+                  "",
+                  "The statistics of the blocks, by increasing height",
+                  {
+                      {RPCResult::Type::OBJ, "", "", BlockStatsResults()},
+                  }},
+        RPCExamples{
+            HelpExampleCli("getblockstatsrange",
+                           R"(1000 2000 '["minfeerate","avgfeerate"]')") +
+            HelpExampleRpc("getblockstatsrange",
+                           R"(1000, 2000, ["minfeerate","avgfeerate"])")},
+        [&](const RPCHelpMan &self, const Config &config,
+            const JSONRPCRequest &request) -> UniValue {
+            const NodeContext &node = EnsureAnyNodeContext(request.context);
+            ChainstateManager &chainman = EnsureChainman(node);
+            const int start_height{request.params[0].getInt<int>()};
+            const int end_height{request.params[1].getInt<int>()};
+            const std::set<std::string> stats{
+                ParseBlockStats(request.params[2])};
 
-                int64_t tx_size = 0;
-                if (do_calculate_size) {
-                    tx_size = tx->GetTotalSize();
-                    if (do_mediantxsize) {
-                        txsize_array.push_back(tx_size);
-                    }
-                    maxtxsize = std::max(maxtxsize, tx_size);
-                    mintxsize = std::min(mintxsize, tx_size);
-                    total_size += tx_size;
+            std::vector<const CBlockIndex *> blocks;
+            {
+                LOCK(cs_main);
+                const CChain &active_chain = chainman.ActiveChain();
+                if (start_height < 0 || start_height > end_height) {
+                    throw JSONRPCError(
+                        RPC_INVALID_PARAMETER,
+                        strprintf("Invalid height range %d-%d", start_height,
+                                  end_height));
                 }
-
-                if (loop_inputs) {
-                    Amount tx_total_in = Amount::zero();
-                    const auto &txundo = blockUndo.vtxundo.at(i - 1);
-                    for (const Coin &coin : txundo.vprevout) {
-                        const CTxOut &prevoutput = coin.GetTxOut();
-
-                        tx_total_in += prevoutput.nValue;
-                        utxo_size_inc -=
-                            GetSerializeSize(prevoutput) + PER_UTXO_OVERHEAD;
-                    }
-
-                    Amount txfee = tx_total_in - tx_total_out;
-                    CHECK_NONFATAL(MoneyRange(txfee));
-                    if (do_medianfee) {
-                        fee_array.push_back(txfee);
-                    }
-                    maxfee = std::max(maxfee, txfee);
-                    minfee = std::min(minfee, txfee);
-                    totalfee += txfee;
-
-                    Amount feerate = txfee / tx_size;
-                    if (do_medianfeerate) {
-                        feerate_array.push_back(feerate);
+                if (end_height > active_chain.Height()) {
+                    throw JSONRPCError(
+                        RPC_INVALID_PARAMETER,
+                        strprintf("Target block height %d after current tip %d",
+                                  end_height, active_chain.Height()));
+                }
+                blocks.reserve(end_height - start_height + 1);
+                for (int height = start_height; height <= end_height;
+                     ++height) {
+                    const CBlockIndex *pindex{active_chain[height]};
+                    if (chainman.m_blockman.IsBlockPruned(*pindex)) {
+                        throw JSONRPCError(
+                            RPC_MISC_ERROR,
+                            strprintf("Block at height %d not available "
+                                      "(pruned data)",
+                                      height));
                     }
-                    maxfeerate = std::max(maxfeerate, feerate);
-                    minfeerate = std::min(minfeerate, feerate);
+                    blocks.push_back(pindex);
                 }
             }
 
-            UniValue ret_all(UniValue::VOBJ);
-            ret_all.pushKV("avgfee",
-                           block.vtx.size() > 1
-                               ? (totalfee / int((block.vtx.size() - 1)))
-                               : Amount::zero());
-            ret_all.pushKV("avgfeerate", total_size > 0
-                                             ? (totalfee / total_size)
-                                             : Amount::zero());
-            ret_all.pushKV("avgtxsize",
-                           (block.vtx.size() > 1)
-                               ? total_size / (block.vtx.size() - 1)
-                               : 0);
-            ret_all.pushKV("blockhash", pindex.GetBlockHash().GetHex());
-            ret_all.pushKV("height", (int64_t)pindex.nHeight);
-            ret_all.pushKV("ins", inputs);
-            ret_all.pushKV("maxfee", maxfee);
-            ret_all.pushKV("maxfeerate", maxfeerate);
-            ret_all.pushKV("maxtxsize", maxtxsize);
-            ret_all.pushKV("medianfee", CalculateTruncatedMedian(fee_array));
-            ret_all.pushKV("medianfeerate",
-                           CalculateTruncatedMedian(feerate_array));
-            ret_all.pushKV("mediantime", pindex.GetMedianTimePast());
-            ret_all.pushKV("mediantxsize",
-                           CalculateTruncatedMedian(txsize_array));
-            ret_all.pushKV("minfee",
-                           minfee == MAX_MONEY ? Amount::zero() : minfee);
-            ret_all.pushKV("minfeerate", minfeerate == MAX_MONEY
-                                             ? Amount::zero()
-                                             : minfeerate);
-            ret_all.pushKV("mintxsize",
-                           mintxsize == blockMaxSize ? 0 : mintxsize);
-            ret_all.pushKV("outs", outputs);
-            ret_all.pushKV("subsidy", GetBlockSubsidy(pindex.nHeight,
-                                                      chainman.GetConsensus(),
-                                                      block.hashPrevBlock));
-            ret_all.pushKV("time", pindex.GetBlockTime());
-            ret_all.pushKV("total_out", total_out);
-            ret_all.pushKV("total_size", total_size);
-            ret_all.pushKV("totalfee", totalfee);
-            ret_all.pushKV("txs", (int64_t)block.vtx.size());
-            ret_all.pushKV("utxo_increase", outputs - inputs);
-            ret_all.pushKV("utxo_size_inc", utxo_size_inc);
-
-            if (do_all) {
-                return ret_all;
-            }
-
-            UniValue ret(UniValue::VOBJ);
-            for (const std::string &stat : stats) {
-                const UniValue &value = ret_all[stat];
-                if (value.isNull()) {
-                    throw JSONRPCError(
-                        RPC_INVALID_PARAMETER,
-                        strprintf("Invalid selected statistic %s", stat));
+            if (!request.CanStreamResult()) {
+                UniValue ret(UniValue::VARR);
+                for (UniValue &block_stats :
+                     ComputeBlockStats(config, chainman, blocks, stats,
+                                       node.rpc_interruption_point)) {
+                    ret.push_back(std::move(block_stats));
                 }
-                ret.pushKV(stat, value);
-            }
-            return ret;
+                return ret;
+            }
+
+            // Only a batch of blocks is held in memory at a time. The first one
+            // is computed before the reply is started, so that errors such as
+            // an unknown statistic are still reported.
+            const size_t batch_size{size_t(MAX_BLOCK_STATS_THREADS) * 4};
+            const auto compute_batch = [&](size_t start) {
+                return ComputeBlockStats(
+                    config, chainman,
+                    Span{blocks}.subspan(
+                        start, std::min(batch_size, blocks.size() - start)),
+                    stats, node.rpc_interruption_point);
+            };
+            const std::vector<UniValue> first_batch{compute_batch(0)};
+
+            request.StreamResult([&](JSONStreamWriter &writer) {
+                writer.BeginArray();
+                for (const UniValue &block_stats : first_batch) {
+                    writer.Value(block_stats);
+                }
+                for (size_t i = batch_size; i < blocks.size();
+                     i += batch_size) {
+                    // Stop with a truncated reply on shutdown rather than
+                    // scanning the rest of the range
+                    node.rpc_interruption_point();
+                    for (const UniValue &block_stats : compute_batch(i)) {
+                        writer.Value(block_stats);
+                    }
+                }
+                writer.EndArray();
+            });
+            return NullUniValue;
         },
     };
 }
 
 namespace {
-//! Search for a given set of pubkey scripts
-static bool FindScriptPubKey(std::atomic<int> &scan_progress,
-                             const std::atomic<bool> &should_abort,
-                             int64_t &count, CCoinsViewCursor *cursor,
-                             const std::set<CScript> &needles,
-                             std::map<COutPoint, Coin> &out_results,
-                             std::function<void()> &interruption_point) {
-    scan_progress = 0;
-    count = 0;
+//! Search for a given set of pubkey scripts in the coins of a cursor
+static bool FindScriptPubKeyInRange(
+    const std::atomic<bool> &should_abort, int64_t &count,
+    CCoinsViewCursor *cursor, const std::set<CScript> &needles,
+    std::map<COutPoint, Coin> &out_results,
+    const std::function<void()> &interruption_point) {
     while (cursor->Valid()) {
         COutPoint key;
         Coin coin;
@@ -2313,20 +2522,52 @@ static bool FindScriptPubKey(std::atomic<int> &scan_progress,
                 return false;
             }
         }
-        if (count % 256 == 0) {
-            // update progress reference every 256 item
-            const TxId &txid = key.GetTxId();
-            uint32_t high = 0x100 * *txid.begin() + *(txid.begin() + 1);
-            scan_progress = int(high * 100.0 / 65536.0 + 0.5);
-        }
         if (needles.count(coin.GetTxOut().scriptPubKey)) {
             out_results.emplace(key, coin);
         }
         cursor->Next();
     }
-    scan_progress = 100;
     return true;
 }
+
+/**
+ * Search for a given set of pubkey scripts, scanning the ranges of the coins
+ * of the cursors on num_threads threads. The progress is the share of the
+ * ranges which are scanned.
+ */
+static bool
+FindScriptPubKey(std::atomic<int> &scan_progress,
+                 const std::atomic<bool> &should_abort, int64_t &count,
+                 const std::vector<std::unique_ptr<CCoinsViewCursor>> &cursors,
+                 size_t num_threads, const std::set<CScript> &needles,
+                 std::map<COutPoint, Coin> &out_results,
+                 std::function<void()> &interruption_point) {
+    scan_progress = 0;
+    count = 0;
+    std::vector<int64_t> range_counts(cursors.size(), 0);
+    std::vector<std::map<COutPoint, Coin>> range_results(cursors.size());
+    std::atomic<size_t> scanned{0};
+    const bool completed{
+        util::ParallelFor(cursors.size(), num_threads, [&](size_t i) {
+            const bool ok{FindScriptPubKeyInRange(
+                should_abort, range_counts[i], cursors[i].get(), needles,
+                range_results[i], interruption_point)};
+            // The ranges complete out of order, don't let progress go back
+            const int progress = ++scanned * 100 / cursors.size();
+            int prev_progress{scan_progress};
+            while (prev_progress < progress &&
+                   !scan_progress.compare_exchange_weak(prev_progress,
+                                                        progress)) {
+            }
+            return ok;
+        })};
+
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        count += range_counts[i];
+        out_results.merge(range_results[i]);
+    }
+    return completed;
+}
 } // namespace
 
 /** RAII object to prevent concurrency issue when scanning the txout set */
@@ -2534,7 +2775,8 @@ static RPCHelpMan scantxoutset() {
                 g_should_abort_scan = false;
                 g_scan_progress = 0;
                 int64_t count = 0;
-                std::unique_ptr<CCoinsViewCursor> pcursor;
+                const size_t num_threads{GetUTXOScanThreads()};
+                std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
                 const CBlockIndex *tip;
                 NodeContext &node = EnsureAnyNodeContext(request.context);
                 {
@@ -2542,13 +2784,15 @@ static RPCHelpMan scantxoutset() {
                     LOCK(cs_main);
                     Chainstate &active_chainstate = chainman.ActiveChainstate();
                     active_chainstate.ForceFlushStateToDisk();
-                    pcursor = CHECK_NONFATAL(std::unique_ptr<CCoinsViewCursor>(
-                        active_chainstate.CoinsDB().Cursor()));
+                    // Several ranges per thread even out the work between the
+                    // threads and make the progress finer.
+                    cursors =
+                        active_chainstate.CoinsDB().Cursors(num_threads * 4);
                     tip = CHECK_NONFATAL(active_chainstate.m_chain.Tip());
                 }
                 bool res = FindScriptPubKey(
-                    g_scan_progress, g_should_abort_scan, count, pcursor.get(),
-                    needles, coins, node.rpc_interruption_point);
+                    g_scan_progress, g_should_abort_scan, count, cursors,
+                    num_threads, needles, coins, node.rpc_interruption_point);
                 result.pushKV("success", res);
                 result.pushKV("txouts", count);
                 result.pushKV("height", tip->nHeight);
@@ -3283,6 +3527,7 @@ void RegisterBlockchainRPCCommands(CRPCTable &t) {
         { "blockchain",         getblockhash,                      },
         { "blockchain",         getblockheader,                    },
         { "blockchain",         getblockstats,                     },
+        { "blockchain",         getblockstatsrange,                },
         { "blockchain",         getchaintips,                      },
         { "blockchain",         getchaintxstats,                   },
         { "blockchain",         getdifficulty,                     },
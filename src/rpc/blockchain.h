@@ -18,6 +18,7 @@
 class CBlock;
 class CBlockIndex;
 class Chainstate;
+class JSONStreamWriter;
 class RPCHelpMan;
 namespace node {
 class BlockManager;
@@ -41,6 +42,14 @@ void RPCNotifyBlockChange(const CBlockIndex *pindex);
 UniValue blockToJSON(node::BlockManager &blockman, const CBlock &block,
                      const CBlockIndex &tip, const CBlockIndex &blockindex,
                      TxVerbosity verbosity) LOCKS_EXCLUDED(cs_main);
+/**
+ * Block description to JSON, written one transaction at a time. The output is
+ * the same as the above.
+ */
+void blockToJSON(node::BlockManager &blockman, const CBlock &block,
+                 const CBlockIndex &tip, const CBlockIndex &blockindex,
+                 TxVerbosity verbosity, JSONStreamWriter &writer)
+    LOCKS_EXCLUDED(cs_main);
 
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex &tip,
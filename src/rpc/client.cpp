@@ -166,6 +166,9 @@ static const CRPCConvertParam vRPCConvertParams[] = {
     {"verifychain", 1, "nblocks"},
     {"getblockstats", 0, "hash_or_height"},
     {"getblockstats", 1, "stats"},
+    {"getblockstatsrange", 0, "start_height"},
+    {"getblockstatsrange", 1, "end_height"},
+    {"getblockstatsrange", 2, "stats"},
     {"pruneblockchain", 0, "height"},
     {"keypoolrefill", 0, "newsize"},
     {"getrawmempool", 0, "verbose"},
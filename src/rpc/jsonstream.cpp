@@ -0,0 +1,121 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+
+#include <crypto/hex_base.h>
+#include <util/check.h>
+
+#include <univalue.h>
+
+#include <algorithm>
+#include <utility>
+
+JSONStreamWriter::JSONStreamWriter(Sink sink, size_t chunk_size)
+    : m_sink{std::move(sink)}, m_chunk_size{chunk_size} {
+    m_buffer.reserve(m_chunk_size);
+}
+
+void JSONStreamWriter::BeginValue() {
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+    if (m_has_value.empty()) {
+        return;
+    }
+    if (m_has_value.back()) {
+        Write(",");
+    }
+    m_has_value.back() = true;
+}
+
+void JSONStreamWriter::Write(std::string_view str) {
+    m_buffer.append(str);
+    if (m_buffer.size() >= m_chunk_size) {
+        Flush();
+    }
+}
+
+void JSONStreamWriter::BeginObject() {
+    BeginValue();
+    Write("{");
+    m_has_value.push_back(false);
+}
+
+void JSONStreamWriter::EndObject() {
+    CHECK_NONFATAL(!m_has_value.empty() && !m_after_key);
+    m_has_value.pop_back();
+    Write("}");
+}
+
+void JSONStreamWriter::BeginArray() {
+    BeginValue();
+    Write("[");
+    m_has_value.push_back(false);
+}
+
+void JSONStreamWriter::EndArray() {
+    CHECK_NONFATAL(!m_has_value.empty() && !m_after_key);
+    m_has_value.pop_back();
+    Write("]");
+}
+
+void JSONStreamWriter::Key(std::string_view key) {
+    CHECK_NONFATAL(!m_has_value.empty() && !m_after_key);
+    BeginValue();
+    Write(UniValue{std::string{key}}.write());
+    Write(":");
+    m_after_key = true;
+}
+
+void JSONStreamWriter::Value(const UniValue &value) {
+    RawValue(value.write());
+}
+
+void JSONStreamWriter::RawValue(std::string_view json) {
+    BeginValue();
+    Write(json);
+}
+
+void JSONStreamWriter::HexValue(Span<const uint8_t> data) {
+    BeginValue();
+    Write("\"");
+    // Hex digits never need escaping
+    const size_t max_chunk_bytes{std::max<size_t>(m_chunk_size / 2, 1)};
+    while (!data.empty()) {
+        const size_t size{std::min(data.size(), max_chunk_bytes)};
+        const size_t pos{m_buffer.size()};
+        m_buffer.resize(pos + size * 2);
+        HexEncode(data.first(size), Span{m_buffer}.subspan(pos));
+        data = data.subspan(size);
+        if (m_buffer.size() >= m_chunk_size) {
+            Flush();
+        }
+    }
+    Write("\"");
+}
+
+void JSONStreamWriter::Members(const UniValue &obj) {
+    const std::vector<std::string> &keys{obj.getKeys()};
+    const std::vector<UniValue> &values{obj.getValues()};
+    for (size_t i = 0; i < keys.size(); ++i) {
+        Key(keys[i]);
+        Value(values[i]);
+    }
+}
+
+void JSONStreamWriter::Flush() {
+    if (m_buffer.empty()) {
+        return;
+    }
+    m_sink(m_buffer);
+    m_buffer.clear();
+}
+
+void JSONStreamWriter::Finish() {
+    CHECK_NONFATAL(m_has_value.empty());
+    m_buffer.append("\n");
+    Flush();
+}
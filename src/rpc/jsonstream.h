@@ -0,0 +1,78 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_JSONSTREAM_H
+#define BITCOIN_RPC_JSONSTREAM_H
+
+#include <span.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class UniValue;
+
+/**
+ * Write a JSON document progressively, handing it over to a sink in chunks,
+ * so a very large document never needs to be held in memory as a whole.
+ *
+ * The containers are opened and closed explicitly while their members can be
+ * written from small UniValue trees. The output is compact, identical to what
+ * UniValue::write() returns for the same document.
+ */
+class JSONStreamWriter {
+public:
+    /** Receives the document in order. It may throw to abort the writing. */
+    using Sink = std::function<void(std::string_view chunk)>;
+
+    static constexpr size_t DEFAULT_CHUNK_SIZE{256 * 1024};
+
+    explicit JSONStreamWriter(Sink sink,
+                              size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    /** Start a member of the current object, its value must follow */
+    void Key(std::string_view key);
+    void Value(const UniValue &value);
+    /** Write a value which is already serialized as JSON */
+    void RawValue(std::string_view json);
+    /**
+     * Write the hexadecimal encoding of data as a string value, encoding it
+     * straight into the output rather than building the string first.
+     */
+    void HexValue(Span<const uint8_t> data);
+    /** Write all the members of the object into the current object */
+    void Members(const UniValue &obj);
+
+    /** Hand over the pending output to the sink */
+    void Flush();
+    /**
+     * Terminate the document with a newline, like the RPC and REST replies
+     * are, and flush it.
+     */
+    void Finish();
+
+private:
+    /** Add the separator expected before a value */
+    void BeginValue();
+    void Write(std::string_view str);
+
+    const Sink m_sink;
+    const size_t m_chunk_size;
+    std::string m_buffer;
+
+    //! For each open container, whether it has a value already
+    std::vector<bool> m_has_value;
+    //! Whether a key was just written
+    bool m_after_key{false};
+};
+
+#endif // BITCOIN_RPC_JSONSTREAM_H
@@ -13,6 +13,7 @@
 #include <node/types.h>
 #include <policy/settings.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
@@ -443,6 +444,45 @@ UniValue MempoolToJSON(const CTxMemPool &pool, bool verbose,
     }
 }
 
+void MempoolToJSON(const CTxMemPool &pool, JSONStreamWriter &writer) {
+    // Number of entries formatted for each lock of the mempool
+    static constexpr size_t BATCH_SIZE{1000};
+
+    std::vector<TxId> txids;
+    {
+        LOCK(pool.cs);
+        txids.reserve(pool.mapTx.size());
+        for (const CTxMemPoolEntryRef &e : pool.mapTx) {
+            txids.push_back(e->GetTx().GetId());
+        }
+    }
+
+    writer.BeginObject();
+    std::vector<std::pair<TxId, std::string>> batch;
+    batch.reserve(BATCH_SIZE);
+    for (size_t i = 0; i < txids.size(); i += BATCH_SIZE) {
+        batch.clear();
+        {
+            LOCK(pool.cs);
+            const size_t end{std::min(txids.size(), i + BATCH_SIZE)};
+            for (size_t j = i; j < end; ++j) {
+                CTxMemPool::txiter it = pool.mapTx.find(txids[j]);
+                if (it == pool.mapTx.end()) {
+                    continue;
+                }
+                UniValue info(UniValue::VOBJ);
+                entryToJSON(pool, info, *it);
+                batch.emplace_back(txids[j], info.write());
+            }
+        }
+        for (const auto &[txid, json] : batch) {
+            writer.Key(txid.ToString());
+            writer.RawValue(json);
+        }
+    }
+    writer.EndObject();
+}
+
 static RPCHelpMan getrawmempool() {
     return RPCHelpMan{
         "getrawmempool",
@@ -503,8 +543,16 @@ static RPCHelpMan getrawmempool() {
                 include_mempool_sequence = request.params[1].get_bool();
             }
 
-            return MempoolToJSON(EnsureAnyMemPool(request.context), fVerbose,
-                                 include_mempool_sequence);
+            const CTxMemPool &mempool = EnsureAnyMemPool(request.context);
+            if (fVerbose && !include_mempool_sequence &&
+                request.CanStreamResult()) {
+                request.StreamResult([&](JSONStreamWriter &writer) {
+                    MempoolToJSON(mempool, writer);
+                });
+                return NullUniValue;
+            }
+
+            return MempoolToJSON(mempool, fVerbose, include_mempool_sequence);
         },
     };
 }
@@ -6,6 +6,7 @@
 #define BITCOIN_RPC_MEMPOOL_H
 
 class CTxMemPool;
+class JSONStreamWriter;
 class UniValue;
 
 /** Mempool information to JSON */
@@ -15,4 +16,11 @@ UniValue MempoolInfoToJSON(const CTxMemPool &pool);
 UniValue MempoolToJSON(const CTxMemPool &pool, bool verbose = false,
                        bool include_mempool_sequence = false);
 
+/**
+ * Write the verbose mempool to JSON. The entries are formatted in batches so
+ * the mempool is not locked while the output is written, a transaction which
+ * leaves the mempool in the meantime is omitted.
+ */
+void MempoolToJSON(const CTxMemPool &pool, JSONStreamWriter &writer);
+
 #endif // BITCOIN_RPC_MEMPOOL_H
@@ -30,6 +30,7 @@
 #include <timedata.h>
 #include <util/any.h>
 #include <util/check.h>
+#include <util/latency.h>
 #include <util/strencodings.h>
 #include <util/time.h>
 
@@ -553,6 +554,123 @@ static std::string RPCMallocInfo() {
 }
 #endif
 
+static UniValue RPCLatencyHistogramInfo(const LatencyHistogram &histogram) {
+    const LatencyHistogram::Snapshot snapshot = histogram.GetSnapshot();
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("description", histogram.GetDescription());
+    obj.pushKV("count", snapshot.count);
+    obj.pushKV("sum", Ticks<SecondsDouble>(snapshot.sum));
+    for (const auto &[key, q] : {std::make_pair("p50", 0.5),
+                                 std::make_pair("p90", 0.9),
+                                 std::make_pair("p99", 0.99)}) {
+        if (auto bound = snapshot.GetQuantileUpperBound(q)) {
+            obj.pushKV(key, Ticks<SecondsDouble>(*bound));
+        }
+    }
+
+    UniValue buckets(UniValue::VARR);
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; ++i) {
+        if (snapshot.buckets[i] == 0) {
+            continue;
+        }
+        UniValue bucket(UniValue::VOBJ);
+        if (i + 1 < LatencyHistogram::NUM_BUCKETS) {
+            bucket.pushKV("le", Ticks<SecondsDouble>(
+                                    LatencyHistogram::GetBucketUpperBound(i)));
+        }
+        bucket.pushKV("count", snapshot.buckets[i]);
+        buckets.push_back(std::move(bucket));
+    }
+    obj.pushKV("buckets", std::move(buckets));
+    return obj;
+}
+
+static RPCHelpMan getlatencyinfo() {
+    return RPCHelpMan{
+        "getlatencyinfo",
+        "Returns latency histograms for the block connection phases, mempool "
+        "acceptance and headers processing, since the node started.\n",
+        {
+            {"mode", RPCArg::Type::STR, RPCArg::Default{"json"},
+             "determines what kind of information is returned.\n"
+             "  - \"json\" returns an object with one entry per histogram.\n"
+             "  - \"prometheus\" returns a string in the Prometheus text "
+             "exposition format."},
+        },
+        {
+            RPCResult{
+                "mode \"json\"",
+                RPCResult::Type::OBJ_DYN,
+                "",
+                "",
+                {
+                    {RPCResult::Type::OBJ,
+                     "name",
+                     "The histogram name",
+                     {
+                         {RPCResult::Type::STR, "description",
+                          "What the histogram measures"},
+                         {RPCResult::Type::NUM, "count",
+                          "Number of observations"},
+                         {RPCResult::Type::NUM, "sum",
+                          "Sum of the observations, in seconds"},
+                         {RPCResult::Type::NUM, "p50", /*optional=*/true,
+                          "Upper bound of the median, in seconds. Omitted if "
+                          "there is no observation or it exceeds the largest "
+                          "bucket bound"},
+                         {RPCResult::Type::NUM, "p90", /*optional=*/true,
+                          "Upper bound of the 90th percentile, in seconds"},
+                         {RPCResult::Type::NUM, "p99", /*optional=*/true,
+                          "Upper bound of the 99th percentile, in seconds"},
+                         {RPCResult::Type::ARR,
+                          "buckets",
+                          "Non-empty buckets, in increasing order",
+                          {
+                              {RPCResult::Type::OBJ,
+                               "",
+                               "",
+                               {
+                                   {RPCResult::Type::NUM, "le",
+                                    /*optional=*/true,
+                                    "Inclusive upper bound of the bucket, in "
+                                    "seconds. Omitted for the unbounded "
+                                    "bucket"},
+                                   {RPCResult::Type::NUM, "count",
+                                    "Number of observations in the bucket"},
+                               }},
+                          }},
+                     }},
+                }},
+            RPCResult{"mode \"prometheus\"", RPCResult::Type::STR, "",
+                      "\"# HELP doged_connect_tip_seconds ...\""},
+        },
+        RPCExamples{HelpExampleCli("getlatencyinfo", "") +
+                    HelpExampleCli("getlatencyinfo", "prometheus") +
+                    HelpExampleRpc("getlatencyinfo", "")},
+        [&](const RPCHelpMan &self, const Config &config,
+            const JSONRPCRequest &request) -> UniValue {
+            std::string mode = request.params[0].isNull()
+                                   ? "json"
+                                   : request.params[0].get_str();
+            if (mode == "json") {
+                UniValue obj(UniValue::VOBJ);
+                for (const LatencyHistogram *histogram :
+                     GetLatencyRegistry().GetHistograms()) {
+                    obj.pushKV(histogram->GetName(),
+                               RPCLatencyHistogramInfo(*histogram));
+                }
+                return obj;
+            } else if (mode == "prometheus") {
+                return GetLatencyRegistry().ToPrometheus();
+            } else {
+                throw JSONRPCError(RPC_INVALID_PARAMETER,
+                                   "unknown mode " + mode);
+            }
+        },
+    };
+}
+
 static RPCHelpMan getmemoryinfo() {
     /* Please, avoid using the word "pool" here in the RPC interface or help,
      * as users will undoubtedly confuse it with the other "memory pool"
@@ -986,6 +1104,7 @@ void RegisterMiscRPCCommands(CRPCTable &t) {
         //  category            actor (function)
         //  ------------------  ----------------------
         { "control",            getmemoryinfo,           },
+        { "control",            getlatencyinfo,          },
         { "control",            logging,                 },
         { "util",               validateaddress,         },
         { "util",               createmultisig,          },
@@ -31,7 +31,10 @@
 #include <validation.h>
 #include <warnings.h>
 
+#include <algorithm>
+#include <map>
 #include <optional>
+#include <vector>
 
 #include <univalue.h>
 
@@ -82,6 +85,31 @@ static RPCHelpMan ping() {
     };
 }
 
+static std::vector<RPCResult> MsgProcessingStatsDoc() {
+    const std::string window{
+        strprintf("%d", count_seconds(MSG_PROCESSING_WINDOW))};
+    return {
+        {RPCResult::Type::NUM, "count", "The number of messages processed"},
+        {RPCResult::Type::NUM, "time",
+         "The time spent processing them, in seconds"},
+        {RPCResult::Type::NUM, "recent_count",
+         "The number of messages processed in the last " + window + " to " +
+             strprintf("%d", 2 * count_seconds(MSG_PROCESSING_WINDOW)) +
+             " seconds"},
+        {RPCResult::Type::NUM, "recent_time",
+         "The time spent processing them, in seconds"},
+    };
+}
+
+static UniValue MsgProcessingStatsToJSON(const MsgTypeProcessingStats &stats) {
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("count", stats.total.count);
+    obj.pushKV("time", CountSecondsDouble(stats.total.time));
+    obj.pushKV("recent_count", stats.recent.count);
+    obj.pushKV("recent_time", CountSecondsDouble(stats.recent.time));
+    return obj;
+}
+
 static RPCHelpMan getpeerinfo() {
     return RPCHelpMan{
         "getpeerinfo",
@@ -157,6 +185,9 @@ static RPCHelpMan getpeerinfo() {
                      "minimum observed ping time (if any at all)"},
                     {RPCResult::Type::NUM, "pingwait",
                      "ping wait (if non-zero)"},
+                    {RPCResult::Type::NUM, "msgqueuedelay",
+                     "Moving average of the time in seconds the messages "
+                     "from this peer wait before being processed"},
                     {RPCResult::Type::NUM, "version",
                      "The peer version, such as 70001"},
                     {RPCResult::Type::STR, "subver", "The string version"},
@@ -213,6 +244,15 @@ static RPCHelpMan getpeerinfo() {
                        "object and all bytes received\n"
                        "of unknown message types are listed under '" +
                            NET_MESSAGE_TYPE_OTHER + "'."}}},
+                    {RPCResult::Type::OBJ_DYN,
+                     "msgprocessing_per_msg",
+                     "The time spent processing the messages from this peer, "
+                     "aggregated by message type. Only the message types that "
+                     "were processed are listed, as for bytesrecv_per_msg.\n"
+                     "The time spent serving the requested data is accounted "
+                     "to getdata.",
+                     {{RPCResult::Type::OBJ, "msg", "",
+                       MsgProcessingStatsDoc()}}},
                 }},
             }},
         },
@@ -279,6 +319,8 @@ static RPCHelpMan getpeerinfo() {
                     obj.pushKV("pingwait",
                                CountSecondsDouble(statestats.m_ping_wait));
                 }
+                obj.pushKV("msgqueuedelay",
+                           CountSecondsDouble(stats.m_msg_queue_delay));
                 obj.pushKV("version", stats.nVersion);
                 // Use the sanitized form of subver here, to avoid tricksy
                 // remote peers from corrupting or modifying the JSON output by
@@ -328,6 +370,15 @@ static RPCHelpMan getpeerinfo() {
                     }
                 }
                 obj.pushKV("bytesrecv_per_msg", std::move(recvPerMsgType));
+
+                UniValue processingPerMsgType(UniValue::VOBJ);
+                for (const auto &[msg_type, processing] :
+                     stats.mapProcessingPerMsgType) {
+                    processingPerMsgType.pushKV(
+                        msg_type, MsgProcessingStatsToJSON(processing));
+                }
+                obj.pushKV("msgprocessing_per_msg",
+                           std::move(processingPerMsgType));
                 obj.pushKV("connection_type",
                            ConnectionTypeAsString(stats.m_conn_type));
 
@@ -682,6 +733,110 @@ static RPCHelpMan getnettotals() {
     };
 }
 
+static RPCHelpMan getnetmsgstats() {
+    return RPCHelpMan{
+        "getnetmsgstats",
+        "Returns the time spent processing the messages received from the "
+        "connected peers, aggregated by message type, and the peers that "
+        "recently cost the most.\n",
+        {},
+        RPCResult{
+            RPCResult::Type::OBJ,
+            "",
+            "",
+            {
+                {RPCResult::Type::NUM, "window",
+                 "The length of a window of the recent stats, in seconds. "
+                 "They cover the current window and the previous one."},
+                {RPCResult::Type::OBJ_DYN,
+                 "msgtypes",
+                 "The stats of the message types that were processed, from "
+                 "the currently connected peers",
+                 {{RPCResult::Type::OBJ, "msg", "",
+                   MsgProcessingStatsDoc()}}},
+                {RPCResult::Type::ARR,
+                 "peers",
+                 "The peers whose messages were recently processed, by "
+                 "decreasing recent processing time",
+                 {{RPCResult::Type::OBJ,
+                   "",
+                   "",
+                   {
+                       {RPCResult::Type::NUM, "id", "Peer index"},
+                       {RPCResult::Type::STR, "connection_type",
+                        "Type of connection"},
+                       {RPCResult::Type::NUM, "recent_time",
+                        "The time recently spent processing the messages "
+                        "from this peer, in seconds"},
+                       {RPCResult::Type::STR, "top_msg",
+                        "The message type that recently cost the most"},
+                   }}}},
+            }},
+        RPCExamples{HelpExampleCli("getnetmsgstats", "") +
+                    HelpExampleRpc("getnetmsgstats", "")},
+        [&](const RPCHelpMan &self, const Config &config,
+            const JSONRPCRequest &request) -> UniValue {
+            NodeContext &node = EnsureAnyNodeContext(request.context);
+            const CConnman &connman = EnsureConnman(node);
+
+            std::vector<CNodeStats> vstats;
+            connman.GetNodeStats(vstats);
+
+            struct PeerCost {
+                const CNodeStats *stats;
+                std::chrono::microseconds recent_time{0us};
+                const std::string *top_msg{nullptr};
+                std::chrono::microseconds top_msg_time{0us};
+            };
+            std::map<std::string, MsgTypeProcessingStats> msg_types;
+            std::vector<PeerCost> peers;
+            for (const CNodeStats &stats : vstats) {
+                PeerCost peer{&stats};
+                for (const auto &[msg_type, processing] :
+                     stats.mapProcessingPerMsgType) {
+                    MsgTypeProcessingStats &aggregate = msg_types[msg_type];
+                    aggregate.total += processing.total;
+                    aggregate.recent += processing.recent;
+                    peer.recent_time += processing.recent.time;
+                    if (processing.recent.time > peer.top_msg_time) {
+                        peer.top_msg = &msg_type;
+                        peer.top_msg_time = processing.recent.time;
+                    }
+                }
+                if (peer.top_msg) {
+                    peers.push_back(peer);
+                }
+            }
+            std::sort(peers.begin(), peers.end(),
+                      [](const PeerCost &a, const PeerCost &b) {
+                          return a.recent_time > b.recent_time;
+                      });
+
+            UniValue ret(UniValue::VOBJ);
+            ret.pushKV("window", count_seconds(MSG_PROCESSING_WINDOW));
+
+            UniValue msgtypes(UniValue::VOBJ);
+            for (const auto &[msg_type, processing] : msg_types) {
+                msgtypes.pushKV(msg_type, MsgProcessingStatsToJSON(processing));
+            }
+            ret.pushKV("msgtypes", std::move(msgtypes));
+
+            UniValue peers_arr(UniValue::VARR);
+            for (const PeerCost &peer : peers) {
+                UniValue obj(UniValue::VOBJ);
+                obj.pushKV("id", peer.stats->nodeid);
+                obj.pushKV("connection_type",
+                           ConnectionTypeAsString(peer.stats->m_conn_type));
+                obj.pushKV("recent_time", CountSecondsDouble(peer.recent_time));
+                obj.pushKV("top_msg", *peer.top_msg);
+                peers_arr.push_back(std::move(obj));
+            }
+            ret.pushKV("peers", std::move(peers_arr));
+            return ret;
+        },
+    };
+}
+
 static UniValue GetNetworksInfo() {
     UniValue networks(UniValue::VARR);
     for (int n = 0; n < NET_MAX; ++n) {
@@ -776,6 +931,35 @@ static RPCHelpMan getnetworkinfo() {
                           {RPCResult::Type::NUM, "score", "relative score"},
                       }},
                  }},
+                {RPCResult::Type::OBJ,
+                 "blockservecache",
+                 /*optional=*/true,
+                 "the cache of blocks served to peers",
+                 {
+                     {RPCResult::Type::NUM, "usage",
+                      "memory used by the cached blocks, in bytes"},
+                     {RPCResult::Type::NUM, "max_usage",
+                      "maximum memory used by the cached blocks, in bytes"},
+                     {RPCResult::Type::NUM, "serialized_blocks",
+                      "number of cached serialized blocks"},
+                     {RPCResult::Type::NUM, "serialized_hits",
+                      "number of block requests served from the cache"},
+                     {RPCResult::Type::NUM, "serialized_misses",
+                      "number of block requests read from disk"},
+                     {RPCResult::Type::NUM, "serialized_hitrate",
+                      "ratio of the block requests served from the cache"},
+                     {RPCResult::Type::NUM, "decoded_blocks",
+                      "number of cached decoded blocks"},
+                     {RPCResult::Type::NUM, "decoded_hits",
+                      "number of merkle and compact block requests served "
+                      "from the cache"},
+                     {RPCResult::Type::NUM, "decoded_misses",
+                      "number of merkle and compact block requests read from "
+                      "disk"},
+                     {RPCResult::Type::NUM, "decoded_hitrate",
+                      "ratio of the merkle and compact block requests served "
+                      "from the cache"},
+                 }},
                 {RPCResult::Type::STR, "warnings",
                  "any network and blockchain warnings"},
             }},
@@ -827,6 +1011,29 @@ static RPCHelpMan getnetworkinfo() {
                 }
             }
             obj.pushKV("localaddresses", std::move(localAddresses));
+            if (node.peerman) {
+                const auto stats{node.peerman->GetBlockServeCacheStats()};
+                const auto hitrate = [](uint64_t hits, uint64_t misses) {
+                    return hits + misses == 0 ? 0.
+                                              : double(hits) / (hits + misses);
+                };
+                UniValue cache(UniValue::VOBJ);
+                cache.pushKV("usage", uint64_t(stats.usage));
+                cache.pushKV("max_usage", uint64_t(stats.max_usage));
+                cache.pushKV("serialized_blocks",
+                             uint64_t(stats.serialized_count));
+                cache.pushKV("serialized_hits", stats.serialized_hits);
+                cache.pushKV("serialized_misses", stats.serialized_misses);
+                cache.pushKV("serialized_hitrate",
+                             hitrate(stats.serialized_hits,
+                                     stats.serialized_misses));
+                cache.pushKV("decoded_blocks", uint64_t(stats.decoded_count));
+                cache.pushKV("decoded_hits", stats.decoded_hits);
+                cache.pushKV("decoded_misses", stats.decoded_misses);
+                cache.pushKV("decoded_hitrate",
+                             hitrate(stats.decoded_hits, stats.decoded_misses));
+                obj.pushKV("blockservecache", std::move(cache));
+            }
             obj.pushKV("warnings", GetWarnings(false).original);
             return obj;
         },
@@ -1256,6 +1463,7 @@ void RegisterNetRPCCommands(CRPCTable &t) {
         { "network",            disconnectnode,          },
         { "network",            getaddednodeinfo,        },
         { "network",            getnettotals,            },
+        { "network",            getnetmsgstats,          },
         { "network",            getnetworkinfo,          },
         { "network",            setban,                  },
         { "network",            listbanned,              },
@@ -8,8 +8,11 @@
 #include <univalue.h>
 
 #include <any>
+#include <functional>
 #include <string>
 
+class JSONStreamWriter;
+
 UniValue JSONRPCRequestObj(const std::string &strMethod, const UniValue &params,
                            const UniValue &id);
 UniValue JSONRPCReplyObj(const UniValue &result, const UniValue &error,
@@ -38,7 +41,33 @@ public:
     std::string peerAddr;
     std::any context;
 
+    using ResultWriter = std::function<void(JSONStreamWriter &writer)>;
+    /**
+     * Set by the server when the reply can be streamed. It writes the reply
+     * around the result, which write_result writes as a single value.
+     */
+    std::function<void(const ResultWriter &write_result)> resultStreamer;
+
     void parse(const UniValue &valRequest);
+
+    /** Whether the command can use StreamResult() */
+    bool CanStreamResult() const { return bool(resultStreamer); }
+    /**
+     * Send the result while write_result writes it rather than returning it,
+     * for the commands whose results can be very large. The command then
+     * returns a null value, which is ignored.
+     *
+     * Anything that can fail must be done before, as the reply is already
+     * being sent when write_result is called.
+     */
+    void StreamResult(const ResultWriter &write_result) const {
+        resultStreamed = true;
+        resultStreamer(write_result);
+    }
+    bool IsResultStreamed() const { return resultStreamed; }
+
+private:
+    mutable bool resultStreamed{false};
 };
 
 #endif // BITCOIN_RPC_REQUEST_H
@@ -8,22 +8,27 @@
 
 #include <common/args.h>
 #include <config.h>
+#include <httpserver.h>
 #include <logging.h>
 #include <rpc/util.h>
 #include <shutdown.h>
 #include <sync.h>
+#include <util/parallel.h>
 #include <util/strencodings.h>
 #include <util/string.h>
 #include <util/time.h>
 
 #include <boost/signals2/signal.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 using util::SplitString;
 
@@ -280,6 +285,56 @@ static RPCHelpMan getrpcinfo() {
                        }},
                       {RPCResult::Type::STR, "logpath",
                        "The complete file path to the debug log"},
+                      {RPCResult::Type::ARR,
+                       "work_queues",
+                       "The HTTP work queues, the default one first followed "
+                       "by the -rpcworklane ones",
+                       {
+                           {RPCResult::Type::OBJ,
+                            "",
+                            "",
+                            {
+                                {RPCResult::Type::STR, "name",
+                                 "The name of the queue"},
+                                {RPCResult::Type::NUM, "threads",
+                                 "The number of threads serving the queue"},
+                                {RPCResult::Type::ARR,
+                                 "targets",
+                                 "The RPC methods and endpoints served by the "
+                                 "queue, empty for the default one",
+                                 {
+                                     {RPCResult::Type::STR, "",
+                                      "An RPC method or an endpoint prefix"},
+                                 }},
+                                {RPCResult::Type::NUM, "depth",
+                                 "The number of requests waiting for a thread"},
+                                {RPCResult::Type::NUM, "max_depth",
+                                 "The number of waiting requests above which "
+                                 "new ones are rejected"},
+                                {RPCResult::Type::NUM, "processed",
+                                 "The number of requests handled"},
+                                {RPCResult::Type::NUM, "rejected",
+                                 "The number of requests rejected because the "
+                                 "queue was full"},
+                                {RPCResult::Type::NUM, "wait_p50",
+                                 /*optional=*/true,
+                                 "Upper bound of the median time spent waiting "
+                                 "for a thread, in seconds. Omitted if no "
+                                 "request was handled"},
+                                {RPCResult::Type::NUM, "wait_p99",
+                                 /*optional=*/true,
+                                 "Upper bound of the 99th percentile of the "
+                                 "time spent waiting for a thread, in seconds"},
+                                {RPCResult::Type::NUM, "run_p50",
+                                 /*optional=*/true,
+                                 "Upper bound of the median time spent "
+                                 "handling a request, in seconds"},
+                                {RPCResult::Type::NUM, "run_p99",
+                                 /*optional=*/true,
+                                 "Upper bound of the 99th percentile of the "
+                                 "time spent handling a request, in seconds"},
+                            }},
+                       }},
                   }},
         RPCExamples{HelpExampleCli("getrpcinfo", "") +
                     HelpExampleRpc("getrpcinfo", "")},
@@ -305,6 +360,36 @@ static RPCHelpMan getrpcinfo() {
             UniValue log_path(UniValue::VSTR, path);
             result.pushKV("logpath", std::move(log_path));
 
+            UniValue work_queues(UniValue::VARR);
+            for (const HTTPWorkQueueStats &stats : GetHTTPWorkQueueStats()) {
+                UniValue queue(UniValue::VOBJ);
+                queue.pushKV("name", stats.name);
+                queue.pushKV("threads", stats.threads);
+                UniValue targets(UniValue::VARR);
+                for (const std::string &target : stats.targets) {
+                    targets.push_back(target);
+                }
+                queue.pushKV("targets", std::move(targets));
+                queue.pushKV("depth", uint64_t(stats.depth));
+                queue.pushKV("max_depth", uint64_t(stats.max_depth));
+                queue.pushKV("processed", stats.processed);
+                queue.pushKV("rejected", stats.rejected);
+                for (const auto &[key, snapshot] :
+                     {std::make_pair("wait", &stats.wait_time),
+                      std::make_pair("run", &stats.run_time)}) {
+                    for (const auto &[suffix, q] :
+                         {std::make_pair("_p50", 0.5),
+                          std::make_pair("_p99", 0.99)}) {
+                        if (auto bound = snapshot->GetQuantileUpperBound(q)) {
+                            queue.pushKV(std::string{key} + suffix,
+                                         Ticks<SecondsDouble>(*bound));
+                        }
+                    }
+                }
+                work_queues.push_back(std::move(queue));
+            }
+            result.pushKV("work_queues", std::move(work_queues));
+
             return result;
         }};
 }
@@ -436,10 +521,19 @@ static UniValue JSONRPCExecOne(const Config &config, RPCServer &rpcServer,
 }
 
 std::string JSONRPCExecBatch(const Config &config, RPCServer &rpcServer,
-                             const JSONRPCRequest &jreq, const UniValue &vReq) {
+                             const JSONRPCRequest &jreq, const UniValue &vReq,
+                             int max_threads) {
+    std::vector<UniValue> replies(vReq.size());
+    // JSONRPCExecOne() turns the errors into replies, so all the requests are
+    // executed
+    util::ParallelFor(vReq.size(), std::max(max_threads, 1), [&](size_t i) {
+        replies[i] = JSONRPCExecOne(config, rpcServer, jreq, vReq[i]);
+        return true;
+    });
+
     UniValue ret(UniValue::VARR);
-    for (size_t i = 0; i < vReq.size(); i++) {
-        ret.push_back(JSONRPCExecOne(config, rpcServer, jreq, vReq[i]));
+    for (UniValue &reply : replies) {
+        ret.push_back(std::move(reply));
     }
 
     return ret.write() + "\n";
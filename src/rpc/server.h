@@ -244,7 +244,12 @@ extern CRPCTable tableRPC;
 void StartRPC();
 void InterruptRPC();
 void StopRPC();
+/**
+ * Execute a batch of requests, on up to max_threads threads at once as the
+ * requests are independent. The replies are in the order of the requests.
+ */
 std::string JSONRPCExecBatch(const Config &config, RPCServer &rpcServer,
-                             const JSONRPCRequest &req, const UniValue &vReq);
+                             const JSONRPCRequest &req, const UniValue &vReq,
+                             int max_threads = 1);
 
 #endif // BITCOIN_RPC_SERVER_H
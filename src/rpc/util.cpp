@@ -638,7 +638,9 @@ UniValue RPCHelpMan::HandleRequest(const Config &config,
     m_req = &request;
     UniValue ret = m_fun(*this, config, request);
     m_req = nullptr;
-    if (gArgs.GetBoolArg("-rpcdoccheck", DEFAULT_RPC_DOC_CHECK)) {
+    // A streamed result was sent already and cannot be checked
+    if (gArgs.GetBoolArg("-rpcdoccheck", DEFAULT_RPC_DOC_CHECK) &&
+        !request.IsResultStreamed()) {
         UniValue mismatch{UniValue::VARR};
         for (const auto &res : m_results.m_results) {
             UniValue match{res.MatchesType(ret)};
@@ -0,0 +1,251 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockdownloadscheduler.h>
+
+#include <util/time.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+BOOST_FIXTURE_TEST_SUITE(blockdownloadscheduler_tests, BasicTestingSetup)
+
+/**
+ * Request num_blocks at once, the first one is received after latency and the
+ * next ones each interval after the previous one.
+ */
+static void DeliverBlocks(BlockDownloadScheduler &scheduler, NodeId peer,
+                          size_t num_blocks, size_t block_size,
+                          std::chrono::microseconds latency,
+                          std::chrono::microseconds interval) {
+    const std::chrono::microseconds request_time{1s};
+    for (size_t i = 0; i < num_blocks; ++i) {
+        scheduler.BlockReceived(peer, block_size, request_time,
+                                request_time + latency +
+                                    int64_t(i + 1) * interval);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(unmeasured_peers) {
+    BlockDownloadScheduler scheduler;
+    BOOST_CHECK_EQUAL(scheduler.GetInFlightTarget(0),
+                      DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER);
+    BOOST_CHECK(!scheduler.GetPeerStats(0));
+
+    // Not enough blocks to compare the peer yet
+    DeliverBlocks(scheduler, 0, MIN_BLOCKS_FOR_COMPARISON - 1, 1000, 10ms,
+                  0ms);
+    BOOST_CHECK_EQUAL(scheduler.GetInFlightTarget(0),
+                      DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER);
+    BOOST_CHECK_EQUAL(scheduler.GetPeerStats(0)->num_blocks,
+                      MIN_BLOCKS_FOR_COMPARISON - 1);
+    BOOST_CHECK(scheduler.GetPeerStats(0)->min_latency == 10ms);
+
+    DeliverBlocks(scheduler, 1, 100, 1000, 10ms, 0ms);
+    BOOST_CHECK(!scheduler.ShouldDuplicateRequest(1, 0));
+    BOOST_CHECK(!scheduler.ShouldDuplicateRequest(0, 1));
+    BOOST_CHECK(!scheduler.ShouldDuplicateRequest(1, 1));
+
+    scheduler.RemovePeer(0);
+    scheduler.RemovePeer(1);
+    BOOST_CHECK(!scheduler.GetPeerStats(0));
+    BOOST_CHECK(!scheduler.GetPeerStats(1));
+    BOOST_CHECK_EQUAL(scheduler.GetInFlightTarget(1),
+                      DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER);
+}
+
+BOOST_AUTO_TEST_CASE(proportional_targets) {
+    BlockDownloadScheduler scheduler;
+
+    // Same speed, same share
+    DeliverBlocks(scheduler, 0, 10, 1'000'000, 1ms, 100ms);
+    DeliverBlocks(scheduler, 1, 10, 1'000'000, 1ms, 100ms);
+    BOOST_CHECK_EQUAL(scheduler.GetInFlightTarget(0),
+                      DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER);
+    BOOST_CHECK_EQUAL(scheduler.GetInFlightTarget(1),
+                      DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER);
+
+    // A 10x slower and a 10x faster peer
+    DeliverBlocks(scheduler, 2, 10, 1'000'000, 1ms, 1000ms);
+    DeliverBlocks(scheduler, 3, 10, 1'000'000, 1ms, 10ms);
+    const auto slow_target{scheduler.GetInFlightTarget(2)};
+    const auto fast_target{scheduler.GetInFlightTarget(3)};
+    BOOST_CHECK_LT(slow_target, scheduler.GetInFlightTarget(0));
+    BOOST_CHECK_GT(fast_target, scheduler.GetInFlightTarget(0));
+    BOOST_CHECK_EQUAL(slow_target, MIN_BLOCKS_IN_FLIGHT_PER_PEER);
+    BOOST_CHECK_GT(fast_target, DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER);
+    BOOST_CHECK_LE(fast_target, MAX_BLOCKS_IN_FLIGHT_PER_PEER);
+
+    BOOST_CHECK(scheduler.ShouldDuplicateRequest(0, 2));
+    BOOST_CHECK(scheduler.ShouldDuplicateRequest(3, 0));
+    BOOST_CHECK(!scheduler.ShouldDuplicateRequest(0, 1));
+    BOOST_CHECK(!scheduler.ShouldDuplicateRequest(2, 3));
+
+    // Removing the fastest peer gives a bigger share to the others
+    const auto target{scheduler.GetInFlightTarget(0)};
+    scheduler.RemovePeer(3);
+    BOOST_CHECK_GT(scheduler.GetInFlightTarget(0), target);
+}
+
+BOOST_AUTO_TEST_CASE(latency_target) {
+    BlockDownloadScheduler scheduler;
+
+    // Both peers deliver about 10 blocks per second, but one of them is 3s
+    // away: it needs about 30 blocks in flight to stay busy during the round
+    // trip.
+    DeliverBlocks(scheduler, 0, 20, 1'000'000, 10ms, 100ms);
+    DeliverBlocks(scheduler, 1, 20, 1'000'000, 3000ms, 100ms);
+    BOOST_CHECK_GT(scheduler.GetInFlightTarget(1),
+                   scheduler.GetInFlightTarget(0));
+    BOOST_CHECK_GE(scheduler.GetInFlightTarget(1), 25);
+}
+
+/**
+ * Simulate the initial block download from peers with different bandwidths,
+ * following what PeerManagerImpl::SendMessages() does, and return the time it
+ * takes to sync.
+ */
+static std::chrono::microseconds
+SimulateSync(const std::vector<double> &bandwidths,
+             std::chrono::microseconds latency, bool use_scheduler) {
+    static constexpr int NUM_BLOCKS{1000};
+    static constexpr int WINDOW{128};
+    static constexpr size_t BLOCK_SIZE{1'000'000};
+
+    struct SimPeer {
+        double bandwidth;
+        std::chrono::microseconds link_free{0};
+        unsigned int in_flight{0};
+    };
+    std::vector<SimPeer> peers;
+    for (double bandwidth : bandwidths) {
+        peers.push_back({bandwidth});
+    }
+
+    BlockDownloadScheduler scheduler;
+    // Peers each block is requested from, in request order
+    std::vector<std::vector<NodeId>> requested(NUM_BLOCKS);
+    std::vector<bool> have(NUM_BLOCKS, false);
+    int tip{-1};
+
+    // Arrival time, peer, height, request time
+    using Arrival =
+        std::tuple<std::chrono::microseconds, NodeId, int,
+                   std::chrono::microseconds>;
+    std::priority_queue<Arrival, std::vector<Arrival>, std::greater<Arrival>>
+        arrivals;
+
+    auto request = [&](NodeId id, int height, std::chrono::microseconds now) {
+        SimPeer &peer = peers[id];
+        const auto start{std::max(now + latency, peer.link_free)};
+        peer.link_free =
+            start + std::chrono::microseconds{int64_t(
+                        double(BLOCK_SIZE) / peer.bandwidth * 1e6)};
+        arrivals.emplace(peer.link_free + latency, id, height, now);
+        requested[height].push_back(id);
+        ++peer.in_flight;
+    };
+
+    auto assign = [&](NodeId id, std::chrono::microseconds now) {
+        const unsigned int target{use_scheduler
+                                      ? scheduler.GetInFlightTarget(id)
+                                      : DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER};
+        const int window_end{std::min(tip + WINDOW, NUM_BLOCKS - 1)};
+        bool requested_any{false};
+        int first_in_flight{-1};
+        for (int height = tip + 1;
+             height <= window_end && peers[id].in_flight < target; ++height) {
+            if (have[height]) {
+                continue;
+            }
+            if (requested[height].empty()) {
+                request(id, height, now);
+                requested_any = true;
+            } else if (first_in_flight == -1) {
+                first_in_flight = height;
+            }
+        }
+        if (use_scheduler && !requested_any && peers[id].in_flight < target &&
+            first_in_flight != -1 && tip + WINDOW < NUM_BLOCKS - 1 &&
+            requested[first_in_flight].size() == 1 &&
+            scheduler.ShouldDuplicateRequest(id,
+                                             requested[first_in_flight][0])) {
+            request(id, first_in_flight, now);
+        }
+    };
+
+    for (NodeId id = 0; id < NodeId(peers.size()); ++id) {
+        assign(id, 0us);
+    }
+
+    std::chrono::microseconds now{0};
+    while (tip < NUM_BLOCKS - 1) {
+        BOOST_REQUIRE(!arrivals.empty());
+        const auto [arrival_time, id, height, request_time] = arrivals.top();
+        arrivals.pop();
+        now = arrival_time;
+
+        auto &requesters = requested[height];
+        auto it = std::find(requesters.begin(), requesters.end(), id);
+        if (it == requesters.end()) {
+            // The request was dropped when the block was received from
+            // another peer
+            continue;
+        }
+
+        scheduler.BlockReceived(id, BLOCK_SIZE, request_time, now);
+        if (!have[height]) {
+            have[height] = true;
+            // Drop the requests to the other peers
+            for (NodeId requester : requesters) {
+                --peers[requester].in_flight;
+            }
+            requesters.clear();
+            while (tip + 1 < NUM_BLOCKS && have[tip + 1]) {
+                ++tip;
+            }
+        }
+
+        for (NodeId peer = 0; peer < NodeId(peers.size()); ++peer) {
+            assign(peer, now);
+        }
+    }
+
+    return now;
+}
+
+BOOST_AUTO_TEST_CASE(simulated_sync) {
+    using std::chrono::milliseconds;
+
+    // Peers with the same bandwidth are not slowed down
+    const std::vector<double> same{5e6, 5e6, 5e6, 5e6};
+    const auto same_static{SimulateSync(same, 50ms, false)};
+    const auto same_scheduled{SimulateSync(same, 50ms, true)};
+    BOOST_TEST_MESSAGE("Same bandwidth: "
+                       << Ticks<milliseconds>(same_static) << "ms static, "
+                       << Ticks<milliseconds>(same_scheduled)
+                       << "ms scheduled");
+    BOOST_CHECK_LE(same_scheduled.count(), same_static.count() * 11 / 10);
+
+    // A slow peer no longer holds back the fast ones
+    const std::vector<double> mixed{10e6, 10e6, 10e6, 0.2e6};
+    const auto mixed_static{SimulateSync(mixed, 50ms, false)};
+    const auto mixed_scheduled{SimulateSync(mixed, 50ms, true)};
+    BOOST_TEST_MESSAGE("Mixed bandwidth: "
+                       << Ticks<milliseconds>(mixed_static) << "ms static, "
+                       << Ticks<milliseconds>(mixed_scheduled)
+                       << "ms scheduled");
+    BOOST_CHECK_LT(mixed_scheduled.count(), mixed_static.count() / 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -429,6 +429,52 @@ BOOST_AUTO_TEST_CASE(ReceiveWithExtraTransactions) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(ReceiveAfterMempoolChurn) {
+    CTxMemPool &pool = *Assert(m_node.mempool);
+    TestMemPoolEntryHelper entry;
+    auto rand_ctx(FastRandomContext(uint256{42}));
+    CBlock block(BuildBlockTestCase(rand_ctx));
+
+    LOCK2(cs_main, pool.cs);
+
+    // Surround the block transaction with unrelated ones, then remove some of
+    // them so the mempool hashes get moved around
+    std::vector<CTransactionRef> unrelated_txs;
+    for (size_t i = 0; i < 100; ++i) {
+        CMutableTransaction mtx = BuildTransactionTestCase();
+        mtx.vin[0].prevout = InsecureRandOutPoint(rand_ctx);
+        unrelated_txs.push_back(MakeTransactionRef(std::move(mtx)));
+        pool.addUnchecked(entry.FromTx(unrelated_txs.back()));
+        if (i == 50) {
+            pool.addUnchecked(entry.FromTx(block.vtx[2]));
+        }
+    }
+    for (size_t i = 0; i < unrelated_txs.size(); i += 3) {
+        pool.removeRecursive(*unrelated_txs[i], MemPoolRemovalReason::CONFLICT);
+    }
+
+    BOOST_CHECK_EQUAL(pool.txns_randomized.size(), pool.size());
+    for (size_t i = 0; i < pool.txns_randomized.size(); ++i) {
+        const auto &[txhash, it] = pool.txns_randomized[i];
+        BOOST_CHECK_EQUAL((*it)->idx_randomized, i);
+        BOOST_CHECK((*it)->GetTx().GetHash() == txhash);
+    }
+
+    const CBlockHeaderAndShortTxIDs cmpctblock{block, rand_ctx.rand64()};
+    PartiallyDownloadedBlock partial_block(m_node.chainman->GetConfig(),
+                                           &pool);
+    BOOST_CHECK(partial_block.InitData(cmpctblock, empty_extra_txn) ==
+                READ_STATUS_OK);
+    BOOST_CHECK(partial_block.IsTxAvailable(0));
+    BOOST_CHECK(!partial_block.IsTxAvailable(1));
+    BOOST_CHECK(partial_block.IsTxAvailable(2));
+
+    CBlock block2;
+    BOOST_CHECK(partial_block.FillBlock(block2, {block.vtx[1]}) ==
+                READ_STATUS_OK);
+    BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = BlockHash(m_rng.rand256());
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockservecache.h>
+
+#include <net.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+using node::BlockServeCache;
+
+BOOST_FIXTURE_TEST_SUITE(blockservecache_tests, BasicTestingSetup)
+
+static std::shared_ptr<const SharedNetPayload> MakePayload(size_t size) {
+    return std::make_shared<const SharedNetPayload>(
+        std::vector<uint8_t>(size, 0x42));
+}
+
+BOOST_AUTO_TEST_CASE(lru_eviction) {
+    // Measure the usage of a single entry
+    size_t entry_usage;
+    {
+        BlockServeCache cache{1 << 20};
+        cache.AddSerialized(BlockHash{m_rng.rand256()}, MakePayload(1000));
+        entry_usage = cache.GetStats().usage;
+        BOOST_CHECK_GE(entry_usage, 1000);
+    }
+
+    // Room for exactly 3 entries
+    BlockServeCache cache{3 * entry_usage};
+    std::vector<BlockHash> hashes;
+    for (size_t i = 0; i < 4; ++i) {
+        hashes.push_back(BlockHash{m_rng.rand256()});
+    }
+
+    std::vector<std::shared_ptr<const SharedNetPayload>> payloads;
+    for (size_t i = 0; i < 3; ++i) {
+        payloads.push_back(MakePayload(1000));
+        cache.AddSerialized(hashes[i], payloads.back());
+    }
+    auto stats{cache.GetStats()};
+    BOOST_CHECK_EQUAL(stats.serialized_count, 3);
+    BOOST_CHECK_EQUAL(stats.usage, 3 * entry_usage);
+
+    // Touch the oldest entry so the second one becomes the least recently used
+    BOOST_CHECK(cache.GetSerialized(hashes[0]) == payloads[0]);
+
+    // Adding a fourth entry evicts the second one
+    cache.AddSerialized(hashes[3], MakePayload(1000));
+    stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.serialized_count, 3);
+    BOOST_CHECK(stats.usage <= stats.max_usage);
+    BOOST_CHECK(cache.GetSerialized(hashes[0]) == payloads[0]);
+    BOOST_CHECK(cache.GetSerialized(hashes[1]) == nullptr);
+    BOOST_CHECK(cache.GetSerialized(hashes[2]) == payloads[2]);
+    BOOST_CHECK(cache.GetSerialized(hashes[3]) != nullptr);
+
+    // The evicted payload is still alive while referenced elsewhere
+    BOOST_CHECK_EQUAL(payloads[1]->data.size(), 1000);
+
+    stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.serialized_hits, 4);
+    BOOST_CHECK_EQUAL(stats.serialized_misses, 1);
+    BOOST_CHECK_EQUAL(stats.decoded_hits, 0);
+    BOOST_CHECK_EQUAL(stats.decoded_misses, 0);
+}
+
+BOOST_AUTO_TEST_CASE(byte_budget) {
+    BlockServeCache cache{10000};
+
+    // An entry larger than half the budget is never cached
+    const BlockHash big_hash{BlockHash{m_rng.rand256()}};
+    cache.AddSerialized(big_hash, MakePayload(6000));
+    BOOST_CHECK(cache.GetSerialized(big_hash) == nullptr);
+    BOOST_CHECK_EQUAL(cache.GetStats().usage, 0);
+
+    // A disabled cache never holds anything
+    BlockServeCache disabled{0};
+    const BlockHash hash{BlockHash{m_rng.rand256()}};
+    disabled.AddSerialized(hash, MakePayload(1));
+    BOOST_CHECK(disabled.GetSerialized(hash) == nullptr);
+    BOOST_CHECK_EQUAL(disabled.GetStats().serialized_count, 0);
+
+    // Fill the cache with small entries, it never exceeds its budget
+    for (size_t i = 0; i < 100; ++i) {
+        cache.AddSerialized(BlockHash{m_rng.rand256()}, MakePayload(500));
+        BOOST_CHECK(cache.GetStats().usage <= 10000);
+    }
+    BOOST_CHECK(cache.GetStats().serialized_count > 0);
+}
+
+BOOST_AUTO_TEST_CASE(serialized_and_decoded) {
+    BlockServeCache cache{1 << 20};
+
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vout.resize(1);
+    auto block{std::make_shared<CBlock>()};
+    block->vtx.push_back(MakeTransactionRef(mtx));
+    const BlockHash hash{block->GetHash()};
+
+    // Serialized and decoded blocks are looked up separately
+    cache.AddDecoded(hash, block);
+    BOOST_CHECK(cache.GetSerialized(hash) == nullptr);
+    BOOST_CHECK(cache.GetDecoded(hash) == block);
+
+    const auto payload{MakePayload(100)};
+    cache.AddSerialized(hash, payload);
+    BOOST_CHECK(cache.GetSerialized(hash) == payload);
+    BOOST_CHECK(cache.GetDecoded(hash) == block);
+
+    // Adding the same block again is a no-op
+    const size_t usage{cache.GetStats().usage};
+    cache.AddDecoded(hash, std::make_shared<CBlock>(*block));
+    BOOST_CHECK(cache.GetDecoded(hash) == block);
+    BOOST_CHECK_EQUAL(cache.GetStats().usage, usage);
+
+    const auto stats{cache.GetStats()};
+    BOOST_CHECK_EQUAL(stats.serialized_count, 1);
+    BOOST_CHECK_EQUAL(stats.decoded_count, 1);
+    BOOST_CHECK_EQUAL(stats.serialized_hits, 1);
+    BOOST_CHECK_EQUAL(stats.serialized_misses, 1);
+    BOOST_CHECK_EQUAL(stats.decoded_hits, 3);
+    BOOST_CHECK_EQUAL(stats.decoded_misses, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,7 @@
 #include <coins.h>
 
 #include <clientversion.h>
+#include <kernel/coinstats.h>
 #include <script/standard.h>
 #include <streams.h>
 #include <test/util/poolresourcetester.h>
@@ -18,6 +19,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <variant>
@@ -1318,4 +1320,95 @@ BOOST_AUTO_TEST_CASE(get_spent_coins_test) {
     BOOST_CHECK(!GetSpentCoins(tx_partial, coins_cache).has_value());
 }
 
+BOOST_AUTO_TEST_CASE(ccoins_view_db_cursors) {
+    CCoinsViewDB db{
+        {.path = "test", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    const auto add_coins = [&](size_t num_txs) {
+        CCoinsViewCache cache{&db};
+        for (size_t i = 0; i < num_txs; ++i) {
+            const TxId txid{m_rng.rand256()};
+            const uint32_t num_outputs{1 + m_rng.randrange<uint32_t>(3)};
+            for (uint32_t n = 0; n < num_outputs; ++n) {
+                cache.AddCoin(COutPoint{txid, n},
+                              Coin{CTxOut{1 * COIN, CScript() << OP_TRUE},
+                                   1, false},
+                              /*possible_overwrite=*/false);
+            }
+        }
+        cache.SetBestBlock(BlockHash{m_rng.rand256()});
+        cache.Flush();
+    };
+    const auto read_coins = [](CCoinsViewCursor &cursor) {
+        std::vector<COutPoint> outpoints;
+        for (; cursor.Valid(); cursor.Next()) {
+            COutPoint outpoint;
+            BOOST_REQUIRE(cursor.GetKey(outpoint));
+            outpoints.push_back(outpoint);
+        }
+        return outpoints;
+    };
+
+    add_coins(1000);
+    const std::vector<COutPoint> all_outpoints{
+        read_coins(*std::unique_ptr<CCoinsViewCursor>(db.Cursor()))};
+    BOOST_CHECK_GE(all_outpoints.size(), 1000);
+
+    for (size_t count : {0, 1, 2, 3, 7, 64, 256, 1000}) {
+        const auto cursors{db.Cursors(count)};
+        const size_t num_ranges{std::clamp<size_t>(count, 1, 256)};
+        BOOST_REQUIRE_EQUAL(cursors.size(), num_ranges);
+
+        // The ranges are consecutive, split by the first byte of the txids
+        std::vector<COutPoint> outpoints;
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            for (const COutPoint &outpoint : read_coins(*cursors[i])) {
+                const size_t first_byte{*outpoint.GetTxId().begin()};
+                BOOST_CHECK_GE(first_byte, i * 256 / num_ranges);
+                BOOST_CHECK_LT(first_byte, (i + 1) * 256 / num_ranges);
+                outpoints.push_back(outpoint);
+            }
+        }
+        BOOST_CHECK(outpoints == all_outpoints);
+    }
+
+    // The cursors don't see the coins written after they were created
+    const auto cursors{db.Cursors(4)};
+    add_coins(100);
+    std::vector<COutPoint> outpoints;
+    for (const auto &cursor : cursors) {
+        for (const COutPoint &outpoint : read_coins(*cursor)) {
+            outpoints.push_back(outpoint);
+        }
+    }
+    BOOST_CHECK(outpoints == all_outpoints);
+}
+
+BOOST_FIXTURE_TEST_CASE(compute_utxo_stats_threads, TestChain100Setup) {
+    Chainstate &chainstate{m_node.chainman->ActiveChainstate()};
+    WITH_LOCK(::cs_main, chainstate.ForceFlushStateToDisk());
+
+    for (const auto hash_type : {kernel::CoinStatsHashType::MUHASH,
+                                 kernel::CoinStatsHashType::NONE}) {
+        const auto stats{kernel::ComputeUTXOStats(
+            hash_type, &chainstate.CoinsDB(), chainstate.m_blockman, [] {})};
+        BOOST_REQUIRE(stats);
+        BOOST_CHECK_GE(stats->nTransactions, 100);
+        for (size_t num_threads : {2, 4, 16}) {
+            const auto thread_stats{kernel::ComputeUTXOStats(
+                hash_type, &chainstate.CoinsDB(), chainstate.m_blockman,
+                [] {}, num_threads)};
+            BOOST_REQUIRE(thread_stats);
+            BOOST_CHECK_EQUAL(thread_stats->nTransactions,
+                              stats->nTransactions);
+            BOOST_CHECK_EQUAL(thread_stats->nTransactionOutputs,
+                              stats->nTransactionOutputs);
+            BOOST_CHECK_EQUAL(thread_stats->nBogoSize, stats->nBogoSize);
+            BOOST_CHECK_EQUAL(thread_stats->coins_count, stats->coins_count);
+            BOOST_CHECK(thread_stats->total_amount == stats->total_amount);
+            BOOST_CHECK_EQUAL(thread_stats->hashSerialized,
+                              stats->hashSerialized);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -11,6 +11,8 @@
 #include <config.h>
 #include <net.h>
 #include <net_processing.h>
+#include <netmessagemaker.h>
+#include <protocol.h>
 #include <script/sign.h>
 #include <script/signingprovider.h>
 #include <script/standard.h>
@@ -25,8 +27,11 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
+#include <thread>
+#include <vector>
 
 static CService ip(uint32_t i) {
     struct in_addr s;
@@ -312,4 +317,103 @@ BOOST_AUTO_TEST_CASE(DoS_bantime) {
     peerLogic->FinalizeNode(config, dummyNode);
 }
 
+BOOST_AUTO_TEST_CASE(getdata_served_without_msgproc_mutex) {
+    const Config &config = m_node.chainman->GetConfig();
+
+    auto connman = std::make_unique<ConnmanTestMsg>(config, 0x1337, 0x1337,
+                                                    *m_node.addrman);
+    auto peerman =
+        PeerManager::make(*connman, *m_node.addrman, nullptr, *m_node.chainman,
+                          *m_node.mempool, /*avalanche=*/nullptr, {});
+    CConnman::Options options;
+    options.m_msgproc = {peerman.get()};
+    connman->Init(options);
+
+    CAddress addr1(ip(0xa0b0c001), NODE_NONE);
+    CNode downloader(id++, /*sock=*/nullptr, addr1,
+                     /* nKeyedNetGroupIn */ 0, /* nLocalHostNonceIn */ 0,
+                     /* nLocalExtraEntropyIn */ 0, CAddress(), /* pszDest */ "",
+                     ConnectionType::INBOUND, /* inbound_onion */ false);
+    CAddress addr2(ip(0xa0b0c002), NODE_NONE);
+    CNode other(id++, /*sock=*/nullptr, addr2,
+                /* nKeyedNetGroupIn */ 1, /* nLocalHostNonceIn */ 1,
+                /* nLocalExtraEntropyIn */ 1, CAddress(), /* pszDest */ "",
+                ConnectionType::INBOUND, /* inbound_onion */ false);
+    {
+        LOCK(NetEventsInterface::g_msgproc_mutex);
+        for (CNode *node : {&downloader, &other}) {
+            connman->Handshake(
+                /*node=*/*node,
+                /*successfully_connected=*/true,
+                /*remote_services=*/ServiceFlags(NODE_NETWORK),
+                /*local_services=*/ServiceFlags(NODE_NETWORK),
+                /*version=*/PROTOCOL_VERSION,
+                /*relay_txs=*/true);
+        }
+    }
+    TestOnlyResetTimeData();
+
+    // Hold the block being served to the downloader until the other peer was
+    // processed.
+    Mutex capture_mutex;
+    std::condition_variable capture_cond;
+    bool block_pushed{false};
+    bool pong_pushed{false};
+    bool other_processed{false};
+    const auto CaptureMessageOrig = CaptureMessage;
+    CaptureMessage = [&](const CAddress &addr, const std::string &msg_type,
+                         Span<const uint8_t> data, bool is_incoming) {
+        if (is_incoming) {
+            return;
+        }
+        WAIT_LOCK(capture_mutex, lock);
+        if (addr == downloader.addr && msg_type == NetMsgType::BLOCK) {
+            block_pushed = true;
+            capture_cond.notify_all();
+            capture_cond.wait_for(lock, 60s, [&] { return other_processed; });
+        } else if (addr == other.addr && msg_type == NetMsgType::PONG) {
+            pong_pushed = true;
+        }
+    };
+    m_node.args->ForceSetArg("-capturemessages", "1");
+
+    const std::vector<CInv> genesis_inv{
+        CInv{MSG_BLOCK, config.GetChainParams().GenesisBlock().GetHash()}};
+    CSerializedNetMsg getdata{NetMsg::Make(NetMsgType::GETDATA, genesis_inv)};
+    BOOST_CHECK(connman->ReceiveMsgFrom(downloader, getdata));
+    {
+        LOCK(NetEventsInterface::g_msgproc_mutex);
+        connman->ProcessMessagesOnce(downloader);
+    }
+    // The block is not served while handling the message
+    BOOST_CHECK(WITH_LOCK(capture_mutex, return !block_pushed));
+
+    std::thread serving{[&] { connman->ServeRequestsOnce(downloader); }};
+    {
+        WAIT_LOCK(capture_mutex, lock);
+        BOOST_CHECK(
+            capture_cond.wait_for(lock, 60s, [&] { return block_pushed; }));
+    }
+
+    // The other peer is processed while the block is being served
+    CSerializedNetMsg ping{NetMsg::Make(NetMsgType::PING, uint64_t{42})};
+    BOOST_CHECK(connman->ReceiveMsgFrom(other, ping));
+    {
+        LOCK(NetEventsInterface::g_msgproc_mutex);
+        connman->ProcessMessagesOnce(other);
+    }
+    {
+        LOCK(capture_mutex);
+        BOOST_CHECK(pong_pushed);
+        other_processed = true;
+    }
+    capture_cond.notify_all();
+    serving.join();
+
+    m_node.args->ForceSetArg("-capturemessages", "0");
+    CaptureMessage = CaptureMessageOrig;
+    peerman->FinalizeNode(config, downloader);
+    peerman->FinalizeNode(config, other);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <flatset.h>
+
+#include <random.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <functional>
+#include <set>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(flatset_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(flatset_basic) {
+    flatset<int> s;
+    BOOST_CHECK(s.empty());
+    BOOST_CHECK_EQUAL(s.size(), 0);
+
+    BOOST_CHECK(s.insert(3).second);
+    BOOST_CHECK(s.insert(1).second);
+    BOOST_CHECK(s.insert(2).second);
+    BOOST_CHECK(!s.insert(2).second);
+    BOOST_CHECK_EQUAL(s.size(), 3);
+
+    // Elements are kept sorted
+    BOOST_CHECK((std::vector<int>(s.begin(), s.end()) ==
+                 std::vector<int>{1, 2, 3}));
+
+    BOOST_CHECK_EQUAL(s.count(1), 1);
+    BOOST_CHECK_EQUAL(s.count(4), 0);
+    BOOST_CHECK(s.find(2) != s.end());
+    BOOST_CHECK_EQUAL(*s.find(2), 2);
+    BOOST_CHECK(s.find(4) == s.end());
+
+    BOOST_CHECK_EQUAL(s.erase(4), 0);
+    BOOST_CHECK_EQUAL(s.erase(2), 1);
+    BOOST_CHECK_EQUAL(s.erase(2), 0);
+    BOOST_CHECK((std::vector<int>(s.begin(), s.end()) ==
+                 std::vector<int>{1, 3}));
+
+    auto it = s.erase(s.begin());
+    BOOST_CHECK_EQUAL(*it, 3);
+    BOOST_CHECK_EQUAL(s.size(), 1);
+
+    s.clear();
+    BOOST_CHECK(s.empty());
+
+    BOOST_CHECK(flatset<int>({3, 1, 2, 1}) == flatset<int>({1, 2, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(flatset_comparator) {
+    flatset<int, std::greater<int>> s{1, 5, 3};
+    BOOST_CHECK((std::vector<int>(s.begin(), s.end()) ==
+                 std::vector<int>{5, 3, 1}));
+    BOOST_CHECK_EQUAL(s.count(3), 1);
+    BOOST_CHECK(!s.insert(5).second);
+}
+
+BOOST_AUTO_TEST_CASE(flatset_matches_std_set) {
+    FastRandomContext rng(/*fDeterministic=*/true);
+
+    flatset<uint32_t> s;
+    std::set<uint32_t> ref;
+    for (int i = 0; i < 10000; i++) {
+        const uint32_t value = rng.randrange(200);
+        switch (rng.randrange(3)) {
+            case 0:
+            case 1:
+                BOOST_CHECK_EQUAL(s.insert(value).second,
+                                  ref.insert(value).second);
+                break;
+            case 2:
+                BOOST_CHECK_EQUAL(s.erase(value), ref.erase(value));
+                break;
+        }
+        BOOST_CHECK_EQUAL(s.count(value), ref.count(value));
+        BOOST_CHECK_EQUAL(s.size(), ref.size());
+    }
+
+    BOOST_CHECK(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -47,6 +47,10 @@ FUZZ_TARGET(node_eviction) {
             fuzzed_data_provider.PickValueInArray(ALL_CONNECTION_TYPES),
             /*availabilityScore=*/
             fuzzed_data_provider.ConsumeFloatingPoint<double>(),
+            /*m_recent_msg_processing_time=*/
+            std::chrono::microseconds{
+                fuzzed_data_provider.ConsumeIntegralInRange<int64_t>(
+                    0, std::chrono::microseconds{24h}.count())},
         });
     }
     // Make a copy since eviction_candidates may be in some valid but otherwise
@@ -53,8 +53,6 @@ void fuzz_target(const std::vector<uint8_t> &buffer,
     FuzzedDataProvider fuzzed_data_provider(buffer.data(), buffer.size());
     ConnmanTestMsg &connman = *(ConnmanTestMsg *)g_setup->m_node.connman.get();
 
-    LOCK(NetEventsInterface::g_msgproc_mutex);
-
     const std::string random_message_type{
         fuzzed_data_provider
             .ConsumeBytesAsString(CMessageHeader::MESSAGE_TYPE_SIZE)
@@ -74,12 +72,17 @@ void fuzz_target(const std::vector<uint8_t> &buffer,
     // fuzzed_data_provider is fully consumed after this call, don't use it
     DataStream random_bytes_data_stream{
         fuzzed_data_provider.ConsumeRemainingBytes<uint8_t>()};
-    try {
-        g_setup->m_node.peerman->ProcessMessage(
-            config, p2p_node, random_message_type, random_bytes_data_stream,
-            GetTime<std::chrono::microseconds>(), std::atomic<bool>{false});
-    } catch (const std::ios_base::failure &) {
+    {
+        LOCK(NetEventsInterface::g_msgproc_mutex);
+        try {
+            g_setup->m_node.peerman->ProcessMessage(
+                config, p2p_node, random_message_type, random_bytes_data_stream,
+                GetTime<std::chrono::microseconds>(), std::atomic<bool>{false});
+        } catch (const std::ios_base::failure &) {
+        }
     }
+    // Serve the data requested by the message, if any
+    connman.ServeRequestsOnce(p2p_node);
     SyncWithValidationInterfaceQueue();
     g_setup->m_node.connman->StopNodes();
 }
@@ -153,7 +153,7 @@ class Tester {
     }
 
 public:
-    Tester() : m_tracker(true) {}
+    explicit Tester(InvRequestTrackerImplType type) : m_tracker(true, type) {}
 
     std::chrono::microseconds Now() const { return m_now; }
 
@@ -328,9 +328,10 @@ public:
 };
 } // namespace
 
-FUZZ_TARGET(txrequest) {
+static void FuzzTxRequest(const std::vector<uint8_t> &buffer,
+                          InvRequestTrackerImplType type) {
     // Tester object (which encapsulates a TxRequestTracker).
-    Tester tester;
+    Tester tester(type);
 
     // Decode the input as a sequence of instructions with parameters
     auto it = buffer.begin();
@@ -404,3 +405,11 @@ FUZZ_TARGET(txrequest) {
     }
     tester.Check();
 }
+
+FUZZ_TARGET(txrequest) {
+    FuzzTxRequest(buffer, InvRequestTrackerImplType::ORDERED);
+}
+
+FUZZ_TARGET(txrequest_flat) {
+    FuzzTxRequest(buffer, InvRequestTrackerImplType::FLAT);
+}
@@ -47,6 +47,17 @@ ssize_t FuzzedSock::Send(const void *data, size_t len, int flags) const {
     return r;
 }
 
+ssize_t FuzzedSock::SendMany(Span<const Span<const uint8_t>> buffers,
+                             int flags) const {
+    size_t len{0};
+    for (const auto &buffer :
+         buffers.first(std::min(buffers.size(), MAX_SEND_BUFFERS))) {
+        len += buffer.size();
+    }
+    // The data itself is ignored, like in Send()
+    return Send(nullptr, len, flags);
+}
+
 ssize_t FuzzedSock::Recv(void *buf, size_t len, int flags) const {
     constexpr std::array<int, 10> recv_errnos{{
         EAGAIN,
@@ -57,6 +57,9 @@ public:
 
     ssize_t Send(const void *data, size_t len, int flags) const override;
 
+    ssize_t SendMany(Span<const Span<const uint8_t>> buffers,
+                     int flags) const override;
+
     ssize_t Recv(void *buf, size_t len, int flags) const override;
 
     int Bind(const sockaddr *, socklen_t) const override;
@@ -0,0 +1,127 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/latency.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+BOOST_FIXTURE_TEST_SUITE(latency_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(bucket_index) {
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(-5us), 0);
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(0us), 0);
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(1us), 0);
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(2us), 1);
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(3us), 2);
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(4us), 2);
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(5us), 3);
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(1024us), 10);
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(1025us), 11);
+
+    // Every duration falls into the first bucket which bound is not lower
+    for (size_t i = 0; i + 1 < LatencyHistogram::NUM_BUCKETS; ++i) {
+        const auto bound = LatencyHistogram::GetBucketUpperBound(i);
+        BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(bound), i);
+        BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(bound + 1us),
+                          i + 1);
+    }
+
+    // Large durations end up in the unbounded bucket
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(1h),
+                      LatencyHistogram::NUM_BUCKETS - 1);
+}
+
+BOOST_AUTO_TEST_CASE(observe_and_snapshot) {
+    LatencyHistogram histogram{"latency_tests_observe", "Test histogram"};
+
+    auto snapshot = histogram.GetSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.count, 0);
+    BOOST_CHECK(snapshot.sum == 0us);
+    BOOST_CHECK(!snapshot.GetQuantileUpperBound(0.5));
+
+    for (int i = 0; i < 98; ++i) {
+        histogram.Observe(3us);
+    }
+    histogram.Observe(100us);
+    histogram.Observe(std::chrono::duration_cast<SteadyClock::duration>(1h));
+
+    snapshot = histogram.GetSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.count, 100);
+    BOOST_CHECK(snapshot.sum == 98 * 3us + 100us + 1h);
+    BOOST_CHECK_EQUAL(snapshot.buckets[2], 98);
+    BOOST_CHECK_EQUAL(snapshot.buckets[7], 1);
+    BOOST_CHECK_EQUAL(snapshot.buckets[LatencyHistogram::NUM_BUCKETS - 1], 1);
+
+    BOOST_CHECK(snapshot.GetQuantileUpperBound(0) == 4us);
+    BOOST_CHECK(snapshot.GetQuantileUpperBound(0.5) == 4us);
+    BOOST_CHECK(snapshot.GetQuantileUpperBound(0.98) == 4us);
+    BOOST_CHECK(snapshot.GetQuantileUpperBound(0.99) == 128us);
+    BOOST_CHECK(!snapshot.GetQuantileUpperBound(1));
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_observe) {
+    LatencyHistogram histogram{"latency_tests_concurrent", "Test histogram"};
+
+    constexpr int NUM_THREADS{10};
+    constexpr int NUM_OBSERVATIONS{1000};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&histogram, t] {
+            for (int i = 0; i < NUM_OBSERVATIONS; ++i) {
+                histogram.Observe(std::chrono::microseconds{t});
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    const auto snapshot = histogram.GetSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.count, NUM_THREADS * NUM_OBSERVATIONS);
+    BOOST_CHECK(snapshot.sum ==
+                NUM_OBSERVATIONS * std::chrono::microseconds{
+                                       NUM_THREADS * (NUM_THREADS - 1) / 2});
+}
+
+BOOST_AUTO_TEST_CASE(registry) {
+    LatencyHistogram histogram_b{"latency_tests_b", "Second test histogram"};
+    LatencyHistogram histogram_a{"latency_tests_a", "First test histogram"};
+    histogram_a.Observe(1us);
+    histogram_a.Observe(10us);
+
+    // The histograms are returned sorted by name
+    const auto histograms = GetLatencyRegistry().GetHistograms();
+    auto it_a = std::find(histograms.begin(), histograms.end(), &histogram_a);
+    auto it_b = std::find(histograms.begin(), histograms.end(), &histogram_b);
+    BOOST_CHECK(it_a != histograms.end());
+    BOOST_CHECK(it_b != histograms.end());
+    BOOST_CHECK(it_a < it_b);
+
+    const std::string prometheus = GetLatencyRegistry().ToPrometheus();
+    for (const char *line : {
+             "# HELP doged_latency_tests_a_seconds First test histogram\n",
+             "# TYPE doged_latency_tests_a_seconds histogram\n",
+             "doged_latency_tests_a_seconds_bucket{le=\"1e-06\"} 1\n",
+             "doged_latency_tests_a_seconds_bucket{le=\"8e-06\"} 1\n",
+             "doged_latency_tests_a_seconds_bucket{le=\"1.6e-05\"} 2\n",
+             "doged_latency_tests_a_seconds_bucket{le=\"+Inf\"} 2\n",
+             "doged_latency_tests_a_seconds_sum 0.000011\n",
+             "doged_latency_tests_a_seconds_count 2\n",
+             "doged_latency_tests_b_seconds_count 0\n",
+         }) {
+        BOOST_CHECK_MESSAGE(prometheus.find(line) != std::string::npos, line);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
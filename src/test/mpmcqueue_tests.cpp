@@ -0,0 +1,100 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/mpmcqueue.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(mpmcqueue_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(capacity) {
+    BOOST_CHECK_EQUAL(MPMCQueue<int>(0).Capacity(), 2);
+    BOOST_CHECK_EQUAL(MPMCQueue<int>(2).Capacity(), 2);
+    BOOST_CHECK_EQUAL(MPMCQueue<int>(3).Capacity(), 4);
+    BOOST_CHECK_EQUAL(MPMCQueue<int>(16).Capacity(), 16);
+    BOOST_CHECK_EQUAL(MPMCQueue<int>(17).Capacity(), 32);
+}
+
+BOOST_AUTO_TEST_CASE(fifo) {
+    MPMCQueue<std::unique_ptr<int>> queue(4);
+    BOOST_CHECK(queue.Empty());
+
+    std::unique_ptr<int> value;
+    BOOST_CHECK(!queue.TryPop(value));
+
+    // Go around the ring a few times
+    int next_push{0};
+    int next_pop{0};
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 4; ++i) {
+            BOOST_CHECK(queue.TryPush(std::make_unique<int>(next_push++)));
+        }
+        BOOST_CHECK(!queue.Empty());
+
+        // A full queue leaves the value to the caller
+        auto extra = std::make_unique<int>(-1);
+        BOOST_CHECK(!queue.TryPush(std::move(extra)));
+        BOOST_REQUIRE(extra);
+        BOOST_CHECK_EQUAL(*extra, -1);
+
+        for (int i = 0; i < 4; ++i) {
+            BOOST_REQUIRE(queue.TryPop(value));
+            BOOST_REQUIRE(value);
+            BOOST_CHECK_EQUAL(*value, next_pop++);
+        }
+        BOOST_CHECK(queue.Empty());
+        BOOST_CHECK(!queue.TryPop(value));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(concurrent) {
+    static constexpr int NUM_THREADS{4};
+    static constexpr uint64_t VALUES_PER_PRODUCER{10000};
+
+    MPMCQueue<uint64_t> queue(64);
+    std::atomic<uint64_t> popped_count{0};
+    std::atomic<uint64_t> popped_sum{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&] {
+            for (uint64_t i = 1; i <= VALUES_PER_PRODUCER; ++i) {
+                uint64_t value{i};
+                while (!queue.TryPush(std::move(value))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&] {
+            uint64_t value;
+            while (popped_count.load() < NUM_THREADS * VALUES_PER_PRODUCER) {
+                if (queue.TryPop(value)) {
+                    popped_sum += value;
+                    ++popped_count;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // Every value was popped exactly once
+    BOOST_CHECK_EQUAL(popped_count.load(), NUM_THREADS * VALUES_PER_PRODUCER);
+    BOOST_CHECK_EQUAL(popped_sum.load(), NUM_THREADS * VALUES_PER_PRODUCER *
+                                             (VALUES_PER_PRODUCER + 1) / 2);
+    BOOST_CHECK(queue.Empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
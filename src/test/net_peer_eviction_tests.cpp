@@ -599,6 +599,46 @@ BOOST_AUTO_TEST_CASE(node_eviction_test) {
                                        protectedNodes.end()),
             random_context));
 
+        // Among the unprotected peers, the ones that cost much more time to
+        // process their messages than the others are evicted first.
+        if (number_of_nodes >= 161) {
+            const auto setup_unprotected_peer =
+                [](NodeEvictionCandidate &candidate,
+                   std::chrono::microseconds processing_time) {
+                    candidate.prefer_evict = false;
+                    candidate.availabilityScore = 0.;
+                    if (candidate.id != 0) {
+                        candidate.nKeyedNetGroup = 1;
+                        return;
+                    }
+                    candidate.m_connected = std::chrono::seconds::max();
+                    candidate.m_min_ping_time =
+                        std::chrono::microseconds::max();
+                    candidate.m_last_block_time = 0s;
+                    candidate.m_last_proof_time = 0s;
+                    candidate.m_last_tx_time = 0s;
+                    candidate.m_relay_txs = true;
+                    candidate.nKeyedNetGroup = 0;
+                    candidate.m_is_local = false;
+                    candidate.m_network = NET_IPV4;
+                    candidate.m_recent_msg_processing_time = processing_time;
+                };
+            BOOST_CHECK(IsEvicted(
+                number_of_nodes,
+                [&](NodeEvictionCandidate &candidate) {
+                    setup_unprotected_peer(candidate, 1min);
+                },
+                {0}, random_context));
+            // Unless the cost is negligible
+            BOOST_CHECK(!IsEvicted(
+                number_of_nodes,
+                [&](NodeEvictionCandidate &candidate) {
+                    setup_unprotected_peer(candidate,
+                                           EXPENSIVE_PEER_MIN_TIME - 1us);
+                },
+                {0}, random_context));
+        }
+
         // An eviction is expected given >= 161 random eviction candidates.
         // The eviction logic protects at most four peers by net group,
         // eight by lowest ping time, four by last time of novel tx, four by
@@ -20,6 +20,7 @@
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <test/util/net.h>
 #include <test/util/validation.h>
 #include <threadsafety.h>
 #include <timedata.h>
@@ -41,6 +42,8 @@
 #include <ios>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace std::literals;
 using util::ToString;
@@ -126,6 +129,27 @@ struct CConnmanTest : public CConnman {
         return InactivityCheck(node);
     }
 
+    std::pair<size_t, bool> TestSocketSendData(CNode &node) const
+        EXCLUSIVE_LOCKS_REQUIRED(node.cs_vSend) {
+        return SocketSendData(node);
+    }
+
+#ifdef USE_EPOLL
+    void TestEnableEpoll() { m_epoll = std::make_unique<SockEpoll>(); }
+
+    void TestSocketHandlerEpoll() EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc) {
+        SocketHandlerEpoll();
+    }
+
+    /** Same as the end of OpenNetworkConnection() */
+    void TestAddConnectedNode(CNode *pnode)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_nodes_mutex) {
+        EpollAddNode(*pnode);
+        LOCK(m_nodes_mutex);
+        m_nodes.push_back(pnode);
+    }
+#endif
+
     void openNetworkConnection(const CAddress &addrConnect,
                                ConnectionType connType)
         EXCLUSIVE_LOCKS_REQUIRED(!cs) {
@@ -1569,4 +1593,231 @@ BOOST_AUTO_TEST_CASE(inactivity_check) {
     connman.ClearNodes();
 }
 
+BOOST_AUTO_TEST_CASE(send_queue) {
+    /** Record the data sent, accepting at most max_bytes per call */
+    class RecordingSock : public StaticContentsSock {
+    public:
+        explicit RecordingSock(size_t max_bytes)
+            : StaticContentsSock{""}, m_max_bytes{max_bytes} {}
+
+        ssize_t SendMany(Span<const Span<const uint8_t>> buffers,
+                         int) const override {
+            size_t sent{0};
+            for (const auto &buffer : buffers) {
+                const size_t len{std::min(buffer.size(), m_max_bytes - sent)};
+                m_sent.insert(m_sent.end(), buffer.begin(),
+                              buffer.begin() + len);
+                sent += len;
+            }
+            return sent;
+        }
+
+        const size_t m_max_bytes;
+        mutable std::vector<uint8_t> m_sent;
+    };
+
+    const Config &config = m_node.chainman->GetConfig();
+    CConnmanTest connman(config, 0x1337, 0x1337, *m_node.addrman);
+    CConnman::Options options;
+    options.nSendBufferMaxSize = 1000 * 1000;
+    connman.Init(options);
+
+    auto serialize = [&](const CSerializedNetMsg &msg) {
+        std::vector<uint8_t> data;
+        V1TransportSerializer{}.prepareForTransport(config, msg, data);
+        const Span<const uint8_t> payload{msg.GetPayload()};
+        data.insert(data.end(), payload.begin(), payload.end());
+        return data;
+    };
+
+    // A big payload shared by several nodes
+    std::vector<uint8_t> block_data(100'000);
+    for (size_t i = 0; i < block_data.size(); ++i) {
+        block_data[i] = i % 251;
+    }
+    const auto payload = std::make_shared<const SharedNetPayload>(
+        std::vector<uint8_t>(block_data));
+    auto make_block_msg = [&] {
+        CSerializedNetMsg msg;
+        msg.m_type = NetMsgType::BLOCK;
+        msg.shared_payload = payload;
+        return msg;
+    };
+
+    // The shared payload gets the same checksum as a regular payload
+    CSerializedNetMsg unshared_block_msg;
+    unshared_block_msg.m_type = NetMsgType::BLOCK;
+    unshared_block_msg.data = block_data;
+    std::vector<uint8_t> expected{serialize(unshared_block_msg)};
+    BOOST_CHECK(serialize(make_block_msg()) == expected);
+
+    // A small message before the block, coalesced with its header
+    const std::vector<uint8_t> ping{
+        serialize(NetMsg::Make(NetMsgType::PING, uint64_t{42}))};
+    expected.insert(expected.begin(), ping.begin(), ping.end());
+
+    // Exercise partial sends at various offsets within the buffers
+    for (size_t max_bytes : {size_t{7}, size_t{24}, size_t{4096},
+                             size_t{1000 * 1000}}) {
+        auto sock = std::make_shared<RecordingSock>(max_bytes);
+        CNode node{/*id=*/0,
+                   sock,
+                   CAddress{},
+                   /*nKeyedNetGroupIn=*/0,
+                   /*nLocalHostNonceIn=*/0,
+                   /*nLocalExtraEntropyIn=*/0,
+                   CAddress{},
+                   /*addrNameIn=*/"",
+                   ConnectionType::OUTBOUND_FULL_RELAY,
+                   /*inbound_onion=*/false};
+
+        connman.PushMessage(&node,
+                            NetMsg::Make(NetMsgType::PING, uint64_t{42}));
+        connman.PushMessage(&node, make_block_msg());
+        while (WITH_LOCK(node.cs_vSend,
+                         return connman.TestSocketSendData(node).second)) {
+        }
+
+        BOOST_CHECK(sock->m_sent == expected);
+        BOOST_CHECK(!node.m_send_pending);
+        LOCK(node.cs_vSend);
+        BOOST_CHECK(node.vSendMsg.empty());
+        BOOST_CHECK_EQUAL(node.nSendSize, 0);
+        BOOST_CHECK_EQUAL(node.nSendOffset, 0);
+        BOOST_CHECK_EQUAL(node.nSendBytes, expected.size());
+    }
+
+    // The send queues released the shared payload
+    BOOST_CHECK_EQUAL(payload.use_count(), 1);
+}
+
+#ifdef USE_EPOLL
+BOOST_AUTO_TEST_CASE(epoll_outbound_connected_while_waiting) {
+    const Config &config = m_node.chainman->GetConfig();
+    CConnmanTest connman(config, 0x1337, 0x1337, *m_node.addrman);
+    CConnman::Options options;
+    options.m_peer_connect_timeout = DEFAULT_PEER_CONNECT_TIMEOUT;
+    connman.Init(options);
+    connman.TestEnableEpoll();
+
+    int s[2];
+    BOOST_REQUIRE_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, s), 0);
+    Sock remote(s[1]);
+
+    // The version is queued but not sent yet, like when the optimistic send
+    // could not complete.
+    CNode *pnode = new CNode{connman.nodeid++,
+                             /*sock=*/nullptr,
+                             CAddress{},
+                             /*nKeyedNetGroupIn=*/0,
+                             /*nLocalHostNonceIn=*/0,
+                             /*nLocalExtraEntropyIn=*/0,
+                             CAddress{},
+                             /*addrNameIn=*/"",
+                             ConnectionType::OUTBOUND_FULL_RELAY,
+                             /*inbound_onion=*/false};
+    CSerializedNetMsg msg_version{
+        NetMsg::Make(NetMsgType::VERSION, PROTOCOL_VERSION, uint64_t{42})};
+    std::vector<uint8_t> expected;
+    V1TransportSerializer{}.prepareForTransport(config, msg_version, expected);
+    expected.insert(expected.end(), msg_version.data.begin(),
+                    msg_version.data.end());
+    connman.PushMessage(pnode, std::move(msg_version));
+    BOOST_CHECK(pnode->m_send_pending);
+    WITH_LOCK(pnode->m_sock_mutex,
+              pnode->m_sock = std::make_shared<Sock>(s[0]));
+
+    // The socket handler is blocked waiting for events when the connection
+    // is added, and its socket only becomes writable once.
+    std::atomic<bool> stop{false};
+    std::thread handler{[&] {
+        while (!stop) {
+            connman.TestSocketHandlerEpoll();
+        }
+    }};
+    std::this_thread::sleep_for(10ms);
+    connman.TestAddConnectedNode(pnode);
+
+    std::vector<uint8_t> received;
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (received.size() < expected.size() &&
+           std::chrono::steady_clock::now() < deadline) {
+        Sock::Event occurred{0};
+        if (!remote.Wait(100ms, Sock::RECV, &occurred) ||
+            !(occurred & Sock::RECV)) {
+            continue;
+        }
+        uint8_t buf[1024];
+        const ssize_t len{remote.Recv(buf, sizeof(buf), MSG_DONTWAIT)};
+        if (len > 0) {
+            received.insert(received.end(), buf, buf + len);
+        }
+    }
+    stop = true;
+    handler.join();
+
+    BOOST_CHECK(received == expected);
+    BOOST_CHECK(WITH_LOCK(pnode->cs_vSend, return pnode->vSendMsg.empty()));
+    BOOST_CHECK(!pnode->m_send_pending);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(msg_processing_tracker) {
+    const auto start{SteadyClock::now()};
+    MsgProcessingTracker tracker{start};
+    BOOST_CHECK(tracker.GetStats(start).empty());
+    BOOST_CHECK(tracker.GetRecentTime(start) == 0us);
+
+    tracker.Record(NetMsgType::INV, {1, 10us}, start);
+    tracker.Record(NetMsgType::INV, {1, 20us}, start + 1s);
+    // Serving the getdata requests is not a new message
+    tracker.Record(NetMsgType::GETDATA, {1, 5us}, start + 1s);
+    tracker.Record(NetMsgType::GETDATA, {0, 100us}, start + 2s);
+    // Unknown message types are accounted together
+    tracker.Record("foo", {1, 1us}, start + 2s);
+    tracker.Record("bar", {1, 2us}, start + 2s);
+
+    auto stats{tracker.GetStats(start + 2s)};
+    BOOST_CHECK_EQUAL(stats.size(), 3);
+    BOOST_CHECK_EQUAL(stats[NetMsgType::INV].total.count, 2);
+    BOOST_CHECK(stats[NetMsgType::INV].total.time == 30us);
+    BOOST_CHECK_EQUAL(stats[NetMsgType::INV].recent.count, 2);
+    BOOST_CHECK(stats[NetMsgType::INV].recent.time == 30us);
+    BOOST_CHECK_EQUAL(stats[NetMsgType::GETDATA].total.count, 1);
+    BOOST_CHECK(stats[NetMsgType::GETDATA].total.time == 105us);
+    BOOST_CHECK_EQUAL(stats[NET_MESSAGE_TYPE_OTHER].total.count, 2);
+    BOOST_CHECK(stats[NET_MESSAGE_TYPE_OTHER].total.time == 3us);
+    // Serving getdata requests is not held against the peer
+    BOOST_CHECK(tracker.GetRecentTime(start + 2s) == 33us);
+
+    // The next window still includes the previous one
+    const auto next_window{start + MSG_PROCESSING_WINDOW};
+    tracker.Record(NetMsgType::INV, {1, 40us}, next_window);
+    stats = tracker.GetStats(next_window);
+    BOOST_CHECK_EQUAL(stats[NetMsgType::INV].total.count, 3);
+    BOOST_CHECK_EQUAL(stats[NetMsgType::INV].recent.count, 3);
+    BOOST_CHECK(stats[NetMsgType::INV].recent.time == 70us);
+    BOOST_CHECK(tracker.GetRecentTime(next_window) == 73us);
+
+    // Without any new message, the first window expires
+    stats = tracker.GetStats(next_window + MSG_PROCESSING_WINDOW);
+    BOOST_CHECK_EQUAL(stats[NetMsgType::INV].recent.count, 1);
+    BOOST_CHECK(stats[NetMsgType::INV].recent.time == 40us);
+    BOOST_CHECK(stats[NetMsgType::GETDATA].recent.time == 0us);
+    BOOST_CHECK(tracker.GetRecentTime(next_window + MSG_PROCESSING_WINDOW) ==
+                40us);
+
+    // Then the second one, but the totals are kept
+    const auto later{next_window + 2 * MSG_PROCESSING_WINDOW};
+    BOOST_CHECK(tracker.GetRecentTime(later) == 0us);
+    tracker.Record(NetMsgType::GETDATA, {1, 7us}, later);
+    stats = tracker.GetStats(later);
+    BOOST_CHECK_EQUAL(stats[NetMsgType::INV].total.count, 3);
+    BOOST_CHECK_EQUAL(stats[NetMsgType::INV].recent.count, 0);
+    BOOST_CHECK_EQUAL(stats[NetMsgType::GETDATA].total.count, 2);
+    BOOST_CHECK(stats[NetMsgType::GETDATA].total.time == 112us);
+    BOOST_CHECK(stats[NetMsgType::GETDATA].recent.time == 7us);
+    BOOST_CHECK(tracker.GetRecentTime(later) == 0us);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -33,12 +33,7 @@ public:
 
     CTransactionRef RandomOrphan() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
         LOCK(m_mutex);
-        std::map<TxId, PoolTx>::iterator it;
-        it = m_pool_txs.lower_bound(TxId{m_rng.rand256()});
-        if (it == m_pool_txs.end()) {
-            it = m_pool_txs.begin();
-        }
-        return it->second.tx;
+        return m_txs_list[m_rng.randrange(m_txs_list.size())]->second.tx;
     }
 
     FastRandomContext &m_rng;
@@ -4,12 +4,14 @@
 
 #include <rpc/blockchain.h>
 #include <rpc/client.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
 
 #include <config.h>
 #include <interfaces/chain.h>
 #include <node/context.h>
+#include <util/strencodings.h>
 #include <util/time.h>
 
 #include <test/util/setup_common.h>
@@ -19,6 +21,8 @@
 #include <univalue.h>
 
 #include <any>
+#include <string_view>
+#include <vector>
 
 using util::SplitString;
 
@@ -847,4 +851,76 @@ BOOST_AUTO_TEST_CASE(rpc_arg_helper) {
              check_named);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_json_stream_writer) {
+    const UniValue header{JSON(R"({"hash": "00ff", "height": 3,)"
+                               R"( "nested": {"a": [1, {}], "b": null}})")};
+    const UniValue tx{JSON(R"({"txid": "ab\"cd", "vout": [], "x": 1.5})")};
+
+    UniValue expected{header};
+    expected.pushKV("key \"\n", "value");
+    UniValue txs{UniValue::VARR};
+    for (int i = 0; i < 10; ++i) {
+        txs.push_back(tx);
+    }
+    expected.pushKV("tx", txs);
+    expected.pushKV("empty", UniValue{UniValue::VARR});
+    std::vector<uint8_t> data(100);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = uint8_t(i * 7);
+    }
+    expected.pushKV("hex", HexStr(data));
+
+    for (size_t chunk_size : {size_t{1}, size_t{7}, size_t{1 << 20}}) {
+        std::string output;
+        size_t chunks{0};
+        JSONStreamWriter writer{[&](std::string_view chunk) {
+                                    BOOST_CHECK(!chunk.empty());
+                                    output.append(chunk);
+                                    ++chunks;
+                                },
+                                chunk_size};
+        writer.BeginObject();
+        writer.Members(header);
+        writer.Key("key \"\n");
+        writer.Value(UniValue{"value"});
+        writer.Key("tx");
+        writer.BeginArray();
+        for (int i = 0; i < 10; ++i) {
+            if (i % 2) {
+                writer.Value(tx);
+            } else {
+                writer.RawValue(tx.write());
+            }
+        }
+        writer.EndArray();
+        writer.Key("empty");
+        writer.BeginArray();
+        writer.EndArray();
+        writer.Key("hex");
+        writer.HexValue(data);
+        writer.EndObject();
+        // Nothing is lost if the output is flushed early
+        writer.Flush();
+        writer.Finish();
+
+        BOOST_CHECK_EQUAL(output, expected.write() + "\n");
+        if (chunk_size > output.size()) {
+            BOOST_CHECK_EQUAL(chunks, 2U);
+        } else {
+            BOOST_CHECK_GT(chunks, output.size() / (chunk_size + 64));
+        }
+    }
+
+    // A value must follow a key, and containers must be closed
+    JSONStreamWriter writer{[](std::string_view) {}};
+    BOOST_CHECK_THROW(writer.Key("a"), NonFatalCheckError);
+    writer.BeginObject();
+    writer.Key("a");
+    BOOST_CHECK_THROW(writer.EndObject(), NonFatalCheckError);
+    writer.Value(UniValue{1});
+    BOOST_CHECK_THROW(writer.Finish(), NonFatalCheckError);
+    writer.EndObject();
+    writer.Finish();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,161 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <txannouncementqueue.h>
+
+#include <kernel/mempool_entry.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(txannouncementqueue_tests, TestingSetup)
+
+static std::vector<CTransactionRef> AddTxs(CTxMemPool &pool, size_t count) {
+    TestMemPoolEntryHelper entry;
+    std::vector<CTransactionRef> txs;
+    LOCK2(cs_main, pool.cs);
+    for (size_t i = 0; i < count; ++i) {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].scriptSig = CScript() << i;
+        mtx.vout.resize(1);
+        mtx.vout[0].nValue = 1000 * SATOSHI;
+        txs.push_back(MakeTransactionRef(mtx));
+        pool.addUnchecked(entry.Fee(int64_t(i) * SATOSHI).FromTx(txs.back()));
+    }
+    return txs;
+}
+
+/** Consume everything for the peer and return the txids in order */
+static std::vector<TxId> ConsumeAll(TxAnnouncementQueue &queue, NodeId peer,
+                                    size_t max_announced = 1000) {
+    std::vector<TxId> txids;
+    queue.Consume(peer, max_announced,
+                  [&](const TxAnnouncement &announcement) {
+                      txids.push_back(announcement.txid);
+                      return true;
+                  });
+    return txids;
+}
+
+BOOST_AUTO_TEST_CASE(mempool_order) {
+    CTxMemPool &pool = *Assert(m_node.mempool);
+    const auto txs{AddTxs(pool, 5)};
+    TxAnnouncementQueue queue{pool};
+    queue.AddPeer(0);
+
+    // Relayed out of order, twice, and a transaction that is not in the
+    // mempool
+    for (size_t i = txs.size(); i-- > 0;) {
+        queue.Push(txs[i]->GetId());
+        queue.Push(txs[i]->GetId());
+    }
+    queue.Push(TxId(m_rng.rand256()));
+    BOOST_CHECK_EQUAL(queue.CountPending(), 11);
+    BOOST_CHECK(ConsumeAll(queue, 0).empty());
+
+    queue.Seal();
+    BOOST_CHECK_EQUAL(queue.CountPending(), 0);
+    BOOST_CHECK_EQUAL(queue.CountQueued(), txs.size());
+    BOOST_CHECK_EQUAL(queue.CountUnconsumed(0), txs.size());
+
+    size_t i{0};
+    queue.Consume(0, 1000, [&](const TxAnnouncement &announcement) {
+        BOOST_CHECK(announcement.txid == txs[i]->GetId());
+        BOOST_CHECK_EQUAL(announcement.fee, int64_t(i) * SATOSHI);
+        BOOST_CHECK_EQUAL(announcement.vsize, txs[i]->GetTotalSize());
+        ++i;
+        return true;
+    });
+    BOOST_CHECK_EQUAL(i, txs.size());
+    BOOST_CHECK_EQUAL(queue.CountUnconsumed(0), 0);
+
+    // The next seal releases the consumed announcements
+    queue.Push(txs[0]->GetId());
+    queue.Seal();
+    BOOST_CHECK_EQUAL(queue.CountQueued(), 1);
+
+    // Removed from the mempool before being sealed
+    WITH_LOCK(pool.cs, pool.removeRecursive(*txs[1],
+                                            MemPoolRemovalReason::CONFLICT));
+    queue.Push(txs[1]->GetId());
+    queue.Seal();
+    BOOST_CHECK(ConsumeAll(queue, 0) == std::vector<TxId>{txs[0]->GetId()});
+}
+
+BOOST_AUTO_TEST_CASE(peer_cursors) {
+    CTxMemPool &pool = *Assert(m_node.mempool);
+    const auto txs{AddTxs(pool, 10)};
+    TxAnnouncementQueue queue{pool};
+
+    // Not tracked yet
+    queue.Push(txs[0]->GetId());
+    queue.Seal();
+    BOOST_CHECK(!queue.HasPeer(0));
+    BOOST_CHECK(ConsumeAll(queue, 0).empty());
+
+    // Only the transactions sealed after the peers are added are announced
+    queue.Push(txs[1]->GetId());
+    queue.AddPeer(0);
+    queue.AddPeer(1);
+    queue.AddPeer(2);
+    BOOST_CHECK(queue.HasPeer(0));
+    queue.Seal();
+    for (size_t i = 2; i < txs.size(); ++i) {
+        queue.Push(txs[i]->GetId());
+    }
+    queue.Seal();
+    BOOST_CHECK_EQUAL(queue.CountUnconsumed(0), txs.size() - 1);
+
+    // Peer 0 gets everything at once
+    const auto all{ConsumeAll(queue, 0)};
+    BOOST_CHECK_EQUAL(all.size(), txs.size() - 1);
+
+    // Peer 1 is limited and continues at the next trickle. Only the
+    // announcements fn returned true for count towards the limit.
+    size_t count{0};
+    std::vector<TxId> announced;
+    queue.Consume(1, 3, [&](const TxAnnouncement &announcement) {
+        if (count++ % 2 == 0) {
+            return false;
+        }
+        announced.push_back(announcement.txid);
+        return true;
+    });
+    BOOST_CHECK_EQUAL(count, 6);
+    BOOST_CHECK(announced == (std::vector<TxId>{all[1], all[3], all[5]}));
+    BOOST_CHECK_EQUAL(queue.CountUnconsumed(1), all.size() - 6);
+    BOOST_CHECK(ConsumeAll(queue, 1) ==
+                std::vector<TxId>(all.begin() + 6, all.end()));
+
+    // Peer 2 is not relaying transactions and holds back the queue until it
+    // skips them
+    queue.Push(txs[0]->GetId());
+    queue.Seal();
+    BOOST_CHECK_EQUAL(queue.CountQueued(), all.size() + 1);
+    queue.Skip(2);
+    BOOST_CHECK_EQUAL(queue.CountUnconsumed(2), 0);
+    BOOST_CHECK(ConsumeAll(queue, 2).empty());
+
+    // The queue is released once the remaining peers consumed it or were
+    // removed
+    queue.RemovePeer(0);
+    BOOST_CHECK(!queue.HasPeer(0));
+    BOOST_CHECK(ConsumeAll(queue, 1) == std::vector<TxId>{txs[0]->GetId()});
+    queue.Push(txs[1]->GetId());
+    queue.Seal();
+    BOOST_CHECK_EQUAL(queue.CountQueued(), 1);
+    queue.RemovePeer(1);
+    queue.RemovePeer(2);
+    queue.Push(txs[2]->GetId());
+    queue.Seal();
+    BOOST_CHECK_EQUAL(queue.CountQueued(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,8 @@
 
 #include <txpool.h>
 
+#include <core_memusage.h>
+
 #include <test/util/setup_common.h>
 
 #include <cstdint>
@@ -127,4 +129,62 @@ BOOST_AUTO_TEST_CASE(txpool_get_tx) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(txpool_peer_usage) {
+    FastRandomContext rng(true);
+
+    auto make_tx = [&]() {
+        CMutableTransaction mtx;
+        mtx.vin.emplace_back(TxId(rng.rand256()), 0);
+        mtx.vin[0].scriptSig = SCRIPT_SIG;
+        mtx.vout.resize(1);
+        mtx.vout[0].nValue = CENT;
+        mtx.vout[0].scriptPubKey = SCRIPT_PUB_KEY;
+        return MakeTransactionRef(mtx);
+    };
+
+    const CTransactionRef tx0 = make_tx();
+    const size_t usage = RecursiveDynamicUsage(tx0);
+
+    // Leave room for exactly 2 transactions per peer
+    TxPool txpool("testing", 1h, 1h, 2 * usage);
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(0), 0);
+
+    BOOST_CHECK(txpool.AddTx(tx0, 0));
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(0), usage);
+    // Adding the same tx again fails and doesn't change the accounting
+    BOOST_CHECK(!txpool.AddTx(tx0, 0));
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(0), usage);
+
+    const CTransactionRef tx1 = make_tx();
+    BOOST_CHECK(txpool.AddTx(tx1, 0));
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(0), 2 * usage);
+
+    // Peer 0 is over its quota, but other peers are not affected
+    const CTransactionRef tx2 = make_tx();
+    BOOST_CHECK(!txpool.AddTx(tx2, 0));
+    BOOST_CHECK(!txpool.HaveTx(tx2->GetId()));
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(0), 2 * usage);
+    BOOST_CHECK(txpool.AddTx(tx2, 1));
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(1), usage);
+    BOOST_CHECK_EQUAL(txpool.Size(), 3);
+
+    // Erasing a transaction frees up some quota
+    BOOST_CHECK_EQUAL(txpool.EraseTx(tx0->GetId()), 1);
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(0), usage);
+    const CTransactionRef tx3 = make_tx();
+    BOOST_CHECK(txpool.AddTx(tx3, 0));
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(0), 2 * usage);
+
+    // Erasing all the peer's transactions resets its usage
+    txpool.EraseForPeer(0);
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(0), 0);
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(1), usage);
+    BOOST_CHECK_EQUAL(txpool.Size(), 1);
+    BOOST_CHECK(txpool.HaveTx(tx2->GetId()));
+
+    FastRandomContext limit_rng(true);
+    BOOST_CHECK_EQUAL(txpool.LimitTxs(0, limit_rng), 1);
+    BOOST_CHECK_EQUAL(txpool.GetPeerUsage(1), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -26,7 +26,7 @@ struct TxRequestTest : BasicTestingSetup {
     void BuildRequestOrderTest(Scenario &scenario, int config);
     void BuildTimeBackwardsTest(Scenario &scenario);
     void BuildWeirdRequestsTest(Scenario &scenario);
-    void TestInterleavedScenarios();
+    void TestInterleavedScenarios(InvRequestTrackerImplType type);
 };
 
 constexpr std::chrono::microseconds MIN_TIME = std::chrono::microseconds::min();
@@ -47,6 +47,8 @@ struct Runner {
     /** The InvRequestTracker being tested. */
     InvRequestTracker<TxId> txrequest;
 
+    explicit Runner(InvRequestTrackerImplType type) : txrequest(false, type) {}
+
     /** List of actions to be executed (in order of increasing timestamp). */
     std::vector<Action> actions;
 
@@ -716,7 +718,7 @@ void TxRequestTest::BuildWeirdRequestsTest(Scenario &scenario) {
     scenario.Check(peer2, {}, 0, 0, 0, "q23");
 }
 
-void TxRequestTest::TestInterleavedScenarios() {
+void TxRequestTest::TestInterleavedScenarios(InvRequestTrackerImplType type) {
     // Create a list of functions which add tests to scenarios.
     std::vector<std::function<void(Scenario &)>> builders;
     // Add instances of every test, for every configuration.
@@ -741,7 +743,7 @@ void TxRequestTest::TestInterleavedScenarios() {
     // Randomly shuffle all those functions.
     Shuffle(builders.begin(), builders.end(), m_rng);
 
-    Runner runner;
+    Runner runner(type);
     auto starttime = RandomTime1y();
     // Construct many scenarios, and run (up to) 10 randomly-chosen tests
     // consecutively in each.
@@ -779,7 +781,13 @@ BOOST_FIXTURE_TEST_SUITE(txrequest_tests, TxRequestTest)
 
 BOOST_AUTO_TEST_CASE(TxRequestTest) {
     for (int i = 0; i < 5; ++i) {
-        TestInterleavedScenarios();
+        TestInterleavedScenarios(InvRequestTrackerImplType::ORDERED);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TxRequestTestFlat) {
+    for (int i = 0; i < 5; ++i) {
+        TestInterleavedScenarios(InvRequestTrackerImplType::FLAT);
     }
 }
 
@@ -119,6 +119,8 @@ GetRandomNodeEvictionCandidates(const int n_candidates,
             .m_noban = false,
             .m_conn_type = ConnectionType::INBOUND,
             .availabilityScore = double(random_context.rand64()),
+            .m_recent_msg_processing_time =
+                std::chrono::microseconds{random_context.randrange(100)},
         });
     }
     return candidates;
@@ -47,6 +47,13 @@ struct ConnmanTestMsg : public CConnman {
         }
     }
 
+    void ServeRequestsOnce(CNode &node)
+        EXCLUSIVE_LOCKS_REQUIRED(!NetEventsInterface::g_msgproc_mutex) {
+        for (auto interface : m_msgproc) {
+            interface->ServeRequests(*config, &node, flagInterruptMsgProc);
+        }
+    }
+
     void NodeReceiveMsgBytes(CNode &node, Span<const uint8_t> msg_bytes,
                              bool &complete) const;
 
@@ -102,6 +109,15 @@ public:
 
     ssize_t Send(const void *, size_t len, int) const override { return len; }
 
+    ssize_t SendMany(Span<const Span<const uint8_t>> buffers,
+                     int) const override {
+        size_t len{0};
+        for (const auto &buffer : buffers) {
+            len += buffer.size();
+        }
+        return len;
+    }
+
     ssize_t Recv(void *buf, size_t len, int flags) const override {
         const size_t consume_bytes{
             std::min(len, m_contents.size() - m_consumed)};
@@ -20,6 +20,7 @@
 #include <util/fs_helpers.h>
 #include <util/moneystr.h>
 #include <util/overflow.h>
+#include <util/parallel.h>
 #include <util/strencodings.h>
 #include <util/string.h>
 #include <util/time.h>
@@ -33,6 +34,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
@@ -277,6 +279,47 @@ BOOST_AUTO_TEST_CASE(util_HexStr) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(util_HexEncodeDecode) {
+    // The sizes cover the vectorized blocks and what is left after them
+    for (size_t size = 0; size <= 200; ++size) {
+        const std::vector<uint8_t> data{m_rng.randbytes(size)};
+        std::string hex(size * 2, 'x');
+        HexEncode(data, hex);
+        BOOST_CHECK_EQUAL(hex, HexStr(data));
+        for (size_t i = 0; i < size; ++i) {
+            BOOST_CHECK_EQUAL(HexDigit(hex[i * 2]), data[i] >> 4);
+            BOOST_CHECK_EQUAL(HexDigit(hex[i * 2 + 1]), data[i] & 15);
+        }
+
+        std::vector<uint8_t> decoded(size);
+        BOOST_CHECK_EQUAL(HexDecodePrefix(hex, decoded), size);
+        BOOST_CHECK(decoded == data);
+        BOOST_CHECK(ParseHex(ToUpper(hex)) == data);
+
+        // Decoding stops at the output size, and before an incomplete pair
+        BOOST_CHECK_EQUAL(HexDecodePrefix(hex, Span{decoded}.first(size / 2)),
+                          size / 2);
+        if (size > 0) {
+            BOOST_CHECK_EQUAL(
+                HexDecodePrefix(std::string_view{hex}.substr(1), decoded),
+                size - 1);
+        }
+
+        // Decoding stops at the pair with an invalid character
+        for (size_t pos = 0; pos < hex.size(); pos += 7) {
+            for (char c : {'g', 'G', '/', ':', '@', '`', ' ', '\0', '\x90'}) {
+                std::string invalid{hex};
+                invalid[pos] = c;
+                BOOST_CHECK_EQUAL(HexDecodePrefix(invalid, decoded), pos / 2);
+                BOOST_CHECK(std::equal(decoded.begin(),
+                                       decoded.begin() + pos / 2,
+                                       data.begin()));
+                BOOST_CHECK(!TryParseHex(invalid).has_value());
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(span_write_bytes) {
     std::array<uint8_t, 2> mut_arr{{0xaa, 0xbb}};
     const auto mut_bytes{MakeWritableByteSpan(mut_arr)};
@@ -3268,4 +3311,50 @@ BOOST_AUTO_TEST_CASE(mib_string_literal_test) {
         HasReason("MiB value too large for size_t byte conversion"));
 }
 
+BOOST_AUTO_TEST_CASE(parallel_for_test) {
+    // Each index is visited exactly once, whatever the number of threads
+    for (size_t num_threads : {0, 1, 4, 100}) {
+        std::vector<std::atomic<int>> visits(50);
+        BOOST_CHECK(util::ParallelFor(visits.size(), num_threads,
+                                      [&](size_t i) {
+                                          ++visits[i];
+                                          return true;
+                                      }));
+        for (const auto &count : visits) {
+            BOOST_CHECK_EQUAL(count, 1);
+        }
+    }
+    BOOST_CHECK(util::ParallelFor(0, 4, [](size_t) { return false; }));
+
+    // No index is started after a failure. The calling thread alone takes the
+    // indices in order.
+    std::vector<size_t> visited;
+    BOOST_CHECK(!util::ParallelFor(10, 1, [&](size_t i) {
+        visited.push_back(i);
+        return i < 3;
+    }));
+    BOOST_CHECK(visited == std::vector<size_t>({0, 1, 2, 3}));
+
+    // Exceptions are rethrown after all the threads completed, and stop each
+    // thread as well
+    std::atomic<size_t> started{0};
+    BOOST_CHECK_THROW(util::ParallelFor(100, 4,
+                                        [&](size_t) -> bool {
+                                            ++started;
+                                            throw std::runtime_error("fail");
+                                        }),
+                      std::runtime_error);
+    BOOST_CHECK_LE(started, 4);
+    BOOST_CHECK_EXCEPTION(util::ParallelFor(10, 1,
+                                            [](size_t i) -> bool {
+                                                if (i >= 2) {
+                                                    throw std::runtime_error(
+                                                        "index " +
+                                                        std::to_string(i));
+                                                }
+                                                return true;
+                                            }),
+                          std::runtime_error, HasReason("index 2"));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
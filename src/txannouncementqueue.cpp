@@ -0,0 +1,112 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <txannouncementqueue.h>
+
+#include <kernel/mempool_entry.h>
+#include <txmempool.h>
+
+#include <algorithm>
+#include <utility>
+
+void TxAnnouncementQueue::Push(const TxId &txid) {
+    LOCK(m_mutex);
+    m_pending.push_back(txid);
+}
+
+void TxAnnouncementQueue::Seal() {
+    LOCK(m_seal_mutex);
+
+    std::vector<TxId> pending;
+    WITH_LOCK(m_mutex, pending.swap(m_pending));
+    if (pending.empty()) {
+        return;
+    }
+
+    // Entry id and announcement, so the mempool order is only looked up once
+    // per transaction.
+    std::vector<std::pair<uint64_t, TxAnnouncement>> sorted;
+    sorted.reserve(pending.size());
+    {
+        LOCK(m_mempool.cs);
+        for (const TxId &txid : pending) {
+            auto it = m_mempool.GetIter(txid);
+            if (!it) {
+                continue;
+            }
+            const CTxMemPoolEntry &entry = ***it;
+            sorted.emplace_back(
+                entry.GetEntryId(),
+                TxAnnouncement{txid, entry.GetFee(), entry.GetTxSize()});
+        }
+    }
+
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    // The same transaction can be relayed several times per trickle
+    sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                             [](const auto &a, const auto &b) {
+                                 return a.first == b.first;
+                             }),
+                 sorted.end());
+
+    LOCK(m_mutex);
+    if (!sorted.empty()) {
+        auto batch = std::make_shared<Batch>();
+        batch->first = m_end;
+        batch->announcements.reserve(sorted.size());
+        for (auto &[entry_id, announcement] : sorted) {
+            batch->announcements.push_back(std::move(announcement));
+        }
+        m_end = batch->end();
+        m_batches.push_back(std::move(batch));
+    }
+
+    uint64_t min_cursor{m_end};
+    for (const auto &[peer, cursor] : m_cursors) {
+        min_cursor = std::min(min_cursor, cursor);
+    }
+    while (!m_batches.empty() && m_batches.front()->end() <= min_cursor) {
+        m_batches.pop_front();
+    }
+}
+
+void TxAnnouncementQueue::AddPeer(NodeId peer) {
+    LOCK2(m_seal_mutex, m_mutex);
+    m_cursors.emplace(peer, m_end);
+}
+
+void TxAnnouncementQueue::RemovePeer(NodeId peer) {
+    LOCK(m_mutex);
+    m_cursors.erase(peer);
+}
+
+bool TxAnnouncementQueue::HasPeer(NodeId peer) const {
+    LOCK(m_mutex);
+    return m_cursors.count(peer);
+}
+
+void TxAnnouncementQueue::Skip(NodeId peer) {
+    LOCK(m_mutex);
+    auto it = m_cursors.find(peer);
+    if (it != m_cursors.end()) {
+        it->second = m_end;
+    }
+}
+
+size_t TxAnnouncementQueue::CountPending() const {
+    LOCK(m_mutex);
+    return m_pending.size();
+}
+
+size_t TxAnnouncementQueue::CountQueued() const {
+    LOCK(m_mutex);
+    return m_batches.empty() ? 0 : m_end - m_batches.front()->first;
+}
+
+size_t TxAnnouncementQueue::CountUnconsumed(NodeId peer) const {
+    LOCK(m_mutex);
+    auto it = m_cursors.find(peer);
+    return it == m_cursors.end() ? 0 : m_end - it->second;
+}
@@ -0,0 +1,150 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_TXANNOUNCEMENTQUEUE_H
+#define BITCOIN_TXANNOUNCEMENTQUEUE_H
+
+#include <consensus/amount.h>
+#include <nodeid.h>
+#include <primitives/txid.h>
+#include <sync.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class CTxMemPool;
+
+/** A transaction waiting to be announced to the peers */
+struct TxAnnouncement {
+    TxId txid;
+    /** Fee and size when the transaction was queued, for the fee filters */
+    Amount fee;
+    size_t vsize;
+};
+
+/**
+ * Transaction announcements shared between all the peers.
+ *
+ * Relayed transactions are pushed once for all the peers instead of being
+ * inserted in a set for each of them. At every trickle, the pending
+ * transactions are looked up in the mempool, sorted in mempool order (which is
+ * a topological order) and appended to the queue as an immutable batch. Each
+ * peer then walks the queue from its own cursor, so the sorting and the
+ * mempool lookups are done once regardless of the number of peers. A peer
+ * that hit its announcement limit keeps its cursor and continues from there
+ * at its next trickle.
+ *
+ * Transactions relayed in different batches are announced in batch order,
+ * which is topological unless a parent is relayed again after its child.
+ *
+ * This class is thread-safe.
+ */
+class TxAnnouncementQueue {
+public:
+    explicit TxAnnouncementQueue(const CTxMemPool &mempool)
+        : m_mempool(mempool) {}
+
+    /** Queue a transaction to be announced to all the registered peers */
+    void Push(const TxId &txid) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Look up the pending transactions in the mempool, drop the ones that
+     * are gone and append the others to the queue in mempool order. Also
+     * release the batches all the peers are done with.
+     */
+    void Seal() EXCLUSIVE_LOCKS_REQUIRED(!m_seal_mutex, !m_mutex);
+
+    /**
+     * Start tracking a peer. It will only get the transactions sealed after
+     * this call, and is a no-op if the peer is already tracked.
+     */
+    void AddPeer(NodeId peer)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_seal_mutex, !m_mutex);
+    void RemovePeer(NodeId peer) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    bool HasPeer(NodeId peer) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Drop all the announcements the peer has not consumed yet */
+    void Skip(NodeId peer) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Pass the announcements the peer has not consumed yet to fn, in order,
+     * until fn returned true max_announced times. The announcements fn is
+     * called for are consumed. The queue lock is not held while calling fn,
+     * so the caller can hold the mempool lock.
+     */
+    template <typename Callable>
+    void Consume(NodeId peer, size_t max_announced, Callable &&fn)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
+        uint64_t cursor;
+        std::vector<std::shared_ptr<const Batch>> batches;
+        {
+            LOCK(m_mutex);
+            auto it = m_cursors.find(peer);
+            if (it == m_cursors.end()) {
+                return;
+            }
+            cursor = it->second;
+            for (const auto &batch : m_batches) {
+                if (batch->end() > cursor) {
+                    batches.push_back(batch);
+                }
+            }
+        }
+
+        size_t announced{0};
+        for (const auto &batch : batches) {
+            for (; cursor < batch->end() && announced < max_announced;
+                 ++cursor) {
+                if (fn(batch->announcements[cursor - batch->first])) {
+                    ++announced;
+                }
+            }
+        }
+
+        LOCK(m_mutex);
+        auto it = m_cursors.find(peer);
+        if (it != m_cursors.end() && it->second < cursor) {
+            it->second = cursor;
+        }
+    }
+
+    /** Number of transactions pushed but not sealed yet */
+    size_t CountPending() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Number of sealed announcements kept for the peers */
+    size_t CountQueued() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Number of announcements the peer has not consumed yet */
+    size_t CountUnconsumed(NodeId peer) const
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Batch {
+        /** Position of the first announcement in the queue */
+        uint64_t first;
+        std::vector<TxAnnouncement> announcements;
+
+        uint64_t end() const { return first + announcements.size(); }
+    };
+
+    const CTxMemPool &m_mempool;
+
+    /**
+     * Held while sealing, so no peer is added between the time the pending
+     * transactions are taken and the time they are appended to the queue.
+     * The mempool lock is taken after this one but before m_mutex.
+     */
+    Mutex m_seal_mutex;
+    mutable Mutex m_mutex;
+    std::vector<TxId> m_pending GUARDED_BY(m_mutex);
+    std::deque<std::shared_ptr<const Batch>> m_batches GUARDED_BY(m_mutex);
+    /** Position after the last sealed announcement */
+    uint64_t m_end GUARDED_BY(m_mutex){0};
+    /** Position of the next announcement to consume, per peer */
+    std::unordered_map<NodeId, uint64_t> m_cursors GUARDED_BY(m_mutex);
+};
+
+#endif // BITCOIN_TXANNOUNCEMENTQUEUE_H
@@ -15,6 +15,7 @@
 #include <util/translation.h>
 #include <util/vector.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 
@@ -213,24 +214,35 @@ bool CBlockTreeDB::ReadLastBlockFile(int &nFile) {
 }
 
 CCoinsViewCursor *CCoinsViewDB::Cursor() const {
-    CCoinsViewDBCursor *i = new CCoinsViewDBCursor(
-        const_cast<CDBWrapper &>(*m_db).NewIterator(), GetBestBlock());
+    return Cursors(1).front().release();
+}
+
+std::vector<std::unique_ptr<CCoinsViewCursor>>
+CCoinsViewDB::Cursors(size_t count) const {
+    count = std::clamp<size_t>(count, 1, 256);
     /**
      * It seems that there are no "const iterators" for LevelDB. Since we only
      * need read operations on it, use a const-cast to get around that
      * restriction.
      */
-    i->pcursor->Seek(DB_COIN);
-    // Cache key of first record
-    if (i->pcursor->Valid()) {
-        CoinEntry entry(&i->keyTmp.second);
-        i->pcursor->GetKey(entry);
-        i->keyTmp.first = entry.key;
-    } else {
-        // Make sure Valid() and GetKey() return false
-        i->keyTmp.first = 0;
+    std::vector<std::unique_ptr<CDBIterator>> iterators{
+        const_cast<CDBWrapper &>(*m_db).NewIterators(count)};
+    const BlockHash best_block{GetBestBlock()};
+
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    cursors.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::unique_ptr<CCoinsViewDBCursor> cursor{
+            new CCoinsViewDBCursor(iterators[i].release(), best_block)};
+        uint256 start;
+        *start.begin() = i * 256 / count;
+        cursor->m_end_txid_byte = (i + 1) * 256 / count;
+        cursor->pcursor->Seek(std::make_pair(DB_COIN, start));
+        // Cache key of first record
+        cursor->CacheKey();
+        cursors.push_back(std::move(cursor));
     }
-    return i;
+    return cursors;
 }
 
 bool CCoinsViewDBCursor::GetKey(COutPoint &key) const {
@@ -256,8 +268,14 @@ bool CCoinsViewDBCursor::Valid() const {
 
 void CCoinsViewDBCursor::Next() {
     pcursor->Next();
+    CacheKey();
+}
+
+void CCoinsViewDBCursor::CacheKey() {
     CoinEntry entry(&keyTmp.second);
-    if (!pcursor->Valid() || !pcursor->GetKey(entry)) {
+    if (!pcursor->Valid() || !pcursor->GetKey(entry) ||
+        (entry.key == DB_COIN &&
+         *keyTmp.second.GetTxId().begin() >= m_end_txid_byte)) {
         // Invalidate cached key after last record so that Valid() and GetKey()
         // return false
         keyTmp.first = 0;
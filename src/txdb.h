@@ -62,6 +62,13 @@ public:
     void BatchWrite(CoinsViewCacheCursor &cursor,
                     const BlockHash &hashBlock) override;
     CCoinsViewCursor *Cursor() const override;
+    /**
+     * The coins are split by the first byte of their txid, so all the outputs
+     * of a transaction are in the same range. There are at most 256 ranges.
+     * All the cursors see the database as it was when they were created.
+     */
+    std::vector<std::unique_ptr<CCoinsViewCursor>>
+    Cursors(size_t count) const override;
 
     //! Whether an unsupported database format is used.
     bool NeedsUpgrade();
@@ -90,8 +97,13 @@ public:
 private:
     CCoinsViewDBCursor(CDBIterator *pcursorIn, const BlockHash &hashBlockIn)
         : CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn) {}
+    //! Cache the key of the current record if it is a coin in range
+    void CacheKey();
+
     std::unique_ptr<CDBIterator> pcursor;
     std::pair<char, COutPoint> keyTmp;
+    //! First byte of the txids past the range of this cursor
+    unsigned int m_end_txid_byte{256};
 
     friend class CCoinsViewDB;
 };
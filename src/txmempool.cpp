@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <limits>
 #include <vector>
 
@@ -32,12 +33,15 @@ bool CTxMemPool::CalculateAncestors(
     setEntries &setAncestors,
     CTxMemPoolEntry::Parents &staged_ancestors) const {
     while (!staged_ancestors.empty()) {
-        const auto stage = staged_ancestors.begin()->get();
+        // Process the staged ancestors from the back, which is cheap to erase
+        // from the flat set.
+        const auto last = std::prev(staged_ancestors.end());
+        const auto stage = last->get();
 
         txiter stageit = mapTx.find(stage->GetTx().GetId());
         assert(stageit != mapTx.end());
         setAncestors.insert(stageit);
-        staged_ancestors.erase(staged_ancestors.begin());
+        staged_ancestors.erase(last);
 
         const CTxMemPoolEntry::Parents &parents =
             (*stageit)->GetMemPoolParentsConst();
@@ -173,6 +177,9 @@ void CTxMemPool::addUnchecked(CTxMemPoolEntryRef entry) {
     cachedInnerUsage += entry->DynamicMemoryUsage();
 
     const CTransactionRef tx = entry->GetSharedTx();
+    txns_randomized.emplace_back(tx->GetHash(), newit);
+    entry->idx_randomized = txns_randomized.size() - 1;
+
     std::set<TxId> setParentTransactions;
     for (const CTxIn &in : tx->vin) {
         mapNextTx.insert(std::make_pair(&in.prevout, tx));
@@ -220,6 +227,18 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason) {
         mapNextTx.erase(txin.prevout);
     }
 
+    // Move the last hash in place of the removed one
+    const size_t idx_randomized{(*it)->idx_randomized};
+    if (idx_randomized != txns_randomized.size() - 1) {
+        txns_randomized[idx_randomized] = std::move(txns_randomized.back());
+        (*txns_randomized[idx_randomized].second)->idx_randomized =
+            idx_randomized;
+    }
+    txns_randomized.pop_back();
+    if (txns_randomized.size() * 2 < txns_randomized.capacity()) {
+        txns_randomized.shrink_to_fit();
+    }
+
     /* add logging because unchecked */
     RemoveUnbroadcastTx(txid, true);
 
@@ -366,6 +385,7 @@ void CTxMemPool::removeForFinalizedBlock(
 
 void CTxMemPool::_clear() {
     mapTx.clear();
+    txns_randomized.clear();
     mapNextTx.clear();
     totalTxSize = 0;
     m_total_fee = Amount::zero();
@@ -496,6 +516,13 @@ void CTxMemPool::check(const CCoinsViewCache &active_coins_tip,
         assert((*it)->GetSharedTx() == nextTx);
     }
 
+    assert(txns_randomized.size() == mapTx.size());
+    for (size_t i = 0; i < txns_randomized.size(); ++i) {
+        const auto &[txhash, it] = txns_randomized[i];
+        assert((*it)->idx_randomized == i);
+        assert((*it)->GetTx().GetHash() == txhash);
+    }
+
     assert(totalTxSize == checkTotal);
     assert(m_total_fee == check_total_fee);
     assert(innerUsage == cachedInnerUsage);
@@ -820,7 +847,8 @@ size_t CTxMemPool::DynamicMemoryUsage() const {
                                  12 * sizeof(void *)) *
                mapTx.size() +
            memusage::DynamicUsage(mapNextTx) +
-           memusage::DynamicUsage(mapDeltas) + cachedInnerUsage;
+           memusage::DynamicUsage(mapDeltas) +
+           memusage::DynamicUsage(txns_randomized) + cachedInnerUsage;
 }
 
 void CTxMemPool::RemoveUnbroadcastTx(const TxId &txid, const bool unchecked) {
@@ -895,22 +923,28 @@ void CTxMemPool::LimitSize(CCoinsViewCache &coins_cache) {
 
 void CTxMemPool::UpdateChild(txiter entry, txiter child, bool add) {
     AssertLockHeld(cs);
-    CTxMemPoolEntry::Children s;
-    if (add && (*entry)->GetMemPoolChildren().insert(*child).second) {
-        cachedInnerUsage += memusage::IncrementalDynamicUsage(s);
-    } else if (!add && (*entry)->GetMemPoolChildren().erase(*child)) {
-        cachedInnerUsage -= memusage::IncrementalDynamicUsage(s);
+    CTxMemPoolEntry::Children &children = (*entry)->GetMemPoolChildren();
+    // The memory usage of the flat set depends on its capacity, not only on
+    // its size, so account for the actual change.
+    cachedInnerUsage -= memusage::DynamicUsage(children);
+    if (add) {
+        children.insert(*child);
+    } else {
+        children.erase(*child);
     }
+    cachedInnerUsage += memusage::DynamicUsage(children);
 }
 
 void CTxMemPool::UpdateParent(txiter entry, txiter parent, bool add) {
     AssertLockHeld(cs);
-    CTxMemPoolEntry::Parents s;
-    if (add && (*entry)->GetMemPoolParents().insert(*parent).second) {
-        cachedInnerUsage += memusage::IncrementalDynamicUsage(s);
-    } else if (!add && (*entry)->GetMemPoolParents().erase(*parent)) {
-        cachedInnerUsage -= memusage::IncrementalDynamicUsage(s);
+    CTxMemPoolEntry::Parents &parents = (*entry)->GetMemPoolParents();
+    cachedInnerUsage -= memusage::DynamicUsage(parents);
+    if (add) {
+        parents.insert(*parent);
+    } else {
+        parents.erase(*parent);
     }
+    cachedInnerUsage += memusage::DynamicUsage(parents);
 }
 
 CFeeRate CTxMemPool::GetMinFee(size_t sizelimit) const {
@@ -318,6 +318,13 @@ public:
     indexed_transaction_set mapTx GUARDED_BY(cs);
 
     using txiter = indexed_transaction_set::nth_index<0>::type::const_iterator;
+    /**
+     * The hashes of all the transactions in mapTx, in no particular order.
+     * They are kept contiguous so a compact block can be matched against the
+     * whole mempool without chasing a pointer per entry.
+     */
+    std::vector<std::pair<TxHash, txiter>> txns_randomized GUARDED_BY(cs);
+
     typedef std::set<txiter, CompareIteratorById> setEntries;
     typedef std::set<txiter, CompareIteratorByRevEntryId> setRevTopoEntries;
 
@@ -6,10 +6,12 @@
 #include <txpool.h>
 
 #include <consensus/validation.h>
+#include <core_memusage.h>
 #include <logging.h>
 #include <policy/policy.h>
 #include <random.h>
 
+#include <algorithm>
 #include <cassert>
 
 bool TxPool::AddTx(const CTransactionRef &tx, NodeId peer) {
@@ -31,13 +33,38 @@ bool TxPool::AddTx(const CTransactionRef &tx, NodeId peer) {
         return false;
     }
 
+    // Account for the memory used by the transaction against the quota of the
+    // peer that provided it, so a single peer can't fill up the pool with
+    // large transactions.
+    const size_t usage = RecursiveDynamicUsage(tx);
+    size_t &peer_usage = m_peer_usage[peer];
+    if (peer_usage + usage > maxPeerUsage) {
+        LogPrint(BCLog::TXPACKAGES,
+                 "ignoring %s tx %s from peer=%d exceeding its quota "
+                 "(usage: %u, peer usage: %u, max: %u)\n",
+                 txKind, txid.ToString(), peer, usage, peer_usage,
+                 maxPeerUsage);
+        if (peer_usage == 0) {
+            m_peer_usage.erase(peer);
+        }
+        return false;
+    }
+    peer_usage += usage;
+
     auto ret = m_pool_txs.emplace(
-        txid,
-        PoolTx{tx, peer, Now<NodeSeconds>() + expireTime, m_txs_list.size()});
+        txid, PoolTx{tx, peer, Now<NodeSeconds>() + expireTime,
+                     m_txs_list.size(), usage});
     assert(ret.second);
-    m_txs_list.push_back(ret.first);
+    PoolTxPtr entry = &*ret.first;
+    m_txs_list.push_back(entry);
     for (const CTxIn &txin : tx->vin) {
-        m_outpoint_to_tx_it[txin.prevout].insert(ret.first);
+        PoolTxPtrs &spenders = m_outpoint_to_tx_it[txin.prevout];
+        // A transaction can't spend the same outpoint twice, but don't rely on
+        // the caller having checked this.
+        if (std::find(spenders.begin(), spenders.end(), entry) ==
+            spenders.end()) {
+            spenders.push_back(entry);
+        }
     }
 
     LogPrint(BCLog::TXPACKAGES,
@@ -54,23 +81,36 @@ int TxPool::EraseTx(const TxId &txid) {
 
 int TxPool::EraseTxNoLock(const TxId &txid) {
     AssertLockHeld(m_mutex);
-    std::map<TxId, PoolTx>::iterator it = m_pool_txs.find(txid);
+    PoolTxMap::iterator it = m_pool_txs.find(txid);
     if (it == m_pool_txs.end()) {
         return 0;
     }
+    PoolTxPtr entry = &*it;
     for (const CTxIn &txin : it->second.tx->vin) {
         auto itPrev = m_outpoint_to_tx_it.find(txin.prevout);
         if (itPrev == m_outpoint_to_tx_it.end()) {
             continue;
         }
-        itPrev->second.erase(it);
-        if (itPrev->second.empty()) {
+        PoolTxPtrs &spenders = itPrev->second;
+        auto spender = std::find(spenders.begin(), spenders.end(), entry);
+        if (spender != spenders.end()) {
+            spenders.erase(spender);
+        }
+        if (spenders.empty()) {
             m_outpoint_to_tx_it.erase(itPrev);
         }
     }
 
+    auto peer_usage = m_peer_usage.find(it->second.fromPeer);
+    assert(peer_usage != m_peer_usage.end() &&
+           peer_usage->second >= it->second.usage);
+    peer_usage->second -= it->second.usage;
+    if (peer_usage->second == 0) {
+        m_peer_usage.erase(peer_usage);
+    }
+
     size_t old_pos = it->second.list_pos;
-    assert(m_txs_list[old_pos] == it);
+    assert(m_txs_list[old_pos] == entry);
     if (old_pos + 1 != m_txs_list.size()) {
         // Unless we're deleting the last entry in m_txs_list, move the last
         // entry to the position we're deleting.
@@ -96,11 +136,16 @@ void TxPool::EraseForPeer(NodeId peer) {
 
     m_peer_work_set.erase(peer);
 
+    if (!m_peer_usage.count(peer)) {
+        // This peer has no transaction in the pool
+        return;
+    }
+
     int nErased = 0;
-    std::map<TxId, PoolTx>::iterator iter = m_pool_txs.begin();
-    while (iter != m_pool_txs.end()) {
-        // increment to avoid iterator becoming invalid after erasure
-        const auto &[txid, orphan] = *iter++;
+    // Erasing a transaction moves the last entry of m_txs_list to its
+    // position, so iterate backwards to visit every entry exactly once.
+    for (size_t i = m_txs_list.size(); i-- > 0;) {
+        const auto &[txid, orphan] = *m_txs_list[i];
         if (orphan.fromPeer == peer) {
             nErased += EraseTxNoLock(txid);
         }
@@ -121,11 +166,10 @@ unsigned int TxPool::LimitTxs(unsigned int max_txs, FastRandomContext &rng) {
         // Sweep out expired orphan pool entries:
         int nErased = 0;
         auto nMinExpTime{nNow + expireTime - expireInterval};
-        std::map<TxId, PoolTx>::iterator iter = m_pool_txs.begin();
-        while (iter != m_pool_txs.end()) {
-            std::map<TxId, PoolTx>::iterator maybeErase = iter++;
+        for (size_t i = m_txs_list.size(); i-- > 0;) {
+            const PoolTxPtr maybeErase = m_txs_list[i];
             if (maybeErase->second.nTimeExpire <= nNow) {
-                nErased += EraseTxNoLock(maybeErase->second.tx->GetId());
+                nErased += EraseTxNoLock(maybeErase->first);
             } else {
                 nMinExpTime =
                     std::min(maybeErase->second.nTimeExpire, nMinExpTime);
@@ -284,7 +328,7 @@ TxPool::GetChildrenFromSamePeer(const CTransactionRef &parent,
 
     // First construct a vector of iterators to ensure we do not return
     // duplicates of the same tx and so we can sort by nTimeExpire.
-    std::vector<PoolTxMap::iterator> iters;
+    std::vector<PoolTxPtr> iters;
 
     // For each output, get all entries spending this prevout, filtering for
     // ones from the specified peer.
@@ -329,7 +373,7 @@ TxPool::GetChildrenFromDifferentPeer(const CTransactionRef &parent,
 
     // First construct vector of iterators to ensure we do not return duplicates
     // of the same tx.
-    std::vector<PoolTxMap::iterator> iters;
+    std::vector<PoolTxPtr> iters;
 
     // For each output, get all entries spending this prevout, filtering for
     // ones not from the specified peer.
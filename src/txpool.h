@@ -1,4 +1,5 @@
 // Copyright (c) 2021 The Bitcoin Core developers
+// Copyright (c) 2024 The Bitcoin developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
@@ -6,29 +7,48 @@
 #define BITCOIN_TXPOOL_H
 
 #include <nodeid.h>
+#include <prevector.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
+#include <support/allocators/pool.h>
 #include <sync.h>
+#include <util/hasher.h>
 #include <util/time.h>
 
 #include <chrono>
-#include <map>
+#include <cstddef>
+#include <functional>
 #include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 class FastRandomContext;
 
+/**
+ * Default maximum memory usage, in bytes, of the transactions a single peer can
+ * have in a TxPool. This is enough for about 20 maximum size standard
+ * transactions, and for several hundreds of typical ones.
+ */
+static constexpr size_t DEFAULT_MAX_TXPOOL_PEER_USAGE{2'000'000};
+
 /**
  * A class to store and track transactions by peers.
  */
 class TxPool {
 public:
     TxPool(const std::string &txKindIn, std::chrono::seconds expireTimeIn,
-           std::chrono::seconds expireIntervalIn)
+           std::chrono::seconds expireIntervalIn,
+           size_t maxPeerUsageIn = DEFAULT_MAX_TXPOOL_PEER_USAGE)
         : txKind(txKindIn), expireTime(expireTimeIn),
-          expireInterval(expireIntervalIn) {}
+          expireInterval(expireIntervalIn), maxPeerUsage(maxPeerUsageIn) {}
 
-    /** Add a new transaction to the pool */
+    /**
+     * Add a new transaction to the pool. Fails if the transaction is already
+     * in the pool, is too large, or would make the memory used by the
+     * transactions from this peer exceed maxPeerUsage.
+     */
     bool AddTx(const CTransactionRef &tx, NodeId peer)
         EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
 
@@ -98,6 +118,13 @@ public:
         return m_pool_txs.size();
     }
 
+    /** Return the memory used by the transactions provided by a peer */
+    size_t GetPeerUsage(NodeId peer) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
+        LOCK(m_mutex);
+        auto it = m_peer_usage.find(peer);
+        return it == m_peer_usage.end() ? 0 : it->second;
+    }
+
 protected:
     /** The transaction kind as string, used for logging */
     const std::string txKind;
@@ -106,6 +133,9 @@ protected:
     /** Minimum time between transactions expire time checks */
     const std::chrono::seconds expireInterval;
 
+    /** Maximum memory usage of the transactions from a single peer */
+    const size_t maxPeerUsage;
+
     /** Guards transactions */
     mutable Mutex m_mutex;
 
@@ -114,18 +144,41 @@ protected:
         NodeId fromPeer;
         NodeSeconds nTimeExpire;
         size_t list_pos;
+        /** Memory usage of tx, accounted against fromPeer's quota */
+        size_t usage;
     };
 
+    /**
+     * The pool is a hash map which nodes are allocated from a PoolResource, so
+     * adding and removing transactions under churn doesn't hit the general
+     * purpose allocator. See CCoinsMap for the MAX_BLOCK_SIZE_BYTES rationale.
+     */
+    using PoolTxPair = std::pair<const TxId, PoolTx>;
+    using PoolTxMap = std::unordered_map<
+        TxId, PoolTx, SaltedTxIdHasher, std::equal_to<TxId>,
+        PoolAllocator<PoolTxPair, sizeof(PoolTxPair) + sizeof(void *) * 4>>;
+
+    /**
+     * Pointer to an entry of m_pool_txs. Unlike the iterators, pointers to the
+     * elements of an unordered_map are not invalidated by a rehash.
+     */
+    using PoolTxPtr = PoolTxMap::value_type *;
+
+    PoolTxMap::allocator_type::ResourceType m_pool_txs_resource{};
+
     /**
      * Map from txid to pool transaction record. Should be size constrained by
      * calling LimitTxs() with the desired max size.
      */
-    std::map<TxId, PoolTx> m_pool_txs GUARDED_BY(m_mutex);
+    PoolTxMap m_pool_txs GUARDED_BY(m_mutex){
+        0, SaltedTxIdHasher{}, std::equal_to<TxId>{}, &m_pool_txs_resource};
 
     /** Which peer provided the transactions that need to be reconsidered */
-    std::map<NodeId, std::set<TxId>> m_peer_work_set GUARDED_BY(m_mutex);
+    std::unordered_map<NodeId, std::set<TxId>>
+        m_peer_work_set GUARDED_BY(m_mutex);
 
-    using PoolTxMap = decltype(m_pool_txs);
+    /** Memory used by the transactions provided by each peer */
+    std::unordered_map<NodeId, size_t> m_peer_usage GUARDED_BY(m_mutex);
 
     struct IteratorComparator {
         template <typename I> bool operator()(const I &a, const I &b) const {
@@ -133,15 +186,31 @@ protected:
         }
     };
 
+    /**
+     * Pool transactions spending an outpoint. There is almost always a single
+     * one, so it is stored inline.
+     */
+    using PoolTxPtrs = prevector<1, PoolTxPtr>;
+    using OutpointPair = std::pair<const COutPoint, PoolTxPtrs>;
+    using OutpointMap = std::unordered_map<
+        COutPoint, PoolTxPtrs, SaltedOutpointHasher, std::equal_to<COutPoint>,
+        PoolAllocator<OutpointPair, sizeof(OutpointPair) + sizeof(void *) * 4>>;
+
+    OutpointMap::allocator_type::ResourceType m_outpoint_to_tx_resource{};
+
     /**
      * Index from the parents' COutPoint into the m_pool_txs. Used to remove
      * transactions from the m_pool_txs
      */
-    std::map<COutPoint, std::set<PoolTxMap ::iterator, IteratorComparator>>
-        m_outpoint_to_tx_it GUARDED_BY(m_mutex);
+    OutpointMap m_outpoint_to_tx_it GUARDED_BY(m_mutex){
+        0, SaltedOutpointHasher{}, std::equal_to<COutPoint>{},
+        &m_outpoint_to_tx_resource};
 
-    /** Pool transactions in vector for quick random eviction */
-    std::vector<PoolTxMap::iterator> m_txs_list GUARDED_BY(m_mutex);
+    /**
+     * Pool transactions in vector for quick random eviction and for linear
+     * scans over contiguous memory.
+     */
+    std::vector<PoolTxPtr> m_txs_list GUARDED_BY(m_mutex);
 
     /** Erase a transaction by txid */
     int EraseTxNoLock(const TxId &txid) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
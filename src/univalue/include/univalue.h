@@ -6,10 +6,12 @@
 #ifndef BITCOIN_UNIVALUE_INCLUDE_UNIVALUE_H
 #define BITCOIN_UNIVALUE_INCLUDE_UNIVALUE_H
 
+#include <atomic>
 #include <charconv>
 #include <cstddef>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -124,13 +126,77 @@ public:
     bool read(std::string_view raw);
 
 private:
+    /**
+     * Hash table of the positions of the keys of a large object, built once
+     * the object has been searched a few times so parsing or writing an object
+     * doesn't pay for it. It is published atomically, so concurrent lookups of
+     * a const object remain safe.
+     *
+     * Only the first of several equal keys is indexed, like the linear search
+     * finds it. The positions remain valid when the object is copied or moved.
+     */
+    class KeyIndex {
+    public:
+        KeyIndex() = default;
+        KeyIndex(const KeyIndex &other);
+        KeyIndex(KeyIndex &&other) noexcept
+            : slots{other.slots.exchange(nullptr)},
+              lookups{other.lookups.load(std::memory_order_relaxed)} {}
+        KeyIndex &operator=(const KeyIndex &other) {
+            if (this != &other) {
+                *this = KeyIndex{other};
+            }
+            return *this;
+        }
+        KeyIndex &operator=(KeyIndex &&other) noexcept {
+            delete slots.exchange(other.slots.exchange(nullptr));
+            lookups = other.lookups.load(std::memory_order_relaxed);
+            return *this;
+        }
+        ~KeyIndex() { delete slots.load(); }
+
+        void clear() {
+            delete slots.exchange(nullptr);
+            lookups = 0;
+        }
+        /** Index the key just added at position pos, if the index is built */
+        void insert(const std::vector<std::string> &keys, size_t pos);
+        bool find(const std::vector<std::string> &keys, std::string_view key,
+                  size_t &retIdx) const;
+
+    private:
+        struct Slots {
+            //! Hash of the key in the upper half, position + 1 in the lower
+            //! half, 0 for an empty slot
+            std::vector<uint64_t> table;
+            size_t used{0};
+
+            explicit Slots(const std::vector<std::string> &keys);
+            /** Return false if the table is too full to add a key */
+            bool insert(const std::vector<std::string> &keys, size_t pos);
+        };
+
+        mutable std::atomic<Slots *> slots{nullptr};
+        //! Number of linear searches, until the index is built
+        mutable std::atomic<uint32_t> lookups{0};
+    };
+
+    /**
+     * Objects with fewer keys are searched linearly, which is as fast and
+     * saves the memory of the index.
+     */
+    static constexpr size_t KEY_INDEX_MIN_SIZE{32};
+    /** Number of linear searches of a large object before indexing it */
+    static constexpr uint32_t KEY_INDEX_MIN_LOOKUPS{4};
+
     UniValue::VType typ;
     std::string val; // numbers are stored as C++ strings
     std::vector<std::string> keys;
     std::vector<UniValue> values;
+    KeyIndex keyIndex;
 
     void checkType(const VType &expected) const;
-    bool findKey(const std::string &key, size_t &retIdx) const;
+    bool findKey(std::string_view key, size_t &retIdx) const;
 
 public:
     // Strict type-specific getters, these throw std::runtime_error if the
@@ -5,6 +5,8 @@
 
 #include <univalue.h>
 
+#include <charconv>
+#include <functional>
 #include <iomanip>
 #include <map>
 #include <memory>
@@ -20,6 +22,7 @@ void UniValue::clear() {
     val.clear();
     keys.clear();
     values.clear();
+    keyIndex.clear();
 }
 
 void UniValue::setNull() {
@@ -54,22 +57,27 @@ void UniValue::setNumStr(std::string str) {
 }
 
 void UniValue::setInt(uint64_t val_) {
-    std::ostringstream oss;
-
-    oss << val_;
+    // The decimal representation of an integer is always a valid JSON number
+    char buf[24];
+    const auto res{std::to_chars(buf, buf + sizeof(buf), val_)};
 
-    return setNumStr(oss.str());
+    clear();
+    typ = VNUM;
+    val.assign(buf, res.ptr);
 }
 
 void UniValue::setInt(int64_t val_) {
-    std::ostringstream oss;
-
-    oss << val_;
+    char buf[24];
+    const auto res{std::to_chars(buf, buf + sizeof(buf), val_)};
 
-    return setNumStr(oss.str());
+    clear();
+    typ = VNUM;
+    val.assign(buf, res.ptr);
 }
 
 void UniValue::setFloat(double val_) {
+    // Floating-point std::to_chars isn't available on all the supported
+    // standard libraries, only integers are formatted with it.
     std::ostringstream oss;
 
     oss << std::setprecision(16) << val_;
@@ -110,6 +118,8 @@ void UniValue::pushKVEnd(std::string key, UniValue val_) {
 
     keys.push_back(std::move(key));
     values.push_back(std::move(val_));
+
+    keyIndex.insert(keys, keys.size() - 1);
 }
 
 void UniValue::pushKV(std::string key, UniValue val_) {
@@ -143,15 +153,117 @@ void UniValue::getObjMap(std::map<std::string, UniValue> &kv) const {
     }
 }
 
-bool UniValue::findKey(const std::string &key, size_t &retIdx) const {
-    for (size_t i = 0; i < keys.size(); i++) {
-        if (keys[i] == key) {
-            retIdx = i;
+/**
+ * Slots use the lower bits of the hash, the upper half is kept in the slot to
+ * skip most of the comparisons of keys. The multiplication spreads all the bits
+ * of std::hash over the upper half, including where size_t is 32 bits.
+ */
+static uint64_t HashKey(std::string_view key) {
+    return uint64_t{std::hash<std::string_view>{}(key)} * 0x9e3779b97f4a7c15;
+}
+
+static constexpr uint64_t KEY_HASH_MASK{0xffffffff00000000};
+static constexpr uint64_t KEY_POS_MASK{0x00000000ffffffff};
+
+UniValue::KeyIndex::Slots::Slots(const std::vector<std::string> &keys) {
+    // Keep the load factor between 1/4 and 1/2
+    size_t table_size{64};
+    while (table_size < 4 * keys.size()) {
+        table_size *= 2;
+    }
+
+    table.resize(table_size);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        insert(keys, i);
+    }
+}
+
+bool UniValue::KeyIndex::Slots::insert(const std::vector<std::string> &keys,
+                                       size_t pos) {
+    if (2 * (used + 1) > table.size()) {
+        return false;
+    }
+
+    const uint64_t hash{HashKey(keys[pos])};
+    const uint64_t tag{hash & KEY_HASH_MASK};
+    const size_t mask{table.size() - 1};
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const uint64_t slot{table[i]};
+        if (slot == 0) {
+            table[i] = tag | (pos + 1);
+            ++used;
+            return true;
+        }
+        if ((slot & KEY_HASH_MASK) == tag &&
+            keys[(slot & KEY_POS_MASK) - 1] == keys[pos]) {
+            // Duplicated key, the first one is found
             return true;
         }
     }
+}
+
+UniValue::KeyIndex::KeyIndex(const KeyIndex &other)
+    : lookups{other.lookups.load(std::memory_order_relaxed)} {
+    const Slots *other_slots{other.slots.load(std::memory_order_acquire)};
+    if (other_slots) {
+        slots = new Slots{*other_slots};
+    }
+}
+
+void UniValue::KeyIndex::insert(const std::vector<std::string> &keys,
+                                size_t pos) {
+    Slots *s{slots.load(std::memory_order_relaxed)};
+    if (s && !s->insert(keys, pos)) {
+        // Rebuilding indexes this key as well
+        delete slots.exchange(new Slots{keys});
+    }
+}
+
+bool UniValue::KeyIndex::find(const std::vector<std::string> &keys,
+                              std::string_view key, size_t &retIdx) const {
+    const Slots *s{slots.load(std::memory_order_acquire)};
+    if (!s) {
+        if (keys.size() < KEY_INDEX_MIN_SIZE ||
+            lookups.fetch_add(1, std::memory_order_relaxed) <
+                KEY_INDEX_MIN_LOOKUPS) {
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (keys[i] == key) {
+                    retIdx = i;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Concurrent lookups may build the index, only one is kept
+        auto built{std::make_unique<Slots>(keys)};
+        Slots *expected{nullptr};
+        if (slots.compare_exchange_strong(expected, built.get(),
+                                          std::memory_order_acq_rel)) {
+            s = built.release();
+        } else {
+            s = expected;
+        }
+    }
+
+    const uint64_t hash{HashKey(key)};
+    const uint64_t tag{hash & KEY_HASH_MASK};
+    const size_t mask{s->table.size() - 1};
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const uint64_t slot{s->table[i]};
+        if (slot == 0) {
+            return false;
+        }
+        if ((slot & KEY_HASH_MASK) == tag &&
+            keys[(slot & KEY_POS_MASK) - 1] == key) {
+            retIdx = (slot & KEY_POS_MASK) - 1;
+            return true;
+        }
+    }
+}
 
-    return false;
+bool UniValue::findKey(std::string_view key, size_t &retIdx) const {
+    return keyIndex.find(keys, key, retIdx);
 }
 
 bool UniValue::checkObject(
@@ -227,10 +339,9 @@ const char *uvTypeName(UniValue::VType t) {
 }
 
 const UniValue &UniValue::find_value(std::string_view key) const {
-    for (unsigned int i = 0; i < keys.size(); ++i) {
-        if (keys[i] == key) {
-            return values.at(i);
-        }
+    size_t index;
+    if (!findKey(key, index)) {
+        return NullUniValue;
     }
-    return NullUniValue;
+    return values.at(index);
 }
@@ -47,9 +47,16 @@ static const char *hatoui(const char *first, const char *last,
     return first;
 }
 
-enum jtokentype getJsonToken(std::string &tokenVal, unsigned int &consumed,
-                             const char *raw, const char *end) {
-    tokenVal.clear();
+/**
+ * Read the next token. The value of a number, or of a string without escape
+ * sequence, is a view of the input. Other strings are decoded into decoded,
+ * which tokenVal is then a view of.
+ */
+static enum jtokentype readJsonToken(std::string &decoded,
+                                     std::string_view &tokenVal,
+                                     unsigned int &consumed, const char *raw,
+                                     const char *end) {
+    tokenVal = {};
     consumed = 0;
 
     const char *rawStart = raw;
@@ -121,8 +128,6 @@ enum jtokentype getJsonToken(std::string &tokenVal, unsigned int &consumed,
         case '8':
         case '9': {
             // part 1: int
-            std::string numStr;
-
             const char *first = raw;
 
             const char *firstDigit = first;
@@ -133,57 +138,50 @@ enum jtokentype getJsonToken(std::string &tokenVal, unsigned int &consumed,
                 return JTOK_ERR;
             }
 
-            // copy first char
-            numStr += *raw;
+            // skip first char
             raw++;
 
             if ((*first == '-') && (raw < end) && (!json_isdigit(*raw))) {
                 return JTOK_ERR;
             }
 
-            // copy digits
+            // skip digits
             while (raw < end && json_isdigit(*raw)) {
-                numStr += *raw;
                 raw++;
             }
 
             // part 2: frac
             if (raw < end && *raw == '.') {
-                // copy .
-                numStr += *raw;
+                // skip .
                 raw++;
 
                 if (raw >= end || !json_isdigit(*raw)) {
                     return JTOK_ERR;
                 }
-                // copy digits
+                // skip digits
                 while (raw < end && json_isdigit(*raw)) {
-                    numStr += *raw;
                     raw++;
                 }
             }
 
             // part 3: exp
             if (raw < end && (*raw == 'e' || *raw == 'E')) {
-                numStr += *raw; // copy E
-                raw++;
+                raw++; // skip E
 
-                if (raw < end && (*raw == '-' || *raw == '+')) { // copy +/-
-                    numStr += *raw;
+                if (raw < end && (*raw == '-' || *raw == '+')) { // skip +/-
                     raw++;
                 }
 
                 if (raw >= end || !json_isdigit(*raw)) {
                     return JTOK_ERR;
                 }
-                // copy digits
+                // skip digits
                 while (raw < end && json_isdigit(*raw)) {
-                    numStr += *raw;
                     raw++;
                 }
             }
 
-            tokenVal = numStr;
+            tokenVal = std::string_view(first, raw - first);
             consumed = (raw - rawStart);
             return JTOK_NUMBER;
         }
@@ -192,8 +190,23 @@ enum jtokentype getJsonToken(std::string &tokenVal, unsigned int &consumed,
             // skip "
             raw++;
 
-            std::string valStr;
-            JSONUTF8StringFilter writer(valStr);
+            // Most strings are plain ASCII, without escape sequence
+            const char *first = raw;
+            while (raw < end && (uint8_t)*raw >= 0x20 && (uint8_t)*raw < 0x80 &&
+                   *raw != '"' && *raw != '\\') {
+                raw++;
+            }
+            if (raw < end && *raw == '"') {
+                tokenVal = std::string_view(first, raw - first);
+                // skip "
+                raw++;
+                consumed = (raw - rawStart);
+                return JTOK_STRING;
+            }
+
+            // The ASCII prefix passes through the filter unchanged
+            decoded.assign(first, raw);
+            JSONUTF8StringFilter writer(decoded);
 
             while (true) {
                 if (raw >= end || (uint8_t)*raw < 0x20) {
@@ -262,7 +275,7 @@ enum jtokentype getJsonToken(std::string &tokenVal, unsigned int &consumed,
             if (!writer.finalize()) {
                 return JTOK_ERR;
             }
-            tokenVal = valStr;
+            tokenVal = decoded;
             consumed = (raw - rawStart);
             return JTOK_STRING;
         }
@@ -272,6 +285,16 @@ enum jtokentype getJsonToken(std::string &tokenVal, unsigned int &consumed,
     }
 }
 
+enum jtokentype getJsonToken(std::string &tokenVal, unsigned int &consumed,
+                             const char *raw, const char *end) {
+    std::string decoded;
+    std::string_view token;
+    const enum jtokentype tt{
+        readJsonToken(decoded, token, consumed, raw, end)};
+    tokenVal.assign(token);
+    return tt;
+}
+
 enum expect_bits : unsigned {
     EXP_OBJ_NAME = (1U << 0),
     EXP_COLON = (1U << 1),
@@ -284,13 +307,108 @@ enum expect_bits : unsigned {
 #define setExpect(bit) (expectMask |= EXP_##bit)
 #define clearExpect(bit) (expectMask &= ~EXP_##bit)
 
+namespace {
+/**
+ * The document is parsed in two passes. The first one validates it and records
+ * its values in a flat tape, the second one builds the tree from the tape so
+ * each object and array is allocated once with its final size, and each string
+ * is copied once from the input.
+ */
+struct TapeEntry {
+    UniValue::VType type;
+    //! Whether the value is in the decoded strings rather than in the input
+    bool decoded{false};
+    //! Offset of the value of a string or number, 1 for true
+    size_t pos{0};
+    //! Size of the value of a string or number, number of members or elements
+    //! of an object or array
+    size_t size{0};
+};
+
+struct Tape {
+    std::string_view input;
+    //! Strings which needed to be unescaped, one after the other
+    std::string decoded;
+    std::vector<TapeEntry> entries;
+
+    /** Record a string or number token */
+    TapeEntry MakeEntry(UniValue::VType type, std::string_view str,
+                        bool is_decoded) {
+        TapeEntry entry{type, is_decoded};
+        if (is_decoded) {
+            entry.pos = decoded.size();
+            decoded.append(str);
+        } else {
+            entry.pos = str.data() - input.data();
+        }
+        entry.size = str.size();
+        return entry;
+    }
+
+    std::string GetString(const TapeEntry &entry) const {
+        return std::string{
+            (entry.decoded ? std::string_view{decoded} : input)
+                .substr(entry.pos, entry.size)};
+    }
+
+    /** Build the value recorded at pos, return the position following it */
+    size_t Build(size_t pos, UniValue &out) const {
+        const TapeEntry &entry{entries[pos++]};
+        switch (entry.type) {
+            case UniValue::VNULL:
+                out.setNull();
+                break;
+            case UniValue::VBOOL:
+                out.setBool(entry.pos != 0);
+                break;
+            case UniValue::VNUM:
+            case UniValue::VSTR:
+                out = UniValue(entry.type, GetString(entry));
+                break;
+            case UniValue::VOBJ:
+                out.setObject();
+                out.reserve(entry.size);
+                for (size_t i = 0; i < entry.size; ++i) {
+                    std::string key{GetString(entries[pos++])};
+                    UniValue value;
+                    pos = Build(pos, value);
+                    out.pushKVEnd(std::move(key), std::move(value));
+                }
+                break;
+            case UniValue::VARR:
+                out.setArray();
+                out.reserve(entry.size);
+                for (size_t i = 0; i < entry.size; ++i) {
+                    UniValue value;
+                    pos = Build(pos, value);
+                    out.push_back(std::move(value));
+                }
+                break;
+        }
+        return pos;
+    }
+};
+} // namespace
+
 bool UniValue::read(std::string_view str_in) {
     clear();
 
     uint32_t expectMask = 0;
-    std::vector<UniValue *> stack;
+    Tape tape{str_in};
+    // Positions in the tape of the open objects and arrays
+    std::vector<size_t> stack;
+
+    // Record a value, counting it in the enclosing array. The values of an
+    // object are counted with their key.
+    auto addValue = [&](TapeEntry entry) {
+        if (!stack.empty() && tape.entries[stack.back()].type == VARR) {
+            ++tape.entries[stack.back()].size;
+        }
+        tape.entries.push_back(entry);
+    };
 
-    std::string tokenVal;
+    std::string decodedToken;
+    std::string_view tokenVal;
     unsigned int consumed;
     enum jtokentype tok = JTOK_NONE;
     enum jtokentype last_tok = JTOK_NONE;
@@ -299,7 +417,7 @@ bool UniValue::read(std::string_view str_in) {
     do {
         last_tok = tok;
 
-        tok = getJsonToken(tokenVal, consumed, raw, end);
+        tok = readJsonToken(decodedToken, tokenVal, consumed, raw, end);
         if (tok == JTOK_NONE || tok == JTOK_ERR) {
             goto return_fail;
         }
@@ -345,21 +463,8 @@ bool UniValue::read(std::string_view str_in) {
             case JTOK_OBJ_OPEN:
             case JTOK_ARR_OPEN: {
                 VType utyp = (tok == JTOK_OBJ_OPEN ? VOBJ : VARR);
-                if (!stack.size()) {
-                    if (utyp == VOBJ) {
-                        setObject();
-                    } else {
-                        setArray();
-                    }
-                    stack.push_back(this);
-                } else {
-                    UniValue tmpVal(utyp);
-                    UniValue *top = stack.back();
-                    top->values.push_back(tmpVal);
-
-                    UniValue *newTop = &(top->values.back());
-                    stack.push_back(newTop);
-                }
+                addValue(TapeEntry{utyp});
+                stack.push_back(tape.entries.size() - 1);
 
                 if (stack.size() > MAX_JSON_DEPTH) {
                     goto return_fail;
@@ -380,8 +485,7 @@ bool UniValue::read(std::string_view str_in) {
                 }
 
                 VType utyp = (tok == JTOK_OBJ_CLOSE ? VOBJ : VARR);
-                UniValue *top = stack.back();
-                if (utyp != top->getType()) {
+                if (utyp != tape.entries[stack.back()].type) {
                     goto return_fail;
                 }
 
@@ -396,8 +500,7 @@ bool UniValue::read(std::string_view str_in) {
                     goto return_fail;
                 }
 
-                UniValue *top = stack.back();
-                if (top->getType() != VOBJ) {
+                if (tape.entries[stack.back()].type != VOBJ) {
                     goto return_fail;
                 }
 
@@ -411,8 +514,7 @@ bool UniValue::read(std::string_view str_in) {
                     goto return_fail;
                 }
 
-                UniValue *top = stack.back();
-                if (top->getType() == VOBJ) {
+                if (tape.entries[stack.back()].type == VOBJ) {
                     setExpect(OBJ_NAME);
                 } else {
                     setExpect(ARR_VALUE);
@@ -423,62 +525,27 @@ bool UniValue::read(std::string_view str_in) {
             case JTOK_KW_NULL:
             case JTOK_KW_TRUE:
             case JTOK_KW_FALSE: {
-                UniValue tmpVal;
-                switch (tok) {
-                    case JTOK_KW_NULL:
-                        // do nothing more
-                        break;
-                    case JTOK_KW_TRUE:
-                        tmpVal.setBool(true);
-                        break;
-                    case JTOK_KW_FALSE:
-                        tmpVal.setBool(false);
-                        break;
-                    default:
-                        /* impossible */
-                        break;
-                }
-
-                if (!stack.size()) {
-                    *this = tmpVal;
-                    break;
-                }
-
-                UniValue *top = stack.back();
-                top->values.push_back(tmpVal);
-
-                setExpect(NOT_VALUE);
-                break;
-            }
-
-            case JTOK_NUMBER: {
-                UniValue tmpVal(VNUM, tokenVal);
-                if (!stack.size()) {
-                    *this = tmpVal;
-                    break;
-                }
-
-                UniValue *top = stack.back();
-                top->values.push_back(tmpVal);
+                TapeEntry entry{tok == JTOK_KW_NULL ? VNULL : VBOOL};
+                entry.pos = (tok == JTOK_KW_TRUE);
+                addValue(entry);
 
                 setExpect(NOT_VALUE);
                 break;
             }
 
+            case JTOK_NUMBER:
             case JTOK_STRING: {
-                if (expect(OBJ_NAME)) {
-                    UniValue *top = stack.back();
-                    top->keys.push_back(tokenVal);
+                TapeEntry entry{
+                    tape.MakeEntry(tok == JTOK_NUMBER ? VNUM : VSTR, tokenVal,
+                                   tokenVal.data() == decodedToken.data())};
+
+                if (tok == JTOK_STRING && expect(OBJ_NAME)) {
+                    ++tape.entries[stack.back()].size;
+                    tape.entries.push_back(entry);
                     clearExpect(OBJ_NAME);
                     setExpect(COLON);
                 } else {
-                    UniValue tmpVal(VSTR, tokenVal);
-                    if (!stack.size()) {
-                        *this = tmpVal;
-                        break;
-                    }
-                    UniValue *top = stack.back();
-                    top->values.push_back(tmpVal);
+                    addValue(entry);
                 }
 
                 setExpect(NOT_VALUE);
@@ -491,11 +558,12 @@ bool UniValue::read(std::string_view str_in) {
     } while (!stack.empty());
 
     /* Check that nothing follows the initial construct (parsed above).  */
-    tok = getJsonToken(tokenVal, consumed, raw, end);
+    tok = readJsonToken(decodedToken, tokenVal, consumed, raw, end);
     if (tok != JTOK_NONE) {
         goto return_fail;
     }
 
+    tape.Build(0, *this);
     return true;
 
 return_fail:
@@ -44,17 +44,19 @@ struct UniValueStreamWriter {
 };
 
 void UniValueStreamWriter::escapeJson(const std::string &inS) {
+    // The characters between two escaped ones are copied at once
     size_t len = inS.length();
+    size_t unescaped = 0;
     for (size_t i = 0; i < len; i++) {
-        const char ch = inS[i];
-        const char *const escStr = escapes[uint8_t(ch)];
+        const char *const escStr = escapes[uint8_t(inS[i])];
 
         if (escStr) {
+            str.append(inS, unescaped, i - unescaped);
             write(escStr);
-        } else {
-            put(ch);
+            unescaped = i + 1;
         }
     }
+    str.append(inS, unescaped, len - unescaped);
 }
 
 void UniValueStreamWriter::writeAny(unsigned int prettyIndent,
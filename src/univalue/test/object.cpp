@@ -7,6 +7,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <limits>
 #include <map>
 #include <memory>
 #include <stdexcept>
@@ -183,6 +184,29 @@ void univalue_set() {
     BOOST_CHECK(v.isNum());
     BOOST_CHECK_EQUAL(v.getValStr(), "1023");
 
+    v.setInt(std::numeric_limits<int64_t>::min());
+    BOOST_CHECK(v.isNum());
+    BOOST_CHECK_EQUAL(v.getValStr(), "-9223372036854775808");
+
+    v.setInt(std::numeric_limits<uint64_t>::max());
+    BOOST_CHECK(v.isNum());
+    BOOST_CHECK_EQUAL(v.getValStr(), "18446744073709551615");
+
+    v.setFloat(1.0 / 3);
+    BOOST_CHECK_EQUAL(v.getValStr(), "0.3333333333333333");
+    BOOST_CHECK_EQUAL(v.get_real(), 0.3333333333333333);
+
+    v.setFloat(-1.5e300);
+    BOOST_CHECK_EQUAL(v.getValStr(), "-1.5e+300");
+    BOOST_CHECK_EQUAL(v.get_real(), -1.5e300);
+
+    BOOST_CHECK_THROW(
+        v.setFloat(std::numeric_limits<double>::infinity()),
+        std::runtime_error);
+    BOOST_CHECK_THROW(
+        v.setFloat(std::numeric_limits<double>::quiet_NaN()),
+        std::runtime_error);
+
     v.setNumStr("-688");
     BOOST_CHECK(v.isNum());
     BOOST_CHECK_EQUAL(v.getValStr(), "-688");
@@ -380,6 +404,72 @@ void univalue_object() {
     BOOST_CHECK_EQUAL(kv["name"].getValStr(), "foo bar");
 }
 
+void univalue_large_object() {
+    // Large enough to be indexed
+    const size_t n_keys = 1000;
+    UniValue obj(UniValue::VOBJ);
+    for (size_t i = 0; i < n_keys; ++i) {
+        obj.pushKV("key" + std::to_string(i), i);
+    }
+    // Replaced, not added
+    obj.pushKV("key10", "ten");
+    BOOST_CHECK_EQUAL(obj.size(), n_keys);
+
+    // Duplicated keys are found first
+    obj.pushKVEnd("key20", "twenty");
+    BOOST_CHECK_EQUAL(obj.size(), n_keys + 1);
+
+    for (size_t round = 0; round < 10; ++round) {
+        for (size_t i = 0; i < n_keys; ++i) {
+            const std::string key = "key" + std::to_string(i);
+            BOOST_CHECK(obj.exists(key));
+            if (i == 10) {
+                BOOST_CHECK_EQUAL(obj[key].get_str(), "ten");
+            } else {
+                BOOST_CHECK_EQUAL(obj.find_value(key).getInt<size_t>(), i);
+            }
+        }
+        BOOST_CHECK(!obj.exists("key"));
+        BOOST_CHECK(obj.find_value("key1000").isNull());
+    }
+
+    // Added once indexed
+    obj.pushKV("new", "value");
+    BOOST_CHECK_EQUAL(obj["new"].get_str(), "value");
+    obj.pushKV("new", "other");
+    BOOST_CHECK_EQUAL(obj.size(), n_keys + 2);
+    BOOST_CHECK_EQUAL(obj["new"].get_str(), "other");
+
+    // Copies are independent
+    UniValue copy{obj};
+    obj.pushKV("key0", "zero");
+    BOOST_CHECK_EQUAL(obj["key0"].get_str(), "zero");
+    BOOST_CHECK_EQUAL(copy["key0"].getInt<int>(), 0);
+    copy.pushKV("copy", true);
+    BOOST_CHECK(copy["copy"].get_bool());
+    BOOST_CHECK(!obj.exists("copy"));
+
+    UniValue moved{std::move(copy)};
+    BOOST_CHECK_EQUAL(moved["key999"].getInt<int>(), 999);
+    BOOST_CHECK(moved["copy"].get_bool());
+
+    obj.setObject();
+    BOOST_CHECK(!obj.exists("key1"));
+    obj.pushKV("key1", 1);
+    BOOST_CHECK_EQUAL(obj["key1"].getInt<int>(), 1);
+
+    // Same when parsed
+    UniValue parsed;
+    BOOST_CHECK(parsed.read(moved.write()));
+    BOOST_CHECK_EQUAL(parsed.write(), moved.write());
+    for (size_t round = 0; round < 10; ++round) {
+        BOOST_CHECK_EQUAL(parsed["key20"].getInt<int>(), 20);
+        BOOST_CHECK_EQUAL(parsed["key999"].getInt<int>(), 999);
+        BOOST_CHECK(parsed["copy"].get_bool());
+        BOOST_CHECK(parsed["key1000"].isNull());
+    }
+}
+
 static const char *json1 = "[1.10000000,{\"key1\":\"str\\u0000\",\"key2\":800,"
                            "\"key3\":{\"name\":\"martian http://test.com\"}}]";
 
@@ -409,6 +499,22 @@ void univalue_readwrite() {
 
     BOOST_CHECK_EQUAL(strJson1, v.write());
 
+    // Plain and escaped strings, as keys and values
+    BOOST_CHECK(v.read("{\"a\": \"plain\", \"b\\n\": \"\\u00e9t\\u00e9\", "
+                       "\"\\u00e9\": [\"\", \"x\\\\y\", \"\xc3\xa9\"]}"));
+    BOOST_CHECK_EQUAL(v["a"].get_str(), "plain");
+    BOOST_CHECK_EQUAL(v["b\n"].get_str(), "\xc3\xa9t\xc3\xa9");
+    BOOST_CHECK_EQUAL(v["\xc3\xa9"][0].get_str(), "");
+    BOOST_CHECK_EQUAL(v["\xc3\xa9"][1].get_str(), "x\\y");
+    BOOST_CHECK_EQUAL(v["\xc3\xa9"][2].get_str(), "\xc3\xa9");
+    BOOST_CHECK_EQUAL(v.write(),
+                      "{\"a\":\"plain\",\"b\\n\":\"\xc3\xa9t\xc3\xa9\","
+                      "\"\xc3\xa9\":[\"\",\"x\\\\y\",\"\xc3\xa9\"]}");
+    // Invalid UTF-8 after an ASCII prefix
+    BOOST_CHECK(!v.read("[\"abc\xc3\"]"));
+    // Unterminated string after an ASCII prefix
+    BOOST_CHECK(!v.read("[\"abc\\\"]"));
+
     // Valid
     BOOST_CHECK(v.read("1.0") && (v.get_real() == 1.0));
     BOOST_CHECK(v.read("true") && v.get_bool());
@@ -460,6 +566,7 @@ int main(int argc, char *argv[]) {
     univalue_set();
     univalue_array();
     univalue_object();
+    univalue_large_object();
     univalue_readwrite();
     return 0;
 }
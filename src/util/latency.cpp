@@ -0,0 +1,131 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/latency.h>
+
+#include <tinyformat.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <utility>
+
+LatencyHistogram::LatencyHistogram(std::string name, std::string description)
+    : m_name{std::move(name)}, m_description{std::move(description)} {
+    GetLatencyRegistry().Register(*this);
+}
+
+LatencyHistogram::~LatencyHistogram() {
+    GetLatencyRegistry().Unregister(*this);
+}
+
+size_t LatencyHistogram::GetBucketIndex(std::chrono::microseconds duration) {
+    const int64_t us = duration.count();
+    if (us <= 1) {
+        return 0;
+    }
+    // Smallest i such that us <= 2^i
+    return std::min<size_t>(std::bit_width(uint64_t(us - 1)), NUM_BUCKETS - 1);
+}
+
+void LatencyHistogram::Observe(std::chrono::microseconds duration) {
+    // Spread the threads over the shards in a round robin fashion, so threads
+    // that record concurrently are likely to write to different cache lines.
+    static std::atomic<size_t> next_shard{0};
+    static thread_local const size_t shard_index{
+        next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS};
+
+    Shard &shard = m_shards[shard_index];
+    shard.buckets[GetBucketIndex(duration)].fetch_add(
+        1, std::memory_order_relaxed);
+    shard.sum_us.fetch_add(std::max<int64_t>(duration.count(), 0),
+                           std::memory_order_relaxed);
+}
+
+std::optional<std::chrono::microseconds>
+LatencyHistogram::Snapshot::GetQuantileUpperBound(double q) const {
+    if (count == 0) {
+        return std::nullopt;
+    }
+    // Rank of the quantile observation, 1-based
+    const uint64_t rank =
+        std::clamp<uint64_t>(std::ceil(q * count), 1, count);
+    uint64_t cumulative{0};
+    for (size_t i = 0; i + 1 < NUM_BUCKETS; ++i) {
+        cumulative += buckets[i];
+        if (cumulative >= rank) {
+            return GetBucketUpperBound(i);
+        }
+    }
+    return std::nullopt;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const {
+    Snapshot snapshot;
+    uint64_t sum_us{0};
+    for (const Shard &shard : m_shards) {
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            const uint64_t n = shard.buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += n;
+            snapshot.count += n;
+        }
+        sum_us += shard.sum_us.load(std::memory_order_relaxed);
+    }
+    snapshot.sum = std::chrono::microseconds{sum_us};
+    return snapshot;
+}
+
+void LatencyRegistry::Register(const LatencyHistogram &histogram) {
+    LOCK(m_mutex);
+    m_histograms.push_back(&histogram);
+}
+
+void LatencyRegistry::Unregister(const LatencyHistogram &histogram) {
+    LOCK(m_mutex);
+    m_histograms.erase(
+        std::remove(m_histograms.begin(), m_histograms.end(), &histogram),
+        m_histograms.end());
+}
+
+std::vector<const LatencyHistogram *> LatencyRegistry::GetHistograms() const {
+    std::vector<const LatencyHistogram *> histograms =
+        WITH_LOCK(m_mutex, return m_histograms);
+    std::sort(histograms.begin(), histograms.end(),
+              [](const LatencyHistogram *a, const LatencyHistogram *b) {
+                  return a->GetName() < b->GetName();
+              });
+    return histograms;
+}
+
+std::string LatencyRegistry::ToPrometheus() const {
+    std::string out;
+    for (const LatencyHistogram *histogram : GetHistograms()) {
+        const std::string metric =
+            strprintf("doged_%s_seconds", histogram->GetName());
+        const LatencyHistogram::Snapshot snapshot = histogram->GetSnapshot();
+
+        out += strprintf("# HELP %s %s\n", metric,
+                         histogram->GetDescription());
+        out += strprintf("# TYPE %s histogram\n", metric);
+        // Prometheus buckets are cumulative
+        uint64_t cumulative{0};
+        for (size_t i = 0; i + 1 < LatencyHistogram::NUM_BUCKETS; ++i) {
+            cumulative += snapshot.buckets[i];
+            out += strprintf(
+                "%s_bucket{le=\"%g\"} %u\n", metric,
+                Ticks<SecondsDouble>(LatencyHistogram::GetBucketUpperBound(i)),
+                cumulative);
+        }
+        out += strprintf("%s_bucket{le=\"+Inf\"} %u\n", metric, snapshot.count);
+        out += strprintf("%s_sum %.6f\n", metric,
+                         Ticks<SecondsDouble>(snapshot.sum));
+        out += strprintf("%s_count %u\n", metric, snapshot.count);
+    }
+    return out;
+}
+
+LatencyRegistry &GetLatencyRegistry() {
+    static LatencyRegistry registry;
+    return registry;
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_LATENCY_H
+#define BITCOIN_UTIL_LATENCY_H
+
+#include <sync.h>
+#include <util/time.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Histogram of the latency of an operation, always enabled.
+ *
+ * Durations are counted in exponential buckets: bucket i counts the
+ * observations that took at most 2^i microseconds, and the last bucket counts
+ * everything above. The counters are relaxed atomics spread over a few cache
+ * line aligned shards, each thread always writing to the same shard, so
+ * recording an observation never takes a lock and threads don't contend.
+ *
+ * Histograms register themselves with the LatencyRegistry on construction and
+ * unregister on destruction. They are expected to be static objects.
+ */
+class LatencyHistogram {
+public:
+    /** Number of buckets, the last one being unbounded (~33s and more) */
+    static constexpr size_t NUM_BUCKETS{27};
+
+    struct Snapshot {
+        /** Non-cumulative count of observations in each bucket */
+        std::array<uint64_t, NUM_BUCKETS> buckets{};
+        uint64_t count{0};
+        std::chrono::microseconds sum{0};
+
+        /**
+         * Upper bound of the bucket containing the q-quantile of the
+         * observations, e.g. q = 0.99 for the 99th percentile. Returns nullopt
+         * if there is no observation or if it falls into the unbounded bucket.
+         */
+        std::optional<std::chrono::microseconds>
+        GetQuantileUpperBound(double q) const;
+    };
+
+    LatencyHistogram(std::string name, std::string description);
+    ~LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    void Observe(std::chrono::microseconds duration);
+    void Observe(SteadyClock::duration duration) {
+        Observe(std::chrono::duration_cast<std::chrono::microseconds>(duration));
+    }
+
+    /**
+     * Sum up the shards. The result is not an atomic snapshot: observations
+     * recorded concurrently may or may not be included.
+     */
+    Snapshot GetSnapshot() const;
+
+    const std::string &GetName() const { return m_name; }
+    const std::string &GetDescription() const { return m_description; }
+
+    /** Inclusive upper bound of bucket i, which must not be the last one */
+    static std::chrono::microseconds GetBucketUpperBound(size_t i) {
+        return std::chrono::microseconds{int64_t{1} << i};
+    }
+
+    /** Index of the bucket an observation of this duration falls into */
+    static size_t GetBucketIndex(std::chrono::microseconds duration);
+
+private:
+    static constexpr size_t NUM_SHARDS{8};
+
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets{};
+        std::atomic<uint64_t> sum_us{0};
+    };
+
+    const std::string m_name;
+    const std::string m_description;
+    std::array<Shard, NUM_SHARDS> m_shards;
+};
+
+/**
+ * Measure the time elapsed between construction and destruction of this object
+ * into a LatencyHistogram.
+ */
+class LatencyTimer {
+public:
+    explicit LatencyTimer(LatencyHistogram &histogram)
+        : m_histogram{histogram}, m_start{SteadyClock::now()} {}
+    ~LatencyTimer() { m_histogram.Observe(SteadyClock::now() - m_start); }
+
+    LatencyTimer(const LatencyTimer &) = delete;
+    LatencyTimer &operator=(const LatencyTimer &) = delete;
+
+private:
+    LatencyHistogram &m_histogram;
+    const SteadyClock::time_point m_start;
+};
+
+/** The set of all the latency histograms of the process. */
+class LatencyRegistry {
+public:
+    void Register(const LatencyHistogram &histogram)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void Unregister(const LatencyHistogram &histogram)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Return the registered histograms, sorted by name */
+    std::vector<const LatencyHistogram *> GetHistograms() const
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Format all the histograms in the Prometheus text exposition format. Each
+     * histogram is a metric family named doged_<name>_seconds.
+     */
+    std::string ToPrometheus() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    mutable Mutex m_mutex;
+    std::vector<const LatencyHistogram *> m_histograms GUARDED_BY(m_mutex);
+};
+
+LatencyRegistry &GetLatencyRegistry();
+
+#endif // BITCOIN_UTIL_LATENCY_H
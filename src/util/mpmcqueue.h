@@ -0,0 +1,117 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_MPMCQUEUE_H
+#define BITCOIN_UTIL_MPMCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * Bounded multi-producer multi-consumer FIFO queue which never takes a lock.
+ *
+ * This is Dmitry Vyukov's array based queue: each cell carries a sequence
+ * number telling whether it is ready to be written or read at a given
+ * position, so producers and consumers only contend on the position they
+ * claim with a compare-and-swap.
+ *
+ * A push fails when the queue is full and a pop fails when it is empty, this
+ * never blocks. A pop may also fail while the oldest element is being pushed,
+ * even if a later one is complete already.
+ */
+template <typename T> class MPMCQueue {
+public:
+    /** The capacity is min_capacity rounded up to a power of two */
+    explicit MPMCQueue(size_t min_capacity) {
+        size_t capacity{2};
+        while (capacity < min_capacity) {
+            capacity *= 2;
+        }
+        m_mask = capacity - 1;
+        m_cells = std::make_unique<Cell[]>(capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue &) = delete;
+    MPMCQueue &operator=(const MPMCQueue &) = delete;
+
+    /** Move value into the queue, leaving it untouched if the queue is full */
+    bool TryPush(T &&value) {
+        Cell *cell;
+        size_t pos{m_enqueue_pos.load(std::memory_order_relaxed)};
+        while (true) {
+            cell = &m_cells[pos & m_mask];
+            const size_t seq{cell->sequence.load(std::memory_order_acquire)};
+            const intptr_t diff{intptr_t(seq) - intptr_t(pos)};
+            if (diff == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The cell still holds the value pushed a lap ago
+                return false;
+            } else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Move the oldest value out of the queue into value */
+    bool TryPop(T &value) {
+        Cell *cell;
+        size_t pos{m_dequeue_pos.load(std::memory_order_relaxed)};
+        while (true) {
+            cell = &m_cells[pos & m_mask];
+            const size_t seq{cell->sequence.load(std::memory_order_acquire)};
+            const intptr_t diff{intptr_t(seq) - intptr_t(pos + 1)};
+            if (diff == 0) {
+                if (m_dequeue_pos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Nothing was pushed at this position yet
+                return false;
+            } else {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        // Don't keep a moved-from value alive until the cell is reused
+        cell->value = T{};
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Whether no value was pushed and not popped yet, approximately */
+    bool Empty() const {
+        return m_enqueue_pos.load(std::memory_order_relaxed) ==
+               m_dequeue_pos.load(std::memory_order_relaxed);
+    }
+
+    size_t Capacity() const { return m_mask + 1; }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+    //! Producers and consumers claim positions on separate cache lines
+    alignas(64) std::atomic<size_t> m_enqueue_pos{0};
+    alignas(64) std::atomic<size_t> m_dequeue_pos{0};
+};
+
+#endif // BITCOIN_UTIL_MPMCQUEUE_H
@@ -0,0 +1,49 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace util {
+bool ParallelFor(size_t count, size_t num_threads,
+                 const std::function<bool(size_t)> &fn) {
+    std::vector<std::exception_ptr> errors(count);
+    // Also set on exceptions, which are rethrown instead of returning false
+    std::atomic<bool> failed{false};
+    std::atomic<size_t> next{0};
+    const auto worker = [&] {
+        for (size_t i = next++; i < count && !failed; i = next++) {
+            try {
+                if (!fn(i)) {
+                    failed = true;
+                }
+            } catch (...) {
+                errors[i] = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(num_threads, count); ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    for (const std::exception_ptr &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return !failed;
+}
+} // namespace util
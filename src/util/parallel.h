@@ -0,0 +1,26 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_PARALLEL_H
+#define BITCOIN_UTIL_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace util {
+/**
+ * Call fn for each index in [0, count) on up to num_threads threads, the
+ * calling thread included. The indices are handed out in increasing order.
+ *
+ * Once fn returns false or throws for an index, no further index is started.
+ * After all the threads are joined, the exception thrown for the lowest index
+ * is rethrown.
+ *
+ * @return false if fn returned false for some index.
+ */
+bool ParallelFor(size_t count, size_t num_threads,
+                 const std::function<bool(size_t)> &fn);
+} // namespace util
+
+#endif // BITCOIN_UTIL_PARALLEL_H
@@ -12,6 +12,8 @@
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
+#include <algorithm>
+#include <array>
 #include <codecvt>
 #include <cwchar>
 #include <locale>
@@ -23,6 +25,11 @@
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
 static inline bool IOErrorIsPermanent(int err) {
     return err != WSAEAGAIN && err != WSAEINTR && err != WSAEWOULDBLOCK &&
            err != WSAEINPROGRESS;
@@ -50,6 +57,29 @@ ssize_t Sock::Send(const void *data, size_t len, int flags) const {
     return send(m_socket, static_cast<const char *>(data), len, flags);
 }
 
+ssize_t Sock::SendMany(Span<const Span<const uint8_t>> buffers,
+                       int flags) const {
+#ifdef WIN32
+    if (buffers.empty()) {
+        return 0;
+    }
+    return Send(buffers[0].data(), buffers[0].size(), flags);
+#else
+    std::array<iovec, MAX_SEND_BUFFERS> iov;
+    const size_t count{std::min(buffers.size(), MAX_SEND_BUFFERS)};
+    for (size_t i = 0; i < count; ++i) {
+        // iovec is not const-correct, sendmsg(2) does not modify the data
+        iov[i].iov_base = const_cast<uint8_t *>(buffers[i].data());
+        iov[i].iov_len = buffers[i].size();
+    }
+
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = count;
+    return sendmsg(m_socket, &msg, flags);
+#endif
+}
+
 ssize_t Sock::Recv(void *buf, size_t len, int flags) const {
     return recv(m_socket, static_cast<char *>(buf), len, flags);
 }
@@ -435,6 +465,58 @@ bool Sock::operator==(SOCKET s) const {
     return m_socket == s;
 };
 
+#ifdef USE_EPOLL
+SockEpoll::SockEpoll() : m_epoll_fd{epoll_create1(EPOLL_CLOEXEC)} {}
+
+SockEpoll::~SockEpoll() {
+    if (m_epoll_fd != -1) {
+        close(m_epoll_fd);
+    }
+}
+
+bool SockEpoll::Add(const Sock &sock, uint64_t key, bool edge_triggered) {
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+    if (edge_triggered) {
+        ev.events |= EPOLLET;
+    }
+    ev.data.u64 = key;
+    return epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, sock.m_socket, &ev) == 0;
+}
+
+bool SockEpoll::Remove(const Sock &sock) {
+    return epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, sock.m_socket, nullptr) == 0;
+}
+
+bool SockEpoll::Wait(std::chrono::milliseconds timeout,
+                     std::vector<ReadyEvent> &ready) const {
+    // Events that don't fit are left in the kernel ready list, and returned by
+    // the next call.
+    std::array<epoll_event, 256> events;
+    const int n = epoll_wait(m_epoll_fd, events.data(), events.size(),
+                             count_milliseconds(timeout));
+    if (n == SOCKET_ERROR) {
+        return errno == EINTR;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        Sock::Event occurred{0};
+        if (events[i].events & EPOLLIN) {
+            occurred |= Sock::RECV;
+        }
+        if (events[i].events & EPOLLOUT) {
+            occurred |= Sock::SEND;
+        }
+        if (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+            occurred |= Sock::ERR;
+        }
+        ready.push_back({events[i].data.u64, occurred});
+    }
+
+    return true;
+}
+#endif
+
 std::string NetworkErrorString(int err) {
 #ifdef WIN32
     return Win32ErrorString(err);
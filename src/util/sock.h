@@ -6,6 +6,7 @@
 #define BITCOIN_UTIL_SOCK_H
 
 #include <compat/compat.h>
+#include <span.h>
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
@@ -13,6 +14,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 /**
  * Maximum time to wait for I/O readiness.
@@ -69,6 +71,19 @@ public:
      */
     virtual ssize_t Send(const void *data, size_t len, int flags) const;
 
+    /** Maximum number of buffers SendMany() sends at once. */
+    static constexpr size_t MAX_SEND_BUFFERS{64};
+
+    /**
+     * Scatter-gather send of several buffers with a single sendmsg(2) call.
+     * Only the first MAX_SEND_BUFFERS buffers are considered. Where sendmsg(2)
+     * is not available only the first buffer is sent. Returns like send(2).
+     * Code that uses this wrapper can be unit tested if this method is
+     * overridden by a mock Sock implementation.
+     */
+    virtual ssize_t SendMany(Span<const Span<const uint8_t>> buffers,
+                             int flags) const;
+
     /**
      * recv(2) wrapper. Equivalent to `recv(m_socket, buf, len, flags);`.
      * Code that uses this wrapper can be unit tested if this method is
@@ -299,6 +314,10 @@ protected:
      */
     SOCKET m_socket;
 
+#ifdef USE_EPOLL
+    friend class SockEpoll;
+#endif
+
 private:
     /**
      * Close `m_socket` if it is not `INVALID_SOCKET`.
@@ -306,6 +325,63 @@ private:
     void Close();
 };
 
+#ifdef USE_EPOLL
+/**
+ * Persistent set of sockets to wait for, backed by epoll(7).
+ *
+ * Unlike `Sock::WaitMany()`, which hands all the sockets over to the kernel on
+ * each call, the sockets are registered once and the cost of waiting only
+ * depends on the number of sockets that are ready.
+ */
+class SockEpoll {
+public:
+    SockEpoll();
+    ~SockEpoll();
+
+    SockEpoll(const SockEpoll &) = delete;
+    SockEpoll &operator=(const SockEpoll &) = delete;
+
+    /** Whether the epoll instance could be created */
+    bool IsValid() const { return m_epoll_fd != -1; }
+
+    /**
+     * Start waiting for both `Sock::RECV` and `Sock::SEND` events on a socket.
+     * In edge-triggered mode, an event is only reported when the socket
+     * becomes ready, so the caller has to remember the readiness until a recv
+     * or send would block. The socket is automatically removed from the set
+     * once it is closed.
+     * @param[in] sock The socket to wait for.
+     * @param[in] key Value identifying the socket in the events reported by
+     *     `Wait()`.
+     * @param[in] edge_triggered Whether to report edges or levels.
+     * @return true on success
+     */
+    [[nodiscard]] bool Add(const Sock &sock, uint64_t key,
+                           bool edge_triggered);
+
+    /** Stop waiting for events on a socket. */
+    [[nodiscard]] bool Remove(const Sock &sock);
+
+    struct ReadyEvent {
+        uint64_t key;
+        Sock::Event occurred;
+    };
+
+    /**
+     * Wait for at least one of the registered sockets to be ready.
+     * @param[in] timeout Wait this long at most.
+     * @param[out] ready Append the events that occurred. Nothing is appended
+     *     on timeout.
+     * @return true on success (or timeout), false otherwise
+     */
+    [[nodiscard]] bool Wait(std::chrono::milliseconds timeout,
+                            std::vector<ReadyEvent> &ready) const;
+
+private:
+    int m_epoll_fd;
+};
+#endif
+
 /** Return readable error string for a network error code */
 std::string NetworkErrorString(int err);
 
@@ -64,23 +64,25 @@ bool IsHexNumber(std::string_view str) {
 
 template <typename Byte>
 std::optional<std::vector<Byte>> TryParseHex(std::string_view str) {
-    std::vector<Byte> vch;
-    auto it = str.begin();
-    while (it != str.end()) {
-        if (IsSpace(*it)) {
-            ++it;
-            continue;
+    std::vector<Byte> vch(str.size() / 2);
+    const Span<uint8_t> out{reinterpret_cast<uint8_t *>(vch.data()),
+                            vch.size()};
+    size_t size{0};
+    while (!str.empty()) {
+        // Decode the runs of hex digits at once, spaces are only allowed
+        // between the bytes
+        const size_t decoded{HexDecodePrefix(str, out.subspan(size))};
+        size += decoded;
+        str.remove_prefix(decoded * 2);
+        if (str.empty()) {
+            break;
         }
-        auto c1 = HexDigit(*(it++));
-        if (it == str.end()) {
+        if (!IsSpace(str.front())) {
             return std::nullopt;
         }
-        auto c2 = HexDigit(*(it++));
-        if (c1 < 0 || c2 < 0) {
-            return std::nullopt;
-        }
-        vch.push_back(Byte(c1 << 4) | Byte(c2));
+        str.remove_prefix(1);
     }
+    vch.resize(size);
     return vch;
 }
 template std::vector<std::byte> ParseHex(std::string_view);
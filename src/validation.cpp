@@ -59,6 +59,7 @@
 #include <util/check.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
+#include <util/latency.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/string.h>
@@ -1423,12 +1424,17 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptPackage(const Package &package,
 }
 } // namespace
 
+static LatencyHistogram latency_accept_to_mempool{
+    "accept_to_mempool",
+    "Time spent accepting a single transaction to the mempool"};
+
 MempoolAcceptResult AcceptToMemoryPool(Chainstate &active_chainstate,
                                        const CTransactionRef &tx,
                                        int64_t accept_time, bool bypass_limits,
                                        bool test_accept,
                                        unsigned int heightOverride) {
     AssertLockHeld(::cs_main);
+    LatencyTimer timer{latency_accept_to_mempool};
     assert(active_chainstate.GetMempool() != nullptr);
     CTxMemPool &pool{*active_chainstate.GetMempool()};
 
@@ -2118,6 +2124,69 @@ void StopPowCheckWorkerThreads() {
     powcheckqueue.StopWorkerThreads();
 }
 
+size_t PreverifyMempoolTransactions(Chainstate &active_chainstate,
+                                    const std::vector<CTransactionRef> &txs) {
+    AssertLockHeld(cs_main);
+    assert(active_chainstate.GetMempool() != nullptr);
+    CTxMemPool &pool{*active_chainstate.GetMempool()};
+    LOCK(pool.cs);
+
+    ChainstateManager &chainman = active_chainstate.m_chainman;
+    // Use the same flags as the standard script checks from PreChecks, so the
+    // work done here is exactly the work that AcceptToMemoryPool will skip.
+    uint32_t flags =
+        GetNextBlockScriptFlags(active_chainstate.m_chain.Tip(), chainman);
+    if (IsLegacyScriptRulesEnabled(chainman.GetConsensus())) {
+        flags |= STANDARD_SCRIPT_VERIFY_FLAGS_LEGACY;
+    } else {
+        flags |= STANDARD_SCRIPT_VERIFY_FLAGS;
+    }
+
+    // Inputs can come from the UTXO set, from the mempool or from a
+    // transaction earlier in the batch.
+    CCoinsViewMemPool view_mempool(&active_chainstate.CoinsTip(), pool);
+    CCoinsViewCache view(&view_mempool);
+
+    // The sigchecks limits are enforced by AcceptToMemoryPool itself, the
+    // limiters only need to outlive the deferred checks.
+    std::vector<TxSigCheckLimiter> tx_limiters(
+        txs.size(), TxSigCheckLimiter::getDisabled());
+
+    size_t queued = 0;
+    CCheckQueueControl<CScriptCheck> control(&scriptcheckqueue);
+    for (size_t i = 0; i < txs.size(); ++i) {
+        const CTransaction &tx = *txs[i];
+
+        TxValidationState state;
+        if (!CheckRegularTransaction(tx, state) || !view.HaveInputs(tx)) {
+            // AcceptToMemoryPool will reject it with the proper reason.
+            continue;
+        }
+
+        std::vector<CScriptCheck> checks;
+        int nSigChecks;
+        // Don't erase any matching script execution cache entry, and don't
+        // store in the script execution cache: the checks are deferred.
+        if (CheckInputScripts(tx, state, view, flags, /*sigCacheStore=*/true,
+                              /*scriptCacheStore=*/true,
+                              PrecomputedTransactionData(tx),
+                              chainman.m_validation_cache, nSigChecks,
+                              tx_limiters[i], nullptr, &checks)) {
+            queued += checks.size();
+            control.Add(std::move(checks));
+        }
+
+        AddCoins(view, tx, MEMPOOL_HEIGHT, /*check=*/true);
+    }
+
+    // A failing check stops the remaining ones from being processed. This is
+    // harmless since the results are only used to populate the signature
+    // cache.
+    control.Complete();
+
+    return queued;
+}
+
 // Returns the script flags which should be checked for the block after
 // the given block.
 static uint32_t GetNextBlockScriptFlags(const CBlockIndex *pindex,
@@ -2209,6 +2278,22 @@ static SteadyClock::duration time_index{};
 static SteadyClock::duration time_total{};
 static int64_t num_blocks_total = 0;
 
+static LatencyHistogram latency_connect_block_check{
+    "connect_block_check",
+    "Time spent in ConnectBlock checking the block, including its proof of "
+    "work"};
+static LatencyHistogram latency_connect_block_inputs{
+    "connect_block_inputs",
+    "Time spent in ConnectBlock fetching and spending the coins, and queuing "
+    "the script checks"};
+static LatencyHistogram latency_connect_block_verify{
+    "connect_block_verify",
+    "Time spent in ConnectBlock until all the scripts are verified, including "
+    "the inputs phase"};
+static LatencyHistogram latency_connect_block_undo{
+    "connect_block_undo",
+    "Time spent in ConnectBlock writing the undo data and the block index"};
+
 /**
  * Apply the effects of this block (with given index) on the UTXO set
  * represented by coins. Validity checks that depend on the UTXO set are also
@@ -2321,6 +2406,7 @@ bool Chainstate::ConnectBlock(const CBlock &block, BlockValidationState &state,
 
     const auto time_1{SteadyClock::now()};
     time_check += time_1 - time_start;
+    latency_connect_block_check.Observe(time_1 - time_start);
     LogPrint(BCLog::BENCH, "    - Sanity checks: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_1 - time_start),
              Ticks<SecondsDouble>(time_check),
@@ -2563,6 +2649,7 @@ bool Chainstate::ConnectBlock(const CBlock &block, BlockValidationState &state,
     }
     const auto time_3{SteadyClock::now()};
     time_connect += time_3 - time_2;
+    latency_connect_block_inputs.Observe(time_3 - time_2);
     LogPrint(BCLog::BENCH,
              "      - Connect %u transactions: %.2fms (%.3fms/tx, %.3fms/txin) "
              "[%.2fs (%.2fms/blk)]\n",
@@ -2602,6 +2689,7 @@ bool Chainstate::ConnectBlock(const CBlock &block, BlockValidationState &state,
     }
     const auto time_4{SteadyClock::now()};
     time_verify += time_4 - time_2;
+    latency_connect_block_verify.Observe(time_4 - time_2);
     LogPrint(
         BCLog::BENCH,
         "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs (%.2fms/blk)]\n",
@@ -2630,6 +2718,7 @@ bool Chainstate::ConnectBlock(const CBlock &block, BlockValidationState &state,
 
     const auto time_5{SteadyClock::now()};
     time_index += time_5 - time_4;
+    latency_connect_block_undo.Observe(time_5 - time_4);
     LogPrint(BCLog::BENCH, "    - Index writing: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_5 - time_4),
              Ticks<SecondsDouble>(time_index),
@@ -3040,6 +3129,21 @@ static SteadyClock::duration time_flush{};
 static SteadyClock::duration time_chainstate{};
 static SteadyClock::duration time_post_connect{};
 
+static LatencyHistogram latency_connect_tip_read{
+    "connect_tip_read", "Time spent reading the block to connect from disk"};
+static LatencyHistogram latency_connect_tip_flush{
+    "connect_tip_flush",
+    "Time spent flushing the block connection view to the coins cache"};
+static LatencyHistogram latency_connect_tip_chainstate{
+    "connect_tip_chainstate",
+    "Time spent writing the chainstate to disk after connecting a block"};
+static LatencyHistogram latency_connect_tip{
+    "connect_tip", "Total time spent connecting a block to the active chain"};
+static LatencyHistogram latency_activate_best_chain_step{
+    "activate_best_chain_step",
+    "Time spent in a step of ActivateBestChain, connecting or disconnecting "
+    "a batch of blocks"};
+
 /**
  * Connect a new block to m_chain. pblock is either nullptr or a pointer to
  * a CBlock corresponding to pindexNew, to bypass loading it again from disk.
@@ -3078,6 +3182,7 @@ bool Chainstate::ConnectTip(BlockValidationState &state,
     // Apply the block atomically to the chain state.
     const auto time_2{SteadyClock::now()};
     time_read_from_disk_total += time_2 - time_1;
+    latency_connect_tip_read.Observe(time_2 - time_1);
     SteadyClock::time_point time_3;
     LogPrint(BCLog::BENCH,
              "  - Load block from disk: %.2fms [%.2fs (%.2fms/blk)]\n",
@@ -3193,6 +3298,7 @@ bool Chainstate::ConnectTip(BlockValidationState &state,
 
     const auto time_4{SteadyClock::now()};
     time_flush += time_4 - time_3;
+    latency_connect_tip_flush.Observe(time_4 - time_3);
     LogPrint(BCLog::BENCH, "  - Flush: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_4 - time_3),
              Ticks<SecondsDouble>(time_flush),
@@ -3203,6 +3309,7 @@ bool Chainstate::ConnectTip(BlockValidationState &state,
     }
     const auto time_5{SteadyClock::now()};
     time_chainstate += time_5 - time_4;
+    latency_connect_tip_chainstate.Observe(time_5 - time_4);
     LogPrint(BCLog::BENCH,
              "  - Writing chainstate: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_5 - time_4),
@@ -3232,6 +3339,7 @@ bool Chainstate::ConnectTip(BlockValidationState &state,
     const auto time_6{SteadyClock::now()};
     time_post_connect += time_6 - time_5;
     time_total += time_6 - time_1;
+    latency_connect_tip.Observe(time_6 - time_1);
     LogPrint(BCLog::BENCH,
              "  - Connect postprocess: %.2fms [%.2fs (%.2fms/blk)]\n",
              Ticks<MillisecondsDouble>(time_6 - time_5),
@@ -3454,6 +3562,8 @@ bool Chainstate::ActivateBestChainStep(
         AssertLockHeld(m_mempool->cs);
     }
 
+    LatencyTimer timer{latency_activate_best_chain_step};
+
     const CBlockIndex *pindexOldTip = m_chain.Tip();
     const CBlockIndex *pindexFork = m_chain.FindFork(pindexMostWork);
 
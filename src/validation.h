@@ -384,6 +384,21 @@ ProcessNewPackage(Chainstate &active_chainstate, CTxMemPool &pool,
                   const Package &txns, bool test_accept)
     EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/**
+ * Verify the input scripts of a batch of transactions on the script check
+ * worker threads, storing the valid signatures in the signature cache.
+ *
+ * This doesn't add anything to the mempool, but makes a subsequent
+ * AcceptToMemoryPool() of the same transactions skip the expensive signature
+ * checks. Transactions are expected to be topologically sorted, inputs can be
+ * spent from the UTXO set, the mempool or a previous transaction in the batch.
+ *
+ * @returns the number of script checks that were run.
+ */
+size_t PreverifyMempoolTransactions(Chainstate &active_chainstate,
+                                    const std::vector<CTransactionRef> &txs)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 /**
  * Simple class for regulating resource usage during CheckInputScripts (and
  * CScriptCheck), atomic so as to be compatible with parallel validation.
@@ -5,10 +5,12 @@
 #ifndef BITCOIN_ZMQ_ZMQABSTRACTNOTIFIER_H
 #define BITCOIN_ZMQ_ZMQABSTRACTNOTIFIER_H
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 
 class CBlockIndex;
 class CTransaction;
@@ -21,11 +23,20 @@ class CZMQAbstractNotifier {
 public:
     static const int DEFAULT_ZMQ_SNDHWM{1000};
 
+    struct QueueStats {
+        //! Messages waiting to be sent
+        size_t queued{0};
+        //! Highest number of messages that were waiting to be sent
+        size_t max_queued{0};
+        //! Messages dropped because the queue was full
+        uint64_t dropped{0};
+    };
+
     virtual ~CZMQAbstractNotifier();
 
-    template <typename T>
-    static std::unique_ptr<CZMQAbstractNotifier> Create() {
-        return std::make_unique<T>();
+    template <typename T, typename... Args>
+    static std::unique_ptr<CZMQAbstractNotifier> Create(Args &&...args) {
+        return std::make_unique<T>(std::forward<Args>(args)...);
     }
 
     std::string GetType() const { return type; }
@@ -44,6 +55,8 @@ public:
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
 
+    virtual QueueStats GetQueueStats() const { return {}; }
+
     // Notifies of ConnectTip result, i.e., new active tip only
     virtual bool NotifyBlock(const CBlockIndex *pindex);
     // Notifies of every block connection
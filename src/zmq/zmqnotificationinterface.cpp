@@ -12,8 +12,15 @@
 #include <kernel/chain.h>
 #include <logging.h>
 #include <primitives/block.h>
+#include <streams.h>
 
-CZMQNotificationInterface::CZMQNotificationInterface() : pcontext(nullptr) {}
+#include <algorithm>
+
+CZMQNotificationInterface::CZMQNotificationInterface(
+    std::function<bool(CBlock &, const CBlockIndex &)> get_block_by_index,
+    size_t max_queued_messages)
+    : pcontext(nullptr), m_get_block_by_index{std::move(get_block_by_index)},
+      m_queue{max_queued_messages} {}
 
 CZMQNotificationInterface::~CZMQNotificationInterface() {
     Shutdown();
@@ -30,20 +37,40 @@ CZMQNotificationInterface::GetActiveNotifiers() const {
 
 std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create(
     std::function<bool(CBlock &, const CBlockIndex &)> get_block_by_index) {
+    std::unique_ptr<CZMQNotificationInterface> notificationInterface(
+        new CZMQNotificationInterface(
+            std::move(get_block_by_index),
+            std::max<int64_t>(1, gArgs.GetIntArg(
+                                     "-zmqqueuesize",
+                                     CZMQPublishQueue::DEFAULT_MAX_SIZE))));
+    CZMQNotificationInterface *self{notificationInterface.get()};
+    CZMQPublishQueue &queue{notificationInterface->m_queue};
+
     std::map<std::string, CZMQNotifierFactory> factories;
-    factories["pubhashblock"] =
-        CZMQAbstractNotifier::Create<CZMQPublishHashBlockNotifier>;
-    factories["pubhashtx"] =
-        CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
-    factories["pubrawblock"] =
-        [&get_block_by_index]() -> std::unique_ptr<CZMQAbstractNotifier> {
-        return std::make_unique<CZMQPublishRawBlockNotifier>(
-            get_block_by_index);
+    factories["pubhashblock"] = [&queue] {
+        return CZMQAbstractNotifier::Create<CZMQPublishHashBlockNotifier>(
+            queue);
+    };
+    factories["pubhashtx"] = [&queue] {
+        return CZMQAbstractNotifier::Create<
+            CZMQPublishHashTransactionNotifier>(queue);
+    };
+    factories["pubrawblock"] = [&queue, self] {
+        return CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>(
+            queue, [self](const CBlockIndex &index) {
+                return self->GetRawBlock(index);
+            });
+    };
+    factories["pubrawtx"] = [&queue, self] {
+        return CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>(
+            queue, [self](const CTransaction &tx) {
+                return self->GetRawTransaction(tx);
+            });
+    };
+    factories["pubsequence"] = [&queue] {
+        return CZMQAbstractNotifier::Create<CZMQPublishSequenceNotifier>(
+            queue);
     };
-    factories["pubrawtx"] =
-        CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
-    factories["pubsequence"] =
-        CZMQAbstractNotifier::Create<CZMQPublishSequenceNotifier>;
 
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
     for (const auto &entry : factories) {
@@ -61,8 +88,6 @@ std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create(
     }
 
     if (!notifiers.empty()) {
-        std::unique_ptr<CZMQNotificationInterface> notificationInterface(
-            new CZMQNotificationInterface());
         notificationInterface->notifiers = std::move(notifiers);
 
         if (notificationInterface->Initialize()) {
@@ -100,6 +125,8 @@ bool CZMQNotificationInterface::Initialize() {
         }
     }
 
+    m_queue.Start();
+
     return true;
 }
 
@@ -107,6 +134,8 @@ bool CZMQNotificationInterface::Initialize() {
 void CZMQNotificationInterface::Shutdown() {
     LogPrint(BCLog::ZMQ, "zmq: Shutdown notification interface\n");
     if (pcontext) {
+        // Publish what is left before closing the sockets
+        m_queue.Stop();
         for (auto &notifier : notifiers) {
             LogPrint(BCLog::ZMQ, "zmq: Shutdown notifier %s at %s\n",
                      notifier->GetType(), notifier->GetAddress());
@@ -181,6 +210,15 @@ void CZMQNotificationInterface::BlockConnected(
     if (role == ChainstateRole::BACKGROUND) {
         return;
     }
+
+    // Keep the block in case it is the new tip, so the rawblock notifiers
+    // don't need to read it back from disk
+    {
+        LOCK(m_raw_mutex);
+        m_connected_block = pblock;
+        m_connected_block_index = pindexConnected;
+    }
+
     for (const CTransactionRef &ptx : pblock->vtx) {
         const CTransaction &tx = *ptx;
         TryForEachAndRemoveFailed(notifiers,
@@ -214,4 +252,46 @@ void CZMQNotificationInterface::BlockDisconnected(
         });
 }
 
+ZMQPayload CZMQNotificationInterface::GetRawBlock(const CBlockIndex &index) {
+    LOCK(m_raw_mutex);
+    if (m_raw_block_index == &index) {
+        return m_raw_block;
+    }
+
+    std::shared_ptr<const CBlock> block;
+    if (m_connected_block_index == &index) {
+        block = m_connected_block;
+    } else {
+        auto read_block{std::make_shared<CBlock>()};
+        if (!m_get_block_by_index(*read_block, index)) {
+            return nullptr;
+        }
+        block = std::move(read_block);
+    }
+
+    auto raw_block{std::make_shared<std::vector<uint8_t>>()};
+    raw_block->reserve(::GetSerializeSize(*block));
+    VectorWriter{*raw_block, 0, *block};
+
+    m_raw_block = std::move(raw_block);
+    m_raw_block_index = &index;
+    return m_raw_block;
+}
+
+ZMQPayload
+CZMQNotificationInterface::GetRawTransaction(const CTransaction &tx) {
+    LOCK(m_raw_mutex);
+    if (m_raw_tx && m_raw_txid == tx.GetId()) {
+        return m_raw_tx;
+    }
+
+    auto raw_tx{std::make_shared<std::vector<uint8_t>>()};
+    raw_tx->reserve(::GetSerializeSize(tx));
+    VectorWriter{*raw_tx, 0, tx};
+
+    m_raw_tx = std::move(raw_tx);
+    m_raw_txid = tx.GetId();
+    return m_raw_tx;
+}
+
 std::unique_ptr<CZMQNotificationInterface> g_zmq_notification_interface;
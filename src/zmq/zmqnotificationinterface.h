@@ -5,8 +5,13 @@
 #ifndef BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
 #define BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
 
+#include <primitives/txid.h>
+#include <sync.h>
+#include <threadsafety.h>
 #include <validationinterface.h>
+#include <zmq/zmqpublishnotifier.h>
 
+#include <cstddef>
 #include <functional>
 #include <list>
 #include <memory>
@@ -44,10 +49,34 @@ protected:
                          bool fInitialDownload) override;
 
 private:
-    CZMQNotificationInterface();
+    CZMQNotificationInterface(
+        std::function<bool(CBlock &, const CBlockIndex &)> get_block_by_index,
+        size_t max_queued_messages);
+
+    /**
+     * The raw block and transaction being published, serialized once for all
+     * the notifiers. The block just connected is used if it is the one asked
+     * for, otherwise it is read from disk.
+     */
+    ZMQPayload GetRawBlock(const CBlockIndex &index)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_raw_mutex);
+    ZMQPayload GetRawTransaction(const CTransaction &tx)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_raw_mutex);
 
     void *pcontext;
+    const std::function<bool(CBlock &, const CBlockIndex &)>
+        m_get_block_by_index;
+    CZMQPublishQueue m_queue;
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
+
+    Mutex m_raw_mutex;
+    std::shared_ptr<const CBlock> m_connected_block GUARDED_BY(m_raw_mutex);
+    const CBlockIndex *m_connected_block_index GUARDED_BY(m_raw_mutex){
+        nullptr};
+    ZMQPayload m_raw_block GUARDED_BY(m_raw_mutex);
+    const CBlockIndex *m_raw_block_index GUARDED_BY(m_raw_mutex){nullptr};
+    ZMQPayload m_raw_tx GUARDED_BY(m_raw_mutex);
+    TxId m_raw_txid GUARDED_BY(m_raw_mutex);
 };
 
 extern std::unique_ptr<CZMQNotificationInterface> g_zmq_notification_interface;
@@ -14,12 +14,15 @@
 #include <primitives/txid.h>
 #include <rpc/server.h>
 #include <streams.h>
+#include <util/thread.h>
 #include <zmq/zmqutil.h>
 
 #include <zmq.h>
 
-#include <cstdarg>
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <cstring>
 #include <map>
 #include <string>
 #include <utility>
@@ -33,44 +36,149 @@ static const char *MSG_RAWBLOCK = "rawblock";
 static const char *MSG_RAWTX = "rawtx";
 static const char *MSG_SEQUENCE = "sequence";
 
-// Internal function to send multipart message
-static int zmq_send_multipart(void *sock, const void *data, size_t size, ...) {
-    va_list args;
-    va_start(args, size);
+// Internal function to send a message part, copying the data
+static bool zmq_send_part(void *sock, const void *data, size_t size,
+                          bool more) {
+    zmq_msg_t msg;
 
-    while (1) {
-        zmq_msg_t msg;
+    int rc = zmq_msg_init_size(&msg, size);
+    if (rc != 0) {
+        zmqError("Unable to initialize ZMQ msg");
+        return false;
+    }
 
-        int rc = zmq_msg_init_size(&msg, size);
-        if (rc != 0) {
-            zmqError("Unable to initialize ZMQ msg");
-            va_end(args);
-            return -1;
-        }
+    void *buf = zmq_msg_data(&msg);
+    memcpy(buf, data, size);
+
+    rc = zmq_msg_send(&msg, sock, more ? ZMQ_SNDMORE : 0);
+    zmq_msg_close(&msg);
+    if (rc == -1) {
+        zmqError("Unable to send ZMQ msg");
+        return false;
+    }
+    return true;
+}
 
-        void *buf = zmq_msg_data(&msg);
-        memcpy(buf, data, size);
+static void zmq_release_payload(void * /*data*/, void *hint) {
+    delete static_cast<ZMQPayload *>(hint);
+}
 
-        data = va_arg(args, const void *);
+// Internal function to send a message part without copying the payload, which
+// is only released once ZMQ is done with it
+static bool zmq_send_payload(void *sock, const ZMQPayload &payload,
+                             bool more) {
+    zmq_msg_t msg;
+
+    auto *hint = new ZMQPayload(payload);
+    int rc = zmq_msg_init_data(&msg, const_cast<uint8_t *>(payload->data()),
+                               payload->size(), zmq_release_payload, hint);
+    if (rc != 0) {
+        delete hint;
+        zmqError("Unable to initialize ZMQ msg");
+        return false;
+    }
+
+    rc = zmq_msg_send(&msg, sock, more ? ZMQ_SNDMORE : 0);
+    zmq_msg_close(&msg);
+    if (rc == -1) {
+        zmqError("Unable to send ZMQ msg");
+        return false;
+    }
+    return true;
+}
+
+CZMQPublishQueue::~CZMQPublishQueue() {
+    Stop();
+}
+
+void CZMQPublishQueue::Start() {
+    assert(!m_thread.joinable());
+    m_thread = std::thread(&util::TraceThread, "zmqpub",
+                           [this] { ThreadPublish(); });
+}
 
-        rc = zmq_msg_send(&msg, sock, data ? ZMQ_SNDMORE : 0);
-        if (rc == -1) {
-            zmqError("Unable to send ZMQ msg");
-            zmq_msg_close(&msg);
-            va_end(args);
-            return -1;
+void CZMQPublishQueue::Stop() {
+    {
+        LOCK(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool CZMQPublishQueue::Push(CZMQAbstractPublishNotifier &notifier,
+                            const char *command, ZMQPayload data,
+                            uint32_t sequence) {
+    {
+        LOCK(m_mutex);
+        if (m_stop || m_messages.size() >= m_max_size) {
+            ++notifier.m_dropped;
+            return false;
+        }
+        m_messages.push_back({&notifier, command, std::move(data), sequence});
+        const size_t queued{++notifier.m_queued};
+        if (queued > notifier.m_max_queued) {
+            notifier.m_max_queued = queued;
         }
+    }
+    m_cond.notify_all();
+    return true;
+}
 
-        zmq_msg_close(&msg);
+void CZMQPublishQueue::Remove(const CZMQAbstractPublishNotifier &notifier) {
+    WAIT_LOCK(m_mutex, lock);
+    m_messages.erase(std::remove_if(m_messages.begin(), m_messages.end(),
+                                    [&](const Message &message) {
+                                        return message.notifier == &notifier;
+                                    }),
+                     m_messages.end());
+    m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+        return m_sending != &notifier;
+    });
+}
 
-        if (!data) {
-            break;
+void CZMQPublishQueue::ThreadPublish() {
+    WAIT_LOCK(m_mutex, lock);
+    while (true) {
+        m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            return m_stop || !m_messages.empty();
+        });
+        if (m_messages.empty()) {
+            // Stopped and everything was sent
+            return;
         }
 
-        size = va_arg(args, size_t);
+        Message message{std::move(m_messages.front())};
+        m_messages.pop_front();
+        CZMQAbstractPublishNotifier &notifier{*message.notifier};
+        --notifier.m_queued;
+        // The notifier and its socket are kept until the message is sent, see
+        // Remove()
+        m_sending = &notifier;
+
+        bool sent;
+        {
+            REVERSE_LOCK(lock);
+
+            /* send three parts, command & data & a LE 4byte sequence number */
+            uint8_t msgseq[sizeof(uint32_t)];
+            WriteLE32(msgseq, message.sequence);
+            sent = zmq_send_part(notifier.psocket, message.command,
+                                 strlen(message.command), /*more=*/true) &&
+                   zmq_send_payload(notifier.psocket, message.data,
+                                    /*more=*/true) &&
+                   zmq_send_part(notifier.psocket, msgseq, sizeof(msgseq),
+                                 /*more=*/false);
+        }
+
+        if (!sent) {
+            notifier.m_send_failed = true;
+        }
+        m_sending = nullptr;
+        m_cond.notify_all();
     }
-    va_end(args);
-    return 0;
 }
 
 bool CZMQAbstractPublishNotifier::Initialize(void *pcontext) {
@@ -139,6 +247,8 @@ void CZMQAbstractPublishNotifier::Shutdown() {
         return;
     }
 
+    m_queue.Remove(*this);
+
     int count = mapPublishNotifiers.count(address);
 
     // remove this notifier from the list of publishers using this address
@@ -167,23 +277,32 @@ void CZMQAbstractPublishNotifier::Shutdown() {
 bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command,
                                                  const void *data,
                                                  size_t size) {
+    const uint8_t *bytes{static_cast<const uint8_t *>(data)};
+    return SendZmqMessage(command, std::make_shared<const std::vector<uint8_t>>(
+                                       bytes, bytes + size));
+}
+
+bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command,
+                                                 ZMQPayload data) {
     assert(psocket);
 
-    /* send three parts, command & data & a LE 4byte sequence number */
-    uint8_t msgseq[sizeof(uint32_t)];
-    WriteLE32(msgseq, nSequence);
-    int rc = zmq_send_multipart(psocket, command, strlen(command), data, size,
-                                msgseq, (size_t)sizeof(uint32_t), nullptr);
-    if (rc == -1) {
+    if (m_send_failed) {
         return false;
     }
 
-    /* increment memory only sequence number after sending */
+    // The sequence number is used even if the message is dropped, so the
+    // subscribers can tell
+    m_queue.Push(*this, command, std::move(data), nSequence);
     nSequence++;
 
     return true;
 }
 
+CZMQAbstractNotifier::QueueStats
+CZMQAbstractPublishNotifier::GetQueueStats() const {
+    return {m_queued, m_max_queued, m_dropped};
+}
+
 bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex) {
     BlockHash hash = pindex->GetBlockHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish hashblock %s to %s\n", hash.GetHex(),
@@ -211,16 +330,13 @@ bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex) {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawblock %s to %s\n",
              pindex->GetBlockHash().GetHex(), this->address);
 
-    DataStream ss{};
-    CBlock block;
-    if (!m_get_block_by_index(block, *pindex)) {
+    ZMQPayload raw_block{m_get_raw_block(*pindex)};
+    if (!raw_block) {
         zmqError("Can't read block from disk");
         return false;
     }
 
-    ss << block;
-
-    return SendZmqMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
+    return SendZmqMessage(MSG_RAWBLOCK, std::move(raw_block));
 }
 
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(
@@ -228,9 +344,7 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(
     TxId txid = transaction.GetId();
     LogPrint(BCLog::ZMQ, "zmq: Publish rawtx %s to %s\n", txid.GetHex(),
              this->address);
-    DataStream ss{};
-    ss << transaction;
-    return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
+    return SendZmqMessage(MSG_RAWTX, m_get_raw_tx(transaction));
 }
 
 // TODO: Dedup this code to take label char, log string
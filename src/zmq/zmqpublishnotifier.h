@@ -7,58 +7,156 @@
 
 #include <zmq/zmqabstractnotifier.h>
 
+#include <sync.h>
+#include <threadsafety.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
 
-class CBlock;
 class CBlockIndex;
+class CTransaction;
+class CZMQAbstractPublishNotifier;
+
+/** A serialized message body, shared by all the notifiers publishing it */
+using ZMQPayload = std::shared_ptr<const std::vector<uint8_t>>;
+
+/**
+ * Messages waiting to be sent by a dedicated thread, so the validation
+ * interface callbacks never wait for the sockets.
+ *
+ * The queue is bounded: once it holds max_size messages the new ones are
+ * dropped, which the subscribers can notice from the gap in the sequence
+ * numbers.
+ */
+class CZMQPublishQueue {
+public:
+    static constexpr size_t DEFAULT_MAX_SIZE{10000};
+
+    explicit CZMQPublishQueue(size_t max_size) : m_max_size{max_size} {}
+    ~CZMQPublishQueue();
+
+    void Start();
+    /** Send the messages still queued, then stop the thread */
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Return false if the queue is full and the message was dropped */
+    bool Push(CZMQAbstractPublishNotifier &notifier, const char *command,
+              ZMQPayload data, uint32_t sequence)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Drop the messages queued by the notifier and wait until none of them
+     * is being sent, so its socket can be closed.
+     */
+    void Remove(const CZMQAbstractPublishNotifier &notifier)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Message {
+        CZMQAbstractPublishNotifier *notifier;
+        const char *command;
+        ZMQPayload data;
+        uint32_t sequence;
+    };
+
+    void ThreadPublish() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    const size_t m_max_size;
+
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Message> m_messages GUARDED_BY(m_mutex);
+    //! The notifier whose message is being sent, if any
+    const CZMQAbstractPublishNotifier *m_sending GUARDED_BY(m_mutex){nullptr};
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    std::thread m_thread;
+};
 
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier {
 private:
+    CZMQPublishQueue &m_queue;
+
     //! upcounting per message sequence number
     uint32_t nSequence{0U};
 
+    //! Updated by the queue
+    std::atomic<size_t> m_queued{0};
+    std::atomic<size_t> m_max_queued{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<bool> m_send_failed{false};
+
+    friend class CZMQPublishQueue;
+
 public:
-    /* send zmq multipart message
+    explicit CZMQAbstractPublishNotifier(CZMQPublishQueue &queue)
+        : m_queue{queue} {}
+
+    /* queue zmq multipart message
        parts:
           * command
           * data
           * message sequence number
+       Return false if a previous message could not be sent.
     */
     bool SendZmqMessage(const char *command, const void *data, size_t size);
+    bool SendZmqMessage(const char *command, ZMQPayload data);
 
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
+
+    QueueStats GetQueueStats() const override;
 };
 
 class CZMQPublishHashBlockNotifier : public CZMQAbstractPublishNotifier {
 public:
+    using CZMQAbstractPublishNotifier::CZMQAbstractPublishNotifier;
     bool NotifyBlock(const CBlockIndex *pindex) override;
 };
 
 class CZMQPublishHashTransactionNotifier : public CZMQAbstractPublishNotifier {
 public:
+    using CZMQAbstractPublishNotifier::CZMQAbstractPublishNotifier;
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
 class CZMQPublishRawBlockNotifier : public CZMQAbstractPublishNotifier {
 private:
-    const std::function<bool(CBlock &, const CBlockIndex &)>
-        m_get_block_by_index;
+    //! Return nullptr if the block cannot be read
+    const std::function<ZMQPayload(const CBlockIndex &)> m_get_raw_block;
 
 public:
     CZMQPublishRawBlockNotifier(
-        std::function<bool(CBlock &, const CBlockIndex &)> get_block_by_index)
-        : m_get_block_by_index{std::move(get_block_by_index)} {}
+        CZMQPublishQueue &queue,
+        std::function<ZMQPayload(const CBlockIndex &)> get_raw_block)
+        : CZMQAbstractPublishNotifier{queue},
+          m_get_raw_block{std::move(get_raw_block)} {}
     bool NotifyBlock(const CBlockIndex *pindex) override;
 };
 
 class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier {
+private:
+    const std::function<ZMQPayload(const CTransaction &)> m_get_raw_tx;
+
 public:
+    CZMQPublishRawTransactionNotifier(
+        CZMQPublishQueue &queue,
+        std::function<ZMQPayload(const CTransaction &)> get_raw_tx)
+        : CZMQAbstractPublishNotifier{queue},
+          m_get_raw_tx{std::move(get_raw_tx)} {}
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
 class CZMQPublishSequenceNotifier : public CZMQAbstractPublishNotifier {
 public:
+    using CZMQAbstractPublishNotifier::CZMQAbstractPublishNotifier;
     bool NotifyBlockConnect(const CBlockIndex *pindex) override;
     bool NotifyBlockDisconnect(const CBlockIndex *pindex) override;
     bool NotifyTransactionAcceptance(const CTransaction &transaction,
@@ -32,6 +32,14 @@ static RPCHelpMan getzmqnotifications() {
                       "Address of the publisher"},
                      {RPCResult::Type::NUM, "hwm",
                       "Outbound message high water mark"},
+                     {RPCResult::Type::NUM, "queued",
+                      "Number of messages waiting to be published"},
+                     {RPCResult::Type::NUM, "max_queued",
+                      "Highest number of messages that were waiting to be "
+                      "published"},
+                     {RPCResult::Type::NUM, "dropped",
+                      "Number of messages dropped because too many were "
+                      "waiting to be published (see -zmqqueuesize)"},
                  }},
             }},
         RPCExamples{HelpExampleCli("getzmqnotifications", "") +
@@ -46,6 +54,10 @@ static RPCHelpMan getzmqnotifications() {
                     obj.pushKV("type", n->GetType());
                     obj.pushKV("address", n->GetAddress());
                     obj.pushKV("hwm", n->GetOutboundMessageHighWaterMark());
+                    const auto queue_stats{n->GetQueueStats()};
+                    obj.pushKV("queued", uint64_t(queue_stats.queued));
+                    obj.pushKV("max_queued", uint64_t(queue_stats.max_queued));
+                    obj.pushKV("dropped", queue_stats.dropped);
                     result.push_back(std::move(obj));
                 }
             }
@@ -12,7 +12,12 @@ from io import BytesIO
 from struct import pack, unpack
 
 from test_framework.blocktools import COINBASE_MATURITY
-from test_framework.messages import BLOCK_HEADER_SIZE
+from test_framework.messages import (
+    BLOCK_HEADER_SIZE,
+    deser_string,
+    ser_compact_size,
+    ser_uint256,
+)
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import (
     assert_equal,
@@ -411,6 +416,60 @@ class RESTTest(BitcoinTestFramework):
             assert_equal(json_obj[tx]["spentby"], txs[i + 1 : i + 2])
             assert_equal(json_obj[tx]["depends"], txs[i - 1 : i])
 
+        self.log.info("Test the /txs URI")
+
+        # The transactions are found in the mempool, an empty one is returned
+        # for the unknown txid
+        unknown_txid = "ab" * 32
+        request = ser_compact_size(4) + b"".join(
+            ser_uint256(int(t, 16)) for t in txs + [unknown_txid]
+        )
+        response = self.test_rest_request(
+            "/txs",
+            http_method="POST",
+            req_type=ReqType.BIN,
+            body=request,
+            ret_type=RetType.BYTES,
+        )
+        f = BytesIO(response)
+        for tx in txs:
+            assert_equal(deser_string(f).hex(), self.nodes[0].getrawtransaction(tx))
+        assert_equal(deser_string(f), b"")
+        assert_equal(f.read(), b"")
+
+        response_hex = self.test_rest_request(
+            "/txs",
+            http_method="POST",
+            req_type=ReqType.HEX,
+            body=request.hex(),
+            ret_type=RetType.BYTES,
+        )
+        assert_equal(response_hex.strip(b"\n"), response.hex().encode())
+
+        self.test_rest_request(
+            "/txs",
+            http_method="POST",
+            req_type=ReqType.BIN,
+            status=400,
+            ret_type=RetType.OBJ,
+        )
+        self.test_rest_request(
+            "/txs",
+            http_method="POST",
+            req_type=ReqType.BIN,
+            body=ser_compact_size(2) + ser_uint256(1),
+            status=400,
+            ret_type=RetType.OBJ,
+        )
+        self.test_rest_request(
+            "/txs",
+            http_method="POST",
+            req_type=ReqType.JSON,
+            body=request,
+            status=404,
+            ret_type=RetType.OBJ,
+        )
+
         # Now mine the transactions
         newblockhash = self.generate(self.nodes[1], 1)
 
@@ -435,6 +494,49 @@ class RESTTest(BitcoinTestFramework):
         for tx in txs:
             assert tx in json_obj["tx"]
 
+        self.log.info("Test the /blocks URI")
+
+        tip_height = self.nodes[0].getblockcount()
+        expected = b"".join(
+            self.test_rest_request(
+                f"/block/{self.nodes[0].getblockhash(h)}",
+                req_type=ReqType.BIN,
+                ret_type=RetType.BYTES,
+            )
+            for h in range(tip_height - 2, tip_height + 1)
+        )
+        response = self.test_rest_request(
+            f"/blocks/{tip_height - 2}/3", req_type=ReqType.BIN, ret_type=RetType.BYTES
+        )
+        assert_equal(response, expected)
+        response_hex = self.test_rest_request(
+            f"/blocks/{tip_height - 2}/3", req_type=ReqType.HEX, ret_type=RetType.BYTES
+        )
+        assert_equal(response_hex.strip(b"\n"), expected.hex().encode())
+
+        # The blocks above the tip are left out
+        response = self.test_rest_request(
+            f"/blocks/{tip_height - 2}/1000",
+            req_type=ReqType.BIN,
+            ret_type=RetType.BYTES,
+        )
+        assert_equal(response, expected)
+
+        resp = self.test_rest_request(
+            f"/blocks/{tip_height + 1}/1",
+            req_type=ReqType.BIN,
+            status=404,
+            ret_type=RetType.OBJ,
+        )
+        assert_equal(resp.read().decode("utf-8").rstrip(), "Block height out of range")
+        for uri in ["/blocks/0/0", "/blocks/0/1001", "/blocks/-1/1", "/blocks/0"]:
+            self.test_rest_request(
+                uri, req_type=ReqType.BIN, status=400, ret_type=RetType.OBJ
+            )
+        self.test_rest_request(
+            "/blocks/0/1", req_type=ReqType.JSON, status=404, ret_type=RetType.OBJ
+        )
+
         self.log.info("Test the /chaininfo URI")
 
         bb_hash = self.nodes[0].getbestblockhash()
@@ -442,6 +544,45 @@ class RESTTest(BitcoinTestFramework):
         json_obj = self.test_rest_request("/chaininfo")
         assert_equal(json_obj["bestblockhash"], bb_hash)
 
+        self.log.info("Test the /events URI")
+
+        self.test_rest_request("/events/tip,foo", status=400, ret_type=RetType.OBJ)
+        self.test_rest_request(
+            "/events", req_type=ReqType.BIN, status=404, ret_type=RetType.OBJ
+        )
+
+        conn = http.client.HTTPConnection(self.url.hostname, self.url.port)
+        conn.request("GET", "/rest/events/tip,mempool.json")
+        resp = conn.getresponse()
+        assert_equal(resp.status, 200)
+        assert_equal(resp.getheader("Content-Type"), "text/event-stream")
+        # Once this is received, no event can be missed
+        assert_equal(resp.readline(), b": subscribed\n")
+        assert_equal(resp.readline(), b"\n")
+
+        def read_event():
+            fields = {}
+            while "event" not in fields:
+                # Skip the keep-alive comments
+                for line in iter(resp.readline, b"\n"):
+                    if not line.startswith(b":"):
+                        name, value = line.decode().rstrip("\n").split(": ", 1)
+                        fields[name] = value
+            return fields["event"], json.loads(fields["data"])
+
+        txid = self.nodes[0].sendtoaddress(self.nodes[1].getnewaddress(), 1)
+        event, data = read_event()
+        assert_equal(event, "mempooladd")
+        assert_equal(data["txid"], txid)
+        assert_equal(data["size"], self.nodes[0].getmempoolentry(txid)["size"])
+
+        bb_hash = self.generate(self.nodes[0], 1)[0]
+        event, data = read_event()
+        assert_equal(event, "tip")
+        assert_equal(data["hash"], bb_hash)
+        assert_equal(data["height"], self.nodes[0].getblockcount())
+        conn.close()
+
 
 if __name__ == "__main__":
     RESTTest().main()
@@ -3,14 +3,21 @@
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
 """Tests some generic aspects of the RPC interface."""
 
+import http.client
 import multiprocessing
 import os
 import subprocess
 import time
+import urllib.parse
 
 from test_framework.authproxy import JSONRPCException
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.util import assert_equal, assert_greater_than_or_equal
+from test_framework.test_node import ErrorMatch
+from test_framework.util import (
+    assert_equal,
+    assert_greater_than_or_equal,
+    str_to_b64str,
+)
 
 
 def expect_http_status(expected_http_status, expected_rpc_code, fcn, *args):
@@ -52,6 +59,13 @@ class RPCInterfaceTest(BitcoinTestFramework):
             os.path.join(self.nodes[0].datadir, self.chain, "debug.log"),
         )
 
+        assert_equal(len(info["work_queues"]), 1)
+        queue = info["work_queues"][0]
+        assert_equal(queue["name"], "default")
+        assert_equal(queue["targets"], [])
+        assert_greater_than_or_equal(queue["threads"], 1)
+        assert_equal(queue["rejected"], 0)
+
     def test_batch_request(self):
         self.log.info("Testing basic JSON-RPC batch request...")
 
@@ -114,11 +128,92 @@ class RPCInterfaceTest(BitcoinTestFramework):
                 error_queue.get(), "error: Server response: Work queue depth exceeded\n"
             )
 
+    def test_work_lanes(self):
+        self.log.info("Testing work lanes...")
+        node = self.nodes[0]
+        self.stop_node(0)
+        for lane, error in [
+            ("fast", "expected <name>:<threads>"),
+            ("Fast:1:uptime", "the name can only contain"),
+            ("default:1:uptime", "the lane default is defined already"),
+            ("fast:0:uptime", "the number of threads must be at least 1"),
+            ("fast:1:", "no method or endpoint to serve"),
+        ]:
+            node.assert_start_raises_init_error(
+                [f"-rpcworklane={lane}"],
+                f"Error: Invalid -rpcworklane={lane}: {error}",
+                match=ErrorMatch.PARTIAL_REGEX,
+            )
+
+        self.start_node(0, ["-rpcworklane=fast:2:uptime,getblockcount"])
+        for _ in range(3):
+            node.getblockcount()
+        node.uptime()
+        # Batches are served by the default lane
+        node.batch([{"method": "uptime", "id": 1}])
+
+        # The requests are accounted for once the reply is sent
+        self.wait_until(lambda: node.getrpcinfo()["work_queues"][1]["processed"] == 4)
+        queues = node.getrpcinfo()["work_queues"]
+        assert_equal([q["name"] for q in queues], ["default", "fast"])
+        fast = queues[1]
+        assert_equal(fast["threads"], 2)
+        assert_equal(fast["targets"], ["uptime", "getblockcount"])
+        assert_equal(fast["rejected"], 0)
+        assert "run_p50" in fast
+
+    def test_concurrent_batch(self):
+        self.log.info("Testing concurrent batch execution...")
+        node = self.nodes[0]
+        self.generate(node, 10, sync_fun=self.no_op)
+        requests = []
+        for i in range(1000):
+            if i % 2:
+                requests.append({"method": "getblockhash", "id": i, "params": [i % 12]})
+            else:
+                requests.append({"method": "getblockcount", "id": i})
+
+        start = time.time()
+        expected = node.batch(requests)
+        sequential_time = time.time() - start
+
+        self.restart_node(0, ["-rpcbatchthreads=4"])
+        start = time.time()
+        results = node.batch(requests)
+        concurrent_time = time.time() - start
+        self.log.info(
+            f"Batch of {len(requests)} requests: {sequential_time:.3f}s with 1 "
+            f"thread, {concurrent_time:.3f}s with 4 threads"
+        )
+
+        # The replies are in the order of the requests, whatever the threads
+        assert_equal([res["id"] for res in results], list(range(1000)))
+        assert_equal(results, expected)
+        # Out of range heights fail on their own
+        assert_equal(results[23]["error"]["code"], -8)
+
+        # Accepted credentials are remembered, a wrong password still isn't
+        url = urllib.parse.urlparse(node.url)
+        for password, status in [(url.password, 200), ("wrong", 401)] * 2:
+            auth = str_to_b64str(f"{url.username}:{password}")
+            conn = http.client.HTTPConnection(url.hostname, url.port)
+            conn.request(
+                "POST",
+                "/",
+                '{"method": "getblockcount"}',
+                {"Authorization": f"Basic {auth}"},
+            )
+            assert_equal(conn.getresponse().status, status)
+            conn.close()
+        self.restart_node(0)
+
     def run_test(self):
         self.test_getrpcinfo()
         self.test_batch_request()
         self.test_http_status_codes()
         self.test_work_queue_exceeded()
+        self.test_work_lanes()
+        self.test_concurrent_batch()
 
 
 if __name__ == "__main__":
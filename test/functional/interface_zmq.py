@@ -11,7 +11,12 @@ from test_framework.address import ADDRESS_ECREG_P2SH_OP_TRUE, ADDRESS_ECREG_UNS
 from test_framework.blocktools import create_block, create_coinbase
 from test_framework.messages import CTransaction, FromHex, hash256
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.util import assert_equal, assert_raises_rpc_error, ensure_for
+from test_framework.util import (
+    assert_equal,
+    assert_greater_than_or_equal,
+    assert_raises_rpc_error,
+    ensure_for,
+)
 
 # Test may be skipped and not have zmq installed
 try:
@@ -230,8 +235,14 @@ class ZMQTest(BitcoinTestFramework):
             assert_equal(payment_txid, txid.hex())
 
         self.log.info("Test the getzmqnotifications RPC")
+        notifications = self.nodes[0].getzmqnotifications()
+        for notification in notifications:
+            # Everything was received, so nothing is left in the queue
+            assert_equal(notification.pop("queued"), 0)
+            assert_greater_than_or_equal(notification.pop("max_queued"), 0)
+            assert_equal(notification.pop("dropped"), 0)
         assert_equal(
-            self.nodes[0].getzmqnotifications(),
+            notifications,
             [
                 {"type": "pubhashblock", "address": address, "hwm": 1000},
                 {"type": "pubhashtx", "address": address, "hwm": 1000},
@@ -218,6 +218,42 @@ class GetblockstatsTest(BitcoinTestFramework):
             -1, "getblockstats hash_or_height ( stats )", self.nodes[0].getblockstats
         )
 
+        self.log.info("Test getblockstatsrange")
+        assert_equal(
+            self.nodes[0].getblockstatsrange(self.start_height, tip),
+            self.expected_stats,
+        )
+        assert_equal(
+            self.nodes[0].getblockstatsrange(tip, tip, ["minfee", "maxfee"]),
+            [{k: self.expected_stats[-1][k] for k in ("minfee", "maxfee")}],
+        )
+        # Every block of the chain, across several batches
+        all_stats = self.nodes[0].getblockstatsrange(0, tip, ["height"])
+        assert_equal(all_stats, [{"height": h} for h in range(tip + 1)])
+
+        assert_raises_rpc_error(
+            -8,
+            f"Target block height {tip + 1} after current tip {tip}",
+            self.nodes[0].getblockstatsrange,
+            0,
+            tip + 1,
+        )
+        assert_raises_rpc_error(
+            -8,
+            "Invalid height range 2-1",
+            self.nodes[0].getblockstatsrange,
+            2,
+            1,
+        )
+        assert_raises_rpc_error(
+            -8,
+            f"Invalid selected statistic {inv_sel_stat}",
+            self.nodes[0].getblockstatsrange,
+            0,
+            tip,
+            ["minfee", inv_sel_stat],
+        )
+
 
 if __name__ == "__main__":
     GetblockstatsTest().main()
@@ -63,6 +63,31 @@ class RpcMiscTest(BitcoinTestFramework):
             -8, "unknown mode foobar", node.getmemoryinfo, mode="foobar"
         )
 
+        self.log.info("test getlatencyinfo")
+        latency = node.getlatencyinfo()
+        for name in [
+            "connect_block_check",
+            "connect_block_inputs",
+            "connect_block_verify",
+            "connect_block_undo",
+            "connect_tip",
+            "accept_to_mempool",
+            "process_headers",
+        ]:
+            assert name in latency
+        for histogram in latency.values():
+            assert_equal(
+                sum(bucket["count"] for bucket in histogram["buckets"]),
+                histogram["count"],
+            )
+
+        prometheus = node.getlatencyinfo(mode="prometheus")
+        assert "# TYPE doged_connect_tip_seconds histogram\n" in prometheus
+        assert 'doged_connect_tip_seconds_bucket{le="+Inf"} ' in prometheus
+        assert_raises_rpc_error(
+            -8, "unknown mode foobar", node.getlatencyinfo, mode="foobar"
+        )
+
         self.log.info("test logging rpc and help")
 
         # Test logging RPC returns the expected number of logging categories.
@@ -19,6 +19,7 @@ from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import (
     assert_equal,
     assert_greater_than,
+    assert_greater_than_or_equal,
     assert_raises_rpc_error,
     p2p_port,
 )
@@ -56,6 +57,7 @@ class NetTest(BitcoinTestFramework):
                 "-avaproofstakeutxodustthreshold=1000000",
                 "-avaproofstakeutxoconfirmations=1",
                 "-minrelaytxfee=5",
+                "-msghandlerthreads=4",
             ],
         ]
         self.supports_cli = False
@@ -72,6 +74,7 @@ class NetTest(BitcoinTestFramework):
         self.test_connection_count()
         self.test_getpeerinfo()
         self.test_getnettotals()
+        self.test_getnetmsgstats()
         self.test_getnetworkinfo()
         self.test_addnode_getaddednodeinfo()
         self.test_service_flags()
@@ -146,6 +149,12 @@ class NetTest(BitcoinTestFramework):
         assert_equal(peer_info[1][0]["connection_type"], "manual")
         assert_equal(peer_info[1][1]["connection_type"], "inbound")
 
+        # The queueing delay is reported whatever the number of message
+        # handler threads
+        for info in peer_info:
+            for peer in info:
+                assert_greater_than_or_equal(peer["msgqueuedelay"], 0)
+
         # Check dynamically generated networks list in getpeerinfo help output.
         assert "(ipv4, ipv6, onion, i2p, not_publicly_routable)" in self.nodes[0].help(
             "getpeerinfo"
@@ -207,6 +216,29 @@ class NetTest(BitcoinTestFramework):
                 timeout=10,
             )
 
+    def test_getnetmsgstats(self):
+        self.log.info("Test getnetmsgstats")
+        # The pongs from the previous test were processed by both nodes
+        stats = self.nodes[0].getnetmsgstats()
+        assert_equal(stats["window"], 600)
+        pong = stats["msgtypes"]["pong"]
+        assert_greater_than_or_equal(pong["count"], 2)
+        assert_greater_than_or_equal(pong["recent_count"], 2)
+        assert_greater_than_or_equal(pong["time"], pong["recent_time"])
+
+        assert_equal(len(stats["peers"]), 2)
+        recent_times = [peer["recent_time"] for peer in stats["peers"]]
+        assert_equal(recent_times, sorted(recent_times, reverse=True))
+
+        # The same stats are reported per peer by getpeerinfo
+        for peer in self.nodes[0].getpeerinfo():
+            processing = peer["msgprocessing_per_msg"]
+            assert_greater_than_or_equal(processing["pong"]["count"], 1)
+            for msg_stats in processing.values():
+                assert_greater_than_or_equal(
+                    msg_stats["time"], msg_stats["recent_time"]
+                )
+
     def test_getnetworkinfo(self):
         self.log.info("Test getnetworkinfo")
         info = self.nodes[0].getnetworkinfo()
@@ -244,6 +276,13 @@ class NetTest(BitcoinTestFramework):
                 int(info["localservices"], 0x10), info["localservicesnames"]
             )
 
+        # check the `blockservecache` field
+        cache_info = self.nodes[0].getnetworkinfo()["blockservecache"]
+        assert_equal(cache_info["max_usage"], 64 << 20)
+        assert_greater_than_or_equal(cache_info["max_usage"], cache_info["usage"])
+        for kind in ["serialized", "decoded"]:
+            assert_greater_than_or_equal(1, cache_info[f"{kind}_hitrate"])
+
         # Check dynamically generated networks list in getnetworkinfo help
         # output.
         assert "(ipv4, ipv6, onion, i2p)" in self.nodes[0].help("getnetworkinfo")